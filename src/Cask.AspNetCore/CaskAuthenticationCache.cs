@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Collections.Concurrent;
+using System.Globalization;
+using System.Security.Claims;
+
+using Microsoft.AspNetCore.Authentication;
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// Caches the claims of each active key, by scheme and fingerprint, so that
+/// requests with a key that was seen before are authenticated without
+/// parsing the key or formatting its claims again. One instance is shared by
+/// all <see cref="CaskAuthenticationHandler"/> instances of an application.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Each entry is a prototype identity that is never handed out: every
+/// request gets a new principal with its own copy of the identity, so that
+/// claims added to the principal of one request are not seen by other
+/// requests with the same key.
+/// </para>
+/// <para>
+/// The claims depend only on the key, so entries never go stale. When the
+/// cache is full, it is cleared rather than trimmed: entries are only
+/// created for active keys and are cheap to create again.
+/// </para>
+/// </remarks>
+public sealed class CaskAuthenticationCache
+{
+    private readonly ConcurrentDictionary<(string Scheme, CaskKeyFingerprint Fingerprint), ClaimsIdentity> _identities = new();
+
+    /// <summary>
+    /// The number of cached identities.
+    /// </summary>
+    public int Count => _identities.Count;
+
+    internal AuthenticateResult Authenticate(string scheme, CaskKeyFingerprint fingerprint, ReadOnlySpan<char> encodedKey, int maxCount)
+    {
+        if (!_identities.TryGetValue((scheme, fingerprint), out ClaimsIdentity? identity))
+        {
+            identity = CreateIdentity(scheme, fingerprint, CaskKey.Create(encodedKey));
+
+            if (maxCount > 0)
+            {
+                if (_identities.Count >= maxCount)
+                {
+                    _identities.Clear();
+                }
+
+                identity = _identities.GetOrAdd((scheme, fingerprint), identity);
+            }
+        }
+
+        // The copy shares the claim values of the prototype. Cloning a
+        // principal would not do, as it shares the identities.
+        return AuthenticateResult.Success(new AuthenticationTicket(new ClaimsPrincipal(identity.Clone()), scheme));
+    }
+
+    private static ClaimsIdentity CreateIdentity(string scheme, CaskKeyFingerprint fingerprint, CaskKey key)
+    {
+        Claim[] claims =
+        [
+            new(ClaimTypes.NameIdentifier, fingerprint.ToString()),
+            new(CaskClaimTypes.ProviderSignature, key.ProviderSignature),
+            new(CaskClaimTypes.ProviderKeyKind, key.ProviderKeyKind.ToString()),
+            new(CaskClaimTypes.Timestamp, key.Timestamp.ToString("O", CultureInfo.InvariantCulture), ClaimValueTypes.DateTime),
+        ];
+
+        return new ClaimsIdentity(claims, scheme);
+    }
+}
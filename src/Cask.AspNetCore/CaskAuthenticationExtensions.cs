@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Microsoft.AspNetCore.Authentication;
+using Microsoft.Extensions.DependencyInjection;
+using Microsoft.Extensions.DependencyInjection.Extensions;
+using Microsoft.Extensions.Options;
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// Registers <see cref="CaskAuthenticationHandler"/>.
+/// </summary>
+public static class CaskAuthenticationExtensions
+{
+    /// <summary>
+    /// The default name of the authentication scheme.
+    /// </summary>
+    public static string DefaultScheme { get; } = "Cask";
+
+    /// <summary>
+    /// Adds CASK key authentication with the <see cref="DefaultScheme"/> name.
+    /// </summary>
+    /// <remarks>
+    /// The application must register an <see cref="IKeyStatusService"/>. A
+    /// shared <see cref="KeyStatusClient"/> is registered for it, configured
+    /// by <see cref="IOptions{KeyStatusClientOptions}"/>, unless the
+    /// application has registered one.
+    /// </remarks>
+    public static AuthenticationBuilder AddCask(this AuthenticationBuilder builder)
+    {
+        return builder.AddCask(DefaultScheme, configureOptions: null);
+    }
+
+    /// <inheritdoc cref="AddCask(AuthenticationBuilder)"/>
+    public static AuthenticationBuilder AddCask(this AuthenticationBuilder builder, Action<CaskAuthenticationOptions>? configureOptions)
+    {
+        return builder.AddCask(DefaultScheme, configureOptions);
+    }
+
+    /// <summary>
+    /// Adds CASK key authentication with the given scheme name.
+    /// </summary>
+    /// <inheritdoc cref="AddCask(AuthenticationBuilder)" path="/remarks"/>
+    public static AuthenticationBuilder AddCask(this AuthenticationBuilder builder, string authenticationScheme, Action<CaskAuthenticationOptions>? configureOptions)
+    {
+        ThrowIfNull(builder);
+
+        builder.Services.TryAddSingleton(services =>
+            new KeyStatusClient(services.GetRequiredService<IKeyStatusService>(),
+                                services.GetRequiredService<IOptions<KeyStatusClientOptions>>().Value));
+
+        builder.Services.TryAddSingleton(new CaskAuthenticationCache());
+
+        return builder.AddScheme<CaskAuthenticationOptions, CaskAuthenticationHandler>(authenticationScheme, configureOptions);
+    }
+}
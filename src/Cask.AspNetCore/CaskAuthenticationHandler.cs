@@ -0,0 +1,155 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Text.Encodings.Web;
+
+using Microsoft.AspNetCore.Authentication;
+using Microsoft.AspNetCore.Http;
+using Microsoft.Extensions.Logging;
+using Microsoft.Extensions.Options;
+using Microsoft.Extensions.Primitives;
+using Microsoft.Net.Http.Headers;
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// Authenticates requests that carry a CASK key in a header.
+/// </summary>
+/// <remarks>
+/// <para>
+/// A request is authenticated if its header holds a valid key that the
+/// <see cref="KeyStatusClient"/> reports as <see cref="KeyStatus.Active"/>.
+/// The status lookup is cached, batched and coalesced by the client, which
+/// calls the <see cref="IKeyStatusService"/> registered by the application.
+/// </para>
+/// <para>
+/// The key is validated and fingerprinted in place in the header value,
+/// without creating a string or a <see cref="CaskKey"/>. The principal for
+/// a key, with a <see cref="System.Security.Claims.ClaimTypes.NameIdentifier"/>
+/// claim holding its fingerprint and the claims in <see cref="CaskClaimTypes"/>,
+/// is created the first time the key is seen and is then copied for each
+/// request with the same key, so each request may modify its own principal.
+/// </para>
+/// </remarks>
+public sealed class CaskAuthenticationHandler : AuthenticationHandler<CaskAuthenticationOptions>
+{
+    private static readonly Task<AuthenticateResult> s_noResult = Task.FromResult(AuthenticateResult.NoResult());
+    private static readonly Task<AuthenticateResult> s_invalidKey = Task.FromResult(AuthenticateResult.Fail("The key is not a valid CASK key."));
+    private static readonly Task<AuthenticateResult> s_multipleKeys = Task.FromResult(AuthenticateResult.Fail("The request has more than one key header."));
+    private static readonly Task<AuthenticateResult> s_revokedKey = Task.FromResult(AuthenticateResult.Fail("The key has been revoked."));
+    private static readonly Task<AuthenticateResult> s_unknownKey = Task.FromResult(AuthenticateResult.Fail("The key is not known."));
+
+    private readonly KeyStatusClient _statusClient;
+    private readonly CaskAuthenticationCache _results;
+
+    /// <summary>
+    /// Creates the handler. Use <see cref="CaskAuthenticationExtensions.AddCask(AuthenticationBuilder)"/>
+    /// to register it with its dependencies.
+    /// </summary>
+    public CaskAuthenticationHandler(IOptionsMonitor<CaskAuthenticationOptions> options,
+                                     ILoggerFactory logger,
+                                     UrlEncoder encoder,
+                                     KeyStatusClient statusClient,
+                                     CaskAuthenticationCache results)
+        : base(options, logger, encoder)
+    {
+        ThrowIfNull(statusClient);
+        ThrowIfNull(results);
+
+        _statusClient = statusClient;
+        _results = results;
+    }
+
+    /// <inheritdoc/>
+    protected override Task<AuthenticateResult> HandleAuthenticateAsync()
+    {
+        StringValues values = Request.Headers[Options.HeaderName];
+
+        if (values.Count == 0)
+        {
+            return s_noResult;
+        }
+
+        if (values.Count > 1)
+        {
+            return s_multipleKeys;
+        }
+
+        ReadOnlySpan<char> encodedKey = values[0].AsSpan();
+
+        if (!TryRemoveScheme(ref encodedKey, Options.HeaderScheme))
+        {
+            return s_noResult;
+        }
+
+        if (!CaskKeyFingerprint.TryCreate(encodedKey, out CaskKeyFingerprint fingerprint))
+        {
+            return s_invalidKey;
+        }
+
+        Task<KeyStatus> lookup = _statusClient.GetStatusAsync(fingerprint, Context.RequestAborted);
+
+        // PERF: Statuses of recently seen keys are cached, so the lookup has
+        // usually completed and the result is returned without awaiting.
+        return lookup.IsCompleted
+            ? GetResult(lookup.GetAwaiter().GetResult(), fingerprint, values[0])
+            : AwaitResult(lookup, fingerprint, values[0]);
+    }
+
+    /// <inheritdoc/>
+    protected override Task HandleChallengeAsync(AuthenticationProperties properties)
+    {
+        if (!string.IsNullOrEmpty(Options.HeaderScheme))
+        {
+            Response.Headers.Append(HeaderNames.WWWAuthenticate, Options.HeaderScheme);
+        }
+
+        return base.HandleChallengeAsync(properties);
+    }
+
+    private async Task<AuthenticateResult> AwaitResult(Task<KeyStatus> lookup, CaskKeyFingerprint fingerprint, string? header)
+    {
+        KeyStatus status = await lookup.ConfigureAwait(false);
+        return await GetResult(status, fingerprint, header).ConfigureAwait(false);
+    }
+
+    private Task<AuthenticateResult> GetResult(KeyStatus status, CaskKeyFingerprint fingerprint, string? header)
+    {
+        switch (status)
+        {
+            case KeyStatus.Active:
+                ReadOnlySpan<char> encodedKey = header.AsSpan();
+                TryRemoveScheme(ref encodedKey, Options.HeaderScheme);
+                return Task.FromResult(_results.Authenticate(Scheme.Name, fingerprint, encodedKey, Options.MaxCachedKeys));
+
+            case KeyStatus.Revoked:
+                return s_revokedKey;
+
+            default:
+                return s_unknownKey;
+        }
+    }
+
+    /// <summary>
+    /// Removes the expected scheme, a space and any further spaces from the
+    /// start of a header value, or returns false if the value has another
+    /// scheme.
+    /// </summary>
+    private static bool TryRemoveScheme(ref ReadOnlySpan<char> value, string? scheme)
+    {
+        if (!string.IsNullOrEmpty(scheme))
+        {
+            if (value.Length <= scheme!.Length ||
+                value[scheme.Length] != ' ' ||
+                !value.StartsWith(scheme.AsSpan(), StringComparison.OrdinalIgnoreCase))
+            {
+                return false;
+            }
+
+            value = value[(scheme.Length + 1)..];
+        }
+
+        value = value.Trim(' ');
+        return true;
+    }
+}
@@ -0,0 +1,49 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Microsoft.AspNetCore.Authentication;
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// Options for <see cref="CaskAuthenticationHandler"/>.
+/// </summary>
+public sealed class CaskAuthenticationOptions : AuthenticationSchemeOptions
+{
+    /// <summary>
+    /// The request header that carries the key. Defaults to
+    /// <c>Authorization</c>.
+    /// </summary>
+    public string HeaderName { get; set; } = "Authorization";
+
+    /// <summary>
+    /// The scheme that must precede the key in the header value, separated
+    /// by a space and compared case-insensitively, or null or empty if the
+    /// header value is only the key, as in an <c>X-Api-Key</c> header.
+    /// Defaults to <c>Bearer</c>. Requests with another scheme are not
+    /// handled, so that other handlers can authenticate them.
+    /// </summary>
+    public string? HeaderScheme { get; set; } = "Bearer";
+
+    /// <summary>
+    /// The maximum number of keys for which claims are cached. Defaults to
+    /// 10,000.
+    /// </summary>
+    public int MaxCachedKeys { get; set; } = 10_000;
+
+    /// <inheritdoc/>
+    public override void Validate()
+    {
+        base.Validate();
+
+        if (string.IsNullOrEmpty(HeaderName))
+        {
+            throw new InvalidOperationException($"{nameof(HeaderName)} must be set.");
+        }
+
+        if (MaxCachedKeys < 0)
+        {
+            throw new InvalidOperationException($"{nameof(MaxCachedKeys)} must not be negative.");
+        }
+    }
+}
@@ -0,0 +1,28 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// The types of the claims that <see cref="CaskAuthenticationHandler"/> sets
+/// from the fields of a key, in addition to a
+/// <see cref="System.Security.Claims.ClaimTypes.NameIdentifier"/> claim with
+/// the key's <see cref="CaskKeyFingerprint"/>.
+/// </summary>
+public static class CaskClaimTypes
+{
+    /// <summary>
+    /// The <see cref="CaskKey.ProviderSignature"/> of the key.
+    /// </summary>
+    public static string ProviderSignature { get; } = "cask:provider_signature";
+
+    /// <summary>
+    /// The <see cref="CaskKey.ProviderKeyKind"/> of the key.
+    /// </summary>
+    public static string ProviderKeyKind { get; } = "cask:provider_key_kind";
+
+    /// <summary>
+    /// The <see cref="CaskKey.Timestamp"/> of the key, in ISO 8601 format.
+    /// </summary>
+    public static string Timestamp { get; } = "cask:timestamp";
+}
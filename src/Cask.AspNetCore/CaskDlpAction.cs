@@ -0,0 +1,29 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// What <see cref="CaskDlpMiddleware"/> and <see cref="CaskDlpHandler"/> do
+/// when a body contains a CASK key.
+/// </summary>
+public enum CaskDlpAction
+{
+    /// <summary>
+    /// The body is not scanned.
+    /// </summary>
+    None,
+
+    /// <summary>
+    /// Each character of the key is replaced by the
+    /// <see cref="CaskDlpOptions.RedactionCharacter"/>, which keeps the length
+    /// of the body.
+    /// </summary>
+    Redact,
+
+    /// <summary>
+    /// The body fails with a <see cref="CaskKeyDetectedException"/> before
+    /// the last character of the key is passed on.
+    /// </summary>
+    Reject,
+}
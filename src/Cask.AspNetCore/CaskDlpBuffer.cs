@@ -0,0 +1,159 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers;
+using System.Diagnostics;
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// Scans a body as it streams through a pooled buffer, redacting or rejecting
+/// the keys that it contains, and releases only the bytes that can no longer
+/// be part of a key.
+/// </summary>
+/// <remarks>
+/// <see cref="CaskScanner"/> reports a key that straddles or ends at the end
+/// of a block only once the next block is scanned, so the last
+/// <see cref="Limits.MaxKeyLengthInChars"/> bytes of what has been scanned are
+/// held back until then. A key that is reported later always starts within
+/// them, so it is redacted or rejected before any of it is released.
+/// </remarks>
+internal sealed class CaskDlpBuffer : IDisposable
+{
+    private static readonly int s_holdBackLength = Limits.MaxKeyLengthInChars;
+
+    private readonly CaskScanner _scanner = new();
+    private readonly List<CaskMatch> _matches = [];
+    private readonly CaskDlpAction _action;
+    private readonly byte _redactionByte;
+    private readonly int _blockSize;
+    private byte[]? _buffer;
+    private long _bufferOffset;
+    private int _start;
+    private int _releasedEnd;
+    private int _end;
+    private long _rejectedOffset = -1;
+
+    public CaskDlpBuffer(CaskDlpAction action, CaskDlpOptions options)
+    {
+        Debug.Assert(action != CaskDlpAction.None);
+        _action = action;
+        _redactionByte = (byte)options.RedactionCharacter;
+        _blockSize = options.BufferSize;
+        _buffer = ArrayPool<byte>.Shared.Rent(options.BufferSize + s_holdBackLength);
+    }
+
+    /// <summary>
+    /// The number of keys found so far.
+    /// </summary>
+    public int KeysFound { get; private set; }
+
+    /// <summary>
+    /// Whether a key was found in a body that is rejected.
+    /// </summary>
+    public bool IsRejected => _rejectedOffset >= 0;
+
+    /// <summary>
+    /// Whether the end of the body was scanned.
+    /// </summary>
+    public bool IsCompleted { get; private set; }
+
+    /// <summary>
+    /// The scanned bytes that can be passed on.
+    /// </summary>
+    public ReadOnlyMemory<byte> Released => Buffer.AsMemory(_start, _releasedEnd - _start);
+
+    private byte[] Buffer
+    {
+        get
+        {
+            ObjectDisposedException.ThrowIf(_buffer == null, this);
+            return _buffer;
+        }
+    }
+
+    /// <summary>
+    /// Marks released bytes as passed on.
+    /// </summary>
+    public void Consume(int count)
+    {
+        Debug.Assert(count <= _releasedEnd - _start);
+        _start += count;
+    }
+
+    /// <summary>
+    /// Gets the space into which the next block of the body is copied before
+    /// it is passed to <see cref="Commit"/>. All released bytes must have been
+    /// consumed.
+    /// </summary>
+    public Memory<byte> GetBlockMemory()
+    {
+        byte[] buffer = Buffer;
+        Debug.Assert(_start == _releasedEnd);
+
+        // Only the held back bytes remain, so moving them to the front leaves
+        // room for a whole block.
+        int heldBack = _end - _start;
+        buffer.AsSpan(_start, heldBack).CopyTo(buffer);
+        _bufferOffset += _start;
+        _start = 0;
+        _releasedEnd = 0;
+        _end = heldBack;
+
+        return buffer.AsMemory(_end, _blockSize);
+    }
+
+    /// <summary>
+    /// Scans the given number of bytes that were copied to the memory from
+    /// <see cref="GetBlockMemory"/>.
+    /// </summary>
+    /// <exception cref="CaskKeyDetectedException">
+    /// The body is rejected and contains a key.
+    /// </exception>
+    public void Commit(int count, bool isFinalBlock)
+    {
+        ThrowIfRejected();
+
+        byte[] buffer = Buffer;
+        _matches.Clear();
+        _scanner.ScanUtf8(buffer.AsSpan(_end, count), isFinalBlock, _matches);
+        _end += count;
+
+        foreach (CaskMatch match in _matches)
+        {
+            KeysFound++;
+            int index = (int)(match.Offset - _bufferOffset);
+            Debug.Assert(index >= _releasedEnd, "A key was found in bytes that were already released.");
+
+            if (_action == CaskDlpAction.Reject)
+            {
+                _rejectedOffset = match.Offset;
+                ThrowIfRejected();
+            }
+
+            buffer.AsSpan(index, match.Key.ToString().Length).Fill(_redactionByte);
+        }
+
+        _releasedEnd = isFinalBlock ? _end : Math.Max(_releasedEnd, _end - s_holdBackLength);
+        IsCompleted = isFinalBlock;
+    }
+
+    public void Dispose()
+    {
+        byte[]? buffer = _buffer;
+        _buffer = null;
+
+        if (buffer != null)
+        {
+            ArrayPool<byte>.Shared.Return(buffer);
+        }
+    }
+
+    private void ThrowIfRejected()
+    {
+        if (_rejectedOffset >= 0)
+        {
+            throw new CaskKeyDetectedException(_rejectedOffset);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Net;
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// Content that scans other content as it is sent, redacting or rejecting the
+/// keys that it contains.
+/// </summary>
+internal sealed class CaskDlpContent : HttpContent
+{
+    private readonly HttpContent _inner;
+    private readonly CaskDlpAction _action;
+    private readonly CaskDlpOptions _options;
+
+    public CaskDlpContent(HttpContent inner, CaskDlpAction action, CaskDlpOptions options)
+    {
+        _inner = inner;
+        _action = action;
+        _options = options;
+
+        foreach (KeyValuePair<string, IEnumerable<string>> header in inner.Headers)
+        {
+            Headers.TryAddWithoutValidation(header.Key, header.Value);
+        }
+    }
+
+    protected override Task SerializeToStreamAsync(Stream stream, TransportContext? context)
+    {
+        return SerializeToStreamAsync(stream, context, CancellationToken.None);
+    }
+
+    protected override async Task SerializeToStreamAsync(Stream stream, TransportContext? context, CancellationToken cancellationToken)
+    {
+        using var dlpStream = new CaskDlpWriteStream(stream, _action, _options);
+        await _inner.CopyToAsync(dlpStream, context, cancellationToken).ConfigureAwait(false);
+        await dlpStream.CompleteAsync(cancellationToken).ConfigureAwait(false);
+    }
+
+    protected override void SerializeToStream(Stream stream, TransportContext? context, CancellationToken cancellationToken)
+    {
+        using var dlpStream = new CaskDlpWriteStream(stream, _action, _options);
+        _inner.CopyTo(dlpStream, context, cancellationToken);
+        dlpStream.Complete();
+    }
+
+    protected override bool TryComputeLength(out long length)
+    {
+        // Redaction keeps the length of the content.
+        long? innerLength = _inner.Headers.ContentLength;
+        length = innerLength.GetValueOrDefault();
+        return innerLength.HasValue;
+    }
+
+    protected override void Dispose(bool disposing)
+    {
+        if (disposing)
+        {
+            _inner.Dispose();
+        }
+
+        base.Dispose(disposing);
+    }
+}
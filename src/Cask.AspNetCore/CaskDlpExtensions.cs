@@ -0,0 +1,56 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Microsoft.AspNetCore.Builder;
+using Microsoft.Extensions.DependencyInjection;
+using Microsoft.Extensions.Options;
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// Adds <see cref="CaskDlpMiddleware"/> and <see cref="CaskDlpHandler"/>.
+/// </summary>
+public static class CaskDlpExtensions
+{
+    /// <summary>
+    /// Adds <see cref="CaskDlpMiddleware"/> to the pipeline, configured by
+    /// <see cref="IOptions{CaskDlpOptions}"/>.
+    /// </summary>
+    public static IApplicationBuilder UseCaskDlp(this IApplicationBuilder app)
+    {
+        ThrowIfNull(app);
+        return app.UseMiddleware<CaskDlpMiddleware>();
+    }
+
+    /// <summary>
+    /// Adds <see cref="CaskDlpMiddleware"/> to the pipeline with the given
+    /// options.
+    /// </summary>
+    public static IApplicationBuilder UseCaskDlp(this IApplicationBuilder app, CaskDlpOptions options)
+    {
+        ThrowIfNull(app);
+        ThrowIfNull(options);
+        return app.UseMiddleware<CaskDlpMiddleware>(Options.Create(options));
+    }
+
+    /// <summary>
+    /// Adds a <see cref="CaskDlpHandler"/> to the handlers of the client,
+    /// configured by <see cref="IOptions{CaskDlpOptions}"/>.
+    /// </summary>
+    public static IHttpClientBuilder AddCaskDlp(this IHttpClientBuilder builder)
+    {
+        ThrowIfNull(builder);
+        return builder.AddHttpMessageHandler(services => new CaskDlpHandler(services.GetRequiredService<IOptions<CaskDlpOptions>>().Value));
+    }
+
+    /// <summary>
+    /// Adds a <see cref="CaskDlpHandler"/> with the given options to the
+    /// handlers of the client.
+    /// </summary>
+    public static IHttpClientBuilder AddCaskDlp(this IHttpClientBuilder builder, CaskDlpOptions options)
+    {
+        ThrowIfNull(builder);
+        ThrowIfNull(options);
+        return builder.AddHttpMessageHandler(() => new CaskDlpHandler(options));
+    }
+}
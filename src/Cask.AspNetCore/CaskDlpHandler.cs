@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// A message handler that scans the bodies of outgoing requests and of their
+/// responses for CASK keys as they stream through, without buffering them.
+/// </summary>
+/// <remarks>
+/// <para>
+/// A rejected request fails with an <see cref="HttpRequestException"/> whose
+/// inner exception is a <see cref="CaskKeyDetectedException"/>, after the
+/// body up to the key has been sent but before any of the key is. A rejected
+/// response fails with a <see cref="CaskKeyDetectedException"/> when its
+/// content is read.
+/// </para>
+/// <para>
+/// <see cref="HttpClient"/> reads the whole response into memory unless it is
+/// sent with <see cref="HttpCompletionOption.ResponseHeadersRead"/>.
+/// </para>
+/// </remarks>
+public sealed class CaskDlpHandler : DelegatingHandler
+{
+    private readonly CaskDlpOptions _options;
+
+    /// <summary>
+    /// Initializes a new instance of the <see cref="CaskDlpHandler"/> class
+    /// with default options.
+    /// </summary>
+    public CaskDlpHandler()
+        : this(new CaskDlpOptions())
+    {
+    }
+
+    /// <summary>
+    /// Initializes a new instance of the <see cref="CaskDlpHandler"/> class.
+    /// </summary>
+    public CaskDlpHandler(CaskDlpOptions options)
+    {
+        ThrowIfNull(options);
+        options.Validate();
+        _options = options;
+    }
+
+    /// <summary>
+    /// Initializes a new instance of the <see cref="CaskDlpHandler"/> class
+    /// that sends requests to the given handler.
+    /// </summary>
+    public CaskDlpHandler(HttpMessageHandler innerHandler, CaskDlpOptions options)
+        : base(innerHandler)
+    {
+        ThrowIfNull(options);
+        options.Validate();
+        _options = options;
+    }
+
+    /// <inheritdoc/>
+    protected override HttpResponseMessage Send(HttpRequestMessage request, CancellationToken cancellationToken)
+    {
+        WrapRequestContent(request);
+        HttpResponseMessage response = base.Send(request, cancellationToken);
+
+        if (_options.ResponseAction != CaskDlpAction.None)
+        {
+            response.Content = WrapResponseContent(response.Content, response.Content.ReadAsStream(cancellationToken));
+        }
+
+        return response;
+    }
+
+    /// <inheritdoc/>
+    protected override async Task<HttpResponseMessage> SendAsync(HttpRequestMessage request, CancellationToken cancellationToken)
+    {
+        WrapRequestContent(request);
+        HttpResponseMessage response = await base.SendAsync(request, cancellationToken).ConfigureAwait(false);
+
+        if (_options.ResponseAction != CaskDlpAction.None)
+        {
+            Stream stream = await response.Content.ReadAsStreamAsync(cancellationToken).ConfigureAwait(false);
+            response.Content = WrapResponseContent(response.Content, stream);
+        }
+
+        return response;
+    }
+
+    private void WrapRequestContent(HttpRequestMessage request)
+    {
+        ThrowIfNull(request);
+
+        if (request.Content != null && _options.RequestAction != CaskDlpAction.None)
+        {
+            request.Content = new CaskDlpContent(request.Content, _options.RequestAction, _options);
+        }
+    }
+
+    private StreamContent WrapResponseContent(HttpContent original, Stream stream)
+    {
+        var content = new StreamContent(new CaskDlpReadStream(stream, _options.ResponseAction, _options, leaveOpen: false));
+
+        foreach (KeyValuePair<string, IEnumerable<string>> header in original.Headers)
+        {
+            content.Headers.TryAddWithoutValidation(header.Key, header.Value);
+        }
+
+        return content;
+    }
+}
@@ -0,0 +1,137 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Microsoft.AspNetCore.Http;
+using Microsoft.AspNetCore.Http.Features;
+using Microsoft.Extensions.Options;
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// Middleware that scans request and response bodies for CASK keys as they
+/// stream through, without buffering them.
+/// </summary>
+/// <remarks>
+/// <para>
+/// A rejected request fails with a <see cref="CaskKeyDetectedException"/>
+/// when the application reads the key, and the response is replaced by a 400
+/// (Bad Request) if it has not started, or the connection is aborted if it
+/// has. The application has already read the body up to the key by then, so
+/// endpoints that act on a body before reading all of it should not depend on
+/// the rejection to undo that.
+/// </para>
+/// <para>
+/// A rejected response is replaced by a 500 (Internal Server Error) if it has
+/// not started, or the connection is aborted if it has. The key itself is
+/// never sent.
+/// </para>
+/// </remarks>
+public sealed class CaskDlpMiddleware
+{
+    private readonly RequestDelegate _next;
+    private readonly CaskDlpOptions _options;
+
+    /// <summary>
+    /// Initializes a new instance of the <see cref="CaskDlpMiddleware"/> class.
+    /// </summary>
+    public CaskDlpMiddleware(RequestDelegate next, IOptions<CaskDlpOptions> options)
+    {
+        ThrowIfNull(next);
+        ThrowIfNull(options);
+
+        _next = next;
+        _options = options.Value;
+        _options.Validate();
+    }
+
+    /// <summary>
+    /// Scans the request and response bodies of the given request.
+    /// </summary>
+    public async Task InvokeAsync(HttpContext context)
+    {
+        ThrowIfNull(context);
+
+        Stream originalRequestBody = context.Request.Body;
+        IHttpResponseBodyFeature? originalResponseBody = null;
+        StreamResponseBodyFeature? responseBodyFeature = null;
+        CaskDlpReadStream? requestBody = null;
+        CaskDlpWriteStream? responseBody = null;
+
+        try
+        {
+            if (_options.RequestAction != CaskDlpAction.None)
+            {
+                requestBody = new CaskDlpReadStream(originalRequestBody, _options.RequestAction, _options, leaveOpen: true);
+                context.Request.Body = requestBody;
+            }
+
+            if (_options.ResponseAction != CaskDlpAction.None)
+            {
+                originalResponseBody = context.Features.GetRequiredFeature<IHttpResponseBodyFeature>();
+                responseBody = new CaskDlpWriteStream(originalResponseBody.Stream, _options.ResponseAction, _options);
+                responseBodyFeature = new StreamResponseBodyFeature(responseBody, originalResponseBody);
+                context.Features.Set<IHttpResponseBodyFeature>(responseBodyFeature);
+            }
+
+            try
+            {
+                await _next(context).ConfigureAwait(false);
+
+                if (responseBody != null && requestBody?.IsRejected != true)
+                {
+                    // Completing the feature first writes out anything the
+                    // application left unflushed in the body pipe, so that
+                    // it is scanned too.
+                    await responseBodyFeature!.CompleteAsync().ConfigureAwait(false);
+                    await responseBody.CompleteAsync(context.RequestAborted).ConfigureAwait(false);
+                }
+            }
+            catch (CaskKeyDetectedException) when (requestBody?.IsRejected == true || responseBody?.IsRejected == true)
+            {
+                // Handled below, as are rejections that the application caught.
+            }
+
+            if (requestBody?.IsRejected == true)
+            {
+                Reject(context, StatusCodes.Status400BadRequest);
+            }
+            else if (responseBody?.IsRejected == true)
+            {
+                Reject(context, StatusCodes.Status500InternalServerError);
+            }
+        }
+        finally
+        {
+            context.Request.Body = originalRequestBody;
+
+            if (originalResponseBody != null)
+            {
+                context.Features.Set(originalResponseBody);
+            }
+
+            responseBodyFeature?.Dispose();
+
+            if (requestBody != null)
+            {
+                await requestBody.DisposeAsync().ConfigureAwait(false);
+            }
+
+            if (responseBody != null)
+            {
+                await responseBody.DisposeAsync().ConfigureAwait(false);
+            }
+        }
+    }
+
+    private static void Reject(HttpContext context, int statusCode)
+    {
+        if (context.Response.HasStarted)
+        {
+            context.Abort();
+            return;
+        }
+
+        context.Response.Clear();
+        context.Response.StatusCode = statusCode;
+    }
+}
@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// Options for <see cref="CaskDlpMiddleware"/> and <see cref="CaskDlpHandler"/>.
+/// </summary>
+public sealed class CaskDlpOptions
+{
+    /// <summary>
+    /// What to do with keys in request bodies: those received by
+    /// <see cref="CaskDlpMiddleware"/> and those sent by
+    /// <see cref="CaskDlpHandler"/>. Defaults to
+    /// <see cref="CaskDlpAction.Reject"/>.
+    /// </summary>
+    public CaskDlpAction RequestAction { get; set; } = CaskDlpAction.Reject;
+
+    /// <summary>
+    /// What to do with keys in response bodies: those sent by
+    /// <see cref="CaskDlpMiddleware"/> and those received by
+    /// <see cref="CaskDlpHandler"/>. Defaults to
+    /// <see cref="CaskDlpAction.Redact"/>.
+    /// </summary>
+    public CaskDlpAction ResponseAction { get; set; } = CaskDlpAction.Redact;
+
+    /// <summary>
+    /// The ASCII character that replaces each character of a redacted key.
+    /// Defaults to <c>*</c>.
+    /// </summary>
+    public char RedactionCharacter { get; set; } = '*';
+
+    /// <summary>
+    /// The most bytes of a body that are scanned at a time. A body is never
+    /// held in memory beyond this and the longest key. Defaults to 16 KiB.
+    /// </summary>
+    public int BufferSize { get; set; } = 16 * 1024;
+
+    internal void Validate()
+    {
+        if (!Enum.IsDefined(RequestAction))
+        {
+            throw new InvalidOperationException($"{nameof(RequestAction)} is not a valid {nameof(CaskDlpAction)}.");
+        }
+
+        if (!Enum.IsDefined(ResponseAction))
+        {
+            throw new InvalidOperationException($"{nameof(ResponseAction)} is not a valid {nameof(CaskDlpAction)}.");
+        }
+
+        if (!char.IsAscii(RedactionCharacter))
+        {
+            throw new InvalidOperationException($"{nameof(RedactionCharacter)} must be an ASCII character.");
+        }
+
+        if (BufferSize <= 0)
+        {
+            throw new InvalidOperationException($"{nameof(BufferSize)} must be positive.");
+        }
+    }
+}
@@ -0,0 +1,132 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// A read-only stream that scans another stream as it is read, redacting or
+/// rejecting the keys that it contains.
+/// </summary>
+internal sealed class CaskDlpReadStream : Stream
+{
+    private readonly Stream _inner;
+    private readonly CaskDlpBuffer _buffer;
+    private readonly bool _leaveOpen;
+
+    public CaskDlpReadStream(Stream inner, CaskDlpAction action, CaskDlpOptions options, bool leaveOpen)
+    {
+        _inner = inner;
+        _buffer = new CaskDlpBuffer(action, options);
+        _leaveOpen = leaveOpen;
+    }
+
+    public bool IsRejected => _buffer.IsRejected;
+
+    public int KeysFound => _buffer.KeysFound;
+
+    public override bool CanRead => true;
+
+    public override bool CanSeek => false;
+
+    public override bool CanWrite => false;
+
+    public override long Length => throw new NotSupportedException();
+
+    public override long Position
+    {
+        get => throw new NotSupportedException();
+        set => throw new NotSupportedException();
+    }
+
+    public override int Read(byte[] buffer, int offset, int count)
+    {
+        return Read(buffer.AsSpan(offset, count));
+    }
+
+    public override int Read(Span<byte> buffer)
+    {
+        while (true)
+        {
+            if (TryCopyReleased(buffer, out int copied))
+            {
+                return copied;
+            }
+
+            int read = _inner.Read(_buffer.GetBlockMemory().Span);
+            _buffer.Commit(read, isFinalBlock: read == 0);
+        }
+    }
+
+    public override Task<int> ReadAsync(byte[] buffer, int offset, int count, CancellationToken cancellationToken)
+    {
+        return ReadAsync(buffer.AsMemory(offset, count), cancellationToken).AsTask();
+    }
+
+    public override async ValueTask<int> ReadAsync(Memory<byte> buffer, CancellationToken cancellationToken = default)
+    {
+        while (true)
+        {
+            if (TryCopyReleased(buffer.Span, out int copied))
+            {
+                return copied;
+            }
+
+            int read = await _inner.ReadAsync(_buffer.GetBlockMemory(), cancellationToken).ConfigureAwait(false);
+            _buffer.Commit(read, isFinalBlock: read == 0);
+        }
+    }
+
+    public override void Flush()
+    {
+    }
+
+    public override long Seek(long offset, SeekOrigin origin)
+    {
+        throw new NotSupportedException();
+    }
+
+    public override void SetLength(long value)
+    {
+        throw new NotSupportedException();
+    }
+
+    public override void Write(byte[] buffer, int offset, int count)
+    {
+        throw new NotSupportedException();
+    }
+
+    protected override void Dispose(bool disposing)
+    {
+        if (disposing)
+        {
+            _buffer.Dispose();
+
+            if (!_leaveOpen)
+            {
+                _inner.Dispose();
+            }
+        }
+
+        base.Dispose(disposing);
+    }
+
+    /// <summary>
+    /// Copies released bytes to the destination, or returns false if more of
+    /// the inner stream must be read first.
+    /// </summary>
+    private bool TryCopyReleased(Span<byte> destination, out int copied)
+    {
+        ReadOnlySpan<byte> released = _buffer.Released.Span;
+
+        if (released.IsEmpty && !_buffer.IsCompleted && !destination.IsEmpty)
+        {
+            copied = 0;
+            return false;
+        }
+
+        copied = Math.Min(released.Length, destination.Length);
+        released[..copied].CopyTo(destination);
+        _buffer.Consume(copied);
+        return true;
+    }
+}
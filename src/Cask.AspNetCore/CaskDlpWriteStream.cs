@@ -0,0 +1,154 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics.CodeAnalysis;
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// A write-only stream that scans what is written to it before passing it on
+/// to another stream, redacting or rejecting the keys that it contains.
+/// </summary>
+/// <remarks>
+/// The last bytes written are held back until more is written or
+/// <see cref="Complete"/> or <see cref="CompleteAsync"/> is called, even when the stream is flushed.
+/// The inner stream is not disposed.
+/// </remarks>
+internal sealed class CaskDlpWriteStream : Stream
+{
+    [SuppressMessage("Usage", "CA2213:Disposable fields should be disposed", Justification = "The inner stream is owned by the caller.")]
+    private readonly Stream _inner;
+    private readonly CaskDlpBuffer _buffer;
+
+    public CaskDlpWriteStream(Stream inner, CaskDlpAction action, CaskDlpOptions options)
+    {
+        _inner = inner;
+        _buffer = new CaskDlpBuffer(action, options);
+    }
+
+    public bool IsRejected => _buffer.IsRejected;
+
+    public int KeysFound => _buffer.KeysFound;
+
+    public override bool CanRead => false;
+
+    public override bool CanSeek => false;
+
+    public override bool CanWrite => true;
+
+    public override long Length => throw new NotSupportedException();
+
+    public override long Position
+    {
+        get => throw new NotSupportedException();
+        set => throw new NotSupportedException();
+    }
+
+    public override void Write(byte[] buffer, int offset, int count)
+    {
+        Write(buffer.AsSpan(offset, count));
+    }
+
+    public override void Write(ReadOnlySpan<byte> buffer)
+    {
+        while (!buffer.IsEmpty)
+        {
+            int count = CopyBlock(buffer);
+            _inner.Write(_buffer.Released.Span);
+            _buffer.Consume(_buffer.Released.Length);
+            buffer = buffer[count..];
+        }
+    }
+
+    public override Task WriteAsync(byte[] buffer, int offset, int count, CancellationToken cancellationToken)
+    {
+        return WriteAsync(buffer.AsMemory(offset, count), cancellationToken).AsTask();
+    }
+
+    public override async ValueTask WriteAsync(ReadOnlyMemory<byte> buffer, CancellationToken cancellationToken = default)
+    {
+        while (!buffer.IsEmpty)
+        {
+            int count = CopyBlock(buffer.Span);
+            await WriteReleasedAsync(cancellationToken).ConfigureAwait(false);
+            buffer = buffer[count..];
+        }
+    }
+
+    /// <summary>
+    /// Scans the end of what was written and passes on the bytes that were
+    /// held back.
+    /// </summary>
+    public void Complete()
+    {
+        if (!_buffer.IsCompleted)
+        {
+            _buffer.GetBlockMemory();
+            _buffer.Commit(0, isFinalBlock: true);
+            _inner.Write(_buffer.Released.Span);
+            _buffer.Consume(_buffer.Released.Length);
+        }
+    }
+
+    /// <inheritdoc cref="Complete"/>
+    public async Task CompleteAsync(CancellationToken cancellationToken = default)
+    {
+        if (!_buffer.IsCompleted)
+        {
+            _buffer.GetBlockMemory();
+            _buffer.Commit(0, isFinalBlock: true);
+            await WriteReleasedAsync(cancellationToken).ConfigureAwait(false);
+        }
+    }
+
+    public override void Flush()
+    {
+        _inner.Flush();
+    }
+
+    public override Task FlushAsync(CancellationToken cancellationToken)
+    {
+        return _inner.FlushAsync(cancellationToken);
+    }
+
+    public override int Read(byte[] buffer, int offset, int count)
+    {
+        throw new NotSupportedException();
+    }
+
+    public override long Seek(long offset, SeekOrigin origin)
+    {
+        throw new NotSupportedException();
+    }
+
+    public override void SetLength(long value)
+    {
+        throw new NotSupportedException();
+    }
+
+    protected override void Dispose(bool disposing)
+    {
+        if (disposing)
+        {
+            _buffer.Dispose();
+        }
+
+        base.Dispose(disposing);
+    }
+
+    private int CopyBlock(ReadOnlySpan<byte> source)
+    {
+        Span<byte> block = _buffer.GetBlockMemory().Span;
+        int count = Math.Min(source.Length, block.Length);
+        source[..count].CopyTo(block);
+        _buffer.Commit(count, isFinalBlock: false);
+        return count;
+    }
+
+    private async ValueTask WriteReleasedAsync(CancellationToken cancellationToken)
+    {
+        ReadOnlyMemory<byte> released = _buffer.Released;
+        await _inner.WriteAsync(released, cancellationToken).ConfigureAwait(false);
+        _buffer.Consume(released.Length);
+    }
+}
@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore;
+
+/// <summary>
+/// The exception thrown when a body that is scanned with
+/// <see cref="CaskDlpAction.Reject"/> contains a CASK key.
+/// </summary>
+public sealed class CaskKeyDetectedException : IOException
+{
+    /// <summary>
+    /// Initializes a new instance of the <see cref="CaskKeyDetectedException"/> class.
+    /// </summary>
+    public CaskKeyDetectedException()
+        : base("The body contains a CASK key.")
+    {
+    }
+
+    /// <summary>
+    /// Initializes a new instance of the <see cref="CaskKeyDetectedException"/> class.
+    /// </summary>
+    public CaskKeyDetectedException(string message)
+        : base(message)
+    {
+    }
+
+    /// <summary>
+    /// Initializes a new instance of the <see cref="CaskKeyDetectedException"/> class.
+    /// </summary>
+    public CaskKeyDetectedException(string message, Exception innerException)
+        : base(message, innerException)
+    {
+    }
+
+    internal CaskKeyDetectedException(long offset)
+        : base($"The body contains a CASK key at offset {offset}.")
+    {
+        Offset = offset;
+    }
+
+    /// <summary>
+    /// The offset in bytes of the key from the start of the body, or -1 if
+    /// it is not known.
+    /// </summary>
+    public long Offset { get; } = -1;
+}
@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// Chooses a concurrency limit by additive increase, multiplicative decrease
+/// (AIMD) on measured throughput, as TCP does on congestion.
+/// </summary>
+/// <remarks>
+/// The limit is raised by one while doing so raises throughput. An increase
+/// that doesn't help is undone and the limit is held for a few intervals
+/// before probing again, since a host's best concurrency changes as other
+/// workloads come and go. A drop in throughput, or memory pressure, cuts the
+/// limit by a constant factor so that contention clears quickly.
+/// </remarks>
+internal sealed class AimdController
+{
+    private const double Tolerance = 0.05;
+    private const double DecreaseFactor = 0.75;
+    private const int HoldIntervals = 4;
+
+    private readonly int _minimum;
+    private readonly int _maximum;
+    private double _previousThroughput;
+    private bool _increased;
+    private int _holdIntervalsRemaining;
+
+    public AimdController(int minimum, int maximum, int initial)
+    {
+        _minimum = minimum;
+        _maximum = maximum;
+        Limit = Math.Clamp(initial, minimum, maximum);
+    }
+
+    public int Limit { get; private set; }
+
+    /// <summary>
+    /// Updates the limit from the throughput measured over the last interval.
+    /// </summary>
+    /// <returns>True if the limit was changed.</returns>
+    public bool Update(double throughput, bool underMemoryPressure)
+    {
+        int limit = Limit;
+        bool increased = false;
+
+        if (underMemoryPressure || throughput < _previousThroughput * (1 - Tolerance))
+        {
+            limit = Math.Max(_minimum, (int)(limit * DecreaseFactor));
+            _holdIntervalsRemaining = HoldIntervals;
+        }
+        else if (_increased && throughput < _previousThroughput * (1 + Tolerance))
+        {
+            limit = Math.Max(_minimum, limit - 1);
+            _holdIntervalsRemaining = HoldIntervals;
+        }
+        else if (_holdIntervalsRemaining > 0)
+        {
+            _holdIntervalsRemaining--;
+        }
+        else if (limit < _maximum)
+        {
+            limit++;
+            increased = true;
+        }
+
+        _previousThroughput = throughput;
+        _increased = increased;
+
+        bool changed = limit != Limit;
+        Limit = limit;
+        return changed;
+    }
+}
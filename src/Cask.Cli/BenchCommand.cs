@@ -0,0 +1,321 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Text;
+using System.Diagnostics;
+using System.Globalization;
+using System.Numerics;
+using System.Runtime;
+using System.Runtime.InteropServices;
+using System.Runtime.Intrinsics;
+using System.Security.Cryptography;
+using System.Text;
+using System.Text.Json;
+
+using Arm = System.Runtime.Intrinsics.Arm;
+using X86 = System.Runtime.Intrinsics.X86;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// A lightweight throughput self-measurement that runs without the SDK or
+/// BenchmarkDotNet. Use Cask.Benchmarks for precise measurements; this is for
+/// comparing host types when sizing fleets.
+/// </summary>
+internal static class BenchCommand
+{
+    private const string ProviderSignature = "TEST";
+    private const string ProviderData = "ACabcdefghijAAAA";
+
+    private const int ScanTextLength = 1024 * 1024;
+    private const int ScanKeyInterval = 4096;
+    private const string ScanFillerChars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_+/=\"' \n";
+
+    private static readonly TimeSpan s_warmupDuration = TimeSpan.FromMilliseconds(200);
+
+    internal static int Run(BenchOptions options)
+    {
+        if (options.Duration <= 0 || options.Threads < 0)
+        {
+            Console.Error.WriteLine("--duration must be positive and --threads must not be negative.");
+            return 1;
+        }
+
+        int threads = options.Threads > 0 ? options.Threads : Environment.ProcessorCount;
+        int[] threadCounts = threads == 1 ? [1] : [1, threads];
+        var duration = TimeSpan.FromSeconds(options.Duration);
+
+        string key = Cask.GenerateKey(ProviderSignature, 'A', ProviderData).ToString();
+        byte[] keyUtf8 = Encoding.UTF8.GetBytes(key);
+        byte[] keyBytes = Base64Url.DecodeFromChars(key.AsSpan());
+        string scanText = CreateScanText(key);
+        byte[] scanTextUtf8 = Encoding.UTF8.GetBytes(scanText);
+
+        Workload[] workloads =
+        [
+            new("GenerateKey", BatchSize: 64, BytesPerOperation: 0, () => Cask.GenerateKey(ProviderSignature, 'A', ProviderData)),
+            new("IsCask", BatchSize: 256, BytesPerOperation: 0, () => Cask.IsCask(key)),
+            new("IsCaskUtf8", BatchSize: 256, BytesPerOperation: 0, () => Cask.IsCaskUtf8(keyUtf8)),
+            new("IsCaskBytes", BatchSize: 256, BytesPerOperation: 0, () => Cask.IsCaskBytes(keyBytes)),
+            new("Scan", BatchSize: 1, BytesPerOperation: scanText.Length, () => CaskKey.Regex.Count(scanText)),
+            new("ScanUtf8", BatchSize: 1, BytesPerOperation: scanTextUtf8.Length, () => CaskScanner.ScanUtf8(scanTextUtf8, new List<CaskMatch>())),
+        ];
+
+        HostInfo host = HostInfo.Detect();
+
+        if (!options.Json)
+        {
+            WriteHost(host);
+            Console.WriteLine();
+            Console.WriteLine($"{"Operation",-12} {"Threads",7} {"Ops/sec",14} {"MB/s",10}");
+        }
+
+        var results = new List<BenchResult>();
+
+        foreach (Workload workload in workloads)
+        {
+            foreach (int threadCount in threadCounts)
+            {
+                BenchResult result = Measure(workload, threadCount, duration);
+                results.Add(result);
+
+                if (!options.Json)
+                {
+                    WriteResult(result);
+                }
+            }
+        }
+
+        if (options.Json)
+        {
+            WriteJson(host, duration, results);
+        }
+
+        return 0;
+    }
+
+    private static BenchResult Measure(Workload workload, int threadCount, TimeSpan duration)
+    {
+        // Let tiered compilation settle before measuring.
+        var warmup = Stopwatch.StartNew();
+        while (warmup.Elapsed < s_warmupDuration)
+        {
+            workload.Operation();
+        }
+
+        long totalOperations = 0;
+        bool stop = false;
+        using var start = new Barrier(threadCount + 1);
+        var workers = new Thread[threadCount];
+
+        for (int i = 0; i < threadCount; i++)
+        {
+            workers[i] = new Thread(() =>
+            {
+                long operations = 0;
+                start.SignalAndWait();
+
+                while (!Volatile.Read(ref stop))
+                {
+                    for (int j = 0; j < workload.BatchSize; j++)
+                    {
+                        workload.Operation();
+                    }
+
+                    operations += workload.BatchSize;
+                }
+
+                Interlocked.Add(ref totalOperations, operations);
+            })
+            {
+                IsBackground = true,
+            };
+
+            workers[i].Start();
+        }
+
+        start.SignalAndWait();
+        var stopwatch = Stopwatch.StartNew();
+        Thread.Sleep(duration);
+        Volatile.Write(ref stop, true);
+
+        foreach (Thread worker in workers)
+        {
+            worker.Join();
+        }
+
+        // NOTE: Elapsed time includes finishing the last batch on every
+        //       thread, so the result is never overstated.
+        stopwatch.Stop();
+
+        double operationsPerSecond = totalOperations / stopwatch.Elapsed.TotalSeconds;
+        double? megabytesPerSecond = workload.BytesPerOperation > 0 ? operationsPerSecond * workload.BytesPerOperation / 1_000_000 : null;
+        return new BenchResult(workload.Name, threadCount, operationsPerSecond, megabytesPerSecond);
+    }
+
+    /// <summary>
+    /// Creates text that resembles a log or config file with a key every
+    /// <see cref="ScanKeyInterval"/> characters.
+    /// </summary>
+    private static string CreateScanText(string key)
+    {
+        byte[] random = RandomNumberGenerator.GetBytes(ScanTextLength);
+        char[] text = new char[ScanTextLength];
+
+        for (int i = 0; i < text.Length; i++)
+        {
+            text[i] = ScanFillerChars[random[i] % ScanFillerChars.Length];
+        }
+
+        for (int i = ScanKeyInterval; i + key.Length + 2 < text.Length; i += ScanKeyInterval)
+        {
+            text[i] = ' ';
+            key.CopyTo(0, text, i + 1, key.Length);
+            text[i + key.Length + 1] = '\n';
+        }
+
+        return new string(text);
+    }
+
+    private static void WriteHost(HostInfo host)
+    {
+        Console.WriteLine($"OS:           {host.OSDescription}");
+        Console.WriteLine($"Architecture: {host.Architecture}");
+        Console.WriteLine($"Runtime:      {host.FrameworkDescription}{(host.IsServerGC ? " (server GC)" : "")}");
+        Console.WriteLine($"Processors:   {host.ProcessorCount}");
+        Console.WriteLine($"Vector<T>:    {host.VectorSizeInBytes} bytes");
+        Console.WriteLine($"ISA:          {string.Join(' ', host.IsaFeatures.Where(f => f.Supported).Select(f => f.Name))}");
+
+        string[] unsupported = [.. host.IsaFeatures.Where(f => !f.Supported).Select(f => f.Name)];
+        if (unsupported.Length > 0)
+        {
+            Console.WriteLine($"Missing ISA:  {string.Join(' ', unsupported)}");
+        }
+    }
+
+    private static void WriteResult(BenchResult result)
+    {
+        string operationsPerSecond = result.OperationsPerSecond.ToString("N0", CultureInfo.InvariantCulture);
+        string megabytesPerSecond = result.MegabytesPerSecond?.ToString("N1", CultureInfo.InvariantCulture) ?? "";
+        Console.WriteLine($"{result.Operation,-12} {result.Threads,7} {operationsPerSecond,14} {megabytesPerSecond,10}".TrimEnd());
+    }
+
+    private static void WriteJson(HostInfo host, TimeSpan duration, List<BenchResult> results)
+    {
+        using Stream stdout = Console.OpenStandardOutput();
+        using var writer = new Utf8JsonWriter(stdout, new JsonWriterOptions { Indented = true });
+
+        writer.WriteStartObject();
+
+        writer.WriteStartObject("host");
+        writer.WriteString("os", host.OSDescription);
+        writer.WriteString("architecture", host.Architecture.ToString());
+        writer.WriteString("runtime", host.FrameworkDescription);
+        writer.WriteBoolean("serverGC", host.IsServerGC);
+        writer.WriteNumber("processorCount", host.ProcessorCount);
+        writer.WriteNumber("vectorSizeInBytes", host.VectorSizeInBytes);
+        writer.WriteStartObject("isa");
+        foreach ((string name, bool supported) in host.IsaFeatures)
+        {
+            writer.WriteBoolean(name, supported);
+        }
+        writer.WriteEndObject();
+        writer.WriteEndObject();
+
+        writer.WriteNumber("durationSeconds", duration.TotalSeconds);
+
+        writer.WriteStartArray("results");
+        foreach (BenchResult result in results)
+        {
+            writer.WriteStartObject();
+            writer.WriteString("operation", result.Operation);
+            writer.WriteNumber("threads", result.Threads);
+            writer.WriteNumber("operationsPerSecond", Math.Round(result.OperationsPerSecond));
+            if (result.MegabytesPerSecond is double megabytesPerSecond)
+            {
+                writer.WriteNumber("megabytesPerSecond", Math.Round(megabytesPerSecond, 1));
+            }
+            writer.WriteEndObject();
+        }
+        writer.WriteEndArray();
+
+        writer.WriteEndObject();
+        writer.Flush();
+
+        stdout.Write("\n"u8);
+    }
+
+    private sealed record Workload(string Name, int BatchSize, int BytesPerOperation, Action Operation);
+
+    private sealed record BenchResult(string Operation, int Threads, double OperationsPerSecond, double? MegabytesPerSecond);
+
+    private sealed record HostInfo(
+        string OSDescription,
+        Architecture Architecture,
+        string FrameworkDescription,
+        bool IsServerGC,
+        int ProcessorCount,
+        int VectorSizeInBytes,
+        (string Name, bool Supported)[] IsaFeatures)
+    {
+        public static HostInfo Detect()
+        {
+            return new HostInfo(
+                RuntimeInformation.OSDescription,
+                RuntimeInformation.ProcessArchitecture,
+                RuntimeInformation.FrameworkDescription,
+                GCSettings.IsServerGC,
+                Environment.ProcessorCount,
+                Vector<byte>.Count,
+                DetectIsaFeatures());
+        }
+
+        // Only features for the architecture of the process are reported.
+        private static (string Name, bool Supported)[] DetectIsaFeatures()
+        {
+            List<(string, bool)> features =
+            [
+                ("Vector128", Vector128.IsHardwareAccelerated),
+                ("Vector256", Vector256.IsHardwareAccelerated),
+                ("Vector512", Vector512.IsHardwareAccelerated),
+            ];
+
+            switch (RuntimeInformation.ProcessArchitecture)
+            {
+                case Architecture.X64:
+                case Architecture.X86:
+                    features.AddRange(
+                    [
+                        ("Sse2", X86.Sse2.IsSupported),
+                        ("Sse41", X86.Sse41.IsSupported),
+                        ("Sse42", X86.Sse42.IsSupported),
+                        ("Popcnt", X86.Popcnt.IsSupported),
+                        ("Bmi1", X86.Bmi1.IsSupported),
+                        ("Bmi2", X86.Bmi2.IsSupported),
+                        ("Aes", X86.Aes.IsSupported),
+                        ("Avx", X86.Avx.IsSupported),
+                        ("Avx2", X86.Avx2.IsSupported),
+                        ("Avx512F", X86.Avx512F.IsSupported),
+                        ("Avx512BW", X86.Avx512BW.IsSupported),
+                        ("Avx512Vbmi", X86.Avx512Vbmi.IsSupported),
+                    ]);
+                    break;
+
+                case Architecture.Arm64:
+                case Architecture.Arm:
+                    features.AddRange(
+                    [
+                        ("AdvSimd", Arm.AdvSimd.IsSupported),
+                        ("Aes", Arm.Aes.IsSupported),
+                        ("Crc32", Arm.Crc32.IsSupported),
+                        ("Sha256", Arm.Sha256.IsSupported),
+                        ("Dp", Arm.Dp.IsSupported),
+                        ("Rdm", Arm.Rdm.IsSupported),
+                    ]);
+                    break;
+            }
+
+            return [.. features];
+        }
+    }
+}
@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics.CodeAnalysis;
+
+using CommandLine;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+[Verb("bench", HelpText = "Measure key generation, validation, and scanning throughput on this host.")]
+[SuppressMessage("Design", "CA1812:Avoid uninstantiated internal classes", Justification = "Instantiated by CommandLineParser.")]
+internal sealed class BenchOptions
+{
+    [Option(
+        "duration",
+        Required = false,
+        Default = 1.0,
+        HelpText = "The number of seconds to measure each operation at each thread count.")]
+    public double Duration { get; set; }
+
+    [Option(
+        "threads",
+        Required = false,
+        Default = 0,
+        HelpText = "The number of threads for the multi-threaded measurements. Defaults to the processor count.")]
+    public int Threads { get; set; }
+
+    [Option(
+        "json",
+        Required = false,
+        HelpText = "Write the results as JSON instead of text.")]
+    public bool Json { get; set; }
+}
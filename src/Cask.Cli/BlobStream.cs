@@ -0,0 +1,102 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// A read-only stream over a range of a file, such as a blob stored in an
+/// archive. The stream owns the file.
+/// </summary>
+internal sealed class BlobStream : Stream
+{
+    private readonly FileStream _file;
+    private readonly long _offset;
+    private readonly long _length;
+    private long _position;
+
+    public BlobStream(FileStream file, long offset, long length)
+    {
+        if (offset < 0 || length < 0 || offset + length > file.Length)
+        {
+            throw new InvalidDataException($"Blob at {offset} of length {length} is outside of {file.Name}.");
+        }
+
+        _file = file;
+        _offset = offset;
+        _length = length;
+        _file.Position = offset;
+    }
+
+    public override bool CanRead => true;
+
+    public override bool CanSeek => true;
+
+    public override bool CanWrite => false;
+
+    public override long Length => _length;
+
+    public override long Position
+    {
+        get => _position;
+        set => Seek(value, SeekOrigin.Begin);
+    }
+
+    public override int Read(byte[] buffer, int offset, int count)
+    {
+        return Read(buffer.AsSpan(offset, count));
+    }
+
+    public override int Read(Span<byte> buffer)
+    {
+        int count = (int)Math.Min(buffer.Length, _length - _position);
+        if (count <= 0)
+        {
+            return 0;
+        }
+
+        int read = _file.Read(buffer[..count]);
+        _position += read;
+        return read;
+    }
+
+    public override long Seek(long offset, SeekOrigin origin)
+    {
+        long position = origin switch
+        {
+            SeekOrigin.Begin => offset,
+            SeekOrigin.Current => _position + offset,
+            SeekOrigin.End => _length + offset,
+            _ => throw new ArgumentOutOfRangeException(nameof(origin)),
+        };
+
+        ArgumentOutOfRangeException.ThrowIfNegative(position, nameof(offset));
+
+        _position = position;
+        _file.Position = _offset + position;
+        return position;
+    }
+
+    public override void Flush()
+    {
+    }
+
+    public override void SetLength(long value)
+    {
+        throw new NotSupportedException();
+    }
+
+    public override void Write(byte[] buffer, int offset, int count)
+    {
+        throw new NotSupportedException();
+    }
+
+    protected override void Dispose(bool disposing)
+    {
+        if (disposing)
+        {
+            _file.Dispose();
+        }
+
+        base.Dispose(disposing);
+    }
+}
@@ -0,0 +1,178 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Globalization;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// The CPU and memory limits of the cgroup (v2) that the process runs in, as
+/// set by container runtimes and systemd. On other platforms, or without
+/// cgroup v2, there are no limits and memory pressure is taken from the GC.
+/// </summary>
+internal sealed class CGroupLimits
+{
+    private const string CGroupRoot = "/sys/fs/cgroup";
+
+    private readonly string? _memoryCurrentPath;
+
+    private CGroupLimits(double? cpuLimit, long? memoryLimitBytes, string? memoryCurrentPath)
+    {
+        CpuLimit = cpuLimit;
+        MemoryLimitBytes = memoryLimitBytes;
+        _memoryCurrentPath = memoryCurrentPath;
+    }
+
+    /// <summary>
+    /// The number of CPUs that the cgroup may use, from <c>cpu.max</c>, or
+    /// null if unlimited.
+    /// </summary>
+    public double? CpuLimit { get; }
+
+    /// <summary>
+    /// The memory limit of the cgroup from <c>memory.max</c>, or null if
+    /// unlimited.
+    /// </summary>
+    public long? MemoryLimitBytes { get; }
+
+    /// <summary>
+    /// Reads the limits of the cgroup of the current process. Limits set on
+    /// ancestor cgroups also apply, so the lowest along the path is used.
+    /// </summary>
+    public static CGroupLimits Read()
+    {
+        string? path = OperatingSystem.IsLinux() ? GetCGroupPath() : null;
+        return path == null ? new CGroupLimits(null, null, null) : Read(CGroupRoot, path);
+    }
+
+    /// <summary>
+    /// Reads the limits of the cgroup at <paramref name="path"/> and its
+    /// ancestors up to <paramref name="root"/>.
+    /// </summary>
+    internal static CGroupLimits Read(string root, string path)
+    {
+        double? cpuLimit = null;
+        long? memoryLimitBytes = null;
+        string? memoryCurrentPath = null;
+
+        for (string? directory = path; directory != null && directory.StartsWith(root, StringComparison.Ordinal); directory = Path.GetDirectoryName(directory))
+        {
+            if (ParseCpuMax(TryReadFirstLine(Path.Combine(directory, "cpu.max"))) is double cpus)
+            {
+                cpuLimit = Math.Min(cpuLimit ?? double.MaxValue, cpus);
+            }
+
+            string memoryMaxPath = Path.Combine(directory, "memory.max");
+            if (ParseMemoryMax(TryReadFirstLine(memoryMaxPath)) is long bytes && bytes < (memoryLimitBytes ?? long.MaxValue))
+            {
+                memoryLimitBytes = bytes;
+                memoryCurrentPath = Path.Combine(directory, "memory.current");
+            }
+        }
+
+        return new CGroupLimits(cpuLimit, memoryLimitBytes, memoryCurrentPath);
+    }
+
+    /// <summary>
+    /// Gets the fraction of the memory limit that is in use, between 0 and 1.
+    /// This is the usage of the cgroup that sets the limit if there is one,
+    /// and the GC's view of the machine's memory load otherwise.
+    /// </summary>
+    public double GetMemoryPressure()
+    {
+        if (MemoryLimitBytes is long limit && ReadMemoryCurrent() is long current)
+        {
+            return Math.Clamp((double)current / limit, 0, 1);
+        }
+
+        GCMemoryInfo info = GC.GetGCMemoryInfo();
+        return info.TotalAvailableMemoryBytes > 0 ? Math.Clamp((double)info.MemoryLoadBytes / info.TotalAvailableMemoryBytes, 0, 1) : 0;
+    }
+
+    /// <summary>
+    /// Gets the number of bytes that can be used before reaching the memory
+    /// limit of the cgroup or the memory available to the GC.
+    /// </summary>
+    public long GetAvailableMemoryBytes()
+    {
+        GCMemoryInfo info = GC.GetGCMemoryInfo();
+        long available = info.TotalAvailableMemoryBytes - info.MemoryLoadBytes;
+
+        if (MemoryLimitBytes is long limit && ReadMemoryCurrent() is long current)
+        {
+            available = Math.Min(available, limit - current);
+        }
+
+        return Math.Max(0, available);
+    }
+
+    private long? ReadMemoryCurrent()
+    {
+        return _memoryCurrentPath != null &&
+               long.TryParse(TryReadFirstLine(_memoryCurrentPath), NumberStyles.None, CultureInfo.InvariantCulture, out long current)
+            ? current
+            : null;
+    }
+
+    // /proc/self/cgroup has a single "0::<path>" line for cgroup v2.
+    private static string? GetCGroupPath()
+    {
+        try
+        {
+            foreach (string line in File.ReadLines("/proc/self/cgroup"))
+            {
+                if (line.StartsWith("0::", StringComparison.Ordinal))
+                {
+                    string path = CGroupRoot + line[3..].TrimEnd('/');
+                    return Directory.Exists(path) ? path : CGroupRoot;
+                }
+            }
+        }
+        catch (IOException)
+        {
+        }
+        catch (UnauthorizedAccessException)
+        {
+        }
+
+        return null;
+    }
+
+    // "<quota> <period>" or "max <period>".
+    private static double? ParseCpuMax(string? text)
+    {
+        string[]? parts = text?.Split(' ');
+        if (parts is [string quota, string period] &&
+            long.TryParse(quota, NumberStyles.None, CultureInfo.InvariantCulture, out long quotaMicroseconds) &&
+            long.TryParse(period, NumberStyles.None, CultureInfo.InvariantCulture, out long periodMicroseconds) &&
+            periodMicroseconds > 0)
+        {
+            return (double)quotaMicroseconds / periodMicroseconds;
+        }
+
+        return null;
+    }
+
+    // "<bytes>" or "max".
+    private static long? ParseMemoryMax(string? text)
+    {
+        return long.TryParse(text, NumberStyles.None, CultureInfo.InvariantCulture, out long bytes) ? bytes : null;
+    }
+
+    private static string? TryReadFirstLine(string path)
+    {
+        try
+        {
+            using var reader = new StreamReader(path);
+            return reader.ReadLine()?.Trim();
+        }
+        catch (IOException)
+        {
+            return null;
+        }
+        catch (UnauthorizedAccessException)
+        {
+            return null;
+        }
+    }
+}
@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Text;
+using System.Text.Json;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// Writes scan findings as they are found by any worker. Only the
+/// non-sensitive part of a key, from the CASK signature on, is written so
+/// that scan output does not itself leak the keys.
+/// </summary>
+internal sealed class FindingWriter : IDisposable
+{
+    private readonly object _lock = new();
+    private readonly Stream? _stdout;
+    private readonly Utf8JsonWriter? _json;
+
+    public FindingWriter(bool json)
+        : this(json ? Console.OpenStandardOutput() : null)
+    {
+    }
+
+    /// <param name="json">The stream to write JSON lines to, or null to write text to the console.</param>
+    internal FindingWriter(Stream? json)
+    {
+        if (json != null)
+        {
+            _stdout = json;
+            _json = new Utf8JsonWriter(_stdout);
+        }
+    }
+
+    public void Write(string path, CaskMatch match)
+    {
+        Write(path, match.Offset, match.Key, match.IsLikelyPlaceholder);
+    }
+
+    /// <param name="path">The file in which the key was found.</param>
+    /// <param name="offset">The offset of the key in the file or in the stream within it.</param>
+    /// <param name="key">The key.</param>
+    /// <param name="isLikelyPlaceholder">
+    /// Whether the key is likely a placeholder, which is written as a
+    /// <c>placeholder</c> property after the further details and before the
+    /// length and the key.
+    /// </param>
+    /// <param name="properties">
+    /// Further details of where the key was found, such as the network flow
+    /// of a capture. They are written in order after the offset.
+    /// </param>
+    public void Write(string path, long offset, CaskKey key, bool isLikelyPlaceholder, params (string Name, string Value)[] properties)
+    {
+        string text = key.ToString();
+        string redacted = text[(key.SecretSize == SecretSize.Bits512 ? 88 : 44)..];
+
+        lock (_lock)
+        {
+            if (_json == null || _stdout == null)
+            {
+                var line = new StringBuilder();
+                line.Append(path).Append('(').Append(offset).Append(')');
+
+                foreach ((string name, string value) in properties)
+                {
+                    line.Append(' ').Append(name).Append('=').Append(value);
+                }
+
+                if (isLikelyPlaceholder)
+                {
+                    line.Append(" placeholder=true");
+                }
+
+                line.Append(": ...").Append(redacted);
+                Console.WriteLine(line.ToString());
+                return;
+            }
+
+            _json.WriteStartObject();
+            _json.WriteString("path", path);
+            _json.WriteNumber("offset", offset);
+
+            foreach ((string name, string value) in properties)
+            {
+                _json.WriteString(name, value);
+            }
+
+            if (isLikelyPlaceholder)
+            {
+                _json.WriteBoolean("placeholder", true);
+            }
+
+            _json.WriteNumber("length", text.Length);
+            _json.WriteString("key", redacted);
+            _json.WriteEndObject();
+            _json.Flush();
+            _json.Reset();
+
+            _stdout.Write("\n"u8);
+            _stdout.Flush();
+        }
+    }
+
+    public void Dispose()
+    {
+        _json?.Dispose();
+        _stdout?.Dispose();
+    }
+}
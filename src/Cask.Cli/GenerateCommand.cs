@@ -1,10 +1,6 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
-using System.Buffers.Text;
-using System.Security.Cryptography;
-using System.Text;
-
 namespace CommonAnnotatedSecurityKeys.Cli;
 
 internal static class GenerateCommand
@@ -13,11 +9,7 @@ internal static class GenerateCommand
 
     internal static int Run(GenerateOptions options)
     {
-        string cloudText = "AC";
-        string region = EncodeForIdentifiableKey("westus");
-        string tenant = EncodeForIdentifiableKey(s_microsoftTenantId);
-        string providerReserved = "AAAA";
-        string providerData = $"{cloudText}{region}{tenant}{providerReserved}";
+        string providerData = TenantProviderData.Encode("westus", s_microsoftTenantId);
 
         string providerSignature = options.FixedSignature;
 
@@ -30,15 +22,4 @@ internal static class GenerateCommand
 
         return 0;
     }
-
-    public static string EncodeForIdentifiableKey(string text)
-    {
-        if (string.IsNullOrWhiteSpace(text))
-        {
-            return "AAAAA";
-        }
-
-        byte[] hashed = SHA256.HashData(Encoding.UTF8.GetBytes(text));
-        return Base64Url.EncodeToString(hashed)[..5];
-    }
 }
@@ -0,0 +1,120 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics;
+using System.Globalization;
+using System.Runtime.InteropServices;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// Lowers the CPU and I/O priority of the process so that a scan only uses
+/// what other workloads on the host leave idle.
+/// </summary>
+/// <remarks>
+/// On Linux, CPU (nice) and I/O (ioprio) priorities belong to threads rather
+/// than processes, and new threads inherit them from the thread that creates
+/// them. Every existing thread of the process is therefore moved to nice 19
+/// and the idle I/O scheduling class, which makes all threads created later,
+/// including thread pool threads, idle too. On Windows, the process priority
+/// class is set to idle and the process enters background processing mode,
+/// which also lowers its I/O and memory priority. On other platforms, only
+/// the process priority class is set to idle, which lowers CPU priority only.
+/// </remarks>
+internal static partial class IdlePriority
+{
+    private const int PRIO_PROCESS = 0;
+    private const int NiceIdle = 19;
+
+    private const int IOPRIO_WHO_PROCESS = 1;
+    private const int IOPRIO_CLASS_IDLE = 3;
+    private const int IOPRIO_CLASS_SHIFT = 13;
+
+    private const uint PROCESS_MODE_BACKGROUND_BEGIN = 0x00100000;
+
+    /// <summary>
+    /// Lowers the priority of the process.
+    /// </summary>
+    /// <returns>
+    /// A description of what could not be lowered, or null if everything was.
+    /// </returns>
+    public static string? Enter()
+    {
+        if (!OperatingSystem.IsLinux())
+        {
+            using var process = Process.GetCurrentProcess();
+            process.PriorityClass = ProcessPriorityClass.Idle;
+
+            if (!OperatingSystem.IsWindows())
+            {
+                return "I/O priority is only lowered on Linux and Windows.";
+            }
+
+            // Background mode can only be entered through the pseudo handle
+            // of the current process, and keeps the idle priority class.
+            return SetPriorityClass(GetCurrentProcess(), PROCESS_MODE_BACKGROUND_BEGIN)
+                ? null
+                : "I/O priority could not be lowered.";
+        }
+
+        long ioprioSyscall = GetIoprioSetSyscallNumber();
+        int niceFailures = 0;
+        int ioprioFailures = 0;
+
+        foreach (string task in Directory.EnumerateDirectories("/proc/self/task"))
+        {
+            if (!int.TryParse(Path.GetFileName(task), NumberStyles.None, CultureInfo.InvariantCulture, out int threadId))
+            {
+                continue;
+            }
+
+            if (SetPriority(PRIO_PROCESS, threadId, NiceIdle) != 0)
+            {
+                niceFailures++;
+            }
+
+            if (ioprioSyscall < 0 || Syscall(ioprioSyscall, IOPRIO_WHO_PROCESS, threadId, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT) != 0)
+            {
+                ioprioFailures++;
+            }
+        }
+
+        return (niceFailures, ioprioFailures) switch
+        {
+            (0, 0) => null,
+            (_, 0) => "CPU priority could not be lowered for every thread.",
+            (0, _) => "I/O priority could not be lowered for every thread.",
+            _ => "CPU and I/O priority could not be lowered for every thread.",
+        };
+    }
+
+    // ioprio_set has no libc wrapper, so it is called by number.
+    private static long GetIoprioSetSyscallNumber()
+    {
+        return RuntimeInformation.ProcessArchitecture switch
+        {
+            Architecture.X64 => 251,
+            Architecture.X86 => 289,
+            Architecture.Arm64 => 30,
+            Architecture.Arm => 314,
+            _ => -1,
+        };
+    }
+
+    [LibraryImport("kernel32.dll", SetLastError = true)]
+    [DefaultDllImportSearchPaths(DllImportSearchPath.System32)]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    private static partial bool SetPriorityClass(nint process, uint priorityClass);
+
+    [LibraryImport("kernel32.dll")]
+    [DefaultDllImportSearchPaths(DllImportSearchPath.System32)]
+    private static partial nint GetCurrentProcess();
+
+    [LibraryImport("libc", EntryPoint = "setpriority", SetLastError = true)]
+    [DefaultDllImportSearchPaths(DllImportSearchPath.SafeDirectories)]
+    private static partial int SetPriority(int which, int who, int priority);
+
+    [LibraryImport("libc", EntryPoint = "syscall", SetLastError = true)]
+    [DefaultDllImportSearchPaths(DllImportSearchPath.SafeDirectories)]
+    private static partial long Syscall(long number, int which, int who, int ioprio);
+}
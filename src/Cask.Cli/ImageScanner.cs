@@ -0,0 +1,287 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics;
+using System.Formats.Tar;
+using System.IO.Compression;
+using System.Text.Json;
+
+using static CommonAnnotatedSecurityKeys.Cli.ImageSource;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// Scans the files in the layers of container images, scanning each distinct
+/// layer only once however many images share it.
+/// </summary>
+/// <remarks>
+/// The manifests of all images are read first to map each layer digest to
+/// the images that contain it. The distinct layers are then scanned in
+/// parallel, each in a single pass that decompresses the layer, reads it as
+/// a tar stream, and scans each file in it with a streaming <see
+/// cref="CaskScanner"/>, and each key found is reported once for every image
+/// with that layer.
+/// </remarks>
+internal sealed class ImageScanner
+{
+    private const int ChunkSize = 64 * 1024;
+
+    private static readonly EnumerationOptions s_enumerationOptions = new()
+    {
+        RecurseSubdirectories = true,
+        IgnoreInaccessible = true,
+        AttributesToSkip = FileAttributes.ReparsePoint,
+    };
+
+    private readonly int _threads;
+    private readonly TokenBucket? _byteRate;
+
+    private long _files;
+    private long _bytes;
+    private long _matchCount;
+    private long _errorCount;
+    private long _throttledTicks;
+
+    /// <param name="threads">
+    /// The number of layers to scan at once, or zero for one per CPU
+    /// available to the process.
+    /// </param>
+    /// <param name="byteRate">Limits the layer bytes read per second, if not null.</param>
+    public ImageScanner(int threads, TokenBucket? byteRate)
+    {
+        _threads = threads > 0
+            ? threads
+            : Math.Max(1, (int)Math.Ceiling(CGroupLimits.Read().CpuLimit ?? Environment.ProcessorCount));
+
+        _byteRate = byteRate;
+    }
+
+    /// <summary>
+    /// Scans the images in the given OCI image layouts, directories
+    /// containing layouts or <c>docker save</c> archives, and archives, and
+    /// calls <paramref name="onMatch"/>, from any thread, for each key found
+    /// in each image.
+    /// </summary>
+    public async Task<ImageSummary> RunAsync(IEnumerable<string> paths,
+                                             Action<ImageFinding> onMatch,
+                                             Action<string, Exception> onError,
+                                             CancellationToken cancellationToken)
+    {
+        var stopwatch = Stopwatch.StartNew();
+        var layers = new Dictionary<string, Layer>(StringComparer.Ordinal);
+        long images = 0;
+        long layerReferences = 0;
+
+        foreach (ImageSource source in FindSources(paths, onError))
+        {
+            IReadOnlyList<ImageManifest> manifests;
+            try
+            {
+                manifests = source.ReadManifests();
+            }
+            catch (Exception e) when (IsImageError(e))
+            {
+                _errorCount++;
+                onError(source.Path, e);
+                continue;
+            }
+
+            foreach (ImageManifest manifest in manifests)
+            {
+                images++;
+
+                foreach (LayerReference reference in manifest.Layers)
+                {
+                    layerReferences++;
+
+                    if (!layers.TryGetValue(reference.Digest, out Layer? layer))
+                    {
+                        layer = new Layer(reference.Digest, reference.Location);
+                        layers.Add(reference.Digest, layer);
+                    }
+
+                    var image = new ImageName(manifest.Source, manifest.Name);
+                    if (!layer.Images.Contains(image))
+                    {
+                        layer.Images.Add(image);
+                    }
+                }
+            }
+        }
+
+        var options = new ParallelOptions { MaxDegreeOfParallelism = _threads, CancellationToken = cancellationToken };
+
+        // Layers are scanned asynchronously so that waiting on the read rate
+        // does not hold a thread.
+        await Parallel.ForEachAsync(layers.Values, options, async (layer, cancellationToken) =>
+        {
+            try
+            {
+                await ScanLayerAsync(layer, onMatch, cancellationToken).ConfigureAwait(false);
+            }
+            catch (Exception e) when (IsImageError(e))
+            {
+                Interlocked.Increment(ref _errorCount);
+                onError($"{layer.Location.Path}!{layer.Digest}", e);
+            }
+        }).ConfigureAwait(false);
+
+        return new ImageSummary(images,
+                                layerReferences,
+                                layers.Count,
+                                Interlocked.Read(ref _files),
+                                Interlocked.Read(ref _bytes),
+                                Interlocked.Read(ref _matchCount),
+                                Interlocked.Read(ref _errorCount),
+                                stopwatch.Elapsed,
+                                TimeSpan.FromTicks(Interlocked.Read(ref _throttledTicks)));
+    }
+
+    private List<ImageSource> FindSources(IEnumerable<string> paths, Action<string, Exception> onError)
+    {
+        var sources = new List<ImageSource>();
+
+        foreach (string path in paths)
+        {
+            if (Directory.Exists(path) && ImageSource.IsLayout(path))
+            {
+                sources.Add(ImageSource.OpenLayout(path));
+                continue;
+            }
+
+            IEnumerable<string> archives = [path];
+
+            if (Directory.Exists(path))
+            {
+                sources.AddRange(Directory.EnumerateDirectories(path, "*", s_enumerationOptions)
+                                          .Where(ImageSource.IsLayout)
+                                          .Select(ImageSource.OpenLayout));
+
+                archives = Directory.EnumerateFiles(path, "*.tar", s_enumerationOptions);
+            }
+
+            foreach (string archive in archives)
+            {
+                try
+                {
+                    sources.Add(ImageSource.OpenArchive(archive));
+                }
+                catch (Exception e) when (IsImageError(e))
+                {
+                    _errorCount++;
+                    onError(archive, e);
+                }
+            }
+        }
+
+        return sources;
+    }
+
+    private async Task ScanLayerAsync(Layer layer, Action<ImageFinding> onMatch, CancellationToken cancellationToken)
+    {
+        using Stream blob = layer.Location.Open();
+
+        byte[] magic = new byte[4];
+        int magicLength = await blob.ReadAtLeastAsync(magic, magic.Length, throwOnEndOfStream: false, cancellationToken).ConfigureAwait(false);
+        blob.Position = 0;
+
+        if (magicLength == 4 && magic.AsSpan().SequenceEqual<byte>([0x28, 0xB5, 0x2F, 0xFD]))
+        {
+            throw new InvalidDataException("zstd-compressed layers are not supported.");
+        }
+
+        bool isGzip = magicLength >= 2 && magic[0] == 0x1F && magic[1] == 0x8B;
+
+        // Concatenated gzip members, as written by parallel compressors, are
+        // decompressed as one stream.
+        using Stream content = isGzip ? new GZipStream(blob, CompressionMode.Decompress, leaveOpen: true) : blob;
+        using var reader = new TarReader(content, leaveOpen: true);
+
+        var scanner = new CaskScanner();
+        byte[] buffer = new byte[ChunkSize];
+        var matches = new List<CaskMatch>();
+        long charged = 0;
+
+        while (await reader.GetNextEntryAsync(copyData: false, cancellationToken).ConfigureAwait(false) is TarEntry entry)
+        {
+            if (entry.EntryType is not (TarEntryType.RegularFile or TarEntryType.V7RegularFile or TarEntryType.ContiguousFile) || entry.DataStream == null)
+            {
+                continue;
+            }
+
+            scanner.Reset();
+            Interlocked.Increment(ref _files);
+
+            int read;
+            do
+            {
+                read = await entry.DataStream.ReadAsync(buffer, cancellationToken).ConfigureAwait(false);
+                Interlocked.Add(ref _bytes, read);
+
+                matches.Clear();
+                scanner.ScanUtf8(buffer.AsSpan(0, read), isFinalBlock: read == 0, matches);
+                Report(layer, entry.Name, matches, onMatch);
+
+                if (_byteRate != null && blob.Position - charged >= ChunkSize)
+                {
+                    long taken = blob.Position - charged;
+                    charged = blob.Position;
+
+                    TimeSpan wait = await _byteRate.TakeAsync(taken, cancellationToken).ConfigureAwait(false);
+                    Interlocked.Add(ref _throttledTicks, wait.Ticks);
+                }
+            }
+            while (read > 0);
+        }
+    }
+
+    private void Report(Layer layer, string path, List<CaskMatch> matches, Action<ImageFinding> onMatch)
+    {
+        foreach (CaskMatch match in matches)
+        {
+            foreach (ImageName image in layer.Images)
+            {
+                Interlocked.Increment(ref _matchCount);
+                onMatch(new ImageFinding(image.Source, image.Name, layer.Digest, path, match.Offset, match.Key, match.IsLikelyPlaceholder));
+            }
+        }
+    }
+
+    private static bool IsImageError(Exception e)
+    {
+        return e is IOException or UnauthorizedAccessException or InvalidDataException or FormatException or JsonException or KeyNotFoundException or InvalidOperationException;
+    }
+
+    /// <summary>
+    /// A key found in a file of an image.
+    /// </summary>
+    /// <param name="Source">The layout directory or archive of the image.</param>
+    /// <param name="Image">The name of the image.</param>
+    /// <param name="Layer">The digest of the layer in which the key was found.</param>
+    /// <param name="Path">The path of the file in the layer.</param>
+    /// <param name="Offset">The offset of the key in the file.</param>
+    /// <param name="Key">The key.</param>
+    /// <param name="IsLikelyPlaceholder">Whether the key is likely a placeholder, as for <see cref="CaskMatch.IsLikelyPlaceholder"/>.</param>
+    internal readonly record struct ImageFinding(string Source, string Image, string Layer, string Path, long Offset, CaskKey Key, bool IsLikelyPlaceholder);
+
+    internal sealed record ImageSummary(long Images,
+                                        long LayerReferences,
+                                        long UniqueLayers,
+                                        long Files,
+                                        long Bytes,
+                                        long Matches,
+                                        long Errors,
+                                        TimeSpan Elapsed,
+                                        TimeSpan ThrottledTime);
+
+    private readonly record struct ImageName(string Source, string Name);
+
+    private sealed class Layer(string digest, BlobLocation location)
+    {
+        public string Digest { get; } = digest;
+
+        public BlobLocation Location { get; } = location;
+
+        public List<ImageName> Images { get; } = [];
+    }
+}
@@ -0,0 +1,389 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Formats.Tar;
+using System.Text;
+using System.Text.Json;
+
+using Microsoft.Win32.SafeHandles;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// Reads the images and their layers from an OCI image layout directory or a
+/// <c>docker save</c> archive, without reading the layers themselves.
+/// </summary>
+/// <remarks>
+/// Layers are identified by the uncompressed digest (diff ID) from the image
+/// configuration where available, so that the same layer is recognized
+/// whether it is stored compressed or not, and otherwise by the digest of the
+/// blob.
+/// </remarks>
+internal sealed class ImageSource
+{
+    private const string OciLayoutFile = "oci-layout";
+    private const string OciIndexFile = "index.json";
+    private const string DockerManifestFile = "manifest.json";
+    private const int TarBlockSize = 512;
+
+    private const string RefNameAnnotation = "org.opencontainers.image.ref.name";
+    private const string ContainerdNameAnnotation = "io.containerd.image.name";
+
+    private const string OciImageConfigMediaType = "application/vnd.oci.image.config.v1+json";
+    private const string DockerImageConfigMediaType = "application/vnd.docker.container.image.v1+json";
+
+    private readonly string _path;
+    private readonly Dictionary<string, BlobLocation>? _archiveEntries;
+
+    private ImageSource(string path, Dictionary<string, BlobLocation>? archiveEntries)
+    {
+        _path = path;
+        _archiveEntries = archiveEntries;
+    }
+
+    /// <summary>
+    /// The layout directory or archive.
+    /// </summary>
+    public string Path => _path;
+
+    /// <summary>
+    /// Determines if the directory is an OCI image layout.
+    /// </summary>
+    public static bool IsLayout(string directory)
+    {
+        return File.Exists(System.IO.Path.Combine(directory, OciLayoutFile));
+    }
+
+    /// <summary>
+    /// Opens an OCI image layout directory.
+    /// </summary>
+    public static ImageSource OpenLayout(string directory)
+    {
+        return new ImageSource(directory, archiveEntries: null);
+    }
+
+    /// <summary>
+    /// Opens a <c>docker save</c> archive, which may itself contain an OCI
+    /// image layout, and indexes where each of its files is.
+    /// </summary>
+    /// <remarks>
+    /// Only the headers are read, so that blobs can be read later straight
+    /// from their place in the archive. <see cref="TarReader"/> does not
+    /// expose where entries are, so the headers are walked here: ustar names
+    /// with a prefix, GNU long names and pax paths are supported, which
+    /// covers archives written by Docker and common tools.
+    /// </remarks>
+    public static ImageSource OpenArchive(string path)
+    {
+        var entries = new Dictionary<string, BlobLocation>(StringComparer.Ordinal);
+
+        using SafeFileHandle handle = File.OpenHandle(path, FileMode.Open, FileAccess.Read, FileShare.ReadWrite | FileShare.Delete);
+        long length = RandomAccess.GetLength(handle);
+        byte[] header = new byte[TarBlockSize];
+        long position = 0;
+        string? longName = null;
+
+        while (position + TarBlockSize <= length)
+        {
+            RandomAccess.Read(handle, header, position);
+            if (header.AsSpan().IndexOfAnyExcept((byte)0) < 0)
+            {
+                break;
+            }
+
+            long size = ParseTarNumber(header.AsSpan(124, 12));
+            long data = position + TarBlockSize;
+            if (size < 0 || data + size > length)
+            {
+                throw new InvalidDataException($"Invalid tar entry at {position}.");
+            }
+
+            switch ((char)header[156])
+            {
+                case 'L':
+                    longName = ReadTarString(handle, data, size).TrimEnd('\0');
+                    break;
+
+                case 'x':
+                    longName = ParsePaxPath(ReadTarString(handle, data, size)) ?? longName;
+                    break;
+
+                case '0' or '\0' or '7':
+                    string name = longName ?? GetUstarName(header);
+                    entries[NormalizeEntryName(name)] = new BlobLocation(path, data, size);
+                    longName = null;
+                    break;
+
+                default:
+                    longName = null;
+                    break;
+            }
+
+            position = data + ((size + TarBlockSize - 1) & ~(long)(TarBlockSize - 1));
+        }
+
+        return new ImageSource(path, entries);
+    }
+
+    /// <summary>
+    /// Reads the manifests of all images in the source. For multi-platform
+    /// images, each platform is a separate image.
+    /// </summary>
+    public IReadOnlyList<ImageManifest> ReadManifests()
+    {
+        var manifests = new List<ImageManifest>();
+
+        // Archives from docker save list their images in manifest.json, even
+        // when they are also laid out as OCI images.
+        if (_archiveEntries != null && _archiveEntries.ContainsKey(DockerManifestFile))
+        {
+            ReadDockerManifests(manifests);
+            return manifests;
+        }
+
+        using JsonDocument index = ReadJson(OciIndexFile);
+        ReadOciIndex(index.RootElement, name: null, manifests);
+        return manifests;
+    }
+
+    /// <summary>
+    /// Finds a file of the source by its path in the layout or archive.
+    /// </summary>
+    public BlobLocation GetLocation(string name)
+    {
+        if (_archiveEntries == null)
+        {
+            string path = System.IO.Path.Combine(_path, name);
+            return new BlobLocation(path, 0, new FileInfo(path).Length);
+        }
+
+        if (!_archiveEntries.TryGetValue(NormalizeEntryName(name), out BlobLocation location))
+        {
+            throw new FileNotFoundException($"{name} not found in {_path}.");
+        }
+
+        return location;
+    }
+
+    private void ReadDockerManifests(List<ImageManifest> manifests)
+    {
+        using JsonDocument document = ReadJson(DockerManifestFile);
+
+        foreach (JsonElement image in document.RootElement.EnumerateArray())
+        {
+            string config = image.GetProperty("Config").GetString()!;
+            string name = image.TryGetProperty("RepoTags", out JsonElement tags) && tags.ValueKind == JsonValueKind.Array && tags.GetArrayLength() > 0
+                ? string.Join(",", tags.EnumerateArray().Select(tag => tag.GetString()))
+                : config;
+
+            List<string> layerPaths = image.GetProperty("Layers").EnumerateArray().Select(layer => layer.GetString()!).ToList();
+            List<string>? diffIds = ReadDiffIds(config);
+
+            var layers = new List<LayerReference>(layerPaths.Count);
+            for (int i = 0; i < layerPaths.Count; i++)
+            {
+                // Without diff IDs, a layer can only be told apart by where it
+                // is, so it is not shared with other sources.
+                string digest = diffIds?.Count == layerPaths.Count ? diffIds[i] : $"{_path}!{layerPaths[i]}";
+                layers.Add(new LayerReference(digest, GetLocation(layerPaths[i])));
+            }
+
+            manifests.Add(new ImageManifest(_path, name, layers));
+        }
+    }
+
+    private void ReadOciIndex(JsonElement index, string? name, List<ImageManifest> manifests)
+    {
+        foreach (JsonElement descriptor in index.GetProperty("manifests").EnumerateArray())
+        {
+            string digest = descriptor.GetProperty("digest").GetString()!;
+            string? mediaType = descriptor.TryGetProperty("mediaType", out JsonElement type) ? type.GetString() : null;
+            string descriptorName = name ?? GetAnnotation(descriptor, ContainerdNameAnnotation) ?? GetAnnotation(descriptor, RefNameAnnotation) ?? digest;
+
+            if (descriptor.TryGetProperty("platform", out JsonElement platform) &&
+                platform.TryGetProperty("os", out JsonElement os) &&
+                platform.TryGetProperty("architecture", out JsonElement architecture))
+            {
+                descriptorName = $"{descriptorName} ({os.GetString()}/{architecture.GetString()})";
+            }
+
+            using JsonDocument document = ReadJson(GetBlobPath(digest));
+            JsonElement root = document.RootElement;
+
+            // Nested indexes hold the manifests of each platform.
+            if (root.TryGetProperty("manifests", out _) || mediaType is "application/vnd.oci.image.index.v1+json" or "application/vnd.docker.distribution.manifest.list.v2+json")
+            {
+                ReadOciIndex(root, descriptorName, manifests);
+                continue;
+            }
+
+            // Skip artifacts such as attestations and signatures, which are
+            // stored as manifests but whose layers are not file systems.
+            if (!root.TryGetProperty("layers", out JsonElement layerDescriptors) ||
+                (root.TryGetProperty("config", out JsonElement configDescriptor) &&
+                 configDescriptor.TryGetProperty("mediaType", out JsonElement configType) &&
+                 configType.GetString() is not (OciImageConfigMediaType or DockerImageConfigMediaType)))
+            {
+                continue;
+            }
+
+            List<string> blobDigests = layerDescriptors.EnumerateArray().Select(layer => layer.GetProperty("digest").GetString()!).ToList();
+            List<string>? diffIds = root.TryGetProperty("config", out JsonElement config)
+                ? ReadDiffIds(GetBlobPath(config.GetProperty("digest").GetString()!))
+                : null;
+
+            var layers = new List<LayerReference>(blobDigests.Count);
+            for (int i = 0; i < blobDigests.Count; i++)
+            {
+                string layerDigest = diffIds?.Count == blobDigests.Count ? diffIds[i] : blobDigests[i];
+                layers.Add(new LayerReference(layerDigest, GetLocation(GetBlobPath(blobDigests[i]))));
+            }
+
+            manifests.Add(new ImageManifest(_path, descriptorName, layers));
+        }
+    }
+
+    private List<string>? ReadDiffIds(string configPath)
+    {
+        using JsonDocument config = ReadJson(configPath);
+
+        if (config.RootElement.TryGetProperty("rootfs", out JsonElement rootfs) &&
+            rootfs.TryGetProperty("diff_ids", out JsonElement diffIds) &&
+            diffIds.ValueKind == JsonValueKind.Array)
+        {
+            return diffIds.EnumerateArray().Select(id => id.GetString()!).ToList();
+        }
+
+        return null;
+    }
+
+    private JsonDocument ReadJson(string name)
+    {
+        BlobLocation location = GetLocation(name);
+
+        using Stream stream = location.Open();
+        return JsonDocument.Parse(stream);
+    }
+
+    private static string GetBlobPath(string digest)
+    {
+        int colon = digest.IndexOf(':', StringComparison.Ordinal);
+        if (colon <= 0 || digest.AsSpan(colon + 1).ContainsAny("/\\.") || digest.AsSpan(0, colon).ContainsAny("/\\."))
+        {
+            throw new InvalidDataException($"Invalid digest '{digest}'.");
+        }
+
+        return $"blobs/{digest[..colon]}/{digest[(colon + 1)..]}";
+    }
+
+    private static long ParseTarNumber(ReadOnlySpan<byte> field)
+    {
+        // Large sizes are stored as big-endian binary with the high bit set.
+        if ((field[0] & 0x80) != 0)
+        {
+            long binary = field[0] & 0x7F;
+            foreach (byte b in field[1..])
+            {
+                binary = checked((binary << 8) | b);
+            }
+
+            return binary;
+        }
+
+        long octal = 0;
+        foreach (byte b in field)
+        {
+            if (b is >= (byte)'0' and <= (byte)'7')
+            {
+                octal = checked((octal * 8) + (b - '0'));
+            }
+            else if (b is not ((byte)' ' or 0))
+            {
+                throw new InvalidDataException("Invalid tar number.");
+            }
+        }
+
+        return octal;
+    }
+
+    private static string GetUstarName(byte[] header)
+    {
+        string name = ReadNulTerminated(header.AsSpan(0, 100));
+
+        if (header.AsSpan(257, 5).SequenceEqual("ustar"u8))
+        {
+            string prefix = ReadNulTerminated(header.AsSpan(345, 155));
+            if (prefix.Length > 0)
+            {
+                name = $"{prefix}/{name}";
+            }
+        }
+
+        return name;
+
+        static string ReadNulTerminated(ReadOnlySpan<byte> field)
+        {
+            int end = field.IndexOf((byte)0);
+            return Encoding.UTF8.GetString(end < 0 ? field : field[..end]);
+        }
+    }
+
+    private static string ReadTarString(SafeFileHandle handle, long offset, long size)
+    {
+        if (size > 1024 * 1024)
+        {
+            throw new InvalidDataException("Tar extended header is too large.");
+        }
+
+        byte[] bytes = new byte[size];
+        RandomAccess.Read(handle, bytes, offset);
+        return Encoding.UTF8.GetString(bytes);
+    }
+
+    /// <summary>
+    /// Finds the path in pax extended header records, which have the form
+    /// "length key=value\n".
+    /// </summary>
+    private static string? ParsePaxPath(string records)
+    {
+        foreach (string record in records.Split('\n'))
+        {
+            int space = record.IndexOf(' ', StringComparison.Ordinal);
+            if (space > 0 && record.AsSpan(space + 1).StartsWith("path=", StringComparison.Ordinal))
+            {
+                return record[(space + 1 + "path=".Length)..];
+            }
+        }
+
+        return null;
+    }
+
+    private static string? GetAnnotation(JsonElement descriptor, string name)
+    {
+        return descriptor.TryGetProperty("annotations", out JsonElement annotations) && annotations.TryGetProperty(name, out JsonElement value)
+            ? value.GetString()
+            : null;
+    }
+
+    private static string NormalizeEntryName(string name)
+    {
+        return name.StartsWith("./", StringComparison.Ordinal) ? name[2..] : name;
+    }
+
+    /// <summary>
+    /// Where the bytes of a blob are: a whole file of a layout, or a range of
+    /// an archive.
+    /// </summary>
+    internal readonly record struct BlobLocation(string Path, long Offset, long Length)
+    {
+        public Stream Open()
+        {
+            var file = new FileStream(Path, FileMode.Open, FileAccess.Read, FileShare.ReadWrite | FileShare.Delete, 64 * 1024, FileOptions.SequentialScan);
+            return Offset == 0 && Length == file.Length ? file : new BlobStream(file, Offset, Length);
+        }
+    }
+
+    internal sealed record LayerReference(string Digest, BlobLocation Location);
+
+    internal sealed record ImageManifest(string Source, string Name, IReadOnlyList<LayerReference> Layers);
+}
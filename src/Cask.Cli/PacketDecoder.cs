@@ -0,0 +1,258 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+using System.Net;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// Decodes the link, network and transport headers of captured packets to
+/// find TCP segments and UDP datagrams.
+/// </summary>
+/// <remarks>
+/// Ethernet (with VLAN tags), raw IP, BSD loopback and Linux cooked captures
+/// are supported. IP fragments are not reassembled; they are skipped, as are
+/// packets whose headers are truncated by the capture snap length.
+/// </remarks>
+internal static class PacketDecoder
+{
+    private const int LinkTypeNull = 0;
+    private const int LinkTypeEthernet = 1;
+    private const int LinkTypeRawBsd = 12;
+    private const int LinkTypeRaw = 101;
+    private const int LinkTypeLinuxSll = 113;
+    private const int LinkTypeIPv4 = 228;
+    private const int LinkTypeIPv6 = 229;
+    private const int LinkTypeLinuxSll2 = 276;
+
+    private const ushort EtherTypeIPv4 = 0x0800;
+    private const ushort EtherTypeIPv6 = 0x86DD;
+    private const ushort EtherTypeVlan = 0x8100;
+    private const ushort EtherTypeQinQ = 0x88A8;
+
+    private const byte ProtocolTcp = 6;
+    private const byte ProtocolUdp = 17;
+
+    public static bool TryDecode(PcapPacket packet, out PacketSegment segment)
+    {
+        segment = default;
+        ReadOnlySpan<byte> data = packet.Data.Span;
+
+        if (!TryGetNetworkOffset(packet.LinkType, data, out int offset))
+        {
+            return false;
+        }
+
+        ReadOnlySpan<byte> ip = data[offset..];
+        if (ip.IsEmpty)
+        {
+            return false;
+        }
+
+        byte protocol;
+        UInt128 source;
+        UInt128 destination;
+        bool isIPv6;
+
+        switch (ip[0] >> 4)
+        {
+            case 4:
+            {
+                int headerLength = (ip[0] & 0x0F) * 4;
+                if (headerLength < 20 || ip.Length < headerLength)
+                {
+                    return false;
+                }
+
+                // More fragments flag or a fragment offset.
+                if ((BinaryPrimitives.ReadUInt16BigEndian(ip[6..]) & 0x3FFF) != 0)
+                {
+                    return false;
+                }
+
+                // Drop Ethernet padding after the datagram.
+                int totalLength = BinaryPrimitives.ReadUInt16BigEndian(ip[2..]);
+                if (totalLength >= headerLength && totalLength < ip.Length)
+                {
+                    ip = ip[..totalLength];
+                }
+
+                protocol = ip[9];
+                source = BinaryPrimitives.ReadUInt32BigEndian(ip[12..]);
+                destination = BinaryPrimitives.ReadUInt32BigEndian(ip[16..]);
+                isIPv6 = false;
+                offset += headerLength;
+                ip = ip[headerLength..];
+                break;
+            }
+
+            case 6:
+            {
+                if (ip.Length < 40)
+                {
+                    return false;
+                }
+
+                int payloadLength = BinaryPrimitives.ReadUInt16BigEndian(ip[4..]);
+                if (40 + payloadLength < ip.Length)
+                {
+                    ip = ip[..(40 + payloadLength)];
+                }
+
+                protocol = ip[6];
+                source = BinaryPrimitives.ReadUInt128BigEndian(ip[8..]);
+                destination = BinaryPrimitives.ReadUInt128BigEndian(ip[24..]);
+                isIPv6 = true;
+                offset += 40;
+                ip = ip[40..];
+
+                // Skip hop-by-hop, routing, destination and authentication
+                // extension headers. Fragments are skipped entirely.
+                while (protocol is 0 or 43 or 60 or 51)
+                {
+                    if (ip.Length < 8)
+                    {
+                        return false;
+                    }
+
+                    int length = protocol == 51 ? (ip[1] + 2) * 4 : (ip[1] + 1) * 8;
+                    if (ip.Length < length)
+                    {
+                        return false;
+                    }
+
+                    protocol = ip[0];
+                    offset += length;
+                    ip = ip[length..];
+                }
+
+                break;
+            }
+
+            default:
+                return false;
+        }
+
+        if (protocol == ProtocolTcp)
+        {
+            int headerLength = ip.Length >= 20 ? (ip[12] >> 4) * 4 : 0;
+            if (headerLength < 20 || ip.Length < headerLength)
+            {
+                return false;
+            }
+
+            var flow = new FlowKey(source, destination, BinaryPrimitives.ReadUInt16BigEndian(ip), BinaryPrimitives.ReadUInt16BigEndian(ip[2..]), isIPv6, IsUdp: false);
+            uint sequence = BinaryPrimitives.ReadUInt32BigEndian(ip[4..]);
+            var flags = (TcpFlags)(ip[13] & 0x07);
+
+            segment = new PacketSegment(flow, sequence, flags, packet.Data.Slice(offset + headerLength, ip.Length - headerLength));
+            return true;
+        }
+
+        if (protocol == ProtocolUdp)
+        {
+            if (ip.Length < 8)
+            {
+                return false;
+            }
+
+            var flow = new FlowKey(source, destination, BinaryPrimitives.ReadUInt16BigEndian(ip), BinaryPrimitives.ReadUInt16BigEndian(ip[2..]), isIPv6, IsUdp: true);
+            segment = new PacketSegment(flow, 0, TcpFlags.None, packet.Data.Slice(offset + 8, ip.Length - 8));
+            return true;
+        }
+
+        return false;
+    }
+
+    private static bool TryGetNetworkOffset(int linkType, ReadOnlySpan<byte> data, out int offset)
+    {
+        offset = 0;
+
+        switch (linkType)
+        {
+            case LinkTypeNull:
+                // A 4-byte address family in host byte order; either way, the
+                // value is small, so only its IP-ness matters here.
+                offset = 4;
+                return data.Length >= 4;
+
+            case LinkTypeRaw:
+            case LinkTypeRawBsd:
+            case LinkTypeIPv4:
+            case LinkTypeIPv6:
+                return true;
+
+            case LinkTypeLinuxSll:
+                offset = 16;
+                return data.Length >= 16 && IsIP(BinaryPrimitives.ReadUInt16BigEndian(data[14..]));
+
+            case LinkTypeLinuxSll2:
+                offset = 20;
+                return data.Length >= 20 && IsIP(BinaryPrimitives.ReadUInt16BigEndian(data));
+
+            case LinkTypeEthernet:
+            {
+                offset = 12;
+
+                while (data.Length >= offset + 2)
+                {
+                    ushort etherType = BinaryPrimitives.ReadUInt16BigEndian(data[offset..]);
+                    offset += 2;
+
+                    if (etherType is EtherTypeVlan or EtherTypeQinQ)
+                    {
+                        offset += 2;
+                        continue;
+                    }
+
+                    return IsIP(etherType);
+                }
+
+                return false;
+            }
+
+            default:
+                return false;
+        }
+
+        static bool IsIP(ushort etherType) => etherType is EtherTypeIPv4 or EtherTypeIPv6;
+    }
+}
+
+[Flags]
+internal enum TcpFlags : byte
+{
+    None = 0,
+    Fin = 1,
+    Syn = 2,
+    Rst = 4,
+}
+
+/// <summary>
+/// The payload of a TCP segment or UDP datagram. The payload refers to the
+/// captured packet and is only valid as long as it is.
+/// </summary>
+internal readonly record struct PacketSegment(FlowKey Flow, uint Sequence, TcpFlags Flags, ReadOnlyMemory<byte> Payload);
+
+/// <summary>
+/// Identifies one direction of a TCP connection, or UDP datagrams between the
+/// same endpoints. IPv4 addresses are held in the low 32 bits.
+/// </summary>
+internal readonly record struct FlowKey(UInt128 Source, UInt128 Destination, ushort SourcePort, ushort DestinationPort, bool IsIPv6, bool IsUdp)
+{
+    public string Protocol => IsUdp ? "udp" : "tcp";
+
+    public string SourceEndPoint => FormatEndPoint(Source, SourcePort);
+
+    public string DestinationEndPoint => FormatEndPoint(Destination, DestinationPort);
+
+    private string FormatEndPoint(UInt128 address, ushort port)
+    {
+        Span<byte> bytes = stackalloc byte[16];
+        BinaryPrimitives.WriteUInt128BigEndian(bytes, address);
+
+        var endPoint = new IPEndPoint(new IPAddress(IsIPv6 ? bytes : bytes[12..]), port);
+        return endPoint.ToString();
+    }
+}
@@ -0,0 +1,399 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// Reads packets from a pcap or pcapng capture as a stream, without loading
+/// the capture into memory.
+/// </summary>
+/// <remarks>
+/// Both byte orders and both microsecond and nanosecond pcap files are
+/// supported, as are pcapng files with multiple sections and interfaces of
+/// different link types and timestamp resolutions. Blocks other than
+/// packets and interface descriptions are skipped.
+/// </remarks>
+internal sealed class PcapReader
+{
+    private const uint PcapMagicMicroseconds = 0xA1B2C3D4;
+    private const uint PcapMagicNanoseconds = 0xA1B23C4D;
+    private const uint PcapngSectionHeaderBlock = 0x0A0D0D0A;
+    private const uint PcapngByteOrderMagic = 0x1A2B3C4D;
+
+    private const uint PcapngInterfaceDescriptionBlock = 1;
+    private const uint PcapngObsoletePacketBlock = 2;
+    private const uint PcapngSimplePacketBlock = 3;
+    private const uint PcapngEnhancedPacketBlock = 6;
+
+    private const ushort PcapngOptionEnd = 0;
+    private const ushort PcapngOptionTimestampResolution = 9;
+    private const ushort PcapngOptionTimestampOffset = 14;
+
+    // Interface (4), timestamp (8), captured length (4), original length (4).
+    private const int PcapngPacketHeaderLength = 20;
+
+    private const int MaxRecordLength = 256 * 1024 * 1024;
+
+    private static readonly long s_minUnixSeconds = DateTimeOffset.MinValue.ToUnixTimeSeconds();
+    private static readonly long s_maxUnixSeconds = DateTimeOffset.MaxValue.ToUnixTimeSeconds();
+
+    private readonly Stream _stream;
+    private readonly bool _isPcapng;
+    private readonly List<Interface> _interfaces = [];
+    private byte[] _buffer = new byte[64 * 1024];
+    private bool _bigEndian;
+    private long _pcapUnitsPerSecond = TimeSpan.TicksPerSecond;
+    private int _pcapLinkType;
+    private DateTimeOffset _lastTimestamp = DateTimeOffset.UnixEpoch;
+
+    public PcapReader(Stream stream)
+    {
+        _stream = stream;
+
+        Span<byte> magic = stackalloc byte[4];
+        _stream.ReadExactly(magic);
+
+        uint little = BinaryPrimitives.ReadUInt32LittleEndian(magic);
+        uint big = BinaryPrimitives.ReadUInt32BigEndian(magic);
+
+        if (little == PcapngSectionHeaderBlock)
+        {
+            _isPcapng = true;
+            ReadSectionHeader();
+        }
+        else if (little is PcapMagicMicroseconds or PcapMagicNanoseconds || big is PcapMagicMicroseconds or PcapMagicNanoseconds)
+        {
+            _bigEndian = big is PcapMagicMicroseconds or PcapMagicNanoseconds;
+            bool nanoseconds = (_bigEndian ? big : little) == PcapMagicNanoseconds;
+            _pcapUnitsPerSecond = nanoseconds ? 1_000_000_000 : 1_000_000;
+
+            // Version (4), reserved (8), snap length (4), link type (4). The
+            // upper bits of the link type hold FCS information.
+            Span<byte> header = stackalloc byte[20];
+            _stream.ReadExactly(header);
+            _pcapLinkType = (int)(ReadUInt32(header[16..]) & 0xFFFF);
+        }
+        else
+        {
+            throw new InvalidDataException("Not a pcap or pcapng capture.");
+        }
+    }
+
+    /// <summary>
+    /// Reads the next packet. The packet data is only valid until the next
+    /// call.
+    /// </summary>
+    public bool TryReadPacket(out PcapPacket packet)
+    {
+        return _isPcapng ? TryReadPcapngPacket(out packet) : TryReadPcapPacket(out packet);
+    }
+
+    private bool TryReadPcapPacket(out PcapPacket packet)
+    {
+        packet = default;
+
+        Span<byte> header = stackalloc byte[16];
+        if (!TryReadExactlyOrEnd(header))
+        {
+            return false;
+        }
+
+        uint seconds = ReadUInt32(header);
+        uint fraction = ReadUInt32(header[4..]);
+        int capturedLength = ReadLength(header[8..]);
+
+        ReadOnlyMemory<byte> data = ReadBody(capturedLength);
+        DateTimeOffset timestamp = FromUnixTime(seconds, fraction * TimeSpan.TicksPerSecond / _pcapUnitsPerSecond);
+
+        packet = new PcapPacket(_pcapLinkType, timestamp, data);
+        return true;
+    }
+
+    private bool TryReadPcapngPacket(out PcapPacket packet)
+    {
+        Span<byte> header = stackalloc byte[8];
+
+        while (TryReadExactlyOrEnd(header))
+        {
+            uint blockType = ReadUInt32(header);
+
+            if (blockType == PcapngSectionHeaderBlock)
+            {
+                // The block length is read again once the byte order is known.
+                ReadSectionHeader(header[4..]);
+                continue;
+            }
+
+            int blockLength = ReadLength(header[4..]);
+            if (blockLength < 12 || blockLength % 4 != 0)
+            {
+                throw new InvalidDataException($"Invalid pcapng block length {blockLength}.");
+            }
+
+            // Body without the trailing copy of the block length.
+            ReadOnlySpan<byte> body = ReadBody(blockLength - 8).Span[..^4];
+
+            switch (blockType)
+            {
+                case PcapngInterfaceDescriptionBlock:
+                    CheckBodyLength(blockType, body, 8);
+                    _interfaces.Add(ReadInterface(body));
+                    break;
+
+                case PcapngEnhancedPacketBlock:
+                {
+                    CheckBodyLength(blockType, body, PcapngPacketHeaderLength);
+                    Interface description = GetInterface(ReadUInt32(body));
+                    ulong timestamp = ((ulong)ReadUInt32(body[4..]) << 32) | ReadUInt32(body[8..]);
+                    int capturedLength = ReadCapturedLength(blockType, body, PcapngPacketHeaderLength);
+
+                    packet = new PcapPacket(description.LinkType, description.GetTimestamp(timestamp), _buffer.AsMemory(8 + PcapngPacketHeaderLength, capturedLength));
+                    _lastTimestamp = packet.Timestamp;
+                    return true;
+                }
+
+                case PcapngObsoletePacketBlock:
+                {
+                    CheckBodyLength(blockType, body, PcapngPacketHeaderLength);
+                    Interface description = GetInterface(ReadUInt16(body));
+                    ulong timestamp = ((ulong)ReadUInt32(body[4..]) << 32) | ReadUInt32(body[8..]);
+                    int capturedLength = ReadCapturedLength(blockType, body, PcapngPacketHeaderLength);
+
+                    packet = new PcapPacket(description.LinkType, description.GetTimestamp(timestamp), _buffer.AsMemory(8 + PcapngPacketHeaderLength, capturedLength));
+                    _lastTimestamp = packet.Timestamp;
+                    return true;
+                }
+
+                case PcapngSimplePacketBlock:
+                {
+                    // Simple packets have no timestamp or interface and are
+                    // only written for captures with a single interface. The
+                    // length is of the original packet, which is cut to the
+                    // block if it was longer than the snap length.
+                    CheckBodyLength(blockType, body, 4);
+                    Interface description = GetInterface(0);
+                    int capturedLength = (int)Math.Min(ReadUInt32(body), (uint)(body.Length - 4));
+
+                    packet = new PcapPacket(description.LinkType, _lastTimestamp, _buffer.AsMemory(8 + 4, capturedLength));
+                    return true;
+                }
+            }
+        }
+
+        packet = default;
+        return false;
+    }
+
+    /// <summary>
+    /// Reads a section header block after its block type, which starts a new
+    /// section with its own byte order and interfaces.
+    /// </summary>
+    private void ReadSectionHeader(ReadOnlySpan<byte> blockLengthBytes = default)
+    {
+        Span<byte> lengthAndMagic = stackalloc byte[8];
+
+        if (blockLengthBytes.IsEmpty)
+        {
+            _stream.ReadExactly(lengthAndMagic);
+        }
+        else
+        {
+            blockLengthBytes.CopyTo(lengthAndMagic);
+            _stream.ReadExactly(lengthAndMagic[4..]);
+        }
+
+        _bigEndian = BinaryPrimitives.ReadUInt32BigEndian(lengthAndMagic[4..]) == PcapngByteOrderMagic;
+        if (!_bigEndian && BinaryPrimitives.ReadUInt32LittleEndian(lengthAndMagic[4..]) != PcapngByteOrderMagic)
+        {
+            throw new InvalidDataException("Invalid pcapng byte-order magic.");
+        }
+
+        int blockLength = ReadLength(lengthAndMagic);
+        if (blockLength < 28 || blockLength % 4 != 0)
+        {
+            throw new InvalidDataException($"Invalid pcapng section header length {blockLength}.");
+        }
+
+        // Skip the version, section length, options and trailing length.
+        ReadBody(blockLength - 12);
+        _interfaces.Clear();
+    }
+
+    private Interface ReadInterface(ReadOnlySpan<byte> body)
+    {
+        int linkType = ReadUInt16(body);
+        long ticksPerSecond = 1_000_000;
+        long offsetSeconds = 0;
+
+        // Link type (2), reserved (2), snap length (4), then options.
+        ReadOnlySpan<byte> options = body[8..];
+        while (options.Length >= 4)
+        {
+            ushort code = ReadUInt16(options);
+            int length = ReadUInt16(options[2..]);
+            if (code == PcapngOptionEnd || 4 + length > options.Length)
+            {
+                break;
+            }
+
+            ReadOnlySpan<byte> value = options.Slice(4, length);
+
+            if (code == PcapngOptionTimestampResolution && length == 1)
+            {
+                // The high bit selects a power of two instead of ten.
+                int exponent = value[0] & 0x7F;
+                ticksPerSecond = (value[0] & 0x80) != 0 ? 1L << Math.Min(exponent, 62) : (long)Math.Pow(10, Math.Min(exponent, 18));
+            }
+            else if (code == PcapngOptionTimestampOffset && length == 8)
+            {
+                // The offset is signed.
+                offsetSeconds = unchecked((long)ReadUInt64(value));
+            }
+
+            options = options[Math.Min(options.Length, 4 + ((length + 3) & ~3))..];
+        }
+
+        return new Interface(linkType, ticksPerSecond, offsetSeconds);
+    }
+
+    private Interface GetInterface(uint id)
+    {
+        if (id >= _interfaces.Count)
+        {
+            throw new InvalidDataException($"Packet refers to undefined interface {id}.");
+        }
+
+        return _interfaces[(int)id];
+    }
+
+    /// <summary>
+    /// Reads the given number of bytes into the start of the internal buffer
+    /// after the 8-byte block header, which is where pcapng packet offsets
+    /// above are relative to. For pcap, the data starts at the beginning.
+    /// </summary>
+    private ReadOnlyMemory<byte> ReadBody(int length)
+    {
+        int start = _isPcapng ? 8 : 0;
+
+        if (length < 0 || length > MaxRecordLength)
+        {
+            throw new InvalidDataException($"Invalid capture record length {length}.");
+        }
+
+        if (_buffer.Length < start + length)
+        {
+            Array.Resize(ref _buffer, Math.Max(start + length, 2 * _buffer.Length));
+        }
+
+        _stream.ReadExactly(_buffer, start, length);
+        return _buffer.AsMemory(start, length);
+    }
+
+    /// <summary>
+    /// Reads a record or block length, which can be at most <see
+    /// cref="MaxRecordLength"/>.
+    /// </summary>
+    private int ReadLength(ReadOnlySpan<byte> bytes)
+    {
+        uint length = ReadUInt32(bytes);
+        if (length > MaxRecordLength)
+        {
+            throw new InvalidDataException($"Invalid capture record length {length}.");
+        }
+
+        return (int)length;
+    }
+
+    private static void CheckBodyLength(uint blockType, ReadOnlySpan<byte> body, int minimum)
+    {
+        if (body.Length < minimum)
+        {
+            throw new InvalidDataException($"Invalid pcapng block of type {blockType}: {body.Length} bytes is too short.");
+        }
+    }
+
+    /// <summary>
+    /// Reads the captured length of a packet, which must fit in the block
+    /// after the packet header.
+    /// </summary>
+    private int ReadCapturedLength(uint blockType, ReadOnlySpan<byte> body, int headerLength)
+    {
+        uint capturedLength = ReadUInt32(body[(headerLength - 8)..]);
+        if (capturedLength > body.Length - headerLength)
+        {
+            throw new InvalidDataException($"Invalid pcapng block of type {blockType}: captured length {capturedLength} is longer than the block.");
+        }
+
+        return (int)capturedLength;
+    }
+
+    /// <summary>
+    /// Converts a Unix time to a timestamp. Times beyond what a <see
+    /// cref="DateTimeOffset"/> can hold are clamped rather than rejected,
+    /// since they don't change what is scanned.
+    /// </summary>
+    private static DateTimeOffset FromUnixTime(Int128 seconds, long ticks)
+    {
+        if (seconds < s_minUnixSeconds)
+        {
+            return DateTimeOffset.MinValue;
+        }
+
+        if (seconds > s_maxUnixSeconds)
+        {
+            return DateTimeOffset.MaxValue;
+        }
+
+        return DateTimeOffset.FromUnixTimeSeconds((long)seconds).AddTicks(ticks);
+    }
+
+    private bool TryReadExactlyOrEnd(Span<byte> buffer)
+    {
+        int read = _stream.ReadAtLeast(buffer, buffer.Length, throwOnEndOfStream: false);
+        if (read == 0)
+        {
+            return false;
+        }
+
+        if (read < buffer.Length)
+        {
+            throw new EndOfStreamException("The capture ends in the middle of a record.");
+        }
+
+        return true;
+    }
+
+    private ushort ReadUInt16(ReadOnlySpan<byte> bytes)
+    {
+        return _bigEndian ? BinaryPrimitives.ReadUInt16BigEndian(bytes) : BinaryPrimitives.ReadUInt16LittleEndian(bytes);
+    }
+
+    private uint ReadUInt32(ReadOnlySpan<byte> bytes)
+    {
+        return _bigEndian ? BinaryPrimitives.ReadUInt32BigEndian(bytes) : BinaryPrimitives.ReadUInt32LittleEndian(bytes);
+    }
+
+    private ulong ReadUInt64(ReadOnlySpan<byte> bytes)
+    {
+        return _bigEndian ? BinaryPrimitives.ReadUInt64BigEndian(bytes) : BinaryPrimitives.ReadUInt64LittleEndian(bytes);
+    }
+
+    private sealed record Interface(int LinkType, long UnitsPerSecond, long OffsetSeconds)
+    {
+        public DateTimeOffset GetTimestamp(ulong units)
+        {
+            ulong seconds = units / (ulong)UnitsPerSecond;
+            ulong fraction = units % (ulong)UnitsPerSecond;
+            long ticks = (long)((UInt128)fraction * TimeSpan.TicksPerSecond / (ulong)UnitsPerSecond);
+
+            return FromUnixTime((Int128)seconds + OffsetSeconds, ticks);
+        }
+    }
+}
+
+/// <summary>
+/// A captured packet, starting with the link-layer header.
+/// </summary>
+internal readonly record struct PcapPacket(int LinkType, DateTimeOffset Timestamp, ReadOnlyMemory<byte> Data);
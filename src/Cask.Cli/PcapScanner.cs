@@ -0,0 +1,404 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers;
+using System.Diagnostics;
+using System.Threading.Channels;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// Scans the TCP streams and UDP datagrams of pcap and pcapng captures for
+/// keys.
+/// </summary>
+/// <remarks>
+/// A capture is read sequentially by a single thread, which only decodes
+/// packet headers and hands each payload to one of several shards by a hash
+/// of its flow. Each shard owns the flows hashed to it, so TCP streams are
+/// reassembled and scanned in parallel without locks, and the reader only
+/// waits for the shards when they fall behind. Memory is bounded by the
+/// capacity of the shard queues, the data held per stream for reordering
+/// (see <see cref="TcpStream"/>), and the number of flows tracked per shard,
+/// beyond which the least recently active flows are ended early.
+/// </remarks>
+internal sealed class PcapScanner
+{
+    private const int BatchSize = 256;
+    private const int BatchesPerShard = 16;
+    private const int MaxFlows = 64 * 1024;
+    private const int ReadBufferSize = 1024 * 1024;
+
+    private readonly int _shardCount;
+    private readonly int _maxFlowsPerShard;
+    private readonly TokenBucket? _byteRate;
+
+    private long _captures;
+    private long _captureBytes;
+    private long _packets;
+    private long _skippedPackets;
+    private long _payloadBytes;
+    private long _streams;
+    private long _gaps;
+    private long _matchCount;
+    private long _errorCount;
+    private long _throttledTicks;
+
+    /// <param name="shards">
+    /// The number of threads that reassemble and scan flows, or zero to use
+    /// one per CPU available to the process.
+    /// </param>
+    /// <param name="byteRate">Limits the capture bytes read per second, if not null.</param>
+    public PcapScanner(int shards, TokenBucket? byteRate)
+    {
+        _shardCount = shards > 0
+            ? shards
+            : Math.Max(1, (int)Math.Ceiling(CGroupLimits.Read().CpuLimit ?? Environment.ProcessorCount));
+
+        _maxFlowsPerShard = Math.Max(1, MaxFlows / _shardCount);
+        _byteRate = byteRate;
+    }
+
+    /// <summary>
+    /// Scans the given captures one after another and calls <paramref
+    /// name="onMatch"/>, from any thread, as soon as each key is found.
+    /// </summary>
+    public async Task<PcapSummary> RunAsync(IEnumerable<string> captures,
+                                            Action<string, PcapFinding> onMatch,
+                                            Action<string, Exception> onError,
+                                            CancellationToken cancellationToken)
+    {
+        var stopwatch = Stopwatch.StartNew();
+
+        foreach (string path in captures)
+        {
+            try
+            {
+                await ScanCaptureAsync(path, onMatch, cancellationToken).ConfigureAwait(false);
+                _captures++;
+            }
+            catch (Exception e) when (e is IOException or UnauthorizedAccessException or InvalidDataException)
+            {
+                // Findings before a truncated or corrupt record have already
+                // been reported.
+                _errorCount++;
+                onError(path, e);
+            }
+        }
+
+        return new PcapSummary(_captures,
+                               _captureBytes,
+                               _packets,
+                               _skippedPackets,
+                               _payloadBytes,
+                               Interlocked.Read(ref _streams),
+                               Interlocked.Read(ref _gaps),
+                               Interlocked.Read(ref _matchCount),
+                               _errorCount,
+                               stopwatch.Elapsed,
+                               TimeSpan.FromTicks(_throttledTicks));
+    }
+
+    private async Task ScanCaptureAsync(string path, Action<string, PcapFinding> onMatch, CancellationToken cancellationToken)
+    {
+        var shards = new Shard[_shardCount];
+        var shardTasks = new Task[_shardCount];
+
+        // Cancelled when a shard fails, so that the reader stops waiting for
+        // room in a queue that is no longer drained.
+        using var shardFailed = CancellationTokenSource.CreateLinkedTokenSource(cancellationToken);
+
+        for (int i = 0; i < shards.Length; i++)
+        {
+            Shard shard = shards[i] = new Shard();
+            shardTasks[i] = Task.Run(() => ProcessAsync(path, shard.Queue.Reader, onMatch, shardFailed, cancellationToken), cancellationToken);
+        }
+
+        try
+        {
+            await ReadAsync(path, shards, shardFailed.Token).ConfigureAwait(false);
+        }
+        finally
+        {
+            foreach (Shard shard in shards)
+            {
+                shard.Queue.Writer.TryComplete();
+            }
+
+            try
+            {
+                // Throws the exception of a failed shard in place of the
+                // cancellation it caused in the reader.
+                await Task.WhenAll(shardTasks).ConfigureAwait(false);
+            }
+            finally
+            {
+                foreach (Shard shard in shards)
+                {
+                    shard.ReturnPayloads();
+                }
+            }
+        }
+    }
+
+    private async Task ReadAsync(string path, Shard[] shards, CancellationToken cancellationToken)
+    {
+        using var stream = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.ReadWrite | FileShare.Delete, ReadBufferSize, FileOptions.SequentialScan);
+        var reader = new PcapReader(stream);
+        long charged = 0;
+
+        try
+        {
+            while (reader.TryReadPacket(out PcapPacket packet))
+            {
+                _packets++;
+
+                if (!PacketDecoder.TryDecode(packet, out PacketSegment segment))
+                {
+                    _skippedPackets++;
+                    continue;
+                }
+
+                // Pure acknowledgements carry nothing to scan or track.
+                if (segment.Payload.IsEmpty && segment.Flags == TcpFlags.None)
+                {
+                    continue;
+                }
+
+                _payloadBytes += segment.Payload.Length;
+
+                // The reader reuses its buffer for the next packet, so the
+                // payload is copied for the shard, which returns it.
+                byte[] payload = segment.Payload.IsEmpty ? [] : ArrayPool<byte>.Shared.Rent(segment.Payload.Length);
+                segment.Payload.Span.CopyTo(payload);
+
+                Shard shard = shards[(int)(unchecked((uint)segment.Flow.GetHashCode()) % (uint)shards.Length)];
+                shard.Batch.Add(new QueuedSegment(segment.Flow, segment.Sequence, segment.Flags, packet.Timestamp, payload, segment.Payload.Length));
+
+                if (shard.Batch.Count == BatchSize)
+                {
+                    await shard.FlushAsync(cancellationToken).ConfigureAwait(false);
+                }
+
+                if (_byteRate != null && stream.Position - charged >= ReadBufferSize)
+                {
+                    TimeSpan wait = _byteRate.Take(stream.Position - charged);
+                    charged = stream.Position;
+
+                    if (wait > TimeSpan.Zero)
+                    {
+                        _throttledTicks += wait.Ticks;
+                        await Task.Delay(wait, cancellationToken).ConfigureAwait(false);
+                    }
+                }
+            }
+        }
+        finally
+        {
+            _captureBytes += stream.Position;
+
+            // Also scan what was read before a corrupt or truncated record.
+            if (!cancellationToken.IsCancellationRequested)
+            {
+                foreach (Shard shard in shards)
+                {
+                    await shard.FlushAsync(cancellationToken).ConfigureAwait(false);
+                }
+            }
+        }
+    }
+
+    private async Task ProcessAsync(string path,
+                                    ChannelReader<List<QueuedSegment>> queue,
+                                    Action<string, PcapFinding> onMatch,
+                                    CancellationTokenSource shardFailed,
+                                    CancellationToken cancellationToken)
+    {
+        var flows = new Dictionary<FlowKey, TcpStream>();
+        var found = new List<(long Offset, CaskKey Key, bool IsLikelyPlaceholder)>();
+        var datagramMatches = new List<CaskMatch>();
+        long activity = 0;
+
+        try
+        {
+            await foreach (List<QueuedSegment> batch in queue.ReadAllAsync(cancellationToken).ConfigureAwait(false))
+            {
+                try
+                {
+                    foreach (QueuedSegment segment in batch)
+                    {
+                        Process(path, segment, flows, found, datagramMatches, ref activity, onMatch);
+                    }
+                }
+                finally
+                {
+                    ReturnPayloads(batch);
+                }
+            }
+
+            // Streams still open at the end of the capture end with it.
+            foreach ((FlowKey flow, TcpStream stream) in flows)
+            {
+                End(path, flow, stream, found, onMatch);
+            }
+        }
+        catch
+        {
+            await shardFailed.CancelAsync().ConfigureAwait(false);
+            throw;
+        }
+    }
+
+    private void Process(string path,
+                         QueuedSegment segment,
+                         Dictionary<FlowKey, TcpStream> flows,
+                         List<(long Offset, CaskKey Key, bool IsLikelyPlaceholder)> found,
+                         List<CaskMatch> datagramMatches,
+                         ref long activity,
+                         Action<string, PcapFinding> onMatch)
+    {
+        ReadOnlySpan<byte> payload = segment.Payload.AsSpan(0, segment.Length);
+
+        if (segment.Flow.IsUdp)
+        {
+            datagramMatches.Clear();
+            CaskScanner.ScanUtf8(payload, datagramMatches);
+
+            foreach (CaskMatch match in datagramMatches)
+            {
+                Report(path, segment.Flow, segment.Timestamp, match.Offset, match.Key, match.IsLikelyPlaceholder, onMatch);
+            }
+
+            return;
+        }
+
+        if (!flows.TryGetValue(segment.Flow, out TcpStream? stream))
+        {
+            if (flows.Count >= _maxFlowsPerShard)
+            {
+                Evict(path, flows, found, onMatch);
+            }
+
+            stream = new TcpStream();
+            flows.Add(segment.Flow, stream);
+            Interlocked.Increment(ref _streams);
+        }
+
+        stream.LastActivity = ++activity;
+        stream.LastTimestamp = segment.Timestamp;
+
+        found.Clear();
+        stream.Add(segment.Sequence, segment.Flags, payload, found);
+
+        foreach ((long offset, CaskKey key, bool isLikelyPlaceholder) in found)
+        {
+            Report(path, segment.Flow, segment.Timestamp, offset, key, isLikelyPlaceholder, onMatch);
+        }
+    }
+
+    /// <summary>
+    /// Ends and forgets the least recently active quarter of the flows.
+    /// </summary>
+    private void Evict(string path, Dictionary<FlowKey, TcpStream> flows, List<(long Offset, CaskKey Key, bool IsLikelyPlaceholder)> found, Action<string, PcapFinding> onMatch)
+    {
+        KeyValuePair<FlowKey, TcpStream>[] oldest = [.. flows.OrderBy(flow => flow.Value.LastActivity).Take(Math.Max(1, flows.Count / 4))];
+
+        foreach ((FlowKey flow, TcpStream stream) in oldest)
+        {
+            End(path, flow, stream, found, onMatch);
+            flows.Remove(flow);
+        }
+    }
+
+    private void End(string path, FlowKey flow, TcpStream stream, List<(long Offset, CaskKey Key, bool IsLikelyPlaceholder)> found, Action<string, PcapFinding> onMatch)
+    {
+        found.Clear();
+        stream.Close(found);
+        Interlocked.Add(ref _gaps, stream.Gaps);
+
+        foreach ((long offset, CaskKey key, bool isLikelyPlaceholder) in found)
+        {
+            Report(path, flow, stream.LastTimestamp, offset, key, isLikelyPlaceholder, onMatch);
+        }
+    }
+
+    private void Report(string path, FlowKey flow, DateTimeOffset timestamp, long offset, CaskKey key, bool isLikelyPlaceholder, Action<string, PcapFinding> onMatch)
+    {
+        Interlocked.Increment(ref _matchCount);
+        onMatch(path, new PcapFinding(flow, timestamp, offset, key, isLikelyPlaceholder));
+    }
+
+    private static void ReturnPayloads(List<QueuedSegment> batch)
+    {
+        foreach (QueuedSegment segment in batch)
+        {
+            if (segment.Length > 0)
+            {
+                ArrayPool<byte>.Shared.Return(segment.Payload);
+            }
+        }
+
+        batch.Clear();
+    }
+
+    /// <summary>
+    /// A key found in a capture.
+    /// </summary>
+    /// <param name="Flow">The flow in which the key was found.</param>
+    /// <param name="Timestamp">The time of the packet that completed the key.</param>
+    /// <param name="Offset">The offset of the key in the TCP stream or UDP datagram.</param>
+    /// <param name="Key">The key.</param>
+    /// <param name="IsLikelyPlaceholder">Whether the key is likely a placeholder, as for <see cref="CaskMatch.IsLikelyPlaceholder"/>.</param>
+    internal readonly record struct PcapFinding(FlowKey Flow, DateTimeOffset Timestamp, long Offset, CaskKey Key, bool IsLikelyPlaceholder);
+
+    internal sealed record PcapSummary(long Captures,
+                                       long CaptureBytes,
+                                       long Packets,
+                                       long SkippedPackets,
+                                       long PayloadBytes,
+                                       long Streams,
+                                       long Gaps,
+                                       long Matches,
+                                       long Errors,
+                                       TimeSpan Elapsed,
+                                       TimeSpan ThrottledTime);
+
+    private readonly record struct QueuedSegment(FlowKey Flow, uint Sequence, TcpFlags Flags, DateTimeOffset Timestamp, byte[] Payload, int Length);
+
+    /// <summary>
+    /// The queue of a shard and the batch of segments the reader is filling
+    /// for it. Segments are queued in batches to keep synchronization off the
+    /// per-packet path.
+    /// </summary>
+    private sealed class Shard
+    {
+        public Channel<List<QueuedSegment>> Queue { get; } =
+            Channel.CreateBounded<List<QueuedSegment>>(new BoundedChannelOptions(BatchesPerShard) { SingleReader = true, SingleWriter = true });
+
+        public List<QueuedSegment> Batch { get; private set; } = new(BatchSize);
+
+        public async ValueTask FlushAsync(CancellationToken cancellationToken)
+        {
+            if (Batch.Count == 0)
+            {
+                return;
+            }
+
+            await Queue.Writer.WriteAsync(Batch, cancellationToken).ConfigureAwait(false);
+            Batch = new(BatchSize);
+        }
+
+        /// <summary>
+        /// Returns the payloads of the segments that were not processed
+        /// because the capture was cancelled or a shard failed.
+        /// </summary>
+        public void ReturnPayloads()
+        {
+            while (Queue.Reader.TryRead(out List<QueuedSegment>? batch))
+            {
+                PcapScanner.ReturnPayloads(batch);
+            }
+
+            PcapScanner.ReturnPayloads(Batch);
+        }
+    }
+}
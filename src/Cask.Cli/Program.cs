@@ -17,11 +17,17 @@ internal static class Program
         {
             return Parser.Default.ParseArguments<
                 GenerateOptions,
-                ValidateOptions
+                ValidateOptions,
+                BenchOptions,
+                ScanOptions,
+                ServeOptions
                 >(args)
               .MapResult(
                 (GenerateOptions options) => GenerateCommand.Run(options),
                 (ValidateOptions options) => ValidateCommand.Run(options),
+                (BenchOptions options) => BenchCommand.Run(options),
+                (ScanOptions options) => ScanCommand.Run(options),
+                (ServeOptions options) => ServeCommand.Run(options),
                 _ => 1);
         }
         catch (Exception e)
@@ -0,0 +1,171 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics.CodeAnalysis;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// A pool of read buffers bounded by a total number of bytes that can be
+/// changed while buffers are rented. Every read needs a buffer, so the budget
+/// also bounds the number of reads in flight.
+/// </summary>
+/// <remarks>
+/// Unlike <see cref="System.Buffers.ArrayPool{T}"/>, buffers that are
+/// returned after the budget or buffer size shrinks are dropped rather than
+/// kept, so memory is given back to the GC under pressure.
+/// </remarks>
+internal sealed class ScanBufferPool
+{
+    private readonly object _lock = new();
+    private readonly Stack<byte[]> _free = new();
+    private readonly Queue<TaskCompletionSource> _waiters = new();
+    private long _budgetBytes;
+    private long _rentedBytes;
+    private int _rentedCount;
+    private int _bufferSize;
+
+    public ScanBufferPool(long budgetBytes, int bufferSize)
+    {
+        _budgetBytes = budgetBytes;
+        _bufferSize = bufferSize;
+    }
+
+    public long BudgetBytes
+    {
+        get { lock (_lock) { return _budgetBytes; } }
+    }
+
+    public int BufferSize
+    {
+        get { lock (_lock) { return _bufferSize; } }
+    }
+
+    public int RentedCount
+    {
+        get { lock (_lock) { return _rentedCount; } }
+    }
+
+    /// <summary>
+    /// Rents a buffer, waiting for one to be returned if the budget is used
+    /// up. A buffer is always available when none are rented, so progress is
+    /// made even if the budget is smaller than a single buffer.
+    /// </summary>
+    public async ValueTask<byte[]> RentAsync(CancellationToken cancellationToken)
+    {
+        while (true)
+        {
+            TaskCompletionSource waiter;
+
+            lock (_lock)
+            {
+                if (TryRentCore(out byte[]? buffer))
+                {
+                    return buffer;
+                }
+
+                waiter = new TaskCompletionSource(TaskCreationOptions.RunContinuationsAsynchronously);
+                _waiters.Enqueue(waiter);
+            }
+
+            // A cancelled waiter is left in the queue but can no longer be
+            // completed, so a return passes over it to the next one.
+            using (cancellationToken.Register(static (state, token) => ((TaskCompletionSource)state!).TrySetCanceled(token), waiter))
+            {
+                await waiter.Task.ConfigureAwait(false);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Rents a buffer only if it fits within the budget. Used for optional
+    /// read-ahead.
+    /// </summary>
+    public bool TryRent([NotNullWhen(true)] out byte[]? buffer)
+    {
+        lock (_lock)
+        {
+            return TryRentCore(out buffer);
+        }
+    }
+
+    public void Return(byte[] buffer)
+    {
+        lock (_lock)
+        {
+            _rentedBytes -= buffer.Length;
+            _rentedCount--;
+
+            if (buffer.Length == _bufferSize && _rentedBytes + (_free.Count + 1) * (long)_bufferSize <= _budgetBytes)
+            {
+                _free.Push(buffer);
+            }
+        }
+
+        // Wake the first waiter that is still waiting.
+        while (true)
+        {
+            TaskCompletionSource? waiter;
+
+            lock (_lock)
+            {
+                if (!_waiters.TryDequeue(out waiter))
+                {
+                    return;
+                }
+            }
+
+            if (waiter.TrySetResult())
+            {
+                return;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Changes the budget and size of buffers rented from now on. Free buffers
+    /// that no longer fit are dropped.
+    /// </summary>
+    public void Resize(long budgetBytes, int bufferSize)
+    {
+        TaskCompletionSource[] waiters;
+
+        lock (_lock)
+        {
+            _budgetBytes = budgetBytes;
+
+            if (bufferSize != _bufferSize)
+            {
+                _bufferSize = bufferSize;
+                _free.Clear();
+            }
+
+            while (_free.Count > 0 && _rentedBytes + _free.Count * (long)_bufferSize > _budgetBytes)
+            {
+                _free.Pop();
+            }
+
+            waiters = [.. _waiters];
+            _waiters.Clear();
+        }
+
+        foreach (TaskCompletionSource waiter in waiters)
+        {
+            waiter.TrySetResult();
+        }
+    }
+
+    private bool TryRentCore([NotNullWhen(true)] out byte[]? buffer)
+    {
+        if (_rentedBytes > 0 && _rentedBytes + _bufferSize > _budgetBytes)
+        {
+            buffer = null;
+            return false;
+        }
+
+        buffer = _free.TryPop(out byte[]? free) ? free : new byte[_bufferSize];
+        _rentedBytes += buffer.Length;
+        _rentedCount++;
+        return true;
+    }
+}
@@ -0,0 +1,218 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Globalization;
+using System.IO.Enumeration;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+internal static class ScanCommand
+{
+    private static readonly EnumerationOptions s_enumerationOptions = new()
+    {
+        RecurseSubdirectories = true,
+        IgnoreInaccessible = true,
+
+        // Include hidden files such as .env, but don't follow links out of
+        // the tree or into cycles.
+        AttributesToSkip = FileAttributes.ReparsePoint,
+    };
+
+    internal static int Run(ScanOptions options)
+    {
+        if (options.Threads < 0 || options.MaxMemory < 0 || options.MaxReadRate < 0 || options.MaxFileRate < 0)
+        {
+            Console.Error.WriteLine("--threads, --max-memory, --max-read-rate and --max-file-rate must not be negative.");
+            return 1;
+        }
+
+        if (options.Pcap && options.Images)
+        {
+            Console.Error.WriteLine("--pcap and --images cannot be combined.");
+            return 1;
+        }
+
+        if (options.Prioritize && (options.Pcap || options.Images))
+        {
+            Console.Error.WriteLine("--prioritize cannot be combined with --pcap or --images.");
+            return 1;
+        }
+
+        // A capture is read as one file and the files of an image are read
+        // from its layers, so there are no file opens to limit.
+        if (options.MaxFileRate > 0 && (options.Pcap || options.Images))
+        {
+            Console.Error.WriteLine("--max-file-rate cannot be combined with --pcap or --images.");
+            return 1;
+        }
+
+        if (options.Idle && IdlePriority.Enter() is string warning)
+        {
+            Console.Error.WriteLine(warning);
+        }
+
+        // Allow bursts of a tenth of a second so that reads and opens from
+        // several workers need not be strictly interleaved, but at least one
+        // full read so that a single large read doesn't always wait.
+        double bytesPerSecond = options.MaxReadRate * 1_000_000;
+        TokenBucket? byteRate = bytesPerSecond > 0 ? new TokenBucket(bytesPerSecond, Math.Max(bytesPerSecond / 10, 1024 * 1024)) : null;
+        TokenBucket? fileRate = options.MaxFileRate > 0 ? new TokenBucket(options.MaxFileRate, Math.Max(options.MaxFileRate / 10, 1)) : null;
+
+        if (options.Pcap)
+        {
+            return RunPcap(options, byteRate);
+        }
+
+        if (options.Images)
+        {
+            return RunImages(options, byteRate);
+        }
+
+        var scheduler = new ScanScheduler(options.Threads,
+                                          options.MaxMemory * 1024L * 1024,
+                                          byteRate,
+                                          fileRate,
+                                          options.Verbose ? message => Console.Error.WriteLine(message) : null);
+
+        using var output = new FindingWriter(options.Json);
+
+        Action<string, Exception> onError = (path, e) => Console.Error.WriteLine($"{path}: {e.Message}");
+
+        ScanScheduler.ScanSummary summary = (options.Prioritize
+            ? scheduler.RunAsync(EnumerateFilesWithPriority(options.Paths, DateTime.UtcNow), output.Write, onError, CancellationToken.None)
+            : scheduler.RunAsync(EnumerateFiles(options.Paths), output.Write, onError, CancellationToken.None)).GetAwaiter().GetResult();
+
+        double seconds = summary.Elapsed.TotalSeconds;
+        Console.Error.WriteLine(string.Create(CultureInfo.InvariantCulture,
+            $"Scanned {summary.Files:N0} files ({summary.Bytes / 1_000_000.0:N1} MB) in {seconds:N2} s ({summary.Bytes / 1_000_000.0 / seconds:N1} MB/s): " +
+            $"{summary.Matches:N0} keys found, {summary.Errors:N0} errors."));
+
+        if (options.Verbose)
+        {
+            Console.Error.WriteLine(string.Create(CultureInfo.InvariantCulture,
+                $"Final workers: {summary.Workers}. Peak reads in flight: {summary.PeakReadsInFlight}. Time waiting on rate limits: {summary.ThrottledTime.TotalSeconds:N2} s. " +
+                $"Time to first key: {(summary.TimeToFirstMatch is TimeSpan first ? $"{first.TotalSeconds:N2} s" : "none found")}."));
+        }
+
+        return 0;
+    }
+
+    private static int RunPcap(ScanOptions options, TokenBucket? byteRate)
+    {
+        var scanner = new PcapScanner(options.Threads, byteRate);
+
+        using var output = new FindingWriter(options.Json);
+
+        PcapScanner.PcapSummary summary = scanner.RunAsync(
+            EnumerateFiles(options.Paths),
+            (path, finding) => output.Write(path,
+                                            finding.Offset,
+                                            finding.Key,
+                                            finding.IsLikelyPlaceholder,
+                                            ("protocol", finding.Flow.Protocol),
+                                            ("source", finding.Flow.SourceEndPoint),
+                                            ("destination", finding.Flow.DestinationEndPoint),
+                                            ("time", finding.Timestamp.ToString("O", CultureInfo.InvariantCulture))),
+            (path, e) => Console.Error.WriteLine($"{path}: {e.Message}"),
+            CancellationToken.None).GetAwaiter().GetResult();
+
+        double seconds = summary.Elapsed.TotalSeconds;
+        Console.Error.WriteLine(string.Create(CultureInfo.InvariantCulture,
+            $"Scanned {summary.Captures:N0} captures ({summary.CaptureBytes / 1_000_000.0:N1} MB) in {seconds:N2} s ({summary.CaptureBytes / 1_000_000.0 / seconds:N1} MB/s): " +
+            $"{summary.Matches:N0} keys found, {summary.Errors:N0} errors."));
+
+        if (options.Verbose)
+        {
+            Console.Error.WriteLine(string.Create(CultureInfo.InvariantCulture,
+                $"Packets: {summary.Packets:N0}, {summary.SkippedPackets:N0} not TCP or UDP. Payload: {summary.PayloadBytes / 1_000_000.0:N1} MB in {summary.Streams:N0} TCP streams with {summary.Gaps:N0} gaps. " +
+                $"Time waiting on rate limits: {summary.ThrottledTime.TotalSeconds:N2} s."));
+        }
+
+        return 0;
+    }
+
+    private static int RunImages(ScanOptions options, TokenBucket? byteRate)
+    {
+        var scanner = new ImageScanner(options.Threads, byteRate);
+
+        using var output = new FindingWriter(options.Json);
+
+        ImageScanner.ImageSummary summary = scanner.RunAsync(
+            options.Paths,
+            finding => output.Write(finding.Path,
+                                    finding.Offset,
+                                    finding.Key,
+                                    finding.IsLikelyPlaceholder,
+                                    ("image", finding.Image),
+                                    ("source", finding.Source),
+                                    ("layer", finding.Layer)),
+            (path, e) => Console.Error.WriteLine($"{path}: {e.Message}"),
+            CancellationToken.None).GetAwaiter().GetResult();
+
+        double seconds = summary.Elapsed.TotalSeconds;
+        Console.Error.WriteLine(string.Create(CultureInfo.InvariantCulture,
+            $"Scanned {summary.Images:N0} images with {summary.UniqueLayers:N0} distinct layers ({summary.Bytes / 1_000_000.0:N1} MB) in {seconds:N2} s ({summary.Bytes / 1_000_000.0 / seconds:N1} MB/s): " +
+            $"{summary.Matches:N0} keys found, {summary.Errors:N0} errors."));
+
+        if (options.Verbose)
+        {
+            Console.Error.WriteLine(string.Create(CultureInfo.InvariantCulture,
+                $"Layers: {summary.LayerReferences:N0} referenced, {summary.LayerReferences - summary.UniqueLayers:N0} not rescanned. Files: {summary.Files:N0}. " +
+                $"Time waiting on rate limits: {summary.ThrottledTime.TotalSeconds:N2} s."));
+        }
+
+        return 0;
+    }
+
+    private static IEnumerable<string> EnumerateFiles(IEnumerable<string> paths)
+    {
+        foreach (string path in paths)
+        {
+            if (!Directory.Exists(path))
+            {
+                // Files, and paths that don't exist, which are reported when
+                // they fail to open.
+                yield return path;
+                continue;
+            }
+
+            foreach (string file in Directory.EnumerateFiles(path, "*", s_enumerationOptions))
+            {
+                yield return file;
+            }
+        }
+    }
+
+    private static IEnumerable<(string Path, ScanPriority Priority)> EnumerateFilesWithPriority(IEnumerable<string> paths, DateTime nowUtc)
+    {
+        foreach (string path in paths)
+        {
+            if (!Directory.Exists(path))
+            {
+                // Paths that don't exist have a last write time in 1601 and
+                // are reported when they fail to open.
+                yield return (path, ScanPriority.Get(path, File.GetLastWriteTimeUtc(path), nowUtc));
+                continue;
+            }
+
+            // The last write time comes from the enumeration, without opening
+            // each file again.
+            var files = new FileSystemEnumerable<(string, ScanPriority)>(
+                path,
+                (ref FileSystemEntry entry) =>
+                {
+                    string file = entry.ToSpecifiedFullPath();
+                    return (file, ScanPriority.Get(file, entry.LastWriteTimeUtc.UtcDateTime, nowUtc));
+                },
+                s_enumerationOptions)
+            {
+                ShouldIncludePredicate = (ref FileSystemEntry entry) => !entry.IsDirectory,
+            };
+
+            foreach ((string, ScanPriority) file in files)
+            {
+                yield return file;
+            }
+        }
+    }
+}
@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#nullable disable
+
+using System.Diagnostics.CodeAnalysis;
+
+using CommandLine;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+[Verb("scan", HelpText = "Scan files and directories for common annotated security keys.")]
+[SuppressMessage("Design", "CA1812:Avoid uninstantiated internal classes", Justification = "Instantiated by CommandLineParser.")]
+internal sealed class ScanOptions
+{
+    [Value(
+        0,
+        MetaName = "paths",
+        Required = true,
+        HelpText = "The files and directories to scan. Directories are scanned recursively.")]
+    public IEnumerable<string> Paths { get; set; }
+
+    [Option(
+        "pcap",
+        Required = false,
+        HelpText = "Treat the files as pcap or pcapng network captures, and scan reassembled TCP streams and UDP datagrams instead of the raw files.")]
+    public bool Pcap { get; set; }
+
+    [Option(
+        "images",
+        Required = false,
+        HelpText = "Treat the paths as OCI image layouts, docker save archives, or directories containing them, and scan the files in each distinct image layer once.")]
+    public bool Images { get; set; }
+
+    [Option(
+        "prioritize",
+        Required = false,
+        HelpText = "Scan the files most likely to contain leaked keys first: files modified in the last 24 hours, then configuration, environment, credential and log files, then the rest, newest first within each group. Cannot be combined with --pcap or --images.")]
+    public bool Prioritize { get; set; }
+
+    [Option(
+        "threads",
+        Required = false,
+        Default = 0,
+        HelpText = "A fixed number of scan workers. By default, the number of workers adapts to the measured throughput within the CPU limit. With --pcap or --images, the number of threads that reassemble flows or scan layers, one per CPU by default.")]
+    public int Threads { get; set; }
+
+    [Option(
+        "max-memory",
+        Required = false,
+        Default = 0,
+        HelpText = "The maximum number of megabytes to use for read buffers. By default, this is derived from the memory limit.")]
+    public int MaxMemory { get; set; }
+
+    [Option(
+        "max-read-rate",
+        Required = false,
+        Default = 0.0,
+        HelpText = "The maximum number of megabytes to read per second across all workers. By default, reads are not limited.")]
+    public double MaxReadRate { get; set; }
+
+    [Option(
+        "max-file-rate",
+        Required = false,
+        Default = 0.0,
+        HelpText = "The maximum number of files to open per second across all workers. Cannot be combined with --pcap or --images. By default, files are not limited.")]
+    public double MaxFileRate { get; set; }
+
+    [Option(
+        "idle",
+        Required = false,
+        HelpText = "Run at idle CPU and I/O priority so that the scan only uses resources that other workloads leave unused.")]
+    public bool Idle { get; set; }
+
+    [Option(
+        "json",
+        Required = false,
+        HelpText = "Write each finding as a line of JSON instead of text.")]
+    public bool Json { get; set; }
+
+    [Option(
+        "verbose",
+        Required = false,
+        HelpText = "Report resource limits and how the scan adapts to them.")]
+    public bool Verbose { get; set; }
+}
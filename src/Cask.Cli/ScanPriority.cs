@@ -0,0 +1,94 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// The order in which a prioritized scan visits files: files modified
+/// recently, then files whose names or directories suggest configuration,
+/// environment variables, credentials or logs, then the rest. Within each
+/// tier, more recently modified files come first.
+/// </summary>
+/// <remarks>
+/// These are heuristics for finding leaked keys as early as possible during
+/// an incident. They only change the order of the scan, not what is scanned.
+/// </remarks>
+internal readonly record struct ScanPriority(int Tier, long LastWriteTicks)
+{
+    private const int RecentTier = 0;
+    private const int RiskyTier = 1;
+    private const int OtherTier = 2;
+
+    private static readonly HashSet<string> s_riskyExtensions = new(StringComparer.OrdinalIgnoreCase)
+    {
+        ".env", ".json", ".yaml", ".yml", ".toml", ".ini", ".conf", ".config", ".cfg", ".cnf",
+        ".properties", ".xml", ".settings", ".pubxml", ".publishsettings", ".tfvars", ".tfstate",
+        ".log", ".out", ".history",
+    };
+
+    private static readonly HashSet<string> s_riskyFileNames = new(StringComparer.OrdinalIgnoreCase)
+    {
+        ".env", ".npmrc", ".pypirc", ".netrc", ".git-credentials", ".dockercfg", ".bash_history",
+        ".zsh_history", "credentials", "secrets", "nuget.config",
+    };
+
+    private static readonly HashSet<string> s_riskyDirectoryNames = new(StringComparer.OrdinalIgnoreCase)
+    {
+        ".aws", ".azure", ".config", ".docker", ".kube", "config", "configs", "secrets", "log", "logs",
+    };
+
+    /// <summary>
+    /// Files modified more recently than this are in the first tier.
+    /// </summary>
+    public static TimeSpan RecentWindow { get; } = TimeSpan.FromHours(24);
+
+    /// <summary>
+    /// Orders higher priorities first.
+    /// </summary>
+    public static IComparer<ScanPriority> Comparer { get; } = Comparer<ScanPriority>.Create(static (x, y) =>
+    {
+        int result = x.Tier.CompareTo(y.Tier);
+        return result != 0 ? result : y.LastWriteTicks.CompareTo(x.LastWriteTicks);
+    });
+
+    /// <summary>
+    /// Gets the priority of a file.
+    /// </summary>
+    /// <param name="path">The path of the file.</param>
+    /// <param name="lastWriteTimeUtc">When the file was last modified.</param>
+    /// <param name="nowUtc">The current time.</param>
+    public static ScanPriority Get(string path, DateTime lastWriteTimeUtc, DateTime nowUtc)
+    {
+        int tier = nowUtc - lastWriteTimeUtc <= RecentWindow ? RecentTier
+                 : IsRisky(path) ? RiskyTier
+                 : OtherTier;
+
+        return new ScanPriority(tier, lastWriteTimeUtc.Ticks);
+    }
+
+    private static bool IsRisky(string path)
+    {
+        string fileName = Path.GetFileName(path);
+
+        if (s_riskyFileNames.Contains(fileName) ||
+            s_riskyExtensions.Contains(Path.GetExtension(fileName)) ||
+            fileName.StartsWith(".env.", StringComparison.OrdinalIgnoreCase) ||
+            fileName.StartsWith("appsettings", StringComparison.OrdinalIgnoreCase))
+        {
+            return true;
+        }
+
+        ReadOnlySpan<char> directory = Path.GetDirectoryName(path.AsSpan());
+        while (!directory.IsEmpty)
+        {
+            if (s_riskyDirectoryNames.Contains(Path.GetFileName(directory).ToString()))
+            {
+                return true;
+            }
+
+            directory = Path.GetDirectoryName(directory);
+        }
+
+        return false;
+    }
+}
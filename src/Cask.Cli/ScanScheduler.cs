@@ -0,0 +1,498 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics;
+using System.Threading.Channels;
+
+using Microsoft.Win32.SafeHandles;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// Scans files in parallel while adapting to the CPU and memory available to
+/// the process.
+/// </summary>
+/// <remarks>
+/// At startup, the CPU and memory limits of the cgroup are read to choose the
+/// maximum number of workers and the memory budget for read buffers. While
+/// scanning, the number of active workers is tuned by <see
+/// cref="AimdController"/> on measured bytes per second, and the buffer
+/// budget, which also bounds the number of reads in flight, is halved under
+/// memory pressure and grown back slowly when the pressure is relieved. This
+/// keeps a scan in a container from being throttled or OOM-killed without
+/// hand-tuning for each host.
+///
+/// Optional token buckets cap bytes read and files opened per second across
+/// all workers, for scans that must not compete with co-located workloads
+/// for disk bandwidth regardless of how much is available.
+///
+/// Files are scanned either in the order given or, for incident response,
+/// in <see cref="ScanPriority"/> order through a <see cref="ScanWorkQueue"/>
+/// so that the most likely leaks are found first at the same throughput.
+/// </remarks>
+internal sealed class ScanScheduler
+{
+    private const int MinBufferSize = 64 * 1024;
+    private const int MaxBufferSize = 1024 * 1024;
+    private const long MinBudgetBytes = 4 * MinBufferSize;
+    private const long MaxBudgetBytes = 256 * 1024 * 1024;
+    private const double HighMemoryPressure = 0.85;
+    private const double LowMemoryPressure = 0.70;
+
+    private static readonly TimeSpan s_adjustInterval = TimeSpan.FromMilliseconds(500);
+
+    private readonly CGroupLimits _limits;
+    private readonly AimdController? _controller;
+    private readonly ScanBufferPool _pool;
+    private readonly int _maxWorkers;
+    private readonly long _initialBudgetBytes;
+    private readonly TokenBucket? _byteRate;
+    private readonly TokenBucket? _fileRate;
+    private readonly Action<string>? _log;
+    private readonly Stopwatch _stopwatch = new();
+
+    private TaskCompletionSource _workerLimitRaised = new(TaskCreationOptions.RunContinuationsAsynchronously);
+    private int _workerLimit;
+    private int _readsInFlight;
+    private int _peakReadsInFlight;
+    private long _bytesScanned;
+    private long _filesScanned;
+    private long _matchCount;
+    private long _errorCount;
+    private long _throttledTicks;
+    private long _firstMatchTicks;
+
+    /// <param name="workers">
+    /// A fixed number of workers, or zero to adapt the number of workers to
+    /// the measured throughput.
+    /// </param>
+    /// <param name="memoryBudgetBytes">
+    /// The maximum number of bytes of read buffers, or zero to derive it from
+    /// the memory available to the process.
+    /// </param>
+    /// <param name="byteRate">Limits the bytes read per second, if not null.</param>
+    /// <param name="fileRate">Limits the files opened per second, if not null.</param>
+    /// <param name="log">Receives a message whenever the scheduler adapts, if not null.</param>
+    public ScanScheduler(int workers, long memoryBudgetBytes, TokenBucket? byteRate, TokenBucket? fileRate, Action<string>? log)
+    {
+        _limits = CGroupLimits.Read();
+        _byteRate = byteRate;
+        _fileRate = fileRate;
+        _log = log;
+
+        int cpus = Math.Max(1, (int)Math.Ceiling(_limits.CpuLimit ?? Environment.ProcessorCount));
+
+        if (workers > 0)
+        {
+            _maxWorkers = workers;
+            _workerLimit = workers;
+        }
+        else
+        {
+            // More workers than CPUs can help to hide I/O latency, but let
+            // the controller find out whether it does on this host.
+            _maxWorkers = 2 * cpus;
+            _controller = new AimdController(minimum: 1, _maxWorkers, initial: cpus);
+            _workerLimit = _controller.Limit;
+        }
+
+        _initialBudgetBytes = memoryBudgetBytes > 0
+            ? memoryBudgetBytes
+            : Math.Clamp(_limits.GetAvailableMemoryBytes() / 4, MinBudgetBytes, MaxBudgetBytes);
+
+        _pool = new ScanBufferPool(_initialBudgetBytes, GetBufferSize(_initialBudgetBytes));
+
+        _log?.Invoke($"Limits: {(_limits.CpuLimit is double cpuLimit ? $"{cpuLimit:0.##} CPUs" : "no CPU limit")}, " +
+                     $"{(_limits.MemoryLimitBytes is long memoryLimit ? $"{memoryLimit / (1024 * 1024)} MB memory" : "no memory limit")}. " +
+                     $"Workers: {_workerLimit} of {_maxWorkers}. Buffers: {_pool.BufferSize / 1024} KB, {_initialBudgetBytes / (1024 * 1024)} MB budget.");
+    }
+
+    /// <summary>
+    /// Scans the given files in order and calls <paramref name="onMatch"/>,
+    /// from any thread, as soon as each key is found.
+    /// </summary>
+    public Task<ScanSummary> RunAsync(IEnumerable<string> files,
+                                      Action<string, CaskMatch> onMatch,
+                                      Action<string, Exception> onError,
+                                      CancellationToken cancellationToken)
+    {
+        var channel = Channel.CreateBounded<string>(new BoundedChannelOptions(1024) { SingleWriter = true });
+
+        return RunAsync(channel.Reader,
+                        () => ProduceAsync(files, channel.Writer, cancellationToken),
+                        onMatch,
+                        onError,
+                        cancellationToken);
+    }
+
+    /// <summary>
+    /// Scans the given files in <see cref="ScanPriority"/> order and calls
+    /// <paramref name="onMatch"/>, from any thread, as soon as each key is
+    /// found.
+    /// </summary>
+    /// <remarks>
+    /// Files are queued as they are enumerated, without waiting for the
+    /// enumeration to finish, so workers always take the highest priority
+    /// file found so far.
+    /// </remarks>
+    public Task<ScanSummary> RunAsync(IEnumerable<(string Path, ScanPriority Priority)> files,
+                                      Action<string, CaskMatch> onMatch,
+                                      Action<string, Exception> onError,
+                                      CancellationToken cancellationToken)
+    {
+        var queue = new ScanWorkQueue();
+
+        return RunAsync(queue,
+                        () => Produce(files, queue, cancellationToken),
+                        onMatch,
+                        onError,
+                        cancellationToken);
+    }
+
+    private async Task<ScanSummary> RunAsync(ChannelReader<string> files,
+                                             Func<Task> produce,
+                                             Action<string, CaskMatch> onMatch,
+                                             Action<string, Exception> onError,
+                                             CancellationToken cancellationToken)
+    {
+        _stopwatch.Restart();
+
+        Task producer = Task.Run(produce, cancellationToken);
+
+        var workers = new Task[_maxWorkers];
+        for (int i = 0; i < workers.Length; i++)
+        {
+            int index = i;
+            workers[i] = Task.Run(() => WorkAsync(index, files, onMatch, onError, cancellationToken), cancellationToken);
+        }
+
+        Task allWorkers = Task.WhenAll(workers);
+        await AdjustAsync(allWorkers, cancellationToken).ConfigureAwait(false);
+        await allWorkers.ConfigureAwait(false);
+        await producer.ConfigureAwait(false);
+
+        long firstMatchTicks = Interlocked.Read(ref _firstMatchTicks);
+
+        return new ScanSummary(Interlocked.Read(ref _filesScanned),
+                               Interlocked.Read(ref _bytesScanned),
+                               Interlocked.Read(ref _matchCount),
+                               Interlocked.Read(ref _errorCount),
+                               _stopwatch.Elapsed,
+                               Volatile.Read(ref _workerLimit),
+                               Volatile.Read(ref _peakReadsInFlight),
+                               TimeSpan.FromTicks(Interlocked.Read(ref _throttledTicks)),
+                               firstMatchTicks > 0 ? TimeSpan.FromTicks(firstMatchTicks) : null);
+    }
+
+    private static async Task ProduceAsync(IEnumerable<string> files, ChannelWriter<string> writer, CancellationToken cancellationToken)
+    {
+        // Whatever stops the enumeration, the channel is completed so that
+        // workers waiting for files see it rather than wait forever.
+        Exception? error = null;
+
+        try
+        {
+            foreach (string file in files)
+            {
+                await writer.WriteAsync(file, cancellationToken).ConfigureAwait(false);
+            }
+        }
+        catch (Exception e)
+        {
+            error = e;
+            throw;
+        }
+        finally
+        {
+            writer.Complete(error);
+        }
+    }
+
+    private static Task Produce(IEnumerable<(string Path, ScanPriority Priority)> files, ScanWorkQueue queue, CancellationToken cancellationToken)
+    {
+        // As with a channel, the queue is completed however the enumeration
+        // stops.
+        Exception? error = null;
+
+        try
+        {
+            foreach ((string path, ScanPriority priority) in files)
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+                queue.Add(path, priority);
+            }
+        }
+        catch (Exception e)
+        {
+            error = e;
+            throw;
+        }
+        finally
+        {
+            queue.CompleteAdding(error);
+        }
+
+        return Task.CompletedTask;
+    }
+
+    private async Task WorkAsync(int index,
+                                 ChannelReader<string> files,
+                                 Action<string, CaskMatch> onMatch,
+                                 Action<string, Exception> onError,
+                                 CancellationToken cancellationToken)
+    {
+        var scanner = new CaskScanner();
+        var matches = new List<CaskMatch>();
+
+        while (true)
+        {
+            // Park while this worker is beyond the current limit. The signal
+            // is read before the limit so that a raise in between is not lost.
+            while (true)
+            {
+                Task raised = Volatile.Read(ref _workerLimitRaised).Task;
+                if (index < Volatile.Read(ref _workerLimit))
+                {
+                    break;
+                }
+
+                await Task.WhenAny(raised, files.Completion).ConfigureAwait(false);
+                if (files.Completion.IsCompleted)
+                {
+                    return;
+                }
+            }
+
+            if (!await files.WaitToReadAsync(cancellationToken).ConfigureAwait(false))
+            {
+                return;
+            }
+
+            if (!files.TryRead(out string? path))
+            {
+                continue;
+            }
+
+            if (_fileRate != null)
+            {
+                AddThrottledTime(await _fileRate.TakeAsync(1, cancellationToken).ConfigureAwait(false));
+            }
+
+            try
+            {
+                await ScanFileAsync(path, scanner, matches, onMatch, cancellationToken).ConfigureAwait(false);
+                Interlocked.Increment(ref _filesScanned);
+            }
+            catch (Exception e) when (e is IOException or UnauthorizedAccessException)
+            {
+                Interlocked.Increment(ref _errorCount);
+                onError(path, e);
+            }
+        }
+    }
+
+    private async Task ScanFileAsync(string path,
+                                     CaskScanner scanner,
+                                     List<CaskMatch> matches,
+                                     Action<string, CaskMatch> onMatch,
+                                     CancellationToken cancellationToken)
+    {
+        using SafeFileHandle handle = File.OpenHandle(path, FileMode.Open, FileAccess.Read, FileShare.ReadWrite | FileShare.Delete, FileOptions.SequentialScan);
+
+        scanner.Reset();
+        long offset = 0;
+        byte[] buffer = await _pool.RentAsync(cancellationToken).ConfigureAwait(false);
+        byte[]? next = null;
+        Task<int>? nextRead = null;
+
+        try
+        {
+            int read = await ReadAsync(handle, buffer, offset, cancellationToken).ConfigureAwait(false);
+
+            while (read > 0)
+            {
+                offset += read;
+
+                // Read ahead while scanning if the budget allows it.
+                if (_pool.TryRent(out next))
+                {
+                    nextRead = ReadAsync(handle, next, offset, cancellationToken);
+                }
+
+                Scan(path, scanner, buffer.AsSpan(0, read), isFinalBlock: false, matches, onMatch);
+
+                if (nextRead != null)
+                {
+                    _pool.Return(buffer);
+                    (buffer, next) = (next!, null);
+                    read = await nextRead.ConfigureAwait(false);
+                    nextRead = null;
+                }
+                else
+                {
+                    read = await ReadAsync(handle, buffer, offset, cancellationToken).ConfigureAwait(false);
+                }
+            }
+
+            Scan(path, scanner, [], isFinalBlock: true, matches, onMatch);
+        }
+        finally
+        {
+            if (nextRead != null)
+            {
+                await ((Task)nextRead).ConfigureAwait(ConfigureAwaitOptions.SuppressThrowing);
+            }
+
+            if (next != null)
+            {
+                _pool.Return(next);
+            }
+
+            _pool.Return(buffer);
+        }
+    }
+
+    private void Scan(string path, CaskScanner scanner, ReadOnlySpan<byte> text, bool isFinalBlock, List<CaskMatch> matches, Action<string, CaskMatch> onMatch)
+    {
+        matches.Clear();
+        scanner.ScanUtf8(text, isFinalBlock, matches);
+        Interlocked.Add(ref _bytesScanned, text.Length);
+
+        if (matches.Count > 0 && Interlocked.Read(ref _firstMatchTicks) == 0)
+        {
+            Interlocked.CompareExchange(ref _firstMatchTicks, Math.Max(1, _stopwatch.Elapsed.Ticks), 0);
+        }
+
+        foreach (CaskMatch match in matches)
+        {
+            Interlocked.Increment(ref _matchCount);
+            onMatch(path, match);
+        }
+    }
+
+    private async Task<int> ReadAsync(SafeFileHandle handle, byte[] buffer, long offset, CancellationToken cancellationToken)
+    {
+        int readsInFlight = Interlocked.Increment(ref _readsInFlight);
+
+        int peak = Volatile.Read(ref _peakReadsInFlight);
+        while (readsInFlight > peak)
+        {
+            int observed = Interlocked.CompareExchange(ref _peakReadsInFlight, readsInFlight, peak);
+            if (observed == peak)
+            {
+                break;
+            }
+
+            peak = observed;
+        }
+
+        int read;
+        try
+        {
+            read = await RandomAccess.ReadAsync(handle, buffer, offset, cancellationToken).ConfigureAwait(false);
+        }
+        finally
+        {
+            Interlocked.Decrement(ref _readsInFlight);
+        }
+
+        if (_byteRate != null && read > 0)
+        {
+            AddThrottledTime(await _byteRate.TakeAsync(read, cancellationToken).ConfigureAwait(false));
+        }
+
+        return read;
+    }
+
+    private void AddThrottledTime(TimeSpan wait)
+    {
+        if (wait > TimeSpan.Zero)
+        {
+            Interlocked.Add(ref _throttledTicks, wait.Ticks);
+        }
+    }
+
+    /// <summary>
+    /// Samples throughput and memory pressure at a fixed interval until the
+    /// workers complete, and adapts the worker limit and buffer budget.
+    /// </summary>
+    private async Task AdjustAsync(Task workers, CancellationToken cancellationToken)
+    {
+        using var timer = new PeriodicTimer(s_adjustInterval);
+        long previousBytes = 0;
+        long previousTimestamp = Stopwatch.GetTimestamp();
+
+        while (true)
+        {
+            await Task.WhenAny(workers, timer.WaitForNextTickAsync(cancellationToken).AsTask()).ConfigureAwait(false);
+            if (workers.IsCompleted)
+            {
+                return;
+            }
+
+            cancellationToken.ThrowIfCancellationRequested();
+
+            long bytes = Interlocked.Read(ref _bytesScanned);
+            long timestamp = Stopwatch.GetTimestamp();
+            double throughput = (bytes - previousBytes) / Stopwatch.GetElapsedTime(previousTimestamp, timestamp).TotalSeconds;
+            (previousBytes, previousTimestamp) = (bytes, timestamp);
+
+            double memoryPressure = _limits.GetMemoryPressure();
+            bool underMemoryPressure = memoryPressure >= HighMemoryPressure;
+
+            AdjustBuffers(memoryPressure);
+
+            if (_controller != null && _controller.Update(throughput, underMemoryPressure))
+            {
+                SetWorkerLimit(_controller.Limit);
+                _log?.Invoke($"{throughput / 1_000_000:0.0} MB/s, memory {memoryPressure:P0}: {_controller.Limit} workers.");
+            }
+        }
+    }
+
+    private void AdjustBuffers(double memoryPressure)
+    {
+        long budget = _pool.BudgetBytes;
+
+        if (memoryPressure >= HighMemoryPressure)
+        {
+            budget = Math.Max(MinBudgetBytes, budget / 2);
+        }
+        else if (memoryPressure < LowMemoryPressure)
+        {
+            budget = Math.Min(_initialBudgetBytes, budget + 2 * (long)_pool.BufferSize);
+        }
+
+        if (budget != _pool.BudgetBytes)
+        {
+            int bufferSize = GetBufferSize(budget);
+            _pool.Resize(budget, bufferSize);
+            _log?.Invoke($"Memory {memoryPressure:P0}: buffers {bufferSize / 1024} KB, {budget / 1024} KB budget.");
+        }
+    }
+
+    private void SetWorkerLimit(int limit)
+    {
+        Volatile.Write(ref _workerLimit, limit);
+        Interlocked.Exchange(ref _workerLimitRaised, new(TaskCreationOptions.RunContinuationsAsynchronously)).TrySetResult();
+    }
+
+    /// <summary>
+    /// Chooses the largest power-of-two buffer size that lets every worker
+    /// read ahead within the budget.
+    /// </summary>
+    private int GetBufferSize(long budgetBytes)
+    {
+        long perBuffer = budgetBytes / (2 * _maxWorkers);
+        int size = MinBufferSize;
+
+        while (size < MaxBufferSize && size * 2L <= perBuffer)
+        {
+            size *= 2;
+        }
+
+        return size;
+    }
+
+    internal sealed record ScanSummary(long Files, long Bytes, long Matches, long Errors, TimeSpan Elapsed, int Workers, int PeakReadsInFlight, TimeSpan ThrottledTime, TimeSpan? TimeToFirstMatch);
+}
@@ -0,0 +1,177 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics.CodeAnalysis;
+using System.Threading.Channels;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// An unbounded queue of files to scan that is read in <see
+/// cref="ScanPriority"/> order rather than the order in which files were
+/// added, so that workers can start on the most likely leaks while the tree
+/// is still being enumerated.
+/// </summary>
+/// <remarks>
+/// The queue is read through the <see cref="ChannelReader{T}"/> API so that
+/// workers read it as they read the channel of a scan in directory order.
+/// Each file added wakes at most one waiting reader, skipping readers
+/// whose wait was cancelled.
+/// </remarks>
+internal sealed class ScanWorkQueue : ChannelReader<string>
+{
+    private readonly object _lock = new();
+    private readonly PriorityQueue<string, ScanPriority> _queue = new(ScanPriority.Comparer);
+    private readonly Queue<TaskCompletionSource<bool>> _waiters = new();
+    private readonly TaskCompletionSource _completion = new(TaskCreationOptions.RunContinuationsAsynchronously);
+    private Exception? _error;
+    private bool _addingCompleted;
+
+    public override Task Completion => _completion.Task;
+
+    public override bool CanCount => true;
+
+    public override int Count
+    {
+        get { lock (_lock) { return _queue.Count; } }
+    }
+
+    public void Add(string path, ScanPriority priority)
+    {
+        lock (_lock)
+        {
+            if (_addingCompleted)
+            {
+                throw new InvalidOperationException("The queue has been completed.");
+            }
+
+            _queue.Enqueue(path, priority);
+        }
+
+        // Wake the first waiter that is still waiting.
+        while (true)
+        {
+            TaskCompletionSource<bool>? waiter;
+
+            lock (_lock)
+            {
+                if (!_waiters.TryDequeue(out waiter))
+                {
+                    return;
+                }
+            }
+
+            if (waiter.TrySetResult(true))
+            {
+                return;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Marks that no more files will be added, optionally because enumerating
+    /// them failed. Readers see the error once the queue is empty.
+    /// </summary>
+    public void CompleteAdding(Exception? error = null)
+    {
+        TaskCompletionSource<bool>[] waiters;
+        bool empty;
+
+        lock (_lock)
+        {
+            _addingCompleted = true;
+            _error = error;
+            empty = _queue.Count == 0;
+
+            waiters = [.. _waiters];
+            _waiters.Clear();
+        }
+
+        foreach (TaskCompletionSource<bool> waiter in waiters)
+        {
+            waiter.TrySetResult(false);
+        }
+
+        if (empty)
+        {
+            SetCompletion();
+        }
+    }
+
+    public override bool TryRead([MaybeNullWhen(false)] out string item)
+    {
+        bool completed;
+
+        lock (_lock)
+        {
+            if (!_queue.TryDequeue(out item, out _))
+            {
+                return false;
+            }
+
+            completed = _addingCompleted && _queue.Count == 0;
+        }
+
+        if (completed)
+        {
+            SetCompletion();
+        }
+
+        return true;
+    }
+
+    public override bool TryPeek([MaybeNullWhen(false)] out string item)
+    {
+        lock (_lock)
+        {
+            return _queue.TryPeek(out item, out _);
+        }
+    }
+
+    public override ValueTask<bool> WaitToReadAsync(CancellationToken cancellationToken = default)
+    {
+        TaskCompletionSource<bool> waiter;
+
+        lock (_lock)
+        {
+            if (_queue.Count > 0)
+            {
+                return new ValueTask<bool>(true);
+            }
+
+            if (_addingCompleted)
+            {
+                return _error != null ? ValueTask.FromException<bool>(_error) : new ValueTask<bool>(false);
+            }
+
+            waiter = new TaskCompletionSource<bool>(TaskCreationOptions.RunContinuationsAsynchronously);
+            _waiters.Enqueue(waiter);
+        }
+
+        return WaitAsync(waiter, cancellationToken);
+    }
+
+    private async ValueTask<bool> WaitAsync(TaskCompletionSource<bool> waiter, CancellationToken cancellationToken)
+    {
+        // A cancelled waiter is left in the queue but can no longer be
+        // completed, so an add passes over it to the next one.
+        using (cancellationToken.Register(static (state, token) => ((TaskCompletionSource<bool>)state!).TrySetCanceled(token), waiter))
+        {
+            // A waiter woken because adding completed rechecks for an error.
+            return await waiter.Task.ConfigureAwait(false) ||
+                   await WaitToReadAsync(cancellationToken).ConfigureAwait(false);
+        }
+    }
+
+    private void SetCompletion()
+    {
+        if (_error != null)
+        {
+            _completion.TrySetException(_error);
+        }
+        else
+        {
+            _completion.TrySetResult();
+        }
+    }
+}
@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Runtime.InteropServices;
+
+using CommonAnnotatedSecurityKeys.Ipc;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+internal static class ServeCommand
+{
+    internal static int Run(ServeOptions options)
+    {
+        string socketPath = options.Socket ?? Path.Combine(Environment.GetEnvironmentVariable("XDG_RUNTIME_DIR") ?? Path.GetTempPath(), "cask.sock");
+
+        using var stop = new CancellationTokenSource();
+        using PosixSignalRegistration sigint = PosixSignalRegistration.Create(PosixSignal.SIGINT, Stop);
+        using PosixSignalRegistration sigterm = PosixSignalRegistration.Create(PosixSignal.SIGTERM, Stop);
+
+        using var server = new CaskIpcServer(socketPath);
+        Console.Error.WriteLine($"Listening on {server.SocketPath}.");
+
+        server.RunAsync(stop.Token).GetAwaiter().GetResult();
+        return 0;
+
+        void Stop(PosixSignalContext context)
+        {
+            // Stop serving and delete the socket instead of exiting at once.
+            context.Cancel = true;
+            stop.Cancel();
+        }
+    }
+}
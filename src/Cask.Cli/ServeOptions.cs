@@ -0,0 +1,21 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#nullable disable
+
+using System.Diagnostics.CodeAnalysis;
+
+using CommandLine;
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+[Verb("serve", HelpText = "Validate, fingerprint and scan batches of keys and text for local processes over a Unix domain socket.")]
+[SuppressMessage("Design", "CA1812:Avoid uninstantiated internal classes", Justification = "Instantiated by CommandLineParser.")]
+internal sealed class ServeOptions
+{
+    [Option(
+        "socket",
+        Required = false,
+        HelpText = "The path of the socket to create. Defaults to cask.sock in $XDG_RUNTIME_DIR, or in the temporary directory if that is not set.")]
+    public string Socket { get; set; }
+}
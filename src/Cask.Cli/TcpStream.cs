@@ -0,0 +1,217 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// Reassembles one direction of a TCP connection from captured segments and
+/// scans the resulting byte stream for keys.
+/// </summary>
+/// <remarks>
+/// Retransmitted and overlapping data is trimmed against the next expected
+/// sequence number, and segments that arrive early are held until the
+/// segments before them arrive. The data held per stream is bounded: when it
+/// would exceed <see cref="MaxPendingBytes"/>, or when the stream ends with
+/// data still missing, the missing bytes are counted as a gap and scanning
+/// restarts after it. Offsets of keys are from the start of the stream and
+/// include the length of any gaps, so they remain positions in the original
+/// stream.
+/// </remarks>
+internal sealed class TcpStream
+{
+    public const int MaxPendingBytes = 64 * 1024;
+
+    private readonly CaskScanner _scanner = new();
+    private readonly List<CaskMatch> _matches = [];
+    private readonly List<(uint Sequence, byte[] Data)> _pending = [];
+    private int _pendingBytes;
+    private bool _synchronized;
+    private uint _next;
+    private long _streamOffset;
+    private long _scannerOffset;
+
+    public bool IsClosed { get; private set; }
+
+    /// <summary>
+    /// The number of times data was missing from the stream.
+    /// </summary>
+    public long Gaps { get; private set; }
+
+    /// <summary>
+    /// When the stream last received a segment, in the units of the owner.
+    /// </summary>
+    public long LastActivity { get; set; }
+
+    public DateTimeOffset LastTimestamp { get; set; }
+
+    /// <summary>
+    /// Adds a segment to the stream.
+    /// </summary>
+    /// <param name="sequence">The sequence number of the segment.</param>
+    /// <param name="flags">The TCP flags of the segment.</param>
+    /// <param name="payload">The data of the segment.</param>
+    /// <param name="found">Receives the keys completed by this segment and their offsets in the stream.</param>
+    public void Add(uint sequence, TcpFlags flags, ReadOnlySpan<byte> payload, List<(long Offset, CaskKey Key, bool IsLikelyPlaceholder)> found)
+    {
+        if ((flags & TcpFlags.Syn) != 0)
+        {
+            // A SYN on a closed stream starts a new connection on the same
+            // ports. Otherwise, it is a retransmission.
+            if (!_synchronized || IsClosed)
+            {
+                Restart();
+                _next = unchecked(sequence + 1);
+                _synchronized = true;
+            }
+
+            // The SYN itself takes up one sequence number.
+            sequence = unchecked(sequence + 1);
+        }
+        else if (IsClosed)
+        {
+            return;
+        }
+        else if (!_synchronized)
+        {
+            // The capture started after the handshake.
+            _next = sequence;
+            _synchronized = true;
+        }
+
+        if (!payload.IsEmpty)
+        {
+            Insert(sequence, payload, found);
+        }
+
+        if ((flags & (TcpFlags.Fin | TcpFlags.Rst)) != 0)
+        {
+            Close(found);
+        }
+    }
+
+    /// <summary>
+    /// Ends the stream, skipping any missing data so that held segments are
+    /// scanned, and reports keys at the very end of the stream.
+    /// </summary>
+    public void Close(List<(long Offset, CaskKey Key, bool IsLikelyPlaceholder)> found)
+    {
+        if (IsClosed)
+        {
+            return;
+        }
+
+        while (_pending.Count > 0)
+        {
+            SkipToPending(found);
+        }
+
+        Scan([], isFinalBlock: true, found);
+        IsClosed = true;
+    }
+
+    private void Insert(uint sequence, ReadOnlySpan<byte> payload, List<(long Offset, CaskKey Key, bool IsLikelyPlaceholder)> found)
+    {
+        int ahead = unchecked((int)(sequence - _next));
+
+        if (ahead <= 0)
+        {
+            if (-ahead >= payload.Length)
+            {
+                // Retransmission of data already scanned.
+                return;
+            }
+
+            Feed(payload[-ahead..], found);
+            DrainPending(found);
+            return;
+        }
+
+        // PERF: Segments rarely arrive out of order, so holding them is not
+        // optimized beyond copying only those that do.
+        int index = _pending.Count;
+        while (index > 0 && unchecked((int)(_pending[index - 1].Sequence - sequence)) > 0)
+        {
+            index--;
+        }
+
+        _pending.Insert(index, (sequence, payload.ToArray()));
+        _pendingBytes += payload.Length;
+
+        while (_pendingBytes > MaxPendingBytes)
+        {
+            SkipToPending(found);
+        }
+    }
+
+    /// <summary>
+    /// Gives up on the data missing before the first held segment.
+    /// </summary>
+    private void SkipToPending(List<(long Offset, CaskKey Key, bool IsLikelyPlaceholder)> found)
+    {
+        int gap = unchecked((int)(_pending[0].Sequence - _next));
+
+        if (gap > 0)
+        {
+            // Data on either side of the gap is unrelated as far as the
+            // scanner is concerned, so end the scan and start a new one.
+            Scan([], isFinalBlock: true, found);
+            _scanner.Reset();
+
+            _streamOffset += gap;
+            _scannerOffset = _streamOffset;
+            _next = _pending[0].Sequence;
+            Gaps++;
+        }
+
+        DrainPending(found);
+    }
+
+    private void DrainPending(List<(long Offset, CaskKey Key, bool IsLikelyPlaceholder)> found)
+    {
+        while (_pending.Count > 0)
+        {
+            (uint sequence, byte[] data) = _pending[0];
+            int ahead = unchecked((int)(sequence - _next));
+            if (ahead > 0)
+            {
+                return;
+            }
+
+            _pending.RemoveAt(0);
+            _pendingBytes -= data.Length;
+
+            if (-ahead < data.Length)
+            {
+                Feed(data.AsSpan(-ahead), found);
+            }
+        }
+    }
+
+    private void Feed(ReadOnlySpan<byte> data, List<(long Offset, CaskKey Key, bool IsLikelyPlaceholder)> found)
+    {
+        Scan(data, isFinalBlock: false, found);
+        _streamOffset += data.Length;
+        _next = unchecked(_next + (uint)data.Length);
+    }
+
+    private void Scan(ReadOnlySpan<byte> data, bool isFinalBlock, List<(long Offset, CaskKey Key, bool IsLikelyPlaceholder)> found)
+    {
+        _matches.Clear();
+        _scanner.ScanUtf8(data, isFinalBlock, _matches);
+
+        foreach (CaskMatch match in _matches)
+        {
+            found.Add((_scannerOffset + match.Offset, match.Key, match.IsLikelyPlaceholder));
+        }
+    }
+
+    private void Restart()
+    {
+        _scanner.Reset();
+        _pending.Clear();
+        _pendingBytes = 0;
+        _streamOffset = 0;
+        _scannerOffset = 0;
+        IsClosed = false;
+    }
+}
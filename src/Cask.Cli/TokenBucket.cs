@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.Cli;
+
+/// <summary>
+/// A lock-free token bucket rate limiter that can be shared by any number of
+/// threads.
+/// </summary>
+/// <remarks>
+/// The bucket is implemented as a generic cell rate algorithm (GCRA): rather
+/// than a token count that must be refilled, the only state is the time at
+/// which all tokens taken so far will have been paid for at the configured
+/// rate. Taking tokens advances that time with a single compare-exchange, and
+/// the caller waits for however far it is ahead of now by more than the
+/// burst allowance. Tokens are taken after they are used, for example after a
+/// read returns the number of bytes read, so the rate holds exactly over time
+/// without knowing sizes up front.
+/// </remarks>
+internal sealed class TokenBucket
+{
+    private readonly TimeProvider _timeProvider;
+    private readonly double _ticksPerToken;
+    private readonly long _burstTicks;
+    private long _paidUntilTimestamp;
+
+    /// <param name="tokensPerSecond">The sustained rate.</param>
+    /// <param name="burst">The number of tokens that can be taken at once without waiting.</param>
+    /// <param name="timeProvider">The clock, or null for <see cref="TimeProvider.System"/>.</param>
+    public TokenBucket(double tokensPerSecond, double burst, TimeProvider? timeProvider = null)
+    {
+        ArgumentOutOfRangeException.ThrowIfNegativeOrZero(tokensPerSecond);
+        ArgumentOutOfRangeException.ThrowIfNegative(burst);
+
+        _timeProvider = timeProvider ?? TimeProvider.System;
+        _ticksPerToken = _timeProvider.TimestampFrequency / tokensPerSecond;
+        _burstTicks = (long)(burst * _ticksPerToken);
+    }
+
+    /// <summary>
+    /// Takes tokens and returns how long the caller must wait before taking
+    /// more to stay within the rate.
+    /// </summary>
+    public TimeSpan Take(long tokens)
+    {
+        long cost = (long)(tokens * _ticksPerToken);
+        long now = _timeProvider.GetTimestamp();
+        long paidUntil;
+        long updated;
+
+        do
+        {
+            paidUntil = Volatile.Read(ref _paidUntilTimestamp);
+            updated = Math.Max(paidUntil, now) + cost;
+        }
+        while (Interlocked.CompareExchange(ref _paidUntilTimestamp, updated, paidUntil) != paidUntil);
+
+        long waitTicks = updated - now - _burstTicks;
+        return waitTicks > 0 ? _timeProvider.GetElapsedTime(0, waitTicks) : TimeSpan.Zero;
+    }
+
+    /// <summary>
+    /// Takes tokens and waits as long as needed to stay within the rate.
+    /// </summary>
+    /// <returns>The time spent waiting.</returns>
+    public async ValueTask<TimeSpan> TakeAsync(long tokens, CancellationToken cancellationToken)
+    {
+        TimeSpan wait = Take(tokens);
+
+        if (wait > TimeSpan.Zero)
+        {
+            await Task.Delay(wait, _timeProvider, cancellationToken).ConfigureAwait(false);
+        }
+
+        return wait;
+    }
+}
@@ -0,0 +1,39 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Microsoft.CodeAnalysis;
+using Microsoft.CodeAnalysis.CSharp.Syntax;
+
+namespace CommonAnnotatedSecurityKeys.Generators;
+
+/// <summary>
+/// Generates a strongly typed key, with a validator specialized to the
+/// provider, for each struct with a [CaskProvider] attribute.
+/// </summary>
+[Generator(LanguageNames.CSharp)]
+public sealed class CaskProviderGenerator : IIncrementalGenerator
+{
+    private const string CaskProviderAttributeName = "CommonAnnotatedSecurityKeys.CaskProviderAttribute";
+
+    public void Initialize(IncrementalGeneratorInitializationContext context)
+    {
+        IncrementalValuesProvider<ProviderResult> results = context.SyntaxProvider.ForAttributeWithMetadataName(
+            CaskProviderAttributeName,
+            predicate: static (node, _) => node is TypeDeclarationSyntax,
+            transform: ProviderParser.Parse);
+
+        context.RegisterSourceOutput(results, static (context, result) =>
+        {
+            foreach (DiagnosticInfo diagnostic in result.Diagnostics)
+            {
+                context.ReportDiagnostic(diagnostic.ToDiagnostic());
+            }
+
+            if (result.Model is not null)
+            {
+                string hintName = result.Model.Namespace is null ? result.Model.TypeName : $"{result.Model.Namespace}.{result.Model.TypeName}";
+                context.AddSource($"{hintName}.g.cs", ProviderEmitter.Emit(result.Model));
+            }
+        });
+    }
+}
@@ -0,0 +1,51 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Microsoft.CodeAnalysis;
+
+namespace CommonAnnotatedSecurityKeys.Generators;
+
+internal static class DiagnosticDescriptors
+{
+    private const string Category = "Usage";
+
+    public static DiagnosticDescriptor InvalidTarget { get; } = new(
+        id: "CASK001",
+        title: "Invalid CaskProvider target",
+        messageFormat: "'{0}' must be a partial struct that is neither nested nor generic to use [CaskProvider]",
+        Category,
+        DiagnosticSeverity.Error,
+        isEnabledByDefault: true);
+
+    public static DiagnosticDescriptor InvalidProviderSignature { get; } = new(
+        id: "CASK002",
+        title: "Invalid provider signature",
+        messageFormat: "'{0}' is not a valid provider signature: it must be 4 base64url characters",
+        Category,
+        DiagnosticSeverity.Error,
+        isEnabledByDefault: true);
+
+    public static DiagnosticDescriptor InvalidKinds { get; } = new(
+        id: "CASK003",
+        title: "Invalid provider key kinds",
+        messageFormat: "'{0}' is not a valid set of provider key kinds: it must be one or more distinct base64url characters",
+        Category,
+        DiagnosticSeverity.Error,
+        isEnabledByDefault: true);
+
+    public static DiagnosticDescriptor InvalidSecretSize { get; } = new(
+        id: "CASK004",
+        title: "Invalid secret size",
+        messageFormat: "'{0}' is not a valid secret size",
+        Category,
+        DiagnosticSeverity.Error,
+        isEnabledByDefault: true);
+
+    public static DiagnosticDescriptor InvalidProviderDataLayout { get; } = new(
+        id: "CASK005",
+        title: "Invalid provider data layout",
+        messageFormat: "'{0}' is not a valid provider data layout: {1}",
+        Category,
+        DiagnosticSeverity.Error,
+        isEnabledByDefault: true);
+}
@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Collections;
+
+namespace CommonAnnotatedSecurityKeys.Generators;
+
+/// <summary>
+/// An immutable array with value equality so that models that hold one can
+/// be cached by the incremental generator pipeline.
+/// </summary>
+internal readonly struct EquatableArray<T> : IEquatable<EquatableArray<T>>, IEnumerable<T> where T : IEquatable<T>
+{
+    private readonly T[]? _items;
+
+    public EquatableArray(T[] items)
+    {
+        _items = items;
+    }
+
+    public int Count => _items?.Length ?? 0;
+
+    public T this[int index] => _items![index];
+
+    public bool Equals(EquatableArray<T> other)
+    {
+        return AsSpan().SequenceEqual(other.AsSpan());
+    }
+
+    public override bool Equals(object? obj)
+    {
+        return obj is EquatableArray<T> other && Equals(other);
+    }
+
+    public override int GetHashCode()
+    {
+        int hashCode = 0;
+
+        foreach (T item in AsSpan())
+        {
+            hashCode = unchecked((hashCode * 31) + item.GetHashCode());
+        }
+
+        return hashCode;
+    }
+
+    public ReadOnlySpan<T> AsSpan()
+    {
+        return _items.AsSpan();
+    }
+
+    public IEnumerator<T> GetEnumerator()
+    {
+        return ((IEnumerable<T>)(_items ?? [])).GetEnumerator();
+    }
+
+    IEnumerator IEnumerable.GetEnumerator()
+    {
+        return GetEnumerator();
+    }
+
+    public static bool operator ==(EquatableArray<T> left, EquatableArray<T> right)
+    {
+        return left.Equals(right);
+    }
+
+    public static bool operator !=(EquatableArray<T> left, EquatableArray<T> right)
+    {
+        return !left.Equals(right);
+    }
+}
@@ -0,0 +1,7 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace System.Runtime.CompilerServices;
+
+// Required to use records and init accessors when targeting netstandard2.0.
+internal static class IsExternalInit { }
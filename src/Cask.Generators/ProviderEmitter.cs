@@ -0,0 +1,603 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Collections.Immutable;
+using System.Globalization;
+using System.Text;
+
+using Microsoft.CodeAnalysis.CSharp;
+
+namespace CommonAnnotatedSecurityKeys.Generators;
+
+/// <summary>
+/// Emits the source of a provider key type.
+/// </summary>
+/// <remarks>
+/// The generated code only uses language features from C# 7.3 so that it
+/// compiles in .NET Framework projects that use the default language version.
+/// </remarks>
+internal static class ProviderEmitter
+{
+    private const string CaskKey = "global::CommonAnnotatedSecurityKeys.CaskKey";
+    private const string Cask = "global::CommonAnnotatedSecurityKeys.Cask";
+    private const string SecretSize = "global::CommonAnnotatedSecurityKeys.SecretSize";
+    private const string ReadOnlySpanOfChar = "global::System.ReadOnlySpan<char>";
+    private const string ReadOnlySpanOfByte = "global::System.ReadOnlySpan<byte>";
+    private const string AsSpan = "global::System.MemoryExtensions.AsSpan";
+
+    private const string Base64UrlChars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+    /// <summary>
+    /// The names of the members emitted into every provider type, which a
+    /// provider data field cannot also take.
+    /// </summary>
+    public static ImmutableArray<string> MemberNames { get; } = ImmutableArray.Create(
+        "LengthInChars",
+        "_key",
+        "ProviderSignature",
+        "Key",
+        "IsInitialized",
+        "ProviderKeyKind",
+        "IsValid",
+        "IsValidUtf8",
+        "TryCreate",
+        "TryCreateUtf8",
+        "Create",
+        "Generate",
+        "ToString",
+        "Equals",
+        "GetHashCode",
+        "GetText",
+        "IsValidCore",
+        "HasFixedCharacters",
+        "Base64UrlValue",
+        "Base64UrlValues");
+
+    public static string Emit(ProviderModel model)
+    {
+        var layout = new KeyLayout(model);
+        string type = model.TypeName;
+        string indent = model.Namespace is null ? "" : "    ";
+        var writer = new Writer(indent);
+
+        writer.Raw("// <auto-generated/>");
+        writer.Raw("");
+
+        if (model.Namespace is not null)
+        {
+            writer.Raw($"namespace {model.Namespace}");
+            writer.Raw("{");
+        }
+
+        writer.Line($"partial struct {type} : global::System.IEquatable<{type}>");
+        writer.Line("{");
+        writer.Line($"    private const int LengthInChars = {Int(layout.LengthInChars)};");
+        writer.Line("");
+        writer.Line($"    private readonly {CaskKey} _key;");
+        writer.Line("");
+        writer.Line($"    private {type}({CaskKey} key)");
+        writer.Line("    {");
+        writer.Line("        _key = key;");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line($"    /// <summary>The provider signature of every <see cref=\"{type}\"/>.</summary>");
+        writer.Line($"    public static string ProviderSignature => \"{model.ProviderSignature}\";");
+        writer.Line("");
+        writer.Line("    /// <summary>The underlying key.</summary>");
+        writer.Line($"    public {CaskKey} Key => _key;");
+        writer.Line("");
+        writer.Line("    /// <summary>Indicates if the key is initialized, and not the default struct value.</summary>");
+        writer.Line("    public bool IsInitialized => _key.IsInitialized;");
+        writer.Line("");
+        writer.Line("    /// <summary>The provider key kind.</summary>");
+        writer.Line($"    public char ProviderKeyKind => GetText()[{Int(layout.ProviderKeyKindOffset)}];");
+
+        int fieldOffset = layout.ProviderDataOffset;
+        foreach (ProviderDataField field in model.Fields)
+        {
+            if (field.Value is null)
+            {
+                writer.Line("");
+                writer.Line($"    /// <summary>The <c>{field.Name}</c> provider data field.</summary>");
+                writer.Line($"    public {ReadOnlySpanOfChar} {field.Name} => {AsSpan}(GetText(), {Int(fieldOffset)}, {Int(field.Length)});");
+            }
+
+            fieldOffset += field.Length;
+        }
+
+        writer.Line("");
+        writer.Line($"    /// <summary>Determines whether the text is a valid <see cref=\"{type}\"/>.</summary>");
+        writer.Line("    public static bool IsValid(string text)");
+        writer.Line("    {");
+        writer.Line("        if (text == null)");
+        writer.Line("        {");
+        writer.Line("            throw new global::System.ArgumentNullException(nameof(text));");
+        writer.Line("        }");
+        writer.Line("");
+        writer.Line($"        return IsValid({AsSpan}(text));");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line($"    /// <summary>Determines whether the UTF-16 text is a valid <see cref=\"{type}\"/>.</summary>");
+        writer.Line($"    public static bool IsValid({ReadOnlySpanOfChar} text)");
+        writer.Line("    {");
+        writer.Line("        return IsValidCore(text);");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line($"    /// <summary>Determines whether the UTF-8 text is a valid <see cref=\"{type}\"/>.</summary>");
+        writer.Line($"    public static bool IsValidUtf8({ReadOnlySpanOfByte} textUtf8)");
+        writer.Line("    {");
+        writer.Line("        return IsValidCore(textUtf8);");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line($"    /// <summary>Creates a <see cref=\"{type}\"/> if the text is valid.</summary>");
+        writer.Line($"    public static bool TryCreate(string text, out {type} key)");
+        writer.Line("    {");
+        writer.Line("        if (text == null)");
+        writer.Line("        {");
+        writer.Line("            throw new global::System.ArgumentNullException(nameof(text));");
+        writer.Line("        }");
+        writer.Line("");
+        writer.Line($"        {CaskKey} caskKey;");
+        writer.Line($"        if (HasFixedCharacters({AsSpan}(text)) && {CaskKey}.TryCreate(text, out caskKey))");
+        writer.Line("        {");
+        writer.Line($"            key = new {type}(caskKey);");
+        writer.Line("            return true;");
+        writer.Line("        }");
+        writer.Line("");
+        writer.Line("        key = default;");
+        writer.Line("        return false;");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line($"    /// <summary>Creates a <see cref=\"{type}\"/> if the UTF-16 text is valid.</summary>");
+        writer.Line($"    public static bool TryCreate({ReadOnlySpanOfChar} text, out {type} key)");
+        writer.Line("    {");
+        writer.Line($"        {CaskKey} caskKey;");
+        writer.Line($"        if (HasFixedCharacters(text) && {CaskKey}.TryCreate(text, out caskKey))");
+        writer.Line("        {");
+        writer.Line($"            key = new {type}(caskKey);");
+        writer.Line("            return true;");
+        writer.Line("        }");
+        writer.Line("");
+        writer.Line("        key = default;");
+        writer.Line("        return false;");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line($"    /// <summary>Creates a <see cref=\"{type}\"/> if the UTF-8 text is valid.</summary>");
+        writer.Line($"    public static bool TryCreateUtf8({ReadOnlySpanOfByte} textUtf8, out {type} key)");
+        writer.Line("    {");
+        writer.Line($"        {CaskKey} caskKey;");
+        writer.Line($"        if (HasFixedCharacters(textUtf8) && {CaskKey}.TryCreateUtf8(textUtf8, out caskKey))");
+        writer.Line("        {");
+        writer.Line($"            key = new {type}(caskKey);");
+        writer.Line("            return true;");
+        writer.Line("        }");
+        writer.Line("");
+        writer.Line("        key = default;");
+        writer.Line("        return false;");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line($"    /// <summary>Creates a <see cref=\"{type}\"/>, throwing <see cref=\"global::System.FormatException\"/> if the text is not valid.</summary>");
+        writer.Line($"    public static {type} Create(string text)");
+        writer.Line("    {");
+        writer.Line($"        {type} key;");
+        writer.Line("        if (!TryCreate(text, out key))");
+        writer.Line("        {");
+        writer.Line($"            throw new global::System.FormatException(\"Input is not a valid {type}.\");");
+        writer.Line("        }");
+        writer.Line("");
+        writer.Line("        return key;");
+        writer.Line("    }");
+
+        EmitGenerate(writer, model, layout);
+
+        writer.Line("");
+        writer.Line("    /// <inheritdoc/>");
+        writer.Line("    public override string ToString()");
+        writer.Line("    {");
+        writer.Line("        return _key.ToString();");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line("    /// <inheritdoc/>");
+        writer.Line($"    public bool Equals({type} other)");
+        writer.Line("    {");
+        writer.Line("        return _key.Equals(other._key);");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line("    /// <inheritdoc/>");
+        writer.Line("    public override bool Equals(object obj)");
+        writer.Line("    {");
+        writer.Line($"        return obj is {type} && Equals(({type})obj);");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line("    /// <inheritdoc/>");
+        writer.Line("    public override int GetHashCode()");
+        writer.Line("    {");
+        writer.Line("        return _key.GetHashCode();");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line($"    /// <summary>Compares two <see cref=\"{type}\"/> values for equality.</summary>");
+        writer.Line($"    public static bool operator ==({type} left, {type} right)");
+        writer.Line("    {");
+        writer.Line("        return left.Equals(right);");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line($"    /// <summary>Compares two <see cref=\"{type}\"/> values for inequality.</summary>");
+        writer.Line($"    public static bool operator !=({type} left, {type} right)");
+        writer.Line("    {");
+        writer.Line("        return !left.Equals(right);");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line($"    /// <summary>Converts a <see cref=\"{type}\"/> to the underlying key.</summary>");
+        writer.Line($"    public static implicit operator {CaskKey}({type} key)");
+        writer.Line("    {");
+        writer.Line("        return key._key;");
+        writer.Line("    }");
+
+        writer.Line("");
+        writer.Line("    private string GetText()");
+        writer.Line("    {");
+        writer.Line("        if (!_key.IsInitialized)");
+        writer.Line("        {");
+        writer.Line("            throw new global::System.InvalidOperationException(\"Operation cannot be performed on the default uninitialized struct value.\");");
+        writer.Line("        }");
+        writer.Line("");
+        writer.Line("        return _key.ToString();");
+        writer.Line("    }");
+
+        EmitIsValidCore(writer, model, layout, ReadOnlySpanOfChar);
+        EmitIsValidCore(writer, model, layout, ReadOnlySpanOfByte);
+        EmitHasFixedCharacters(writer, model, layout, ReadOnlySpanOfChar, charPrefix: "");
+        EmitHasFixedCharacters(writer, model, layout, ReadOnlySpanOfByte, charPrefix: "(byte)");
+        EmitBase64UrlValues(writer);
+
+        writer.Line("}");
+
+        if (model.Namespace is not null)
+        {
+            writer.Raw("}");
+        }
+
+        return writer.ToString();
+    }
+
+    private static void EmitGenerate(Writer writer, ProviderModel model, KeyLayout layout)
+    {
+        bool hasKindParameter = model.Kinds is null || model.Kinds.Length > 1;
+        var parameters = new List<string>();
+
+        if (hasKindParameter)
+        {
+            parameters.Add("char providerKeyKind");
+        }
+
+        foreach (ProviderDataField field in model.Fields)
+        {
+            if (field.Value is null)
+            {
+                parameters.Add($"string {ParameterName(field.Name)}");
+            }
+        }
+
+        writer.Line("");
+        writer.Line($"    /// <summary>Generates a new <see cref=\"{model.TypeName}\"/>.</summary>");
+        writer.Line($"    public static {model.TypeName} Generate({string.Join(", ", parameters)})");
+        writer.Line("    {");
+
+        if (hasKindParameter && model.Kinds is not null)
+        {
+            writer.Line($"        if ({KindCondition("providerKeyKind", model.Kinds, charPrefix: "")})");
+            writer.Line("        {");
+            writer.Line($"            throw new global::System.ArgumentOutOfRangeException(nameof(providerKeyKind), providerKeyKind, \"Provider key kind must be one of '{model.Kinds}'.\");");
+            writer.Line("        }");
+            writer.Line("");
+        }
+
+        var providerDataParts = new List<string>();
+
+        foreach (ProviderDataField field in model.Fields)
+        {
+            if (field.Value is not null)
+            {
+                providerDataParts.Add($"\"{field.Value}\"");
+                continue;
+            }
+
+            string parameter = ParameterName(field.Name);
+            providerDataParts.Add(parameter);
+
+            writer.Line($"        if ({parameter} == null)");
+            writer.Line("        {");
+            writer.Line($"            throw new global::System.ArgumentNullException(nameof({parameter}));");
+            writer.Line("        }");
+            writer.Line("");
+            writer.Line($"        if ({parameter}.Length != {Int(field.Length)})");
+            writer.Line("        {");
+            writer.Line($"            throw new global::System.ArgumentException(\"{field.Name} must be {Int(field.Length)} characters long.\", nameof({parameter}));");
+            writer.Line("        }");
+            writer.Line("");
+        }
+
+        string providerData = providerDataParts.Count switch
+        {
+            0 => "null",
+            1 => providerDataParts[0],
+            _ => $"string.Concat(new string[] {{ {string.Join(", ", providerDataParts)} }})",
+        };
+
+        string kind = hasKindParameter ? "providerKeyKind" : $"'{model.Kinds}'";
+
+        string secretSize = model.SecretSize == 2 ? "Bits512" : "Bits256";
+
+        writer.Line($"        {CaskKey} key = {Cask}.GenerateKey(ProviderSignature, {kind}, {providerData}, {SecretSize}.{secretSize});");
+        writer.Line($"        return new {model.TypeName}(key);");
+        writer.Line("    }");
+    }
+
+    /// <summary>
+    /// Emits the whole validation of a key of the provider: the characters
+    /// that are the same in all keys, then the alphabet of every other
+    /// character, the zero padding at the end of the sensitive component and
+    /// the ranges of the timestamp characters. It accepts exactly the keys that
+    /// <c>Cask.IsCask</c> accepts and that match the provider, without
+    /// decoding the key or recording telemetry.
+    /// </summary>
+    /// <remarks>
+    /// Each range check is folded into one value that turns negative if any
+    /// character is out of range, so there is one branch for the fixed
+    /// characters and one for everything else.
+    /// </remarks>
+    private static void EmitIsValidCore(Writer writer, ProviderModel model, KeyLayout layout, string spanType)
+    {
+        writer.Line("");
+        writer.Line($"    private static bool IsValidCore({spanType} text)");
+        writer.Line("    {");
+        writer.Line("        if (!HasFixedCharacters(text))");
+        writer.Line("        {");
+        writer.Line("            return false;");
+        writer.Line("        }");
+        writer.Line("");
+        writer.Line("        int outOfRange = 0;");
+        writer.Line("");
+        writer.Line($"        for (int i = 0; i < {Int(layout.SecretLastCharOffset)}; i++)");
+        writer.Line("        {");
+        writer.Line("            outOfRange |= 63 - Base64UrlValue(text[i]);");
+        writer.Line("        }");
+        writer.Line("");
+        writer.Line("        // The low bits of the last character of the sensitive component are zero padding.");
+        writer.Line($"        outOfRange |= -(Base64UrlValue(text[{Int(layout.SecretLastCharOffset)}]) & {Int(layout.SecretLastCharPaddingMask)});");
+
+        if (model.Kinds is null)
+        {
+            writer.Line($"        outOfRange |= 63 - Base64UrlValue(text[{Int(layout.ProviderKeyKindOffset)}]);");
+        }
+
+        int fieldOffset = layout.ProviderDataOffset;
+        foreach (ProviderDataField field in model.Fields)
+        {
+            if (field.Value is null)
+            {
+                writer.Line("");
+                writer.Line($"        for (int i = {Int(fieldOffset)}; i < {Int(fieldOffset + field.Length)}; i++)");
+                writer.Line("        {");
+                writer.Line("            outOfRange |= 63 - Base64UrlValue(text[i]);");
+                writer.Line("        }");
+            }
+
+            fieldOffset += field.Length;
+        }
+
+        int timestamp = layout.TimestampOffset;
+        writer.Line("");
+        writer.Line($"        outOfRange |= 63 - Base64UrlValue(text[{Int(timestamp + 2)}]); // Year.");
+        writer.Line($"        outOfRange |= 11 - Base64UrlValue(text[{Int(timestamp + 3)}]); // Month.");
+        writer.Line($"        outOfRange |= 30 - Base64UrlValue(text[{Int(timestamp + 4)}]); // Day.");
+        writer.Line($"        outOfRange |= 23 - Base64UrlValue(text[{Int(timestamp + 5)}]); // Hour.");
+        writer.Line($"        outOfRange |= 59 - Base64UrlValue(text[{Int(timestamp + 6)}]); // Minute.");
+        writer.Line($"        outOfRange |= 59 - Base64UrlValue(text[{Int(timestamp + 7)}]); // Second.");
+        writer.Line("");
+        writer.Line("        return outOfRange >= 0;");
+        writer.Line("    }");
+    }
+
+    /// <summary>
+    /// Emits a lookup of the value of a base64url character, or 255 for any
+    /// other character, so that every range check is one subtraction.
+    /// </summary>
+    private static void EmitBase64UrlValues(Writer writer)
+    {
+        var values = new byte[128];
+        for (int i = 0; i < values.Length; i++)
+        {
+            values[i] = 0xFF;
+        }
+
+        for (int i = 0; i < Base64UrlChars.Length; i++)
+        {
+            values[Base64UrlChars[i]] = (byte)i;
+        }
+
+        writer.Line("");
+        writer.Line("    private static int Base64UrlValue(int c)");
+        writer.Line("    {");
+        writer.Line("        return c < 128 ? Base64UrlValues[c] : 0xFF;");
+        writer.Line("    }");
+        writer.Line("");
+        writer.Line($"    private static {ReadOnlySpanOfByte} Base64UrlValues => new byte[]");
+        writer.Line("    {");
+
+        for (int i = 0; i < values.Length; i += 16)
+        {
+            writer.Line("        " + string.Join(", ", values.Skip(i).Take(16).Select(v => "0x" + v.ToString("X2", CultureInfo.InvariantCulture))) + ",");
+        }
+
+        writer.Line("    };");
+    }
+
+    /// <summary>
+    /// Emits a check of every character that is the same in all keys of the
+    /// provider. The comparisons are combined without branches and all offsets
+    /// are constants, so the JIT can also drop the bounds checks after the
+    /// length check.
+    /// </summary>
+    private static void EmitHasFixedCharacters(Writer writer, ProviderModel model, KeyLayout layout, string spanType, string charPrefix)
+    {
+        List<(int Offset, char Value)> fixedCharacters = layout.GetFixedCharacters();
+
+        writer.Line("");
+        writer.Line($"    private static bool HasFixedCharacters({spanType} text)");
+        writer.Line("    {");
+        writer.Line("        if (text.Length != LengthInChars)");
+        writer.Line("        {");
+        writer.Line("            return false;");
+        writer.Line("        }");
+        writer.Line("");
+
+        for (int i = 0; i < fixedCharacters.Count; i++)
+        {
+            (int offset, char value) = fixedCharacters[i];
+            string prefix = i == 0 ? "int mismatch = " : "               ";
+            string suffix = i == fixedCharacters.Count - 1 ? ";" : " |";
+            writer.Line($"        {prefix}(text[{Int(offset)}] ^ {charPrefix}'{value}'){suffix}");
+        }
+
+        writer.Line("");
+
+        if (model.Kinds is not null)
+        {
+            string kind = $"text[{Int(layout.ProviderKeyKindOffset)}]";
+            writer.Line($"        if ({KindCondition(kind, model.Kinds, charPrefix)})");
+            writer.Line("        {");
+            writer.Line("            return false;");
+            writer.Line("        }");
+            writer.Line("");
+        }
+
+        writer.Line("        return mismatch == 0;");
+        writer.Line("    }");
+    }
+
+    private static string KindCondition(string kind, string kinds, string charPrefix)
+    {
+        return string.Join(" && ", kinds.Select(k => $"{kind} != {charPrefix}'{k}'"));
+    }
+
+    private static string ParameterName(string fieldName)
+    {
+        string name = char.ToLowerInvariant(fieldName[0]) + fieldName.Substring(1);
+        return SyntaxFacts.GetKeywordKind(name) != SyntaxKind.None ? "@" + name : name;
+    }
+
+    private static string Int(int value)
+    {
+        return value.ToString(CultureInfo.InvariantCulture);
+    }
+
+    /// <summary>
+    /// The constant character offsets of a provider's keys.
+    /// </summary>
+    private sealed class KeyLayout
+    {
+        private readonly ProviderModel _model;
+
+        public KeyLayout(ProviderModel model)
+        {
+            _model = model;
+
+            int secretSizeInBytes = model.SecretSize * 32;
+            int paddedSecretSizeInBytes = (secretSizeInBytes + 2) / 3 * 3;
+
+            CaskSignatureOffset = paddedSecretSizeInBytes / 3 * 4;
+            ProviderDataLengthInChars = model.Fields.Sum(f => f.Length);
+            LengthInChars = CaskSignatureOffset + 12 + ProviderDataLengthInChars + 8;
+        }
+
+        //  [CaskSignatureOffset]      QJJQ
+        //  [CaskSignatureOffset + 4]  'A', secret size, provider data size, provider key kind
+        //  [CaskSignatureOffset + 8]  provider signature
+        //  [ProviderDataOffset]       provider data
+        //  [TimestampOffset]          'A', 'A', year, month, day, hour, minute, second
+        public int CaskSignatureOffset { get; }
+
+        public int ProviderDataLengthInChars { get; }
+
+        public int LengthInChars { get; }
+
+        public int ProviderKeyKindOffset => CaskSignatureOffset + 7;
+
+        public int ProviderDataOffset => CaskSignatureOffset + 12;
+
+        public int TimestampOffset => ProviderDataOffset + ProviderDataLengthInChars;
+
+        // The last character of the sensitive component holds its final bits
+        // followed by zero padding: 2 bits for 256-bit secrets and 4 bits for
+        // 512-bit secrets. Any characters after it are 'A' and are fixed.
+        public int SecretLastCharOffset => _model.SecretSize * 32 * 8 / 6;
+
+        public int SecretLastCharPaddingMask => (1 << (6 - (_model.SecretSize * 32 * 8 % 6))) - 1;
+
+        public List<(int Offset, char Value)> GetFixedCharacters()
+        {
+            var result = new List<(int, char)>();
+
+            Add(result, SecretLastCharOffset + 1, new string('A', CaskSignatureOffset - SecretLastCharOffset - 1));
+            Add(result, CaskSignatureOffset, "QJJQ");
+            Add(result, CaskSignatureOffset + 4, "A");
+            Add(result, CaskSignatureOffset + 5, Base64UrlChars[_model.SecretSize].ToString());
+            Add(result, CaskSignatureOffset + 6, Base64UrlChars[ProviderDataLengthInChars / 4].ToString());
+            Add(result, CaskSignatureOffset + 8, _model.ProviderSignature);
+
+            int offset = ProviderDataOffset;
+            foreach (ProviderDataField field in _model.Fields)
+            {
+                if (field.Value is not null)
+                {
+                    Add(result, offset, field.Value);
+                }
+
+                offset += field.Length;
+            }
+
+            Add(result, TimestampOffset, "AA");
+            return result;
+        }
+
+        private static void Add(List<(int, char)> result, int offset, string value)
+        {
+            for (int i = 0; i < value.Length; i++)
+            {
+                result.Add((offset + i, value[i]));
+            }
+        }
+    }
+
+    private sealed class Writer
+    {
+        private readonly StringBuilder _builder = new();
+        private readonly string _indent;
+
+        public Writer(string indent)
+        {
+            _indent = indent;
+        }
+
+        public void Raw(string line)
+        {
+            _builder.Append(line).Append('\n');
+        }
+
+        public void Line(string line)
+        {
+            if (line.Length > 0)
+            {
+                _builder.Append(_indent);
+            }
+
+            _builder.Append(line).Append('\n');
+        }
+
+        public override string ToString()
+        {
+            return _builder.ToString();
+        }
+    }
+}
@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Microsoft.CodeAnalysis;
+using Microsoft.CodeAnalysis.Text;
+
+namespace CommonAnnotatedSecurityKeys.Generators;
+
+/// <summary>
+/// Everything needed to emit a provider key type. Only values, no symbols or
+/// syntax, so that the generator is incremental.
+/// </summary>
+internal sealed record ProviderModel(
+    string? Namespace,
+    string TypeName,
+    string ProviderSignature,
+    string? Kinds,
+    int SecretSize,
+    EquatableArray<ProviderDataField> Fields);
+
+/// <summary>
+/// A provider data field. <see cref="Value"/> is set for fields with a fixed
+/// value and null for variable fields.
+/// </summary>
+internal sealed record ProviderDataField(string Name, int Length, string? Value);
+
+internal sealed record ProviderResult(ProviderModel? Model, EquatableArray<DiagnosticInfo> Diagnostics);
+
+internal sealed record DiagnosticInfo(DiagnosticDescriptor Descriptor, LocationInfo? Location, EquatableArray<string> MessageArgs)
+{
+    public Diagnostic ToDiagnostic()
+    {
+        return Diagnostic.Create(Descriptor, Location?.ToLocation(), [.. MessageArgs]);
+    }
+}
+
+internal sealed record LocationInfo(string FilePath, TextSpan TextSpan, LinePositionSpan LineSpan)
+{
+    public static LocationInfo? From(Location location)
+    {
+        return location.SourceTree is null ? null : new LocationInfo(location.SourceTree.FilePath, location.SourceSpan, location.GetLineSpan().Span);
+    }
+
+    public Location ToLocation()
+    {
+        return Location.Create(FilePath, TextSpan, LineSpan);
+    }
+}
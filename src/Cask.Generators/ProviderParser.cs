@@ -0,0 +1,209 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Globalization;
+
+using Microsoft.CodeAnalysis;
+using Microsoft.CodeAnalysis.CSharp;
+using Microsoft.CodeAnalysis.CSharp.Syntax;
+
+namespace CommonAnnotatedSecurityKeys.Generators;
+
+/// <summary>
+/// Reads a [CaskProvider] attribute and the struct it is applied to into a
+/// <see cref="ProviderModel"/>, reporting anything that is invalid.
+/// </summary>
+internal static class ProviderParser
+{
+    // NOTE: These mirror values in the Cask library, which the generator
+    //       cannot reference.
+    private const int ProviderSignatureLengthInChars = 4;
+    private const int MaxProviderDataLengthInChars = 40;
+    private const int MinSecretSize = 1; // SecretSize.Bits256
+    private const int MaxSecretSize = 2; // SecretSize.Bits512
+
+    public static ProviderResult Parse(GeneratorAttributeSyntaxContext context, CancellationToken cancellationToken)
+    {
+        var syntax = (TypeDeclarationSyntax)context.TargetNode;
+        var type = (INamedTypeSymbol)context.TargetSymbol;
+        AttributeData attribute = context.Attributes[0];
+
+        if (syntax is not StructDeclarationSyntax ||
+            !syntax.Modifiers.Any(SyntaxKind.PartialKeyword) ||
+            type.ContainingType is not null ||
+            type.IsGenericType)
+        {
+            return Error(DiagnosticDescriptors.InvalidTarget, syntax.Identifier.GetLocation(), type.Name);
+        }
+
+        Location location = attribute.ApplicationSyntaxReference?.GetSyntax(cancellationToken).GetLocation() ?? syntax.Identifier.GetLocation();
+
+        string? providerSignature = attribute.ConstructorArguments.Length == 1 ? attribute.ConstructorArguments[0].Value as string : null;
+        string? kinds = null;
+        string? layout = null;
+        int secretSize = MinSecretSize;
+
+        foreach (KeyValuePair<string, TypedConstant> argument in attribute.NamedArguments)
+        {
+            switch (argument.Key)
+            {
+                case "Kinds":
+                    kinds = argument.Value.Value as string;
+                    break;
+                case "ProviderDataLayout":
+                    layout = argument.Value.Value as string;
+                    break;
+                case "SecretSize":
+                    secretSize = argument.Value.Value is int value ? value : 0;
+                    break;
+            }
+        }
+
+        var diagnostics = new List<DiagnosticInfo>();
+
+        if (providerSignature is null || providerSignature.Length != ProviderSignatureLengthInChars || !IsValidForBase64Url(providerSignature))
+        {
+            diagnostics.Add(CreateDiagnostic(DiagnosticDescriptors.InvalidProviderSignature, location, providerSignature ?? "null"));
+        }
+
+        if (kinds is not null && (kinds.Length == 0 || !IsValidForBase64Url(kinds) || kinds.Distinct().Count() != kinds.Length))
+        {
+            diagnostics.Add(CreateDiagnostic(DiagnosticDescriptors.InvalidKinds, location, kinds));
+        }
+
+        if (secretSize is < MinSecretSize or > MaxSecretSize)
+        {
+            diagnostics.Add(CreateDiagnostic(DiagnosticDescriptors.InvalidSecretSize, location, secretSize.ToString(CultureInfo.InvariantCulture)));
+        }
+
+        if (!TryParseLayout(layout, type.Name, out ProviderDataField[] fields, out string? error))
+        {
+            diagnostics.Add(CreateDiagnostic(DiagnosticDescriptors.InvalidProviderDataLayout, location, layout ?? "null", error));
+        }
+
+        if (diagnostics.Count > 0)
+        {
+            return new ProviderResult(null, new EquatableArray<DiagnosticInfo>([.. diagnostics]));
+        }
+
+        var model = new ProviderModel(
+            type.ContainingNamespace.IsGlobalNamespace ? null : type.ContainingNamespace.ToDisplayString(),
+            type.Name,
+            providerSignature!,
+            kinds,
+            secretSize,
+            new EquatableArray<ProviderDataField>(fields));
+
+        return new ProviderResult(model, default);
+    }
+
+    /// <summary>
+    /// Parses a comma-separated list of <c>Name:Length</c> and
+    /// <c>Name=Value</c> fields.
+    /// </summary>
+    private static bool TryParseLayout(string? layout, string typeName, out ProviderDataField[] fields, out string error)
+    {
+        fields = [];
+        error = string.Empty;
+
+        if (layout is null || layout.Trim().Length == 0)
+        {
+            return true;
+        }
+
+        var result = new List<ProviderDataField>();
+        var names = new HashSet<string>(StringComparer.Ordinal);
+        int totalLength = 0;
+
+        foreach (string part in layout.Split(','))
+        {
+            string field = part.Trim();
+            int separator = field.IndexOfAny([':', '=']);
+
+            if (separator <= 0)
+            {
+                error = $"field '{field}' must be 'Name:Length' or 'Name=Value'";
+                return false;
+            }
+
+            string name = field.Substring(0, separator).Trim();
+            string rest = field.Substring(separator + 1).Trim();
+
+            if (!SyntaxFacts.IsValidIdentifier(name) ||
+                SyntaxFacts.GetKeywordKind(name) != SyntaxKind.None ||
+                name == typeName ||
+                ProviderEmitter.MemberNames.Contains(name))
+            {
+                error = $"'{name}' is not a valid field name";
+                return false;
+            }
+
+            if (!names.Add(name))
+            {
+                error = $"field '{name}' is declared more than once";
+                return false;
+            }
+
+            if (field[separator] == ':')
+            {
+                if (!int.TryParse(rest, NumberStyles.None, CultureInfo.InvariantCulture, out int length) || length <= 0)
+                {
+                    error = $"field '{name}' must have a positive length";
+                    return false;
+                }
+
+                result.Add(new ProviderDataField(name, length, Value: null));
+                totalLength += length;
+            }
+            else
+            {
+                if (rest.Length == 0 || !IsValidForBase64Url(rest))
+                {
+                    error = $"the value of field '{name}' must be one or more base64url characters";
+                    return false;
+                }
+
+                result.Add(new ProviderDataField(name, rest.Length, rest));
+                totalLength += rest.Length;
+            }
+
+            if (totalLength > MaxProviderDataLengthInChars)
+            {
+                error = $"the total length must be at most {MaxProviderDataLengthInChars} characters";
+                return false;
+            }
+        }
+
+        if (totalLength % 4 != 0)
+        {
+            error = $"the total length, {totalLength} characters, must be a multiple of 4";
+            return false;
+        }
+
+        fields = [.. result];
+        return true;
+    }
+
+    private static bool IsValidForBase64Url(string value)
+    {
+        foreach (char c in value)
+        {
+            if (!(c is >= 'A' and <= 'Z' or >= 'a' and <= 'z' or >= '0' and <= '9' or '-' or '_'))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    private static ProviderResult Error(DiagnosticDescriptor descriptor, Location location, params string[] messageArgs)
+    {
+        return new ProviderResult(null, new EquatableArray<DiagnosticInfo>([CreateDiagnostic(descriptor, location, messageArgs)]));
+    }
+
+    private static DiagnosticInfo CreateDiagnostic(DiagnosticDescriptor descriptor, Location location, params string[] messageArgs)
+    {
+        return new DiagnosticInfo(descriptor, LocationInfo.From(location), new EquatableArray<string>(messageArgs));
+    }
+}
@@ -0,0 +1,388 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers;
+using System.Collections.Concurrent;
+using System.Net.Sockets;
+using System.Text;
+
+namespace CommonAnnotatedSecurityKeys.Ipc;
+
+/// <summary>
+/// Sends batches of keys and text to a <see cref="CaskIpcServer"/>.
+/// </summary>
+/// <remarks>
+/// The client is thread-safe. Requests from concurrent callers are sent
+/// without waiting for the responses to earlier ones, and each batch costs one
+/// round trip however many items it has.
+/// </remarks>
+public sealed class CaskIpcClient : IAsyncDisposable, IDisposable
+{
+    private const int InitialBufferLength = 64 * 1024;
+
+    private readonly NetworkStream _stream;
+    private readonly SemaphoreSlim _writeLock = new(1, 1);
+    private readonly CaskIpcFrameWriter _writer = new(InitialBufferLength);
+    private readonly ConcurrentQueue<PendingRequest> _pending = new();
+    private readonly CancellationTokenSource _disposed = new();
+    private readonly Task _readLoop;
+    private Exception? _failure;
+    private uint _nextRequestId;
+
+    private CaskIpcClient(Socket socket)
+    {
+        _stream = new NetworkStream(socket, ownsSocket: true);
+        _readLoop = ReadResponsesAsync();
+    }
+
+    private delegate T ResultReader<T>(ref CaskIpcFrameReader reader, int count, object? state);
+
+    /// <summary>
+    /// Connects to the server listening on the socket at the given path.
+    /// </summary>
+    public static async Task<CaskIpcClient> ConnectAsync(string socketPath, CancellationToken cancellationToken = default)
+    {
+        ThrowIfNull(socketPath);
+
+        Socket? socket = new(AddressFamily.Unix, SocketType.Stream, ProtocolType.Unspecified);
+
+        try
+        {
+            await socket.ConnectAsync(new UnixDomainSocketEndPoint(socketPath), cancellationToken).ConfigureAwait(false);
+            var client = new CaskIpcClient(socket);
+            socket = null;
+            return client;
+        }
+        finally
+        {
+            socket?.Dispose();
+        }
+    }
+
+    /// <summary>
+    /// Validates each of the given keys.
+    /// </summary>
+    public Task<CaskValidationError[]> ValidateAsync(IReadOnlyList<string> keys, CancellationToken cancellationToken = default)
+    {
+        ThrowIfNull(keys);
+        return SendAsync(CaskIpcOperation.Validate, keys, ReadValidationErrors, state: null, cancellationToken);
+    }
+
+    /// <summary>
+    /// Computes the fingerprint of each of the given keys, or null for each
+    /// one that is not valid.
+    /// </summary>
+    public Task<CaskKeyFingerprint?[]> FingerprintAsync(IReadOnlyList<string> keys, CancellationToken cancellationToken = default)
+    {
+        ThrowIfNull(keys);
+        return SendAsync(CaskIpcOperation.Fingerprint, keys, ReadFingerprints, state: null, cancellationToken);
+    }
+
+    /// <summary>
+    /// Finds the keys in each of the given UTF-8 texts.
+    /// </summary>
+    public Task<IReadOnlyList<CaskMatch>[]> ScanAsync(IReadOnlyList<ReadOnlyMemory<byte>> textsUtf8, CancellationToken cancellationToken = default)
+    {
+        ThrowIfNull(textsUtf8);
+        return SendAsync(CaskIpcOperation.Scan, textsUtf8, ReadMatches, textsUtf8, cancellationToken);
+    }
+
+    /// <summary>
+    /// Closes the connection. Requests that have not been answered fail.
+    /// </summary>
+    public async ValueTask DisposeAsync()
+    {
+        if (_disposed.IsCancellationRequested)
+        {
+            return;
+        }
+
+        await _disposed.CancelAsync().ConfigureAwait(false);
+        await _stream.DisposeAsync().ConfigureAwait(false);
+
+        try
+        {
+            await _readLoop.ConfigureAwait(false);
+        }
+        finally
+        {
+            _writeLock.Dispose();
+            _disposed.Dispose();
+        }
+    }
+
+    /// <inheritdoc cref="DisposeAsync"/>
+    public void Dispose()
+    {
+        DisposeAsync().AsTask().GetAwaiter().GetResult();
+    }
+
+    private async Task<T> SendAsync<TItem, T>(CaskIpcOperation operation,
+                                              IReadOnlyList<TItem> items,
+                                              ResultReader<T> readResults,
+                                              object? state,
+                                              CancellationToken cancellationToken)
+    {
+        var request = new PendingRequest<T>(operation, items.Count, readResults, state);
+
+        await _writeLock.WaitAsync(cancellationToken).ConfigureAwait(false);
+        try
+        {
+            ObjectDisposedException.ThrowIf(_disposed.IsCancellationRequested, this);
+
+            if (Volatile.Read(ref _failure) is Exception failure)
+            {
+                throw new IOException("The connection to the server failed.", failure);
+            }
+
+            request.RequestId = unchecked(_nextRequestId++);
+            _writer.Reset();
+            _writer.BeginFrame(request.RequestId, (byte)operation, items.Count);
+
+            foreach (TItem item in items)
+            {
+                WriteItem(item);
+            }
+
+            _writer.EndFrame();
+
+            // Responses arrive in the order of the requests, so the request
+            // must be queued in the order that it is sent.
+            _pending.Enqueue(request);
+            await _stream.WriteAsync(_writer.WrittenMemory, CancellationToken.None).ConfigureAwait(false);
+        }
+        finally
+        {
+            _writeLock.Release();
+        }
+
+        return await request.Task.WaitAsync(cancellationToken).ConfigureAwait(false);
+    }
+
+    private void WriteItem<TItem>(TItem item)
+    {
+        if (item is string text)
+        {
+            int length = Encoding.UTF8.GetByteCount(text);
+            _writer.WriteUInt32((uint)length);
+            Encoding.UTF8.GetBytes(text, _writer.GetSpan(length));
+            _writer.Advance(length);
+        }
+        else if (item is ReadOnlyMemory<byte> bytes)
+        {
+            _writer.WriteUInt32((uint)bytes.Length);
+            _writer.WriteBytes(bytes.Span);
+        }
+    }
+
+    private async Task ReadResponsesAsync()
+    {
+        await Task.Yield();
+
+        byte[] input = ArrayPool<byte>.Shared.Rent(InitialBufferLength);
+        int start = 0;
+        int end = 0;
+
+        try
+        {
+            while (true)
+            {
+                while (CaskIpcProtocol.TryGetFrame(input.AsSpan(start, end - start), out int frameLength))
+                {
+                    CompleteRequest(input.AsSpan(start + CaskIpcProtocol.LengthPrefixLength, frameLength - CaskIpcProtocol.LengthPrefixLength));
+                    start += frameLength;
+                }
+
+                if (start == end)
+                {
+                    start = 0;
+                    end = 0;
+                }
+
+                int required = CaskIpcProtocol.GetRequiredLength(input.AsSpan(start, end - start));
+                if (required > input.Length - start)
+                {
+                    byte[] larger = required > input.Length ? ArrayPool<byte>.Shared.Rent(required) : input;
+                    input.AsSpan(start, end - start).CopyTo(larger);
+
+                    if (larger != input)
+                    {
+                        ArrayPool<byte>.Shared.Return(input);
+                        input = larger;
+                    }
+
+                    end -= start;
+                    start = 0;
+                }
+
+                int read = await _stream.ReadAsync(input.AsMemory(end), _disposed.Token).ConfigureAwait(false);
+                if (read == 0)
+                {
+                    throw new IOException("The server closed the connection.");
+                }
+
+                end += read;
+            }
+        }
+        catch (Exception e) when (e is IOException or SocketException or InvalidDataException or OperationCanceledException or ObjectDisposedException)
+        {
+            // Fail the requests that are waiting, and make sending any more
+            // fail, since the responses to them can no longer be matched.
+            Volatile.Write(ref _failure, e);
+            await _stream.DisposeAsync().ConfigureAwait(false);
+
+            while (_pending.TryDequeue(out PendingRequest? request))
+            {
+                request.Fail(_disposed.IsCancellationRequested ? new ObjectDisposedException(nameof(CaskIpcClient)) : e);
+            }
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(input);
+        }
+    }
+
+    private void CompleteRequest(ReadOnlySpan<byte> frame)
+    {
+        var reader = new CaskIpcFrameReader(frame);
+
+        if (!_pending.TryDequeue(out PendingRequest? request) ||
+            !reader.TryReadUInt32(out uint requestId) ||
+            requestId != request.RequestId ||
+            !reader.TryReadByte(out byte status) ||
+            !reader.TryReadUInt32(out uint count))
+        {
+            throw new InvalidDataException("The server sent an unexpected response.");
+        }
+
+        if (status != (byte)CaskIpcStatus.Success)
+        {
+            request.Fail(new InvalidDataException($"The server rejected the {request.Operation} request: {(CaskIpcStatus)status}."));
+            return;
+        }
+
+        if (count != request.Count)
+        {
+            throw new InvalidDataException("The server sent an unexpected response.");
+        }
+
+        try
+        {
+            request.Complete(ref reader);
+        }
+        catch (InvalidDataException e)
+        {
+            request.Fail(e);
+            throw;
+        }
+    }
+
+    private static CaskValidationError[] ReadValidationErrors(ref CaskIpcFrameReader reader, int count, object? state)
+    {
+        var errors = new CaskValidationError[count];
+
+        for (int i = 0; i < count; i++)
+        {
+            errors[i] = (CaskValidationError)ReadByte(ref reader);
+        }
+
+        return errors;
+    }
+
+    private static CaskKeyFingerprint?[] ReadFingerprints(ref CaskIpcFrameReader reader, int count, object? state)
+    {
+        var fingerprints = new CaskKeyFingerprint?[count];
+
+        for (int i = 0; i < count; i++)
+        {
+            bool valid = ReadByte(ref reader) != 0;
+
+            if (!reader.TryReadBytes(CaskKeyFingerprint.SizeInBytes, out ReadOnlySpan<byte> bytes))
+            {
+                throw new InvalidDataException("The server sent a truncated response.");
+            }
+
+            fingerprints[i] = valid ? CaskKeyFingerprint.Read(bytes) : null;
+        }
+
+        return fingerprints;
+    }
+
+    private static IReadOnlyList<CaskMatch>[] ReadMatches(ref CaskIpcFrameReader reader, int count, object? state)
+    {
+        var textsUtf8 = (IReadOnlyList<ReadOnlyMemory<byte>>)state!;
+        var matches = new IReadOnlyList<CaskMatch>[count];
+
+        for (int i = 0; i < count; i++)
+        {
+            uint matchCount = ReadUInt32(ref reader);
+            if (matchCount == 0)
+            {
+                matches[i] = [];
+                continue;
+            }
+
+            var textMatches = new List<CaskMatch>((int)Math.Min(matchCount, 1024));
+            ReadOnlySpan<byte> text = textsUtf8[i].Span;
+
+            for (uint j = 0; j < matchCount; j++)
+            {
+                uint offset = ReadUInt32(ref reader);
+                uint length = ReadUInt32(ref reader);
+
+                if ((ulong)offset + length > (ulong)text.Length ||
+                    !CaskKey.TryCreateUtf8(text.Slice((int)offset, (int)length), out CaskKey key))
+                {
+                    throw new InvalidDataException("The server sent a match that is not a key.");
+                }
+
+                textMatches.Add(new CaskMatch(offset, key));
+            }
+
+            matches[i] = textMatches;
+        }
+
+        return matches;
+    }
+
+    private static byte ReadByte(ref CaskIpcFrameReader reader)
+    {
+        return reader.TryReadByte(out byte value) ? value : throw new InvalidDataException("The server sent a truncated response.");
+    }
+
+    private static uint ReadUInt32(ref CaskIpcFrameReader reader)
+    {
+        return reader.TryReadUInt32(out uint value) ? value : throw new InvalidDataException("The server sent a truncated response.");
+    }
+
+    private abstract class PendingRequest(CaskIpcOperation operation, int count)
+    {
+        public uint RequestId { get; set; }
+
+        public CaskIpcOperation Operation { get; } = operation;
+
+        public int Count { get; } = count;
+
+        public abstract void Complete(ref CaskIpcFrameReader reader);
+
+        public abstract void Fail(Exception exception);
+    }
+
+    private sealed class PendingRequest<T>(CaskIpcOperation operation, int count, ResultReader<T> readResults, object? state)
+        : PendingRequest(operation, count)
+    {
+        private readonly TaskCompletionSource<T> _completion = new(TaskCreationOptions.RunContinuationsAsynchronously);
+
+        public Task<T> Task => _completion.Task;
+
+        public override void Complete(ref CaskIpcFrameReader reader)
+        {
+            _completion.TrySetResult(readResults(ref reader, Count, state));
+        }
+
+        public override void Fail(Exception exception)
+        {
+            _completion.TrySetException(exception);
+        }
+    }
+}
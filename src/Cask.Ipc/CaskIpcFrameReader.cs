@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+
+namespace CommonAnnotatedSecurityKeys.Ipc;
+
+/// <summary>
+/// Reads the fields of a frame without its length prefix, failing instead of
+/// reading past its end.
+/// </summary>
+internal ref struct CaskIpcFrameReader
+{
+    private ReadOnlySpan<byte> _remaining;
+
+    public CaskIpcFrameReader(ReadOnlySpan<byte> frame)
+    {
+        _remaining = frame;
+    }
+
+    public readonly bool IsEmpty => _remaining.IsEmpty;
+
+    public bool TryReadByte(out byte value)
+    {
+        if (_remaining.IsEmpty)
+        {
+            value = 0;
+            return false;
+        }
+
+        value = _remaining[0];
+        _remaining = _remaining[1..];
+        return true;
+    }
+
+    public bool TryReadUInt32(out uint value)
+    {
+        if (!BinaryPrimitives.TryReadUInt32LittleEndian(_remaining, out value))
+        {
+            return false;
+        }
+
+        _remaining = _remaining[4..];
+        return true;
+    }
+
+    public bool TryReadBytes(int length, out ReadOnlySpan<byte> value)
+    {
+        if ((uint)length > (uint)_remaining.Length)
+        {
+            value = default;
+            return false;
+        }
+
+        value = _remaining[..length];
+        _remaining = _remaining[length..];
+        return true;
+    }
+
+    /// <summary>
+    /// Reads an item, which is a 32-bit length followed by that many bytes.
+    /// </summary>
+    public bool TryReadItem(out ReadOnlySpan<byte> item)
+    {
+        if (!TryReadUInt32(out uint length) || length > int.MaxValue)
+        {
+            item = default;
+            return false;
+        }
+
+        return TryReadBytes((int)length, out item);
+    }
+}
@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+using System.Diagnostics;
+
+namespace CommonAnnotatedSecurityKeys.Ipc;
+
+/// <summary>
+/// Writes frames to a growable buffer, so that several responses can be sent
+/// in one write.
+/// </summary>
+internal sealed class CaskIpcFrameWriter
+{
+    private byte[] _buffer;
+    private int _length;
+    private int _frameStart = -1;
+
+    public CaskIpcFrameWriter(int initialCapacity)
+    {
+        _buffer = new byte[initialCapacity];
+    }
+
+    public int Length => _length;
+
+    /// <summary>
+    /// The length of the frame started by <see cref="BeginFrame"/> so far,
+    /// without its length prefix.
+    /// </summary>
+    public int FrameLength => _length - _frameStart - CaskIpcProtocol.LengthPrefixLength;
+
+    public ReadOnlyMemory<byte> WrittenMemory => _buffer.AsMemory(0, _length);
+
+    public void Reset()
+    {
+        _length = 0;
+        _frameStart = -1;
+    }
+
+    /// <summary>
+    /// Starts a frame whose length is filled in by <see cref="EndFrame"/>.
+    /// </summary>
+    public void BeginFrame(uint requestId, byte operationOrStatus, int count)
+    {
+        Debug.Assert(_frameStart < 0);
+        _frameStart = _length;
+        WriteUInt32(0);
+        WriteUInt32(requestId);
+        WriteByte(operationOrStatus);
+        WriteUInt32((uint)count);
+    }
+
+    /// <summary>
+    /// Discards what was written since <see cref="BeginFrame"/>.
+    /// </summary>
+    public void CancelFrame()
+    {
+        Debug.Assert(_frameStart >= 0);
+        _length = _frameStart;
+        _frameStart = -1;
+    }
+
+    /// <exception cref="InvalidOperationException">
+    /// The frame is longer than <see cref="CaskIpcProtocol.MaxFrameLength"/>.
+    /// </exception>
+    public void EndFrame()
+    {
+        Debug.Assert(_frameStart >= 0);
+        int frameLength = FrameLength;
+
+        if (frameLength > CaskIpcProtocol.MaxFrameLength)
+        {
+            CancelFrame();
+            throw new InvalidOperationException($"The frame length {frameLength} exceeds the maximum of {CaskIpcProtocol.MaxFrameLength}.");
+        }
+
+        BinaryPrimitives.WriteUInt32LittleEndian(_buffer.AsSpan(_frameStart), (uint)frameLength);
+        _frameStart = -1;
+    }
+
+    public void WriteByte(byte value)
+    {
+        GetSpan(1)[0] = value;
+        _length++;
+    }
+
+    public void WriteUInt32(uint value)
+    {
+        BinaryPrimitives.WriteUInt32LittleEndian(GetSpan(4), value);
+        _length += 4;
+    }
+
+    public void WriteBytes(ReadOnlySpan<byte> value)
+    {
+        value.CopyTo(GetSpan(value.Length));
+        _length += value.Length;
+    }
+
+    /// <summary>
+    /// Gets space for the given number of bytes, which must be written
+    /// before <see cref="Advance"/> is called.
+    /// </summary>
+    public Span<byte> GetSpan(int length)
+    {
+        if (_buffer.Length - _length < length)
+        {
+            Array.Resize(ref _buffer, Math.Max(_buffer.Length * 2, _length + length));
+        }
+
+        return _buffer.AsSpan(_length, length);
+    }
+
+    public void Advance(int length)
+    {
+        _length += length;
+    }
+}
@@ -0,0 +1,29 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.Ipc;
+
+/// <summary>
+/// The operations of a <see cref="CaskIpcServer"/>, each applied to every
+/// item of a batch.
+/// </summary>
+internal enum CaskIpcOperation : byte
+{
+    /// <summary>
+    /// Validates each item as a UTF-8 key and returns its
+    /// <see cref="CaskValidationError"/>.
+    /// </summary>
+    Validate = 1,
+
+    /// <summary>
+    /// Validates each item as a UTF-8 key and returns its
+    /// <see cref="CaskKeyFingerprint"/>.
+    /// </summary>
+    Fingerprint = 2,
+
+    /// <summary>
+    /// Scans each item as UTF-8 text and returns the offset and length of
+    /// each key that it contains.
+    /// </summary>
+    Scan = 3,
+}
@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+
+namespace CommonAnnotatedSecurityKeys.Ipc;
+
+/// <summary>
+/// The framing of requests and responses between <see cref="CaskIpcClient"/>
+/// and <see cref="CaskIpcServer"/>, described in docs/CaskIpcProtocol.md.
+/// </summary>
+/// <remarks>
+/// Every frame is a little-endian 32-bit length followed by that many bytes:
+/// a 32-bit request ID, an operation or status byte, a 32-bit item count and
+/// the items. A client can send any number of requests without waiting, and
+/// the server responds to them in order.
+/// </remarks>
+internal static class CaskIpcProtocol
+{
+    /// <summary>
+    /// The length of the length that precedes every frame.
+    /// </summary>
+    public const int LengthPrefixLength = 4;
+
+    /// <summary>
+    /// The length of the request ID, operation or status and item count at
+    /// the start of every frame.
+    /// </summary>
+    public const int HeaderLength = 9;
+
+    /// <summary>
+    /// The longest frame that is accepted. A longer length prefix closes the
+    /// connection, since the frames after it cannot be found.
+    /// </summary>
+    public const int MaxFrameLength = 64 * 1024 * 1024;
+
+    /// <summary>
+    /// Finds the frame at the start of the buffer.
+    /// </summary>
+    /// <returns>False if the buffer does not yet hold the whole frame.</returns>
+    /// <exception cref="InvalidDataException">
+    /// The frame is longer than <see cref="MaxFrameLength"/>.
+    /// </exception>
+    public static bool TryGetFrame(ReadOnlySpan<byte> buffer, out int frameLength)
+    {
+        if (buffer.Length < LengthPrefixLength)
+        {
+            frameLength = 0;
+            return false;
+        }
+
+        uint length = BinaryPrimitives.ReadUInt32LittleEndian(buffer);
+        if (length > MaxFrameLength)
+        {
+            throw new InvalidDataException($"The frame length {length} exceeds the maximum of {MaxFrameLength}.");
+        }
+
+        frameLength = LengthPrefixLength + (int)length;
+        return buffer.Length >= frameLength;
+    }
+
+    /// <summary>
+    /// Gets the length of the buffer needed to hold the frame at the start of
+    /// the buffer, or of its length prefix if that is not yet known.
+    /// </summary>
+    public static int GetRequiredLength(ReadOnlySpan<byte> buffer)
+    {
+        return buffer.Length < LengthPrefixLength
+            ? LengthPrefixLength
+            : LengthPrefixLength + (int)Math.Min(BinaryPrimitives.ReadUInt32LittleEndian(buffer), (uint)MaxFrameLength);
+    }
+}
@@ -0,0 +1,322 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers;
+using System.Net.Sockets;
+using System.Runtime.Versioning;
+
+namespace CommonAnnotatedSecurityKeys.Ipc;
+
+/// <summary>
+/// Validates, fingerprints and scans batches of keys and text for local
+/// processes over a Unix domain socket, so that tools in any language can use
+/// the library without starting a process for each call.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Each connection is served in order: the requests that a client has sent
+/// are processed as soon as they are received, and the responses to all of
+/// them are sent together, so that a client that sends requests without
+/// waiting for responses pays for one read and one write per group of
+/// requests rather than per request.
+/// </para>
+/// <para>
+/// The socket is created so that only its owner can connect to it: it is
+/// bound in a new directory that only the owner can enter, given mode 0600,
+/// and only then moved to its path.
+/// </para>
+/// </remarks>
+public sealed class CaskIpcServer : IDisposable
+{
+    private const int InitialBufferLength = 64 * 1024;
+
+    private readonly Socket _listener;
+    private readonly HashSet<Task> _connections = [];
+    private bool _disposed;
+
+    /// <summary>
+    /// Creates the socket at the given path, replacing any file there, and
+    /// starts listening on it.
+    /// </summary>
+    public CaskIpcServer(string socketPath)
+    {
+        ThrowIfNull(socketPath);
+
+        SocketPath = socketPath;
+        File.Delete(socketPath);
+
+        _listener = new Socket(AddressFamily.Unix, SocketType.Stream, ProtocolType.Unspecified);
+
+        try
+        {
+            if (OperatingSystem.IsWindows())
+            {
+                _listener.Bind(new UnixDomainSocketEndPoint(socketPath));
+            }
+            else
+            {
+                BindPrivately(_listener, socketPath);
+            }
+
+            _listener.Listen();
+        }
+        catch
+        {
+            _listener.Dispose();
+            throw;
+        }
+    }
+
+    /// <summary>
+    /// The path of the socket.
+    /// </summary>
+    public string SocketPath { get; }
+
+    /// <summary>
+    /// Accepts and serves connections until cancelled, then closes them.
+    /// </summary>
+    public async Task RunAsync(CancellationToken cancellationToken)
+    {
+        ObjectDisposedException.ThrowIf(_disposed, this);
+
+        try
+        {
+            while (true)
+            {
+                Socket connection = await _listener.AcceptAsync(cancellationToken).ConfigureAwait(false);
+                Task task = ServeAsync(connection, cancellationToken);
+
+                lock (_connections)
+                {
+                    _connections.Add(task);
+                }
+
+                _ = task.ContinueWith(RemoveConnection, this, CancellationToken.None, TaskContinuationOptions.ExecuteSynchronously, TaskScheduler.Default);
+            }
+        }
+        catch (OperationCanceledException) when (cancellationToken.IsCancellationRequested)
+        {
+        }
+
+        Task[] remaining;
+        lock (_connections)
+        {
+            remaining = [.. _connections];
+        }
+
+        await Task.WhenAll(remaining).ConfigureAwait(false);
+    }
+
+    /// <summary>
+    /// Stops listening and deletes the socket.
+    /// </summary>
+    public void Dispose()
+    {
+        if (!_disposed)
+        {
+            _disposed = true;
+            _listener.Dispose();
+            File.Delete(SocketPath);
+        }
+    }
+
+    /// <summary>
+    /// Binds a socket so that nobody else can connect to it at any point,
+    /// rather than setting its mode after binding it at its path.
+    /// </summary>
+    [UnsupportedOSPlatform("windows")]
+    private static void BindPrivately(Socket socket, string socketPath)
+    {
+        // A sibling of the socket, so that the socket is moved within one
+        // file system.
+        string directory = Path.Combine(Path.GetDirectoryName(Path.GetFullPath(socketPath))!, $".cask-{Guid.NewGuid():N}"[..14]);
+        Directory.CreateDirectory(directory, UnixFileMode.UserRead | UnixFileMode.UserWrite | UnixFileMode.UserExecute);
+
+        try
+        {
+            string path = Path.Combine(directory, "s");
+            socket.Bind(new UnixDomainSocketEndPoint(path));
+            File.SetUnixFileMode(path, UnixFileMode.UserRead | UnixFileMode.UserWrite);
+            File.Move(path, socketPath, overwrite: true);
+        }
+        finally
+        {
+            Directory.Delete(directory, recursive: true);
+        }
+    }
+
+    private static void RemoveConnection(Task task, object? state)
+    {
+        HashSet<Task> connections = ((CaskIpcServer)state!)._connections;
+
+        lock (connections)
+        {
+            connections.Remove(task);
+        }
+    }
+
+    private static async Task ServeAsync(Socket socket, CancellationToken cancellationToken)
+    {
+        await Task.Yield();
+
+        byte[] input = ArrayPool<byte>.Shared.Rent(InitialBufferLength);
+        var output = new CaskIpcFrameWriter(InitialBufferLength);
+        var matches = new List<CaskMatch>();
+        int start = 0;
+        int end = 0;
+
+        try
+        {
+            using var stream = new NetworkStream(socket, ownsSocket: true);
+
+            while (true)
+            {
+                while (CaskIpcProtocol.TryGetFrame(input.AsSpan(start, end - start), out int frameLength))
+                {
+                    ProcessRequest(input.AsSpan(start + CaskIpcProtocol.LengthPrefixLength, frameLength - CaskIpcProtocol.LengthPrefixLength), output, matches);
+                    start += frameLength;
+                }
+
+                // Respond to everything that was received before waiting for
+                // more.
+                if (output.Length > 0)
+                {
+                    await stream.WriteAsync(output.WrittenMemory, cancellationToken).ConfigureAwait(false);
+                    output.Reset();
+                }
+
+                if (start == end)
+                {
+                    start = 0;
+                    end = 0;
+                }
+
+                int required = CaskIpcProtocol.GetRequiredLength(input.AsSpan(start, end - start));
+                if (required > input.Length - start)
+                {
+                    byte[] larger = required > input.Length ? ArrayPool<byte>.Shared.Rent(required) : input;
+                    input.AsSpan(start, end - start).CopyTo(larger);
+
+                    if (larger != input)
+                    {
+                        ArrayPool<byte>.Shared.Return(input);
+                        input = larger;
+                    }
+
+                    end -= start;
+                    start = 0;
+                }
+
+                int read = await stream.ReadAsync(input.AsMemory(end), cancellationToken).ConfigureAwait(false);
+                if (read == 0)
+                {
+                    return;
+                }
+
+                end += read;
+            }
+        }
+        catch (Exception e) when (e is IOException or SocketException or InvalidDataException or OperationCanceledException)
+        {
+            // The client disconnected, sent a frame that is too long, or the
+            // server is stopping.
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(input);
+        }
+    }
+
+    /// <summary>
+    /// Processes a request frame without its length prefix and writes the
+    /// response frame.
+    /// </summary>
+    internal static void ProcessRequest(ReadOnlySpan<byte> frame, CaskIpcFrameWriter output, List<CaskMatch> matches)
+    {
+        var reader = new CaskIpcFrameReader(frame);
+
+        if (!reader.TryReadUInt32(out uint requestId) ||
+            !reader.TryReadByte(out byte operation) ||
+            !reader.TryReadUInt32(out uint count) ||
+            count > (uint)frame.Length)
+        {
+            WriteError(output, requestId, CaskIpcStatus.MalformedRequest);
+            return;
+        }
+
+        if (operation is < (byte)CaskIpcOperation.Validate or > (byte)CaskIpcOperation.Scan)
+        {
+            WriteError(output, requestId, CaskIpcStatus.UnknownOperation);
+            return;
+        }
+
+        output.BeginFrame(requestId, (byte)CaskIpcStatus.Success, (int)count);
+
+        for (uint i = 0; i < count; i++)
+        {
+            if (!reader.TryReadItem(out ReadOnlySpan<byte> item))
+            {
+                output.CancelFrame();
+                WriteError(output, requestId, CaskIpcStatus.MalformedRequest);
+                return;
+            }
+
+            switch ((CaskIpcOperation)operation)
+            {
+                case CaskIpcOperation.Validate:
+                {
+                    output.WriteByte((byte)Cask.ValidateUtf8(item, out _));
+                    break;
+                }
+
+                case CaskIpcOperation.Fingerprint:
+                {
+                    bool valid = CaskKeyFingerprint.TryCreateUtf8(item, out CaskKeyFingerprint fingerprint);
+                    output.WriteByte(valid ? (byte)1 : (byte)0);
+                    fingerprint.WriteTo(output.GetSpan(CaskKeyFingerprint.SizeInBytes));
+                    output.Advance(CaskKeyFingerprint.SizeInBytes);
+                    break;
+                }
+
+                case CaskIpcOperation.Scan:
+                {
+                    matches.Clear();
+                    CaskScanner.ScanUtf8(item, matches);
+                    output.WriteUInt32((uint)matches.Count);
+
+                    foreach (CaskMatch match in matches)
+                    {
+                        output.WriteUInt32((uint)match.Offset);
+                        output.WriteUInt32((uint)match.Key.ToString().Length);
+                    }
+
+                    break;
+                }
+            }
+
+            // Results can be several times longer than their items, so a
+            // request within the limit can still have a response beyond it.
+            if (output.FrameLength > CaskIpcProtocol.MaxFrameLength)
+            {
+                output.CancelFrame();
+                WriteError(output, requestId, CaskIpcStatus.ResponseTooLarge);
+                return;
+            }
+        }
+
+        if (!reader.IsEmpty)
+        {
+            output.CancelFrame();
+            WriteError(output, requestId, CaskIpcStatus.MalformedRequest);
+            return;
+        }
+
+        output.EndFrame();
+    }
+
+    private static void WriteError(CaskIpcFrameWriter output, uint requestId, CaskIpcStatus status)
+    {
+        output.BeginFrame(requestId, (byte)status, count: 0);
+        output.EndFrame();
+    }
+}
@@ -0,0 +1,15 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.Ipc;
+
+/// <summary>
+/// The status of a response from a <see cref="CaskIpcServer"/>.
+/// </summary>
+internal enum CaskIpcStatus : byte
+{
+    Success = 0,
+    MalformedRequest = 1,
+    UnknownOperation = 2,
+    ResponseTooLarge = 3,
+}
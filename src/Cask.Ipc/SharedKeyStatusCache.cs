@@ -0,0 +1,542 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.IO.MemoryMappedFiles;
+using System.Numerics;
+using System.Runtime.InteropServices;
+using System.Runtime.Versioning;
+
+using Microsoft.Win32.SafeHandles;
+
+namespace CommonAnnotatedSecurityKeys.Ipc;
+
+/// <summary>
+/// Caches key statuses in a memory-mapped file shared by every process on a
+/// host, so that each hot key is looked up in the remote <see
+/// cref="IKeyStatusService"/> about once per host rather than once per
+/// process.
+/// </summary>
+/// <remarks>
+/// <para>
+/// The cache is itself an <see cref="IKeyStatusService"/> that wraps the
+/// remote one: keys found in the cache are answered from it, and the rest are
+/// looked up in one request and added to it. Wrap it in a <see
+/// cref="KeyStatusClient"/> in each process, which adds a per-process cache
+/// and batches lookups.
+/// </para>
+/// <para>
+/// The file holds a fixed-size open-addressing table of 32-byte entries,
+/// each with a fingerprint, a status and an expiry time. Each key has eight
+/// candidate entries; when they are all in use, the one closest to expiring
+/// is replaced, so the file never grows. Every entry has a sequence number
+/// that is odd while it is written: readers retry or miss if it changes
+/// while they read, and writers skip an entry that another writer holds, so
+/// no process ever waits for another, and a process that dies while writing
+/// only loses that entry. Two processes that miss the same key at the same
+/// time may both look it up.
+/// </para>
+/// <para>
+/// Entries expire by the wall clock so that they mean the same in every
+/// process. An entry that would outlive the configured time to live of its
+/// status, for example after the clock was set back, is ignored.
+/// </para>
+/// <para>
+/// Any process that can write the file can make keys appear active or
+/// revoked, so outside Windows the file is created so that only its owner
+/// can open it, and an existing file is refused unless it is owned by the
+/// effective user of the process and no other user can open it.
+/// </para>
+/// </remarks>
+public sealed partial class SharedKeyStatusCache : IKeyStatusService, IDisposable
+{
+    private const uint Magic = 0x4353_4B43; // "CKSC"
+    private const uint Version = 1;
+    private const int HeaderLength = 64;
+    private const int EntryLength = 32;
+    private const int MaxCapacity = 1 << 26;
+    private const int MaxProbes = 8;
+    private const int MaxReadAttempts = 4;
+    private const int AT_EMPTY_PATH = 0x1000;
+    private const uint STATX_UID = 0x8;
+    private const int StatxLength = 256;
+    private const int StatxUidOffset = 20;
+
+    private readonly IKeyStatusService _service;
+    private readonly TimeProvider _timeProvider;
+    private readonly long[] _timeToLive;
+    private readonly FileStream _stream;
+    private readonly MemoryMappedFile _file;
+    private readonly MemoryMappedViewAccessor _view;
+    private readonly unsafe Entry* _entries;
+    private readonly ulong _mask;
+    private bool _disposed;
+
+    /// <summary>
+    /// Opens the cache file, creating it if it does not exist.
+    /// </summary>
+    /// <param name="service">The service that looks up keys that are not in the cache.</param>
+    /// <param name="options">The options, which every process that shares the file should agree on.</param>
+    /// <exception cref="InvalidDataException">The file is not a cache of this version.</exception>
+    /// <exception cref="UnauthorizedAccessException">The file is owned by another user or other users can open it.</exception>
+    public SharedKeyStatusCache(IKeyStatusService service, SharedKeyStatusCacheOptions? options = null)
+    {
+        ThrowIfNull(service);
+        options ??= new SharedKeyStatusCacheOptions();
+
+        if (options.Capacity < 1 || options.Capacity > MaxCapacity)
+        {
+            throw new ArgumentOutOfRangeException(nameof(options), $"The capacity must be between 1 and {MaxCapacity}.");
+        }
+
+        _service = service;
+        _timeProvider = options.TimeProvider ?? TimeProvider.System;
+        _timeToLive =
+        [
+            Math.Max(0, options.UnknownTimeToLive.Ticks),
+            Math.Max(0, options.ActiveTimeToLive.Ticks),
+            Math.Max(0, options.RevokedTimeToLive.Ticks),
+        ];
+
+        var streamOptions = new FileStreamOptions
+        {
+            Mode = FileMode.OpenOrCreate,
+            Access = FileAccess.ReadWrite,
+            Share = FileShare.ReadWrite,
+        };
+
+        if (!OperatingSystem.IsWindows())
+        {
+            streamOptions.UnixCreateMode = UnixFileMode.UserRead | UnixFileMode.UserWrite;
+        }
+
+        _stream = new FileStream(options.Path, streamOptions);
+
+        try
+        {
+            if (!OperatingSystem.IsWindows())
+            {
+                CheckAccess(_stream.SafeFileHandle, GetEffectiveUserId());
+            }
+
+            uint capacity = BitOperations.RoundUpToPowerOf2((uint)options.Capacity);
+            GrowFile(HeaderLength);
+
+            // The capacity is only known once the header is mapped, so the
+            // file is mapped again if it then turns out to be too small.
+            while (true)
+            {
+                _file = MemoryMappedFile.CreateFromFile(_stream, mapName: null, capacity: 0, MemoryMappedFileAccess.ReadWrite, HandleInheritability.None, leaveOpen: true);
+                _view = _file.CreateViewAccessor(0, 0, MemoryMappedFileAccess.ReadWrite);
+
+                unsafe
+                {
+                    byte* pointer = null;
+                    _view.SafeMemoryMappedViewHandle.AcquirePointer(ref pointer);
+                    pointer += _view.PointerOffset;
+
+                    uint sharedCapacity = InitializeHeader((Header*)pointer, capacity);
+                    if (GetFileLength(sharedCapacity) <= _view.Capacity)
+                    {
+                        _entries = (Entry*)(pointer + HeaderLength);
+                        _mask = sharedCapacity - 1;
+                        break;
+                    }
+
+                    _view.SafeMemoryMappedViewHandle.ReleasePointer();
+                    _view.Dispose();
+                    _file.Dispose();
+                    GrowFile(GetFileLength(sharedCapacity));
+                }
+            }
+        }
+        catch
+        {
+            _view?.Dispose();
+            _file?.Dispose();
+            _stream.Dispose();
+            throw;
+        }
+    }
+
+    /// <summary>
+    /// The number of entries in the cache, as set by the process that
+    /// created the file.
+    /// </summary>
+    public int Capacity => (int)(_mask + 1);
+
+    public async Task<IReadOnlyList<KeyStatus>> GetStatusesAsync(IReadOnlyList<CaskKeyFingerprint> fingerprints, CancellationToken cancellationToken)
+    {
+        ThrowIfNull(fingerprints);
+
+        var statuses = new KeyStatus[fingerprints.Count];
+        List<int>? misses = null;
+
+        UseEntries(() =>
+        {
+            long now = GetNow();
+
+            for (int i = 0; i < statuses.Length; i++)
+            {
+                if (!TryGet(fingerprints[i], now, out statuses[i]))
+                {
+                    (misses ??= []).Add(i);
+                }
+            }
+        });
+
+        if (misses == null)
+        {
+            return statuses;
+        }
+
+        var missed = new CaskKeyFingerprint[misses.Count];
+        for (int i = 0; i < missed.Length; i++)
+        {
+            missed[i] = fingerprints[misses[i]];
+        }
+
+        IReadOnlyList<KeyStatus> found = await _service.GetStatusesAsync(missed, cancellationToken).ConfigureAwait(false);
+        if (found.Count != missed.Length)
+        {
+            throw new InvalidOperationException($"The key status service returned {found.Count} statuses for {missed.Length} keys.");
+        }
+
+        UseEntries(() =>
+        {
+            long now = GetNow();
+
+            for (int i = 0; i < missed.Length; i++)
+            {
+                statuses[misses[i]] = found[i];
+                Set(missed[i], found[i], now);
+            }
+        });
+
+        return statuses;
+    }
+
+    /// <summary>
+    /// Unmaps and closes the file, which other processes keep using.
+    /// </summary>
+    public void Dispose()
+    {
+        if (_disposed)
+        {
+            return;
+        }
+
+        _disposed = true;
+        _view.SafeMemoryMappedViewHandle.ReleasePointer();
+        _view.Dispose();
+        _file.Dispose();
+        _stream.Dispose();
+    }
+
+    /// <summary>
+    /// Looks up a status in the cache.
+    /// </summary>
+    internal unsafe bool TryGet(CaskKeyFingerprint fingerprint, long now, out KeyStatus status)
+    {
+        ulong high = fingerprint.High;
+        ulong low = fingerprint.Low;
+
+        for (int i = 0; i < MaxProbes; i++)
+        {
+            Entry* entry = GetEntry(high, i);
+            if (!TryRead(entry, out Entry value))
+            {
+                continue;
+            }
+
+            // Entries are never emptied, so the key is not further on.
+            if (value.IsEmpty)
+            {
+                break;
+            }
+
+            if (value.High == high && value.Low == low)
+            {
+                if (IsFresh(value, now))
+                {
+                    status = (KeyStatus)value.Status;
+                    return true;
+                }
+
+                break;
+            }
+        }
+
+        status = default;
+        return false;
+    }
+
+    /// <summary>
+    /// Adds or replaces a status in the cache, unless its time to live is
+    /// zero or its entries are all being written.
+    /// </summary>
+    internal unsafe void Set(CaskKeyFingerprint fingerprint, KeyStatus status, long now)
+    {
+        long timeToLive = (uint)status < (uint)_timeToLive.Length ? _timeToLive[(int)status] : 0;
+        if (timeToLive <= 0)
+        {
+            return;
+        }
+
+        ulong high = fingerprint.High;
+        ulong low = fingerprint.Low;
+        Entry* target = null;
+        bool targetIsFree = false;
+        long targetExpiresAt = long.MaxValue;
+
+        for (int i = 0; i < MaxProbes; i++)
+        {
+            Entry* entry = GetEntry(high, i);
+            if (!TryRead(entry, out Entry value))
+            {
+                continue;
+            }
+
+            if (value.High == high && value.Low == low)
+            {
+                target = entry;
+                break;
+            }
+
+            if (value.IsEmpty || !IsFresh(value, now))
+            {
+                if (!targetIsFree)
+                {
+                    target = entry;
+                    targetIsFree = true;
+                }
+
+                if (value.IsEmpty)
+                {
+                    break;
+                }
+            }
+            else if (!targetIsFree && value.ExpiresAt < targetExpiresAt)
+            {
+                target = entry;
+                targetExpiresAt = value.ExpiresAt;
+            }
+        }
+
+        if (target != null)
+        {
+            TryWrite(target, high, low, (int)status, now + timeToLive);
+        }
+    }
+
+    private static unsafe bool TryRead(Entry* entry, out Entry value)
+    {
+        for (int attempt = 0; attempt < MaxReadAttempts; attempt++)
+        {
+            uint sequence = Volatile.Read(ref entry->Sequence);
+            if ((sequence & 1) != 0)
+            {
+                continue;
+            }
+
+            value = default;
+            value.High = Volatile.Read(ref entry->High);
+            value.Low = Volatile.Read(ref entry->Low);
+            value.Status = Volatile.Read(ref entry->Status);
+            value.ExpiresAt = Volatile.Read(ref entry->ExpiresAt);
+
+            if (Volatile.Read(ref entry->Sequence) == sequence)
+            {
+                return true;
+            }
+        }
+
+        value = default;
+        return false;
+    }
+
+    private static unsafe void TryWrite(Entry* entry, ulong high, ulong low, int status, long expiresAt)
+    {
+        uint sequence = Volatile.Read(ref entry->Sequence);
+        if ((sequence & 1) != 0 || Interlocked.CompareExchange(ref entry->Sequence, unchecked(sequence + 1), sequence) != sequence)
+        {
+            return;
+        }
+
+        entry->High = high;
+        entry->Low = low;
+        entry->Status = status;
+        entry->ExpiresAt = expiresAt;
+        Volatile.Write(ref entry->Sequence, unchecked(sequence + 2));
+    }
+
+    private static unsafe uint InitializeHeader(Header* header, uint capacity)
+    {
+        // Every field is set by whichever process gets there first, and an
+        // all-zero table is empty, so processes can open a new file at once.
+        uint magic = Interlocked.CompareExchange(ref header->Magic, Magic, 0);
+        uint version = Interlocked.CompareExchange(ref header->Version, Version, 0);
+        uint sharedCapacity = Interlocked.CompareExchange(ref header->Capacity, capacity, 0);
+
+        if ((magic != 0 && magic != Magic) || (version != 0 && version != Version))
+        {
+            throw new InvalidDataException("The file is not a shared key status cache of a supported version.");
+        }
+
+        if (sharedCapacity == 0)
+        {
+            return capacity;
+        }
+
+        if (sharedCapacity > MaxCapacity || !BitOperations.IsPow2(sharedCapacity))
+        {
+            throw new InvalidDataException("The capacity of the shared key status cache is invalid.");
+        }
+
+        return sharedCapacity;
+    }
+
+    /// <summary>
+    /// Refuses a file that is not owned by the given user or that other users
+    /// can open.
+    /// </summary>
+    [UnsupportedOSPlatform("windows")]
+    internal static void CheckAccess(SafeFileHandle handle, uint userId)
+    {
+        UnixFileMode mode = File.GetUnixFileMode(handle);
+        if ((mode & ~(UnixFileMode.UserRead | UnixFileMode.UserWrite | UnixFileMode.UserExecute)) != 0)
+        {
+            throw new UnauthorizedAccessException("The shared key status cache file can be opened by other users.");
+        }
+
+        if (OperatingSystem.IsLinux() && TryGetOwner(handle, out uint owner))
+        {
+            if (owner != userId)
+            {
+                throw new UnauthorizedAccessException("The shared key status cache file is owned by another user.");
+            }
+
+            return;
+        }
+
+        // Without the owner, fall back on only the owner, or a privileged
+        // process, being allowed to change the mode of a file: setting the
+        // mode it already has checks the owner without changing the file.
+        try
+        {
+            File.SetUnixFileMode(handle, mode);
+        }
+        catch (UnauthorizedAccessException e)
+        {
+            throw new UnauthorizedAccessException("The shared key status cache file is owned by another user.", e);
+        }
+    }
+
+    // Unlike struct stat, struct statx has the same layout on every
+    // architecture.
+    private static unsafe bool TryGetOwner(SafeFileHandle handle, out uint owner)
+    {
+        byte* buffer = stackalloc byte[StatxLength];
+        bool added = false;
+
+        try
+        {
+            handle.DangerousAddRef(ref added);
+
+            if (Statx((int)handle.DangerousGetHandle(), "", AT_EMPTY_PATH, STATX_UID, buffer) != 0 ||
+                (*(uint*)buffer & STATX_UID) == 0)
+            {
+                owner = 0;
+                return false;
+            }
+        }
+        finally
+        {
+            if (added)
+            {
+                handle.DangerousRelease();
+            }
+        }
+
+        owner = *(uint*)(buffer + StatxUidOffset);
+        return true;
+    }
+
+    private static long GetFileLength(uint capacity)
+    {
+        return HeaderLength + ((long)capacity * EntryLength);
+    }
+
+    private void GrowFile(long length)
+    {
+        if (_stream.Length < length)
+        {
+            _stream.SetLength(length);
+        }
+    }
+
+    private unsafe Entry* GetEntry(ulong high, int probe)
+    {
+        return _entries + (unchecked(high + (ulong)probe) & _mask);
+    }
+
+    private bool IsFresh(in Entry entry, long now)
+    {
+        long remaining = entry.ExpiresAt - now;
+        return (uint)entry.Status < (uint)_timeToLive.Length && remaining > 0 && remaining <= _timeToLive[entry.Status];
+    }
+
+    private long GetNow()
+    {
+        return _timeProvider.GetUtcNow().UtcTicks;
+    }
+
+    /// <summary>
+    /// Keeps the file mapped while the entries are used, even if the cache is
+    /// disposed on another thread.
+    /// </summary>
+    private void UseEntries(Action use)
+    {
+        bool added = false;
+
+        try
+        {
+            _view.SafeMemoryMappedViewHandle.DangerousAddRef(ref added);
+            use();
+        }
+        finally
+        {
+            if (added)
+            {
+                _view.SafeMemoryMappedViewHandle.DangerousRelease();
+            }
+        }
+    }
+
+    [LibraryImport("libc", EntryPoint = "geteuid")]
+    [DefaultDllImportSearchPaths(DllImportSearchPath.SafeDirectories)]
+    private static partial uint GetEffectiveUserId();
+
+    [LibraryImport("libc", EntryPoint = "statx", StringMarshalling = StringMarshalling.Utf8)]
+    [DefaultDllImportSearchPaths(DllImportSearchPath.SafeDirectories)]
+    private static unsafe partial int Statx(int directory, string path, int flags, uint mask, byte* buffer);
+
+    [StructLayout(LayoutKind.Sequential)]
+    private struct Header
+    {
+        public uint Magic;
+        public uint Version;
+        public uint Capacity;
+    }
+
+    [StructLayout(LayoutKind.Explicit, Size = EntryLength)]
+    private struct Entry
+    {
+        [FieldOffset(0)] public uint Sequence;
+        [FieldOffset(4)] public int Status;
+        [FieldOffset(8)] public ulong High;
+        [FieldOffset(16)] public ulong Low;
+        [FieldOffset(24)] public long ExpiresAt;
+
+        public readonly bool IsEmpty => High == 0 && Low == 0;
+    }
+}
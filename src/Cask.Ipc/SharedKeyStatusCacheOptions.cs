@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys.Ipc;
+
+/// <summary>
+/// Options for <see cref="SharedKeyStatusCache"/>. Every process that shares
+/// a cache should use the same options.
+/// </summary>
+public sealed class SharedKeyStatusCacheOptions
+{
+    /// <summary>
+    /// The path of the file that holds the cache, which should be in a
+    /// directory that only its user can write. Defaults to
+    /// <c>cask-key-status</c> in <c>$XDG_RUNTIME_DIR</c> on Linux, or to
+    /// <c>/dev/shm/cask-key-status-</c> followed by the user name if that is
+    /// not set, both of which are in memory, and to
+    /// <c>cask-key-status-</c> followed by the user name in the temporary
+    /// directory elsewhere. Processes of different users do not share a
+    /// cache.
+    /// </summary>
+    public string Path { get; set; } = GetDefaultPath();
+
+    /// <summary>
+    /// The number of entries in the cache, rounded up to a power of two. Each
+    /// entry takes 32 bytes. The process that creates the file sets its size,
+    /// and other processes use that size. Defaults to 131,072.
+    /// </summary>
+    public int Capacity { get; set; } = 128 * 1024;
+
+    /// <summary>
+    /// How long an active status is cached, which bounds how long a revoked
+    /// key can still be reported as active. Defaults to 1 minute.
+    /// </summary>
+    public TimeSpan ActiveTimeToLive { get; set; } = TimeSpan.FromMinutes(1);
+
+    /// <summary>
+    /// How long a revoked status is cached. Defaults to 1 hour.
+    /// </summary>
+    public TimeSpan RevokedTimeToLive { get; set; } = TimeSpan.FromHours(1);
+
+    /// <summary>
+    /// How long an unknown status is cached. Defaults to 10 seconds.
+    /// </summary>
+    public TimeSpan UnknownTimeToLive { get; set; } = TimeSpan.FromSeconds(10);
+
+    /// <summary>
+    /// The clock used to expire entries. Entries are stamped with the wall
+    /// clock so that they mean the same in every process. Defaults to <see
+    /// cref="TimeProvider.System"/>.
+    /// </summary>
+    public TimeProvider TimeProvider { get; set; } = TimeProvider.System;
+
+    private static string GetDefaultPath()
+    {
+        if (OperatingSystem.IsLinux())
+        {
+            string? runtimeDirectory = Environment.GetEnvironmentVariable("XDG_RUNTIME_DIR");
+            if (!string.IsNullOrEmpty(runtimeDirectory))
+            {
+                return System.IO.Path.Combine(runtimeDirectory, "cask-key-status");
+            }
+
+            return $"/dev/shm/cask-key-status-{Environment.UserName}";
+        }
+
+        return System.IO.Path.Combine(System.IO.Path.GetTempPath(), $"cask-key-status-{Environment.UserName}");
+    }
+}
@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// A directory of buckets on the leading bits of sorted 64-bit keys, which
+/// narrows a search of the keys to the few in one bucket.
+/// </summary>
+/// <remarks>
+/// Entry b of a directory of 2^bits buckets is the index of the first key
+/// whose leading bits are at least b, and an extra last entry is the number
+/// of keys, so bucket b holds the keys from entry b up to entry b + 1. Sized
+/// to about one key per bucket, a lookup reads two entries and searches a
+/// handful of keys however many there are. Keys of fewer than 64 bits are
+/// shifted to the top.
+/// </remarks>
+internal readonly struct BucketDirectory
+{
+    private readonly int[] _starts;
+    private readonly int _bucketBits;
+
+    /// <param name="count">The number of keys.</param>
+    /// <param name="maxBucketBits">The most bits to bucket on, which bounds the size of the directory.</param>
+    /// <param name="getKey">Gets the key at an index. Keys must be in ascending order.</param>
+    public BucketDirectory(int count, int maxBucketBits, Func<int, ulong> getKey)
+    {
+        _bucketBits = GetBucketBits(count, maxBucketBits);
+        _starts = new int[(1 << _bucketBits) + 1];
+        Fill(_starts, count, _bucketBits, getKey);
+    }
+
+    /// <summary>
+    /// Gets the range of indexes of the keys in the bucket of a key.
+    /// </summary>
+    public void GetRange(ulong key, out int start, out int end)
+    {
+        int bucket = GetBucket(key, _bucketBits);
+        start = _starts[bucket];
+        end = _starts[bucket + 1];
+    }
+
+    /// <summary>
+    /// Chooses about one bucket per key: the most bits, up to the maximum,
+    /// that give no more buckets than keys.
+    /// </summary>
+    public static int GetBucketBits(long count, int maxBucketBits)
+    {
+        int bits = 0;
+        while (bits < maxBucketBits && (2L << bits) <= count)
+        {
+            bits++;
+        }
+
+        return bits;
+    }
+
+    public static int GetBucket(ulong key, int bucketBits)
+    {
+        // Shift counts are taken modulo 64, so this shifts in two steps for
+        // the single bucket of a directory with no bits.
+        return (int)((key >> 1) >> (63 - bucketBits));
+    }
+
+    /// <summary>
+    /// Fills in the entries of a directory of 2^<paramref name="bucketBits"/>
+    /// buckets.
+    /// </summary>
+    public static void Fill(Span<int> starts, int count, int bucketBits, Func<int, ulong> getKey)
+    {
+        int index = 0;
+
+        for (int bucket = 0; bucket < starts.Length - 1; bucket++)
+        {
+            while (index < count && GetBucket(getKey(index), bucketBits) < bucket)
+            {
+                index++;
+            }
+
+            starts[bucket] = index;
+        }
+
+        starts[starts.Length - 1] = count;
+    }
+}
@@ -28,9 +28,119 @@ public static class Cask
     /// </summary>
     public static bool IsCask(ReadOnlySpan<char> encodedKey)
     {
+        return Validate(encodedKey, out _) == CaskValidationError.None;
+    }
+
+    /// <summary>
+    /// Validates that the provided UTF8-encoded text represents a valid
+    /// base64url-encoded CASK key.
+    /// </summary>
+    public static bool IsCaskUtf8(ReadOnlySpan<byte> encodedKey)
+    {
+        return ValidateUtf8(encodedKey, out _) == CaskValidationError.None;
+    }
+
+    /// <summary>
+    /// Validates that the provided byte sequence represents a valid Cask key in binary decoded form.
+    /// </summary>
+    public static bool IsCaskBytes(ReadOnlySpan<byte> decodedKey)
+    {
+        return ValidateBytes(decodedKey, out _) == CaskValidationError.None;
+    }
+
+    /// <summary>
+    /// Validates that the provided string is a valid Cask key in URL-safe
+    /// base64-encoded form and returns the reason it is not.
+    /// </summary>
+    /// <param name="key">The key to validate.</param>
+    /// <param name="errorOffset">
+    /// The offset in characters of the first character that encodes the
+    /// invalid data, or zero if the key is valid or has an invalid length.
+    /// </param>
+    public static CaskValidationError Validate(string key, out int errorOffset)
+    {
+        ThrowIfNull(key);
+        return Validate(key.AsSpan(), out errorOffset);
+    }
+
+    /// <summary>
+    /// Validates that the provided UTF16-encoded text represents a valid
+    /// base64url-encoded CASK key and returns the reason it is not.
+    /// </summary>
+    /// <param name="encodedKey">The key to validate.</param>
+    /// <param name="errorOffset">
+    /// The offset in characters of the first character that encodes the
+    /// invalid data, or zero if the key is valid or has an invalid length.
+    /// </param>
+    public static CaskValidationError Validate(ReadOnlySpan<char> encodedKey, out int errorOffset)
+    {
+        CaskValidationError error = ValidateCore(encodedKey, out errorOffset);
+        CaskTelemetry.RecordValidation(error, errorOffset, encodedKey.Length);
+
+        if (CaskShadowValidation.ShouldSample())
+        {
+            CaskShadowValidation.Check(encodedKey, error);
+        }
+
+        return error;
+    }
+
+    /// <summary>
+    /// Validates that the provided UTF8-encoded text represents a valid
+    /// base64url-encoded CASK key and returns the reason it is not.
+    /// </summary>
+    /// <param name="encodedKey">The key to validate.</param>
+    /// <param name="errorOffset">
+    /// The offset in bytes of the first UTF8 character that encodes the
+    /// invalid data, or zero if the key is valid or has an invalid length.
+    /// </param>
+    public static CaskValidationError ValidateUtf8(ReadOnlySpan<byte> encodedKey, out int errorOffset)
+    {
+        CaskValidationError error = ValidateUtf8Core(encodedKey, out errorOffset);
+        CaskTelemetry.RecordValidation(error, errorOffset, encodedKey.Length);
+
+        if (CaskShadowValidation.ShouldSample())
+        {
+            CaskShadowValidation.CheckUtf8(encodedKey, error);
+        }
+
+        return error;
+    }
+
+    /// <summary>
+    /// Validates that the provided byte sequence represents a valid Cask key
+    /// in binary decoded form and returns the reason it is not.
+    /// </summary>
+    /// <param name="decodedKey">The key to validate.</param>
+    /// <param name="errorOffset">
+    /// The offset of the first byte that holds the invalid data, or zero if the
+    /// key is valid or has an invalid length.
+    /// </param>
+    public static CaskValidationError ValidateBytes(ReadOnlySpan<byte> decodedKey, out int errorOffset)
+    {
+        CaskValidationError error = ValidateBytesCore(decodedKey, out int errorBitOffset);
+        errorOffset = errorBitOffset / 8;
+        CaskTelemetry.RecordValidation(error, errorOffset, decodedKey.Length);
+
+        if (CaskShadowValidation.ShouldSample())
+        {
+            CaskShadowValidation.CheckBytes(decodedKey, error);
+        }
+
+        return error;
+    }
+
+    // The *Core methods below do the actual validation. They are not
+    // instrumented so that a key is only counted once, by the public entry
+    // point that was called, no matter how many of them it passes through.
+
+    internal static CaskValidationError ValidateCore(ReadOnlySpan<char> encodedKey, out int errorOffset)
+    {
+        errorOffset = 0;
+
         if (!IsValidKeyLengthInChars(encodedKey.Length))
         {
-            return false;
+            return CaskValidationError.InvalidLength;
         }
 
         Range caskSignatureCharRange = ComputeCaskSignatureCharRange(encodedKey.Length, out SecretSize _);
@@ -38,7 +148,8 @@ public static class Cask
         // Check for CASK signature, "QJJQ".
         if (!encodedKey[caskSignatureCharRange].SequenceEqual(CaskSignature))
         {
-            return false;
+            errorOffset = caskSignatureCharRange.Start.Value;
+            return CaskValidationError.InvalidCaskSignature;
         }
 
         int lengthInBytes = Base64CharsToBytes(encodedKey.Length);
@@ -58,21 +169,23 @@ public static class Cask
         //       input has padding or whitespace, which we don't allow.
         if (status != OperationStatus.Done || bytesWritten != lengthInBytes)
         {
-            return false;
+            int searchStart = status == OperationStatus.InvalidData ? charsConsumed : 0;
+            errorOffset = searchStart + IndexOfInvalidBase64Url(encodedKey[searchStart..]);
+            return CaskValidationError.InvalidCharacter;
         }
 
-        return IsCaskBytes(keyBytes);
+        CaskValidationError error = ValidateBytesCore(keyBytes, out int errorBitOffset);
+        errorOffset = errorBitOffset / 6;
+        return error;
     }
 
-    /// <summary>
-    /// Validates that the provided UTF8-encoded text represents a valid
-    /// base64url-encoded CASK key.
-    /// </summary>
-    public static bool IsCaskUtf8(ReadOnlySpan<byte> encodedKey)
+    internal static CaskValidationError ValidateUtf8Core(ReadOnlySpan<byte> encodedKey, out int errorOffset)
     {
+        errorOffset = 0;
+
         if (!IsValidKeyLengthInChars(encodedKey.Length))
         {
-            return false;
+            return CaskValidationError.InvalidLength;
         }
 
         Range caskSignatureCharRange = ComputeCaskSignatureCharRange(encodedKey.Length, out SecretSize _);
@@ -80,7 +193,8 @@ public static class Cask
         // Check for CASK signature, "QJJQ".
         if (!encodedKey[caskSignatureCharRange].SequenceEqual(CaskSignatureUtf8))
         {
-            return false;
+            errorOffset = caskSignatureCharRange.Start.Value;
+            return CaskValidationError.InvalidCaskSignature;
         }
 
         int lengthInBytes = Base64CharsToBytes(encodedKey.Length);
@@ -100,31 +214,42 @@ public static class Cask
         //       input has padding or whitespace, which we don't allow.
         if (status != OperationStatus.Done || bytesWritten != lengthInBytes)
         {
-            return false;
+            int searchStart = status == OperationStatus.InvalidData ? charsConsumed : 0;
+            errorOffset = searchStart + IndexOfInvalidBase64Url(encodedKey[searchStart..]);
+            return CaskValidationError.InvalidCharacter;
         }
 
-        return IsCaskBytes(keyBytes);
+        // All characters are ASCII at this point, so character offsets
+        // computed by the bytewise validation are also UTF8 byte offsets.
+        CaskValidationError error = ValidateBytesCore(keyBytes, out int errorBitOffset);
+        errorOffset = errorBitOffset / 6;
+        return error;
     }
 
     /// <summary>
-    /// Validates that the provided byte sequence represents a valid Cask key in binary decoded form.
+    /// Validates a decoded key. The error offset is returned in bits so that
+    /// callers can convert it exactly to either a byte offset (divide by 8) or
+    /// to an offset into the base64url-encoded form (divide by 6).
     /// </summary>
-    public static bool IsCaskBytes(ReadOnlySpan<byte> decodedKey)
+    internal static CaskValidationError ValidateBytesCore(ReadOnlySpan<byte> decodedKey, out int errorBitOffset)
     {
+        errorBitOffset = 0;
+
         if (!IsValidKeyLengthInBytes(decodedKey.Length))
         {
-            return false;
+            return CaskValidationError.InvalidLength;
         }
 
         int caskSignatureByteOffset = ComputeSignatureByteOffset(decodedKey.Length, out SecretSize secretSize);
 
         int paddingBytesCount = secretSize == SecretSize.Bits256 ? 1 : 2;
 
-        for (int i = 1; i <= paddingBytesCount; i++)
+        for (int i = caskSignatureByteOffset - paddingBytesCount; i < caskSignatureByteOffset; i++)
         {
-            if (decodedKey[caskSignatureByteOffset - i] != 0)
+            if (decodedKey[i] != 0)
             {
-                return false;
+                errorBitOffset = i * 8;
+                return CaskValidationError.InvalidPadding;
             }
         }
 
@@ -133,10 +258,12 @@ public static class Cask
         // Check for CASK signature. "QJJQ" base64-decoded.
         if (!source[..CaskSignatureSizeInBytes].SequenceEqual(CaskSignatureBytes))
         {
-            return false;
+            errorBitOffset = caskSignatureByteOffset * 8;
+            return CaskValidationError.InvalidCaskSignature;
         }
         source = source[CaskSignatureSizeInBytes..];
 
+        int paddingSizesAndProviderKindBitOffset = (decodedKey.Length - source.Length) * 8;
         ReadOnlySpan<byte> paddingSizesAndProviderKindBytes = source[..PaddingSizesAndProviderKindInBytes];
         source = source[PaddingSizesAndProviderKindInBytes..];
 
@@ -146,14 +273,16 @@ public static class Cask
 
         if (paddingSizesAndProviderKindChars[0] != 'A')
         {
-            return false;
+            errorBitOffset = paddingSizesAndProviderKindBitOffset;
+            return CaskValidationError.InvalidPadding;
         }
 
         // 'A' == index 0 of all printable base64-encoded characters.
         var encodedSecretSize = (SecretSize)(paddingSizesAndProviderKindChars[1] - 'A');
         if (secretSize != encodedSecretSize)
         {
-            return false;
+            errorBitOffset = paddingSizesAndProviderKindBitOffset + 6;
+            return CaskValidationError.SecretSizeMismatch;
         }
 
         int encodedProviderDataSizeInBytes = (paddingSizesAndProviderKindChars[2] - 'A') * OptionalDataChunkSizeInBytes;
@@ -166,7 +295,8 @@ public static class Cask
         int expectedKeyLengthInBytes = paddedSecretSizeInBytes + FixedKeyComponentSizeInBytes + encodedProviderDataSizeInBytes;
         if (expectedKeyLengthInBytes != decodedKey.Length)
         {
-            return false;
+            errorBitOffset = paddingSizesAndProviderKindBitOffset + 12;
+            return CaskValidationError.ProviderDataSizeMismatch;
         }
 
         // All provider signatures are legal, so no validity check.
@@ -175,6 +305,7 @@ public static class Cask
         // Any  provider data is legal, so no validity check.
         source = source[encodedProviderDataSizeInBytes..];
 
+        int paddingAndTimestampBitOffset = (decodedKey.Length - source.Length) * 8;
         ReadOnlySpan<byte> paddingAndTimestampBytes = source[..PaddingAndTimestampSizeInBytes];
         Span<char> paddingAndTimestampChars = stackalloc char[PaddingAndTimestampSizeInChars];
         bytesWritten = Base64Url.EncodeToChars(paddingAndTimestampBytes, paddingAndTimestampChars);
@@ -182,7 +313,8 @@ public static class Cask
 
         if (paddingAndTimestampChars[0] != 'A' || paddingAndTimestampChars[1] != 'A')
         {
-            return false;
+            errorBitOffset = paddingAndTimestampBitOffset + (paddingAndTimestampChars[0] != 'A' ? 0 : 6);
+            return CaskValidationError.InvalidPadding;
         }
 
         // Any encoded year, i.e., paddingAndTimestampChars[2], is legal.
@@ -191,21 +323,24 @@ public static class Cask
         // An encoded month (a zero-indexed value) that exceeds 11 ('L') is not valid.
         if (month < 'A' || month > 'L')
         {
-            return false;
+            errorBitOffset = paddingAndTimestampBitOffset + (3 * 6);
+            return CaskValidationError.InvalidTimestamp;
         }
 
         char day = paddingAndTimestampChars[4];
         // An encoded day (a zero-indexed value) that exceeds 30 ('e') is not valid.
         if (!((day >= 'A' && day <= 'Z') || (day >= 'a' && day <= 'e')))
         {
-            return false;
+            errorBitOffset = paddingAndTimestampBitOffset + (4 * 6);
+            return CaskValidationError.InvalidTimestamp;
         }
 
         char hour = paddingAndTimestampChars[5];
         // An encoded hour (a zero-indexed value) that exceeds 23 (base64-encoded 'X') is not valid.
         if (hour < 'A' || hour > 'X')
         {
-            return false;
+            errorBitOffset = paddingAndTimestampBitOffset + (5 * 6);
+            return CaskValidationError.InvalidTimestamp;
         }
 
         char minute = paddingAndTimestampChars[6];
@@ -214,15 +349,49 @@ public static class Cask
              (minute >= 'a' && minute <= 'z') ||
              (minute >= '0' && minute <= '7')))
         {
-            return false;
+            errorBitOffset = paddingAndTimestampBitOffset + (6 * 6);
+            return CaskValidationError.InvalidTimestamp;
         }
 
         char second = paddingAndTimestampChars[7];
         // An encoded second (a zero-indexed value) that exceeds 59 ('7') is not valid.
-        return
-            (second >= 'A' && second <= 'Z') ||
-            (second >= 'a' && second <= 'z') ||
-            (second >= '0' && second <= '7');
+        if (!((second >= 'A' && second <= 'Z') ||
+              (second >= 'a' && second <= 'z') ||
+              (second >= '0' && second <= '7')))
+        {
+            errorBitOffset = paddingAndTimestampBitOffset + (7 * 6);
+            return CaskValidationError.InvalidTimestamp;
+        }
+
+        return CaskValidationError.None;
+    }
+
+    // Only called on the failure path to locate the character that caused
+    // base64url decoding to fail.
+    private static int IndexOfInvalidBase64Url(ReadOnlySpan<char> text)
+    {
+        for (int i = 0; i < text.Length; i++)
+        {
+            if (!IsValidForBase64Url(text[i]))
+            {
+                return i;
+            }
+        }
+
+        return 0;
+    }
+
+    private static int IndexOfInvalidBase64Url(ReadOnlySpan<byte> textUtf8)
+    {
+        for (int i = 0; i < textUtf8.Length; i++)
+        {
+            if (!IsValidForBase64Url((char)textUtf8[i]))
+            {
+                return i;
+            }
+        }
+
+        return 0;
     }
 
     internal static SecretSize ExtractSecretSizeFromKeyChars(ReadOnlySpan<char> key, out Range caskSignatureCharRange)
@@ -233,11 +402,57 @@ public static class Cask
         return encodedSecretSize;
     }
 
+    internal static ReadOnlySpan<char> ExtractProviderSignatureFromKeyChars(ReadOnlySpan<char> key)
+    {
+        Range caskSignatureCharRange = ComputeCaskSignatureCharRange(key.Length, out _);
+        int providerSignatureCharOffset = caskSignatureCharRange.End.Value + PaddingSizesAndProviderKindInChars;
+        return key.Slice(providerSignatureCharOffset, BytesToBase64Chars(ProviderSignatureSizeInBytes));
+    }
+
+    internal static char ExtractProviderKeyKindFromKeyChars(ReadOnlySpan<char> key)
+    {
+        Range caskSignatureCharRange = ComputeCaskSignatureCharRange(key.Length, out _);
+        return key[caskSignatureCharRange.End.Value + 3];
+    }
+
+    /// <summary>
+    /// Reads the allocation timestamp of a key that has already been
+    /// validated. A day past the end of its month, which validation allows,
+    /// rolls over into the next month.
+    /// </summary>
+    internal static DateTimeOffset ExtractTimestampFromKeyChars(ReadOnlySpan<char> key)
+    {
+        Range caskSignatureCharRange = ComputeCaskSignatureCharRange(key.Length, out _);
+        int providerDataSizeCharOffset = caskSignatureCharRange.End.Value + 2;
+        int providerDataLengthInChars = (key[providerDataSizeCharOffset] - 'A') * BytesToBase64Chars(OptionalDataChunkSizeInBytes);
+
+        // Skip the padding, sizes and kind, the provider signature, the
+        // provider data and the two padding characters before the timestamp.
+        int timestampCharOffset = caskSignatureCharRange.End.Value +
+                                  PaddingSizesAndProviderKindInChars +
+                                  BytesToBase64Chars(ProviderSignatureSizeInBytes) +
+                                  providerDataLengthInChars +
+                                  2;
+
+        ReadOnlySpan<char> timestamp = key.Slice(timestampCharOffset, 6);
+        ReadOnlySpan<char> alphabet = Base64UrlChars.AsSpan();
+        var start = new DateTimeOffset(2025 + alphabet.IndexOf(timestamp[0]),
+                                       1 + alphabet.IndexOf(timestamp[1]),
+                                       1,
+                                       alphabet.IndexOf(timestamp[3]),
+                                       alphabet.IndexOf(timestamp[4]),
+                                       alphabet.IndexOf(timestamp[5]),
+                                       TimeSpan.Zero);
+
+        return start.AddDays(alphabet.IndexOf(timestamp[2]));
+    }
+
     public static CaskKey GenerateKey(string providerSignature,
                                       char providerKeyKind,
                                       string? providerData = null,
                                       SecretSize secretSize = SecretSize.Bits256)
     {
+        long startTimestamp = CaskTelemetry.StartGenerate();
         providerData ??= string.Empty;
 
         ValidateProviderSignature(providerSignature);
@@ -309,10 +524,168 @@ public static class Cask
         Debug.Assert(bytesWritten == PaddingAndTimestampSizeInBytes);
         destination = destination[PaddingAndTimestampSizeInBytes..];
 
-        return CaskKey.Encode(key);
+        CaskKey caskKey = CaskKey.EncodeGenerated(key);
+        CaskTelemetry.RecordGenerate(providerSignature, secretSize, startTimestamp);
+        return caskKey;
     }
 
-    private static Range ComputeCaskSignatureCharRange(int keyLengthInChars, out SecretSize secretSize)
+    /// <summary>
+    /// Generates a fresh key for each of the given keys, with the same
+    /// provider signature, provider key kind, secret size and provider data
+    /// as the key it replaces, but new entropy and the current time.
+    /// </summary>
+    /// <remarks>
+    /// This is equivalent to calling <see cref="GenerateKey"/> with the parts
+    /// of each key, but much faster for rotations of many keys: the parts are
+    /// copied as they are encoded without being parsed or validated again,
+    /// entropy is drawn in blocks of 4 KiB for many keys at a time, and every
+    /// key of a batch is stamped with the same time.
+    /// </remarks>
+    /// <param name="oldKeys">The keys to replace.</param>
+    /// <param name="freshKeys">
+    /// The destination for the fresh keys, in the same order as the keys they
+    /// replace. It must be at least as long as <paramref name="oldKeys"/>.
+    /// </param>
+    public static void Reissue(ReadOnlySpan<CaskKey> oldKeys, Span<CaskKey> freshKeys)
+    {
+        ThrowIfDestinationTooSmall(freshKeys, oldKeys.Length);
+
+        for (int i = 0; i < oldKeys.Length; i++)
+        {
+            if (!oldKeys[i].IsInitialized)
+            {
+                throw new ArgumentException($"The key at index {i} is not initialized.", nameof(oldKeys));
+            }
+        }
+
+        using var reissuer = new CaskReissuer();
+
+        for (int i = 0; i < oldKeys.Length; i++)
+        {
+            freshKeys[i] = reissuer.Reissue(oldKeys[i]);
+        }
+    }
+
+    /// <summary>
+    /// Reissues, as <see cref="Reissue(ReadOnlySpan{CaskKey}, Span{CaskKey})"/>
+    /// does, a batch of keys in UTF-8 text with one key per line.
+    /// </summary>
+    /// <remarks>
+    /// Lines are separated by '\n' and may end with '\r'. Empty lines are
+    /// kept. A fresh key is the same length as the key it replaces, so the
+    /// fresh text is the same length as the old text, and it may be written
+    /// over the old text.
+    /// </remarks>
+    /// <param name="oldKeysUtf8">The keys to replace, one per line.</param>
+    /// <param name="freshKeysUtf8">
+    /// The destination for the fresh keys, which must be at least as long as
+    /// <paramref name="oldKeysUtf8"/>. It may be the same memory, but must
+    /// not otherwise overlap it.
+    /// </param>
+    /// <returns>The number of keys reissued.</returns>
+    /// <exception cref="FormatException">A line that is not empty is not a valid key.</exception>
+    public static int ReissueUtf8(ReadOnlySpan<byte> oldKeysUtf8, Span<byte> freshKeysUtf8)
+    {
+        ThrowIfDestinationTooSmall(freshKeysUtf8, oldKeysUtf8.Length);
+
+        Span<byte> text = freshKeysUtf8[..oldKeysUtf8.Length];
+        oldKeysUtf8.CopyTo(text);
+
+        using var reissuer = new CaskReissuer();
+        long line = 0;
+        return (int)ReissueLines(reissuer, text, ref line);
+    }
+
+    /// <summary>
+    /// Reissues, as <see cref="ReissueUtf8"/> does, the keys in UTF-8 text
+    /// read from one stream, with one key per line, and writes the fresh keys
+    /// to another.
+    /// </summary>
+    /// <remarks>
+    /// The text is processed in blocks of 64 KiB. Every key read from the
+    /// stream is stamped with the same time.
+    /// </remarks>
+    /// <param name="source">The stream of keys to replace, one per line.</param>
+    /// <param name="destination">The stream to which the fresh keys are written.</param>
+    /// <returns>The number of keys reissued.</returns>
+    /// <exception cref="FormatException">A line that is not empty is not a valid key.</exception>
+    public static long Reissue(Stream source, Stream destination)
+    {
+        ThrowIfNull(source);
+        ThrowIfNull(destination);
+
+        const int BufferSize = 64 * 1024;
+        byte[] buffer = new byte[BufferSize];
+        int length = 0;
+        long line = 0;
+        long count = 0;
+
+        using var reissuer = new CaskReissuer();
+
+        while (true)
+        {
+            int bytesRead = source.Read(buffer, length, buffer.Length - length);
+            length += bytesRead;
+
+            // Reissue the complete lines, and keep the last, partial line for
+            // the next read unless the stream has ended.
+            int end = bytesRead == 0 ? length : buffer.AsSpan(0, length).LastIndexOf((byte)'\n') + 1;
+            if (end == 0 && length == buffer.Length)
+            {
+                throw new FormatException($"Line {line + 1} is not a valid CASK key.");
+            }
+
+            count += ReissueLines(reissuer, buffer.AsSpan(0, end), ref line);
+            destination.Write(buffer, 0, end);
+
+            if (bytesRead == 0)
+            {
+                return count;
+            }
+
+            buffer.AsSpan(end, length - end).CopyTo(buffer);
+            length -= end;
+        }
+    }
+
+    /// <summary>
+    /// Reissues in place the keys in lines of text, which ends at the end of
+    /// a line or of the stream, and counts the lines that it had.
+    /// </summary>
+    private static long ReissueLines(CaskReissuer reissuer, Span<byte> text, ref long line)
+    {
+        long count = 0;
+
+        while (text.Length > 0)
+        {
+            int lineLength = text.IndexOf((byte)'\n');
+            Span<byte> key = lineLength < 0 ? text : text[..lineLength];
+            text = lineLength < 0 ? [] : text[(lineLength + 1)..];
+            line++;
+
+            if (key.Length > 0 && key[^1] == '\r')
+            {
+                key = key[..^1];
+            }
+
+            if (key.Length == 0)
+            {
+                continue;
+            }
+
+            if (ValidateUtf8Core(key, out _) != CaskValidationError.None)
+            {
+                throw new FormatException($"Line {line} is not a valid CASK key.");
+            }
+
+            reissuer.ReissueUtf8(key);
+            count++;
+        }
+
+        return count;
+    }
+
+    internal static Range ComputeCaskSignatureCharRange(int keyLengthInChars, out SecretSize secretSize)
     {
         int keyLengthInBytes = keyLengthInChars / 4 * 3;
         secretSize = InferSecretSizeFromByteLength(keyLengthInBytes);
@@ -362,7 +735,23 @@ public static class Cask
         return SecretSize.Bits256;
     }
 
-    private static void FillRandom(Span<byte> buffer)
+    internal static void FillRandom(Span<byte> buffer)
+    {
+        CaskEntropyHealthMode healthMode = CaskEntropyHealth.Mode;
+        if (healthMode != CaskEntropyHealthMode.Disabled)
+        {
+            CaskEntropyHealth.Fill(buffer, healthMode);
+            return;
+        }
+
+        FillRandomUnchecked(buffer);
+    }
+
+    /// <summary>
+    /// Fills a buffer from the random number generator, or the mock, without
+    /// health tests.
+    /// </summary>
+    internal static void FillRandomUnchecked(Span<byte> buffer)
     {
         if (t_mockedFillRandom != null)
         {
@@ -373,7 +762,7 @@ public static class Cask
         RandomNumberGenerator.Fill(buffer);
     }
 
-    private static DateTimeOffset GetUtcNow()
+    internal static DateTimeOffset GetUtcNow()
     {
         if (t_mockedGetUtcNow != null)
         {
@@ -404,7 +793,7 @@ public static class Cask
         }
     }
 
-    private static void ValidateTimestamp(DateTimeOffset now)
+    internal static void ValidateTimestamp(DateTimeOffset now)
     {
         if (now.Year < 2025 || now.Year > 2088)
         {
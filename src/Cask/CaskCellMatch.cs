@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// A CASK key found in one cell of a batch by
+/// <see cref="CaskScanner.ScanManyUtf8(ReadOnlySpan{byte}, ReadOnlySpan{int}, ICollection{CaskCellMatch})"/>.
+/// </summary>
+public readonly record struct CaskCellMatch
+{
+    internal CaskCellMatch(int cell, int offset, CaskKey key)
+    {
+        Cell = cell;
+        Offset = offset;
+        Key = key;
+        IsLikelyPlaceholder = CaskPlaceholderDetector.IsLikelyPlaceholder(key);
+    }
+
+    /// <summary>
+    /// The index of the cell that contains the key.
+    /// </summary>
+    public int Cell { get; }
+
+    /// <summary>
+    /// The offset in bytes of the first character of the key from the start
+    /// of the cell.
+    /// </summary>
+    public int Offset { get; }
+
+    /// <summary>
+    /// The key that was found.
+    /// </summary>
+    public CaskKey Key { get; }
+
+    /// <summary>
+    /// Whether the sensitive component of the key is so far from random, for
+    /// example all zeros, a repeated or counting pattern, or few distinct
+    /// characters, that the key is likely a documentation sample or test
+    /// fixture rather than a real key. About one real key in 300 million is
+    /// classified as a placeholder.
+    /// </summary>
+    public bool IsLikelyPlaceholder { get; }
+}
@@ -0,0 +1,303 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics;
+using System.Diagnostics.CodeAnalysis;
+using System.Numerics;
+using System.Runtime.InteropServices;
+using System.Security.Cryptography;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Continuous health tests on the entropy used by <see
+/// cref="Cask.GenerateKey"/>, modeled on the repetition count and adaptive
+/// proportion tests of NIST SP 800-90B, section 4.4.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Each byte of entropy is a sample. The repetition count test fails if
+/// <see cref="RepetitionCountCutoff"/> consecutive bytes are identical. The
+/// adaptive proportion test splits the entropy into windows of 512 bytes and
+/// fails if the first byte of a window occurs <see
+/// cref="AdaptiveProportionCutoff"/> or more times in the window. The
+/// default cut-offs assume 8 bits of entropy per byte and give a false
+/// positive rate of less than 2^-40 per sample. Blocks are tested
+/// independently of each other.
+/// </para>
+/// <para>
+/// The tests fail closed: when entropy fails, it is cleared, no key is
+/// generated and <see cref="Cask.GenerateKey"/> throws a <see
+/// cref="CryptographicException"/>. The next call draws new entropy. Each
+/// tested block is counted by the <c>cask.entropy.health.blocks</c> counter
+/// with a <c>cask.outcome</c> of <c>pass</c> or <c>fail</c> and a
+/// <c>cask.reason</c> naming the failed test, and each failure raises an
+/// error event from the event source named <see cref="CaskTelemetry.Name"/>.
+/// </para>
+/// <para>
+/// With <see cref="CaskEntropyHealthMode.PerCall"/>, the 32 or 64 bytes of
+/// each key are tested on their own, which detects a stuck source but is too
+/// few samples for the adaptive proportion test to detect bias. With <see
+/// cref="CaskEntropyHealthMode.Pooled"/>, each thread draws and tests 4 KiB
+/// at a time and hands it out to the keys it generates, which tests full
+/// windows and makes fewer calls to the random number generator. The cost is
+/// that up to 4 KiB of entropy for future keys is held in memory per thread.
+/// Each part of a block is cleared as it is handed out. In the other modes no
+/// entropy is drawn ahead of the key that uses it, on any platform. On .NET
+/// Framework, where each call to the random number generator is slower, this
+/// mode is also the way to draw entropy for many keys at once.
+/// </para>
+/// <para>
+/// The mode can be set with <see cref="Mode"/> or, without a code change,
+/// with the <see cref="AppContext"/> data named by <see
+/// cref="ModeConfigName"/>, for example in runtimeconfig.json.
+/// </para>
+/// </remarks>
+public static class CaskEntropyHealth
+{
+    private const string ConfigName = "CommonAnnotatedSecurityKeys.EntropyHealthMode";
+    private const int WindowSize = 512;
+    internal const int PoolSize = 4096;
+
+    private static int s_mode = (int)GetConfiguredMode();
+    private static int s_repetitionCountCutoff = 6;
+    private static int s_adaptiveProportionCutoff = 20;
+
+    // Incremented whenever the settings change so that each thread discards
+    // a pooled block that was tested with the old settings.
+    private static int s_version;
+
+    [ThreadStatic]
+    private static byte[]? t_pool;
+
+    [ThreadStatic]
+    private static int t_poolOffset;
+
+    [ThreadStatic]
+    private static int t_poolVersion;
+
+    /// <summary>
+    /// The name of the <see cref="AppContext"/> data that sets the initial
+    /// <see cref="Mode"/>, either by name or by value.
+    /// </summary>
+    public static string ModeConfigName => ConfigName;
+
+    /// <summary>
+    /// When to test entropy. Defaults to <see
+    /// cref="CaskEntropyHealthMode.Disabled"/>.
+    /// </summary>
+    public static CaskEntropyHealthMode Mode
+    {
+        get => (CaskEntropyHealthMode)s_mode;
+        set
+        {
+            if (value < CaskEntropyHealthMode.Disabled || value > CaskEntropyHealthMode.Pooled)
+            {
+                throw new ArgumentOutOfRangeException(nameof(value), value, "Invalid entropy health test mode.");
+            }
+
+            Volatile.Write(ref s_mode, (int)value);
+            Interlocked.Increment(ref s_version);
+        }
+    }
+
+    /// <summary>
+    /// The number of consecutive identical bytes that fails the repetition
+    /// count test. At least 2. Defaults to 6.
+    /// </summary>
+    public static int RepetitionCountCutoff
+    {
+        get => s_repetitionCountCutoff;
+        set
+        {
+            if (value < 2)
+            {
+                throw new ArgumentOutOfRangeException(nameof(value), value, "The cut-off must be at least 2.");
+            }
+
+            Volatile.Write(ref s_repetitionCountCutoff, value);
+            Interlocked.Increment(ref s_version);
+        }
+    }
+
+    /// <summary>
+    /// The number of occurrences of the first byte of a 512-byte window that
+    /// fails the adaptive proportion test. Between 2 and 512. Defaults to 20.
+    /// </summary>
+    public static int AdaptiveProportionCutoff
+    {
+        get => s_adaptiveProportionCutoff;
+        set
+        {
+            if (value < 2 || value > WindowSize)
+            {
+                throw new ArgumentOutOfRangeException(nameof(value), value, $"The cut-off must be between 2 and {WindowSize}.");
+            }
+
+            Volatile.Write(ref s_adaptiveProportionCutoff, value);
+            Interlocked.Increment(ref s_version);
+        }
+    }
+
+    /// <summary>
+    /// Fills a buffer with entropy that has passed the health tests in the
+    /// given mode, or throws.
+    /// </summary>
+    internal static void Fill(Span<byte> buffer, CaskEntropyHealthMode mode)
+    {
+        Debug.Assert(mode != CaskEntropyHealthMode.Disabled);
+
+        if (mode == CaskEntropyHealthMode.Pooled && buffer.Length <= PoolSize)
+        {
+            FillFromPool(buffer);
+            return;
+        }
+
+        Cask.FillRandomUnchecked(buffer);
+        Check(buffer);
+    }
+
+    /// <summary>
+    /// Runs both health tests on a block of entropy with the given cut-offs.
+    /// </summary>
+    internal static CaskEntropyHealthFailure Test(ReadOnlySpan<byte> entropy, int repetitionCountCutoff, int adaptiveProportionCutoff)
+    {
+        if (!PassesRepetitionCountTest(entropy, repetitionCountCutoff))
+        {
+            return CaskEntropyHealthFailure.RepetitionCount;
+        }
+
+        if (!PassesAdaptiveProportionTest(entropy, adaptiveProportionCutoff))
+        {
+            return CaskEntropyHealthFailure.AdaptiveProportion;
+        }
+
+        return CaskEntropyHealthFailure.None;
+    }
+
+    /// <summary>
+    /// Discards the rest of the current thread's pooled block.
+    /// </summary>
+    internal static void DiscardPool()
+    {
+        t_pool?.AsSpan().Clear();
+        t_poolOffset = PoolSize;
+    }
+
+    private static void FillFromPool(Span<byte> buffer)
+    {
+        byte[]? pool = t_pool;
+        int offset = t_poolOffset;
+        int version = Volatile.Read(ref s_version);
+
+        if (pool == null || t_poolVersion != version || PoolSize - offset < buffer.Length)
+        {
+            pool ??= t_pool = new byte[PoolSize];
+
+            // The pool stays empty unless the new block passes.
+            t_poolOffset = PoolSize;
+            t_poolVersion = version;
+
+            Cask.FillRandomUnchecked(pool);
+            Check(pool);
+            offset = 0;
+        }
+
+        Span<byte> entropy = pool.AsSpan(offset, buffer.Length);
+        entropy.CopyTo(buffer);
+        entropy.Clear();
+        t_poolOffset = offset + buffer.Length;
+    }
+
+    private static void Check(Span<byte> entropy)
+    {
+        CaskEntropyHealthFailure failure = Test(entropy, s_repetitionCountCutoff, s_adaptiveProportionCutoff);
+        CaskTelemetry.RecordEntropyHealthTest(entropy.Length, failure);
+
+        if (failure != CaskEntropyHealthFailure.None)
+        {
+            entropy.Clear();
+            ThrowHealthTestFailed(failure);
+        }
+    }
+
+    private static bool PassesRepetitionCountTest(ReadOnlySpan<byte> entropy, int cutoff)
+    {
+        Debug.Assert(cutoff >= 2);
+        int i = 0;
+
+        if (Vector.IsHardwareAccelerated)
+        {
+            // A run of `cutoff` identical bytes starts at each lane whose byte
+            // equals each of the next `cutoff - 1` bytes. For random data
+            // almost every vector is ruled out after one or two comparisons.
+            for (; i <= entropy.Length - Vector<byte>.Count - (cutoff - 1); i += Vector<byte>.Count)
+            {
+                Vector<byte> first = MemoryMarshal.Read<Vector<byte>>(entropy.Slice(i));
+                Vector<byte> run = Vector.Equals(first, MemoryMarshal.Read<Vector<byte>>(entropy.Slice(i + 1)));
+
+                for (int k = 2; k < cutoff && !Vector.EqualsAll(run, Vector<byte>.Zero); k++)
+                {
+                    run &= Vector.Equals(first, MemoryMarshal.Read<Vector<byte>>(entropy.Slice(i + k)));
+                }
+
+                if (!Vector.EqualsAll(run, Vector<byte>.Zero))
+                {
+                    return false;
+                }
+            }
+        }
+
+        // Every run that starts before `i` has been checked in full.
+        int runLength = 1;
+        for (int j = i + 1; j < entropy.Length; j++)
+        {
+            if (entropy[j] != entropy[j - 1])
+            {
+                runLength = 1;
+            }
+            else if (++runLength >= cutoff)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    private static bool PassesAdaptiveProportionTest(ReadOnlySpan<byte> entropy, int cutoff)
+    {
+        for (int start = 0; start < entropy.Length; start += WindowSize)
+        {
+            ReadOnlySpan<byte> window = entropy.Slice(start, Math.Min(WindowSize, entropy.Length - start));
+
+            if (window.Count(window[0]) >= cutoff)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    private static CaskEntropyHealthMode GetConfiguredMode()
+    {
+        object? data = AppContext.GetData(ConfigName);
+
+        return data switch
+        {
+            int value when value >= (int)CaskEntropyHealthMode.Disabled && value <= (int)CaskEntropyHealthMode.Pooled => (CaskEntropyHealthMode)value,
+            string text when Enum.TryParse(text, ignoreCase: true, out CaskEntropyHealthMode mode) &&
+                             mode >= CaskEntropyHealthMode.Disabled &&
+                             mode <= CaskEntropyHealthMode.Pooled => mode,
+            _ => CaskEntropyHealthMode.Disabled,
+        };
+    }
+
+    [DoesNotReturn]
+    private static void ThrowHealthTestFailed(CaskEntropyHealthFailure failure)
+    {
+        string test = failure == CaskEntropyHealthFailure.RepetitionCount ? "repetition count" : "adaptive proportion";
+        throw new CryptographicException($"The entropy for key generation failed the {test} health test.");
+    }
+}
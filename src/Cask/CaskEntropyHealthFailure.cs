@@ -0,0 +1,14 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// The health test that a block of entropy failed.
+/// </summary>
+internal enum CaskEntropyHealthFailure
+{
+    None = 0,
+    RepetitionCount = 1,
+    AdaptiveProportion = 2,
+}
@@ -0,0 +1,28 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// When <see cref="CaskEntropyHealth"/> tests the entropy used to generate
+/// keys.
+/// </summary>
+public enum CaskEntropyHealthMode
+{
+    /// <summary>
+    /// Entropy is not tested.
+    /// </summary>
+    Disabled = 0,
+
+    /// <summary>
+    /// The entropy for each key is tested on its own when the key is
+    /// generated.
+    /// </summary>
+    PerCall = 1,
+
+    /// <summary>
+    /// Entropy is drawn and tested in blocks of several kilobytes per thread,
+    /// and each key takes its entropy from the current block.
+    /// </summary>
+    Pooled = 2,
+}
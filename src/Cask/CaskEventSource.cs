@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics.Tracing;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Event source that publishes per-operation diagnostic events. Aggregate
+/// metrics are published separately by <see cref="CaskTelemetry"/>.
+/// </summary>
+/// <remarks>
+/// All events are verbose except for shadow validation mismatches, which
+/// are warnings, and entropy health test failures, which are errors.
+/// Callers must check <see cref="EventSource.IsEnabled(EventLevel, EventKeywords)"/>
+/// before raising an event so that nothing is computed when there is no listener.
+/// </remarks>
+[EventSource(Name = "CommonAnnotatedSecurityKeys")]
+internal sealed class CaskEventSource : EventSource
+{
+    public static readonly CaskEventSource Log = new();
+
+    private CaskEventSource() { }
+
+    public static class Keywords
+    {
+        public const EventKeywords Generation = (EventKeywords)0x1;
+        public const EventKeywords Validation = (EventKeywords)0x2;
+    }
+
+    [Event(1, Level = EventLevel.Verbose, Keywords = Keywords.Generation)]
+    public void KeyGenerated(string providerSignature, int secretSize)
+    {
+        WriteEvent(1, providerSignature, secretSize);
+    }
+
+    [Event(2, Level = EventLevel.Verbose, Keywords = Keywords.Validation)]
+    public void KeyValidationFailed(CaskValidationError error, int errorOffset, int length)
+    {
+        WriteEvent(2, (int)error, errorOffset, length);
+    }
+
+    [Event(3, Level = EventLevel.Warning, Keywords = Keywords.Validation)]
+    public void ShadowValidationMismatch(string fingerprint, CaskValidationError error, bool referenceIsValid)
+    {
+        WriteEvent(3, fingerprint, (int)error, referenceIsValid);
+    }
+
+    [Event(4, Level = EventLevel.Error, Keywords = Keywords.Generation)]
+    public void EntropyHealthTestFailed(CaskEntropyHealthFailure failure, int length)
+    {
+        WriteEvent(4, (int)failure, length);
+    }
+}
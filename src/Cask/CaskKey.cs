@@ -19,7 +19,17 @@ public readonly partial record struct CaskKey : IIsInitialized
     // safety without any runtime overhead after creation.
     private readonly string? _key;
 
-    public static Regex Regex { get; } = CompiledRegex();
+    /// <summary>
+    /// A regular expression that matches CASK keys in text.
+    /// </summary>
+    /// <remarks>
+    /// PERF: This is intentionally not a static readonly field or an
+    /// initialized auto-property. That would make the regex part of the static
+    /// initialization of <see cref="CaskKey"/> and every caller that only
+    /// validates or creates keys would pay to construct it on first use. The
+    /// instance is created on first access and cached.
+    /// </remarks>
+    public static Regex Regex => CompiledRegex();
 
     /// <summary>
     /// Indicates if the key is initialized, and not the default struct value.
@@ -36,6 +46,42 @@ public readonly partial record struct CaskKey : IIsInitialized
         }
     }
 
+    /// <summary>
+    /// The four-character signature of the provider that issued the key.
+    /// </summary>
+    public string ProviderSignature
+    {
+        get
+        {
+            ThrowIfNotInitialized();
+            return Cask.ExtractProviderSignatureFromKeyChars(_key.AsSpan()).ToString();
+        }
+    }
+
+    /// <summary>
+    /// The provider-defined kind of the key.
+    /// </summary>
+    public char ProviderKeyKind
+    {
+        get
+        {
+            ThrowIfNotInitialized();
+            return Cask.ExtractProviderKeyKindFromKeyChars(_key.AsSpan());
+        }
+    }
+
+    /// <summary>
+    /// The time in UTC, to the second, at which the key was generated.
+    /// </summary>
+    public DateTimeOffset Timestamp
+    {
+        get
+        {
+            ThrowIfNotInitialized();
+            return Cask.ExtractTimestampFromKeyChars(_key.AsSpan());
+        }
+    }
+
     public int SizeInBytes
     {
         get
@@ -141,6 +187,46 @@ public readonly partial record struct CaskKey : IIsInitialized
         return key;
     }
 
+    /// <summary>
+    /// Encodes a key produced by <see cref="Cask.GenerateKey"/>. The bytes are
+    /// still validated, but not counted as a validation by <see cref="CaskTelemetry"/>.
+    /// </summary>
+    internal static CaskKey EncodeGenerated(ReadOnlySpan<byte> bytes)
+    {
+        if (Cask.ValidateBytesCore(bytes, out _) != CaskValidationError.None)
+        {
+            ThrowFormat();
+        }
+
+        return new CaskKey(Base64Url.EncodeToString(bytes));
+    }
+
+    /// <summary>
+    /// Creates a key that <see cref="Cask.Reissue(ReadOnlySpan{CaskKey}, Span{CaskKey})"/>
+    /// built from the parts of a valid key, which is not validated again.
+    /// </summary>
+    internal static CaskKey CreateReissued(string text)
+    {
+        Debug.Assert(Cask.ValidateCore(text.AsSpan(), out _) == CaskValidationError.None);
+        return new CaskKey(text);
+    }
+
+    /// <summary>
+    /// Creates a key found by <see cref="CaskScanner"/>. The text is
+    /// validated, but not counted as a validation by <see cref="CaskTelemetry"/>.
+    /// </summary>
+    internal static bool TryCreateScannedUtf8(ReadOnlySpan<byte> textUtf8, out CaskKey key)
+    {
+        if (Cask.ValidateUtf8Core(textUtf8, out _) != CaskValidationError.None)
+        {
+            key = default;
+            return false;
+        }
+
+        key = new CaskKey(Encoding.UTF8.GetString(textUtf8));
+        return true;
+    }
+
     public void Decode(Span<byte> destination)
     {
         ThrowIfNotInitialized();
@@ -0,0 +1,161 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers;
+using System.Buffers.Binary;
+using System.Buffers.Text;
+using System.Security.Cryptography;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Identifies a key without revealing it, for looking up its status or
+/// metadata in caches and remote services.
+/// </summary>
+/// <remarks>
+/// A fingerprint is the first 128 bits of the SHA-256 hash of the decoded
+/// key bytes. It is printed as 22 base64url characters.
+/// </remarks>
+public readonly record struct CaskKeyFingerprint
+{
+    internal const int SizeInBytes = 16;
+    internal const int SizeInChars = 22;
+
+    private readonly ulong _high;
+    private readonly ulong _low;
+
+    private CaskKeyFingerprint(ulong high, ulong low)
+    {
+        _high = high;
+        _low = low;
+    }
+
+    /// <summary>
+    /// The first 64 bits, which are uniformly distributed and can be used to
+    /// bucket fingerprints.
+    /// </summary>
+    internal ulong High => _high;
+
+    /// <summary>
+    /// The last 64 bits.
+    /// </summary>
+    internal ulong Low => _low;
+
+    /// <summary>
+    /// Orders fingerprints as their bytes would be ordered.
+    /// </summary>
+    internal static int Compare(CaskKeyFingerprint x, CaskKeyFingerprint y)
+    {
+        int result = x._high.CompareTo(y._high);
+        return result != 0 ? result : x._low.CompareTo(y._low);
+    }
+
+    /// <summary>
+    /// Computes the fingerprint of a key.
+    /// </summary>
+    public static CaskKeyFingerprint Create(CaskKey key)
+    {
+        Span<byte> bytes = stackalloc byte[key.SizeInBytes];
+        key.Decode(bytes);
+        return Compute(bytes);
+    }
+
+    /// <summary>
+    /// Validates a key in its base64url-encoded form and computes its
+    /// fingerprint without creating a <see cref="CaskKey"/>, for example to
+    /// look up a key given in a request header without allocating.
+    /// </summary>
+    /// <returns>False if the text is not a valid key.</returns>
+    public static bool TryCreate(ReadOnlySpan<char> encodedKey, out CaskKeyFingerprint fingerprint)
+    {
+        if (!Cask.IsCask(encodedKey))
+        {
+            fingerprint = default;
+            return false;
+        }
+
+        Span<byte> bytes = stackalloc byte[Base64CharsToBytes(encodedKey.Length)];
+        Base64Url.DecodeFromChars(encodedKey, bytes);
+        fingerprint = Compute(bytes);
+        return true;
+    }
+
+    /// <summary>
+    /// Validates a key in its UTF-8 base64url-encoded form and computes its
+    /// fingerprint without creating a <see cref="CaskKey"/>.
+    /// </summary>
+    /// <returns>False if the text is not a valid key.</returns>
+    public static bool TryCreateUtf8(ReadOnlySpan<byte> encodedKey, out CaskKeyFingerprint fingerprint)
+    {
+        if (!Cask.IsCaskUtf8(encodedKey))
+        {
+            fingerprint = default;
+            return false;
+        }
+
+        Span<byte> bytes = stackalloc byte[Base64CharsToBytes(encodedKey.Length)];
+        Base64Url.DecodeFromUtf8(encodedKey, bytes, out _, out _);
+        fingerprint = Compute(bytes);
+        return true;
+    }
+
+    /// <summary>
+    /// Computes the fingerprint of arbitrary data, which is the fingerprint
+    /// of a key when the data is the decoded key.
+    /// </summary>
+    internal static CaskKeyFingerprint Compute(ReadOnlySpan<byte> data)
+    {
+        Span<byte> hash = stackalloc byte[32];
+        SHA256.HashData(data, hash);
+        return Read(hash);
+    }
+
+    /// <summary>
+    /// Reads a fingerprint from the 16 bytes written by <see cref="WriteTo"/>.
+    /// </summary>
+    public static CaskKeyFingerprint Read(ReadOnlySpan<byte> source)
+    {
+        if (source.Length < SizeInBytes)
+        {
+            throw new ArgumentException("Source buffer is too small.", nameof(source));
+        }
+
+        return new CaskKeyFingerprint(BinaryPrimitives.ReadUInt64BigEndian(source),
+                                      BinaryPrimitives.ReadUInt64BigEndian(source[8..]));
+    }
+
+    /// <summary>
+    /// Parses a fingerprint printed by <see cref="ToString"/>.
+    /// </summary>
+    public static bool TryParse(ReadOnlySpan<char> text, out CaskKeyFingerprint fingerprint)
+    {
+        Span<byte> bytes = stackalloc byte[SizeInBytes];
+        if (text.Length != SizeInChars ||
+            Base64Url.DecodeFromChars(text, bytes, out _, out int bytesWritten) != OperationStatus.Done ||
+            bytesWritten != SizeInBytes)
+        {
+            fingerprint = default;
+            return false;
+        }
+
+        fingerprint = Read(bytes);
+        return true;
+    }
+
+    /// <summary>
+    /// Writes the fingerprint as 16 bytes.
+    /// </summary>
+    public void WriteTo(Span<byte> destination)
+    {
+        ThrowIfDestinationTooSmall(destination, SizeInBytes);
+        BinaryPrimitives.WriteUInt64BigEndian(destination, _high);
+        BinaryPrimitives.WriteUInt64BigEndian(destination[8..], _low);
+    }
+
+    public override string ToString()
+    {
+        Span<byte> bytes = stackalloc byte[SizeInBytes];
+        WriteTo(bytes);
+        return Base64Url.EncodeToString(bytes);
+    }
+}
@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Text;
+using System.Diagnostics;
+using System.Runtime.InteropServices;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Tells keys whose sensitive component is obviously not random, such as
+/// documentation samples, test fixtures with zeroed or repeated bytes and
+/// keys made by deterministic mocks, from keys that are likely real.
+/// </summary>
+/// <remarks>
+/// <para>
+/// A key is a likely placeholder if its sensitive component, read as base64
+/// symbols, uses too few distinct symbols (at most 16 of the 42 symbols of a
+/// 256-bit secret or 30 of the 85 of a 512-bit secret), has a run of 8 or
+/// more symbols that repeat or step by the same amount, such as "AAAAAAAA"
+/// or "abcdefgh", or if its bits are unbalanced, with a number of set bits
+/// at least 6 standard deviations from half.
+/// </para>
+/// <para>
+/// Each test is cut off so that a random secret fails it with a probability
+/// of about 2 in a billion or less, so about one real key in 300 million is
+/// classified as a placeholder. The tests take one pass over fewer than 100
+/// characters and are only run on keys that were found.
+/// </para>
+/// </remarks>
+internal static class CaskPlaceholderDetector
+{
+    private const int MaxRunLength = 8;
+
+    /// <summary>
+    /// Whether the sensitive component of a key is likely a placeholder
+    /// rather than random.
+    /// </summary>
+    public static bool IsLikelyPlaceholder(CaskKey key)
+    {
+        Debug.Assert(key.IsInitialized);
+
+        SecretSize secretSize = key.SecretSize;
+        int secretSizeInBytes = (int)secretSize * SecretChunkSizeInBytes;
+        ReadOnlySpan<char> chars = key.ToString().AsSpan(0, BytesToBase64Chars(secretSizeInBytes));
+
+        return HasFewSymbolsOrLongRun(chars[..(secretSizeInBytes * 8 / 6)], secretSize) ||
+               HasUnbalancedBits(chars, secretSizeInBytes);
+    }
+
+    /// <summary>
+    /// Counts the distinct symbols and finds the longest run of symbols that
+    /// differ from the one before by the same amount, modulo 64, in the
+    /// symbols that hold only bits of the secret.
+    /// </summary>
+    private static bool HasFewSymbolsOrLongRun(ReadOnlySpan<char> chars, SecretSize secretSize)
+    {
+        ulong seen = 0;
+        int previous = GetSymbol(chars[0]);
+        int previousStep = -1;
+        int run = 1;
+        int longestRun = 1;
+
+        seen |= 1UL << previous;
+
+        for (int i = 1; i < chars.Length; i++)
+        {
+            int symbol = GetSymbol(chars[i]);
+            int step = (symbol - previous) & 63;
+
+            run = step == previousStep ? run + 1 : 2;
+            longestRun = Math.Max(longestRun, run);
+            seen |= 1UL << symbol;
+
+            previous = symbol;
+            previousStep = step;
+        }
+
+        int maxFewSymbols = secretSize == SecretSize.Bits512 ? 30 : 16;
+        return longestRun >= MaxRunLength || PopCount(seen) <= maxFewSymbols;
+    }
+
+    /// <summary>
+    /// Whether the number of set bits in the secret is at least 6 standard
+    /// deviations, or 3 times the square root of the number of bits, away
+    /// from half of them.
+    /// </summary>
+    private static bool HasUnbalancedBits(ReadOnlySpan<char> chars, int secretSizeInBytes)
+    {
+        Span<byte> bytes = stackalloc byte[RoundUpTo3ByteAlignment(secretSizeInBytes)];
+        int bytesWritten = Base64Url.DecodeFromChars(chars, bytes);
+        Debug.Assert(bytesWritten == bytes.Length);
+
+        int setBits = 0;
+        foreach (ulong word in MemoryMarshal.Cast<byte, ulong>(bytes[..secretSizeInBytes]))
+        {
+            setBits += PopCount(word);
+        }
+
+        int bits = secretSizeInBytes * 8;
+        long deviation = (2 * setBits) - bits;
+        return deviation * deviation >= 36L * bits;
+    }
+
+    private static int GetSymbol(char c)
+    {
+        return c switch
+        {
+            >= 'a' => c - 'a' + 26,
+            >= 'A' and <= 'Z' => c - 'A',
+            >= '0' and <= '9' => c - '0' + 52,
+            '-' => 62,
+            _ => 63,
+        };
+    }
+
+    private static int PopCount(ulong value)
+    {
+        value -= (value >> 1) & 0x5555_5555_5555_5555UL;
+        value = (value & 0x3333_3333_3333_3333UL) + ((value >> 2) & 0x3333_3333_3333_3333UL);
+        value = (value + (value >> 4)) & 0x0F0F_0F0F_0F0F_0F0FUL;
+        return (int)(unchecked(value * 0x0101_0101_0101_0101UL) >> 56);
+    }
+}
@@ -0,0 +1,66 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Generates a strongly typed key for a single provider on the partial
+/// struct to which it is applied.
+/// </summary>
+/// <remarks>
+/// The generated struct wraps a <see cref="CaskKey"/> and has <c>IsValid</c>,
+/// <c>TryCreate</c>, <c>Create</c> and <c>Generate</c> methods, as well as an
+/// accessor for every named provider data field. Because the provider
+/// signature, secret size, and provider data layout are known at compile time,
+/// the generated validator checks every character of the key at a constant
+/// offset in one pass: the fixed characters first, then the alphabet, padding
+/// and timestamp ranges of the others. It accepts the same keys as <see
+/// cref="Cask.IsCask(ReadOnlySpan{char})"/> that match the provider, but does
+/// not decode the key or record validation telemetry. <c>TryCreate</c> and
+/// <c>Create</c> check the fixed characters and then validate the key once
+/// with <see cref="CaskKey.TryCreate(string, out CaskKey)"/>.
+/// </remarks>
+/// <example>
+/// <code>
+/// [CaskProvider("TEST", Kinds = "AM", ProviderDataLayout = "Version=AC,Region:5,Tenant:5,Reserved=AAAA")]
+/// public readonly partial struct TestKey { }
+/// </code>
+/// </example>
+[AttributeUsage(AttributeTargets.Struct, Inherited = false, AllowMultiple = false)]
+public sealed class CaskProviderAttribute : Attribute
+{
+    /// <param name="providerSignature">
+    /// The 4-character base64url provider signature.
+    /// </param>
+    public CaskProviderAttribute(string providerSignature)
+    {
+        ProviderSignature = providerSignature;
+    }
+
+    /// <summary>
+    /// The 4-character base64url provider signature.
+    /// </summary>
+    public string ProviderSignature { get; }
+
+    /// <summary>
+    /// The provider key kinds that are allowed, one base64url character per
+    /// kind. If not set, any kind is allowed.
+    /// </summary>
+    public string? Kinds { get; set; }
+
+    /// <summary>
+    /// The layout of the provider data as a comma-separated list of fields.
+    /// Each field is either <c>Name:Length</c>, a variable field of the given
+    /// number of base64url characters, or <c>Name=Value</c>, a field that must
+    /// always hold the given base64url characters. The total length must be a
+    /// multiple of 4 characters and no more than <see
+    /// cref="Limits.MaxProviderDataLengthInChars"/>. If not set, keys have no
+    /// provider data.
+    /// </summary>
+    public string? ProviderDataLayout { get; set; }
+
+    /// <summary>
+    /// The size of the secret. The default is <see cref="SecretSize.Bits256"/>.
+    /// </summary>
+    public SecretSize SecretSize { get; set; } = SecretSize.Bits256;
+}
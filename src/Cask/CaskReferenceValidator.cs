@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// A deliberately simple implementation of CASK key validation that is used
+/// as the reference for shadow validation. See <see cref="CaskShadowValidation"/>.
+/// </summary>
+/// <remarks>
+/// This follows the key format as it is specified, one character at a time
+/// on the base64url-encoded form, and shares none of the decoding or
+/// bytewise validation code of <see cref="Cask"/>. It is not optimized and
+/// allocates, so it must only be used on sampled keys.
+/// </remarks>
+internal static class CaskReferenceValidator
+{
+    // The characters after the secret: the CASK signature, the padding,
+    // sizes and kind, the provider signature and the timestamp.
+    private const int FixedCharsAfterSecret = 4 + 4 + 4 + 8;
+
+    public static bool IsCask(ReadOnlySpan<char> encodedKey)
+    {
+        foreach (char c in encodedKey)
+        {
+            if (!IsValidForBase64Url(c))
+            {
+                return false;
+            }
+        }
+
+        return IsCaskText(encodedKey.ToString());
+    }
+
+    public static bool IsCaskUtf8(ReadOnlySpan<byte> encodedKey)
+    {
+        var text = new char[encodedKey.Length];
+
+        for (int i = 0; i < encodedKey.Length; i++)
+        {
+            // Any byte that is not ASCII is not base64url.
+            if (encodedKey[i] >= 0x80)
+            {
+                return false;
+            }
+
+            text[i] = (char)encodedKey[i];
+        }
+
+        return IsCask(text);
+    }
+
+    public static bool IsCaskBytes(ReadOnlySpan<byte> decodedKey)
+    {
+        if (decodedKey.Length % 3 != 0)
+        {
+            return false;
+        }
+
+        string text = Convert.ToBase64String(decodedKey.ToArray()).Replace('+', '-').Replace('/', '_');
+        return IsCaskText(text);
+    }
+
+    private static bool IsCaskText(string key)
+    {
+        if (key.Length % 4 != 0)
+        {
+            return false;
+        }
+
+        // Provider data is at most 40 characters, so the shortest 512-bit
+        // key is longer than the longest 256-bit key.
+        SecretSize secretSize = key.Length >= Min512BitKeyLengthInChars ? SecretSize.Bits512 : SecretSize.Bits256;
+        int secretChars = secretSize == SecretSize.Bits512 ? 88 : 44;
+        int providerDataChars = key.Length - secretChars - FixedCharsAfterSecret;
+
+        if (providerDataChars < 0 || providerDataChars > MaxProviderDataLengthInChars)
+        {
+            return false;
+        }
+
+        // The secret is padded with zero bytes to a multiple of 3 bytes: one
+        // byte, the last 8 bits, for 256 bits and two bytes, the last 16
+        // bits, for 512 bits.
+        if (secretSize == SecretSize.Bits256)
+        {
+            if (Decode(key[43]) != 0 || (Decode(key[42]) & 0x3) != 0)
+            {
+                return false;
+            }
+        }
+        else if (Decode(key[87]) != 0 || Decode(key[86]) != 0 || (Decode(key[85]) & 0xF) != 0)
+        {
+            return false;
+        }
+
+        int i = secretChars;
+
+        if (key.Substring(i, 4) != "QJJQ")
+        {
+            return false;
+        }
+
+        i += 4;
+
+        if (key[i] != 'A' ||
+            Decode(key[i + 1]) != (int)secretSize ||
+            Decode(key[i + 2]) * 4 != providerDataChars)
+        {
+            return false;
+        }
+
+        // The provider key kind, the provider signature and the provider data
+        // can be anything.
+        i += 4 + 4 + providerDataChars;
+
+        if (key[i] != 'A' || key[i + 1] != 'A')
+        {
+            return false;
+        }
+
+        // The year can be anything. The month, day, hour, minute and second
+        // are zero-based.
+        return Decode(key[i + 3]) <= 11 &&
+               Decode(key[i + 4]) <= 30 &&
+               Decode(key[i + 5]) <= 23 &&
+               Decode(key[i + 6]) <= 59 &&
+               Decode(key[i + 7]) <= 59;
+    }
+
+    private static int Decode(char c)
+    {
+        return Base64UrlChars.AsSpan().IndexOf(c);
+    }
+}
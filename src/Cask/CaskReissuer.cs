@@ -0,0 +1,137 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Text;
+using System.Diagnostics;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Replaces the entropy and timestamp of a batch of valid keys, keeping the
+/// rest of each key as it is encoded.
+/// </summary>
+/// <remarks>
+/// Every component of a key is a whole number of 3-byte groups, so the
+/// encoded secret, the fixed components with the provider data and the
+/// timestamp are separate runs of characters. A fresh key is the encoding of
+/// new entropy, followed by the characters of the old key from the CASK
+/// signature up to the timestamp, followed by the timestamp of the batch.
+/// Entropy is drawn a block of <see cref="CaskEntropyHealth.PoolSize"/> bytes
+/// at a time, and each part is cleared as it is used.
+/// </remarks>
+internal sealed class CaskReissuer : IDisposable
+{
+    private const int TimestampLengthInChars = 6;
+
+    private readonly byte[] _entropy = new byte[CaskEntropyHealth.PoolSize];
+    private readonly byte[] _timestampUtf8 = new byte[TimestampLengthInChars];
+    private int _entropyOffset;
+    private long _bits256Count;
+    private long _bits512Count;
+
+    public CaskReissuer()
+    {
+        DateTimeOffset now = Cask.GetUtcNow();
+        Cask.ValidateTimestamp(now);
+
+        ReadOnlySpan<char> timestamp = [
+            Base64UrlChars[now.Year - 2025], // Years since 2025.
+            Base64UrlChars[now.Month - 1],   // Zero-indexed month.
+            Base64UrlChars[now.Day - 1],     // Zero-indexed day.
+            Base64UrlChars[now.Hour],        // Zero-indexed hour.
+            Base64UrlChars[now.Minute],      // Zero-index minute.
+            Base64UrlChars[now.Second],      // Zero-index second.
+        ];
+
+        for (int i = 0; i < timestamp.Length; i++)
+        {
+            _timestampUtf8[i] = (byte)timestamp[i];
+        }
+
+        _entropyOffset = _entropy.Length;
+    }
+
+    public CaskKey Reissue(CaskKey oldKey)
+    {
+        string oldText = oldKey.ToString();
+        Range caskSignatureCharRange = Cask.ComputeCaskSignatureCharRange(oldText.Length, out SecretSize secretSize);
+        int secretLengthInChars = caskSignatureCharRange.Start.Value;
+
+        Span<char> key = stackalloc char[oldText.Length];
+        oldText.AsSpan(secretLengthInChars).CopyTo(key[secretLengthInChars..]);
+
+        Span<byte> secret = stackalloc byte[Base64CharsToBytes(secretLengthInChars)];
+        NextSecret(secret, secretSize);
+        int charsWritten = Base64Url.EncodeToChars(secret, key);
+        Debug.Assert(charsWritten == secretLengthInChars);
+        secret.Clear();
+
+        Span<char> timestamp = key[^TimestampLengthInChars..];
+        for (int i = 0; i < timestamp.Length; i++)
+        {
+            timestamp[i] = (char)_timestampUtf8[i];
+        }
+
+        return CaskKey.CreateReissued(key.ToString());
+    }
+
+    /// <summary>
+    /// Replaces the entropy and timestamp of a valid key in place.
+    /// </summary>
+    public void ReissueUtf8(Span<byte> key)
+    {
+        Range caskSignatureCharRange = Cask.ComputeCaskSignatureCharRange(key.Length, out SecretSize secretSize);
+        int secretLengthInChars = caskSignatureCharRange.Start.Value;
+
+        Span<byte> secret = stackalloc byte[Base64CharsToBytes(secretLengthInChars)];
+        NextSecret(secret, secretSize);
+        int bytesWritten = Base64Url.EncodeToUtf8(secret, key);
+        Debug.Assert(bytesWritten == secretLengthInChars);
+        secret.Clear();
+
+        _timestampUtf8.CopyTo(key[^TimestampLengthInChars..]);
+    }
+
+    /// <summary>
+    /// Clears the unused entropy and counts the keys generated.
+    /// </summary>
+    public void Dispose()
+    {
+        _entropy.AsSpan().Clear();
+        _entropyOffset = _entropy.Length;
+
+        CaskTelemetry.RecordReissue(SecretSize.Bits256, _bits256Count);
+        CaskTelemetry.RecordReissue(SecretSize.Bits512, _bits512Count);
+        _bits256Count = 0;
+        _bits512Count = 0;
+    }
+
+    /// <summary>
+    /// Fills a secret with entropy followed by zero padding.
+    /// </summary>
+    private void NextSecret(Span<byte> paddedSecret, SecretSize secretSize)
+    {
+        int secretSizeInBytes = (int)secretSize * SecretChunkSizeInBytes;
+
+        if (_entropy.Length - _entropyOffset < secretSizeInBytes)
+        {
+            Cask.FillRandom(_entropy);
+            _entropyOffset = 0;
+        }
+
+        Span<byte> entropy = _entropy.AsSpan(_entropyOffset, secretSizeInBytes);
+        entropy.CopyTo(paddedSecret);
+        entropy.Clear();
+        paddedSecret[secretSizeInBytes..].Clear();
+        _entropyOffset += secretSizeInBytes;
+
+        if (secretSize == SecretSize.Bits512)
+        {
+            _bits512Count++;
+        }
+        else
+        {
+            _bits256Count++;
+        }
+    }
+}
@@ -0,0 +1,497 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics;
+using System.Diagnostics.CodeAnalysis;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Finds CASK keys in UTF-8 text, either in a single buffer or in a stream
+/// of buffers of any size.
+/// </summary>
+/// <remarks>
+/// Matches are the same as those of <see cref="CaskKey.Regex"/>: a valid key
+/// that is not immediately preceded or followed by a base64 or base64url
+/// character. Rather than trying a pattern at every position, the scanner
+/// searches for the fixed "QJJQ" CASK signature and only looks at the text
+/// around each occurrence, so text without keys is scanned at the speed of a
+/// vectorized substring search.
+///
+/// An instance carries enough of the end of each buffer over to the next to
+/// find keys that straddle buffer boundaries, and reports each key exactly
+/// once with its offset from the start of the stream. Instances are not
+/// thread-safe; use one per stream.
+///
+/// Each match also says whether the key is likely a placeholder, such as a
+/// documentation sample or test fixture, so that findings can be triaged
+/// without another pass over the text.
+/// </remarks>
+public sealed class CaskScanner
+{
+    // Offsets relative to the CASK signature, which is at character 44 of a
+    // 256-bit key and character 88 of a 512-bit key.
+    private const int SecretSizeCharOffset = 5;
+    private const int ProviderDataSizeCharOffset = 6;
+    private const int Bits256CaskSignatureCharOffset = 44;
+    private const int Bits512CaskSignatureCharOffset = 88;
+    private const int Bits256KeyLengthWithoutProviderData = 64;
+    private const int Bits512KeyLengthWithoutProviderData = 108;
+
+    // The least number of bytes of a batch of cells that is worth scanning on
+    // another thread.
+    private const int ParallelChunkLength = 1024 * 1024;
+
+    // Every key, together with the characters before and after it that must
+    // not be base64, fits in this many bytes. Keeping this many bytes of
+    // each buffer is enough to find any key that straddles a boundary.
+    private static readonly int s_carryLength = MaxKeyLengthInChars + 2;
+
+    private readonly byte[] _seam = new byte[2 * s_carryLength];
+    private int _carryLength;
+    private long _position;
+    private long _nextReportableOffset;
+    private bool _completed;
+
+    /// <summary>
+    /// The number of bytes scanned since the scanner was created or reset.
+    /// </summary>
+    public long Position => _position;
+
+    /// <summary>
+    /// Scans a complete UTF-8 text for CASK keys.
+    /// </summary>
+    /// <param name="textUtf8">The text to scan.</param>
+    /// <param name="matches">The collection to which matches are added in order of offset.</param>
+    /// <returns>The number of matches found.</returns>
+    public static int ScanUtf8(ReadOnlySpan<byte> textUtf8, ICollection<CaskMatch> matches)
+    {
+        ThrowIfNull(matches);
+
+        int count = ScanCore(textUtf8, 0, isStreamStart: true, isStreamEnd: true, long.MinValue, matches, out _);
+        CaskTelemetry.RecordScan(textUtf8.Length, count);
+        return count;
+    }
+
+    /// <summary>
+    /// Scans a batch of short UTF-8 texts, such as database columns or CSV
+    /// cells, that are packed one after another in a single buffer.
+    /// </summary>
+    /// <remarks>
+    /// The cells are described as in Apache Arrow: cell <c>i</c> is the bytes
+    /// from <c>offsets[i]</c> up to <c>offsets[i + 1]</c>, so there is one more
+    /// offset than there are cells. The whole batch is searched in one pass,
+    /// which avoids the per-call overhead of scanning each cell on its own,
+    /// and each cell is treated as a complete text: a key must be within one
+    /// cell, and the start and end of a cell delimit it.
+    /// </remarks>
+    /// <param name="dataUtf8">The cells.</param>
+    /// <param name="offsets">
+    /// The offset of the start of each cell in <paramref name="dataUtf8"/>,
+    /// followed by the offset of the end of the last cell. The offsets must
+    /// not decrease.
+    /// </param>
+    /// <param name="matches">The collection to which matches are added in order of cell and offset.</param>
+    /// <returns>The number of matches found.</returns>
+    /// <exception cref="ArgumentException">
+    /// The offsets decrease or are outside <paramref name="dataUtf8"/>.
+    /// </exception>
+    public static int ScanManyUtf8(ReadOnlySpan<byte> dataUtf8, ReadOnlySpan<int> offsets, ICollection<CaskCellMatch> matches)
+    {
+        ThrowIfNull(matches);
+        ValidateOffsets(dataUtf8, offsets);
+
+        if (offsets.Length < 2)
+        {
+            return 0;
+        }
+
+        int count = ScanCells(dataUtf8, offsets, 0, offsets.Length - 1, matches);
+        CaskTelemetry.RecordScan(offsets[^1] - offsets[0], count);
+        return count;
+    }
+
+    /// <summary>
+    /// Scans a batch of short UTF-8 texts that are packed one after another
+    /// in a single buffer, dividing large batches between threads.
+    /// </summary>
+    /// <remarks>
+    /// Matches are the same, and in the same order, as those of
+    /// <see cref="ScanManyUtf8(ReadOnlySpan{byte}, ReadOnlySpan{int}, ICollection{CaskCellMatch})"/>.
+    /// Batches of less than 2 MB are scanned on the calling thread.
+    /// </remarks>
+    /// <param name="dataUtf8">The cells.</param>
+    /// <param name="offsets">
+    /// The offset of the start of each cell in <paramref name="dataUtf8"/>,
+    /// followed by the offset of the end of the last cell. The offsets must
+    /// not decrease.
+    /// </param>
+    /// <param name="matches">The collection to which matches are added in order of cell and offset.</param>
+    /// <param name="parallelOptions">Limits the number of threads and allows cancellation.</param>
+    /// <returns>The number of matches found.</returns>
+    /// <exception cref="ArgumentException">
+    /// The offsets decrease or are outside <paramref name="dataUtf8"/>.
+    /// </exception>
+    public static int ScanManyUtf8(ReadOnlyMemory<byte> dataUtf8,
+                                   ReadOnlyMemory<int> offsets,
+                                   ICollection<CaskCellMatch> matches,
+                                   ParallelOptions parallelOptions)
+    {
+        ThrowIfNull(matches);
+        ThrowIfNull(parallelOptions);
+        ValidateOffsets(dataUtf8.Span, offsets.Span);
+
+        int cellCount = offsets.Length - 1;
+        if (cellCount < 1)
+        {
+            return 0;
+        }
+
+        int first = offsets.Span[0];
+        int length = offsets.Span[cellCount] - first;
+        int chunkCount = Math.Min(cellCount, length / ParallelChunkLength);
+
+        if (chunkCount < 2)
+        {
+            return ScanManyUtf8(dataUtf8.Span, offsets.Span, matches);
+        }
+
+        // Divide the cells into chunks of about equal length in bytes.
+        int[] chunkStarts = new int[chunkCount + 1];
+        chunkStarts[chunkCount] = cellCount;
+
+        for (int i = 1; i < chunkCount; i++)
+        {
+            int position = first + (int)((long)length * i / chunkCount);
+            chunkStarts[i] = FindCell(offsets.Span, chunkStarts[i - 1], cellCount, position);
+        }
+
+        var chunkMatches = new List<CaskCellMatch>[chunkCount];
+
+        Parallel.For(0, chunkCount, parallelOptions, i =>
+        {
+            var list = new List<CaskCellMatch>();
+            ScanCells(dataUtf8.Span, offsets.Span, chunkStarts[i], chunkStarts[i + 1], list);
+            chunkMatches[i] = list;
+        });
+
+        int count = 0;
+        foreach (List<CaskCellMatch> list in chunkMatches)
+        {
+            foreach (CaskCellMatch match in list)
+            {
+                matches.Add(match);
+            }
+
+            count += list.Count;
+        }
+
+        CaskTelemetry.RecordScan(length, count);
+        return count;
+    }
+
+    /// <summary>
+    /// Scans the next buffer of a UTF-8 stream for CASK keys.
+    /// </summary>
+    /// <param name="textUtf8">The next buffer of the stream. It may be empty.</param>
+    /// <param name="isFinalBlock">
+    /// True if this is the last buffer of the stream. Keys that end exactly at
+    /// the end of a buffer are only reported once the next buffer, or the end
+    /// of the stream, shows that they are not followed by a base64 character.
+    /// </param>
+    /// <param name="matches">The collection to which matches are added in order of offset.</param>
+    /// <returns>The number of matches found.</returns>
+    /// <exception cref="InvalidOperationException">
+    /// The final block was already scanned and the scanner was not <see cref="Reset"/>.
+    /// </exception>
+    public int ScanUtf8(ReadOnlySpan<byte> textUtf8, bool isFinalBlock, ICollection<CaskMatch> matches)
+    {
+        ThrowIfNull(matches);
+
+        if (_completed)
+        {
+            ThrowCompleted();
+        }
+
+        int count = 0;
+        int carryLength = _carryLength;
+        long bufferOffset = _position;
+
+        // Scan the end of the previous buffer joined to the start of this one
+        // for keys that straddle the boundary. Keys entirely within the
+        // previous buffer were already reported, and keys entirely within this
+        // one are found below, but both are skipped by offset if seen again.
+        if (carryLength > 0)
+        {
+            int headLength = Math.Min(textUtf8.Length, s_carryLength);
+            textUtf8[..headLength].CopyTo(_seam.AsSpan(carryLength));
+
+            long seamOffset = bufferOffset - carryLength;
+            count += ScanCore(_seam.AsSpan(0, carryLength + headLength),
+                              seamOffset,
+                              isStreamStart: seamOffset == 0,
+                              isStreamEnd: isFinalBlock && headLength == textUtf8.Length,
+                              _nextReportableOffset,
+                              matches,
+                              out _nextReportableOffset);
+        }
+
+        count += ScanCore(textUtf8,
+                          bufferOffset,
+                          isStreamStart: bufferOffset == 0,
+                          isStreamEnd: isFinalBlock,
+                          _nextReportableOffset,
+                          matches,
+                          out _nextReportableOffset);
+
+        UpdateCarry(textUtf8);
+        _position += textUtf8.Length;
+        _completed = isFinalBlock;
+
+        CaskTelemetry.RecordScan(textUtf8.Length, count);
+        return count;
+    }
+
+    /// <summary>
+    /// Resets the scanner so that it can be used for another stream.
+    /// </summary>
+    public void Reset()
+    {
+        _carryLength = 0;
+        _position = 0;
+        _nextReportableOffset = 0;
+        _completed = false;
+    }
+
+    private void UpdateCarry(ReadOnlySpan<byte> textUtf8)
+    {
+        if (textUtf8.Length >= s_carryLength)
+        {
+            textUtf8[^s_carryLength..].CopyTo(_seam);
+            _carryLength = s_carryLength;
+            return;
+        }
+
+        // Keep the end of the previous carry followed by all of this buffer.
+        int keep = Math.Min(_carryLength, s_carryLength - textUtf8.Length);
+        _seam.AsSpan(_carryLength - keep, keep).CopyTo(_seam);
+        textUtf8.CopyTo(_seam.AsSpan(keep));
+        _carryLength = keep + textUtf8.Length;
+    }
+
+    /// <summary>
+    /// Finds keys in a buffer that starts at the given offset of the stream.
+    /// Only keys whose surrounding characters are in the buffer, or that
+    /// touch the start or end of the stream, are reported, and only if they
+    /// start at or after <paramref name="nextReportableOffset"/>.
+    /// </summary>
+    internal static int ScanCore(ReadOnlySpan<byte> text,
+                                 long bufferOffset,
+                                 bool isStreamStart,
+                                 bool isStreamEnd,
+                                 long nextReportableOffset,
+                                 ICollection<CaskMatch> matches,
+                                 out long updatedNextReportableOffset)
+    {
+        int count = 0;
+        int searchStart = 0;
+
+        while (true)
+        {
+            int index = text[searchStart..].IndexOf(CaskSignatureUtf8);
+            if (index < 0)
+            {
+                break;
+            }
+
+            int anchor = searchStart + index;
+
+            if (!TryMatchAt(text, anchor, isStreamStart, isStreamEnd, out int start, out int length) ||
+                bufferOffset + start < nextReportableOffset)
+            {
+                searchStart = anchor + 1;
+                continue;
+            }
+
+            ReadOnlySpan<byte> keyUtf8 = text.Slice(start, length);
+
+            if (!CaskKey.TryCreateScannedUtf8(keyUtf8, out CaskKey key))
+            {
+                searchStart = anchor + 1;
+                continue;
+            }
+
+            matches.Add(new CaskMatch(bufferOffset + start, key));
+            nextReportableOffset = bufferOffset + start + length;
+            searchStart = start + length;
+            count++;
+        }
+
+        updatedNextReportableOffset = nextReportableOffset;
+        return count;
+    }
+
+    /// <summary>
+    /// Finds keys in the cells from <paramref name="firstCell"/> up to
+    /// <paramref name="endCell"/> by searching all of their bytes at once and
+    /// matching each occurrence of the CASK signature within its cell.
+    /// </summary>
+    private static int ScanCells(ReadOnlySpan<byte> data,
+                                 ReadOnlySpan<int> offsets,
+                                 int firstCell,
+                                 int endCell,
+                                 ICollection<CaskCellMatch> matches)
+    {
+        int count = 0;
+        int cell = firstCell;
+        int position = offsets[firstCell];
+        int end = offsets[endCell];
+
+        while (position < end)
+        {
+            int index = data[position..end].IndexOf(CaskSignatureUtf8);
+            if (index < 0)
+            {
+                break;
+            }
+
+            int anchor = position + index;
+            cell = FindCell(offsets, cell, endCell, anchor);
+
+            int cellStart = offsets[cell];
+            ReadOnlySpan<byte> text = data[cellStart..offsets[cell + 1]];
+
+            if (!TryMatchAt(text, anchor - cellStart, isStreamStart: true, isStreamEnd: true, out int start, out int length) ||
+                !CaskKey.TryCreateScannedUtf8(text.Slice(start, length), out CaskKey key))
+            {
+                position = anchor + 1;
+                continue;
+            }
+
+            matches.Add(new CaskCellMatch(cell, start, key));
+            position = cellStart + start + length;
+            count++;
+        }
+
+        return count;
+    }
+
+    /// <summary>
+    /// Finds the cell from <paramref name="firstCell"/> up to
+    /// <paramref name="endCell"/> that contains the given position, which must
+    /// not be before the first of them.
+    /// </summary>
+    private static int FindCell(ReadOnlySpan<int> offsets, int firstCell, int endCell, int position)
+    {
+        // The last cell that starts at or before the position. Empty cells
+        // before it start at the same offset, so they are skipped.
+        int low = firstCell;
+        int high = endCell;
+
+        while (high - low > 1)
+        {
+            int middle = low + ((high - low) / 2);
+
+            if (offsets[middle] <= position)
+            {
+                low = middle;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        return low;
+    }
+
+    private static void ValidateOffsets(ReadOnlySpan<byte> data, ReadOnlySpan<int> offsets)
+    {
+        int previous = 0;
+
+        foreach (int offset in offsets)
+        {
+            if (offset < previous)
+            {
+                throw new ArgumentException("The offsets must not decrease.", nameof(offsets));
+            }
+
+            previous = offset;
+        }
+
+        if (previous > data.Length)
+        {
+            throw new ArgumentException("The offsets must be within the data.", nameof(offsets));
+        }
+    }
+
+    /// <summary>
+    /// Determines the extent of the key that would have its CASK signature at
+    /// <paramref name="anchor"/> and checks that it is within the text and
+    /// delimited. The key itself is not validated.
+    /// </summary>
+    private static bool TryMatchAt(ReadOnlySpan<byte> text, int anchor, bool isStreamStart, bool isStreamEnd, out int start, out int length)
+    {
+        start = 0;
+        length = 0;
+
+        if (anchor + ProviderDataSizeCharOffset >= text.Length)
+        {
+            return false;
+        }
+
+        int signatureOffset;
+        int lengthWithoutProviderData;
+
+        switch (text[anchor + SecretSizeCharOffset])
+        {
+            case (byte)'B':
+                signatureOffset = Bits256CaskSignatureCharOffset;
+                lengthWithoutProviderData = Bits256KeyLengthWithoutProviderData;
+                break;
+            case (byte)'C':
+                signatureOffset = Bits512CaskSignatureCharOffset;
+                lengthWithoutProviderData = Bits512KeyLengthWithoutProviderData;
+                break;
+            default:
+                return false;
+        }
+
+        int providerDataSize = text[anchor + ProviderDataSizeCharOffset] - 'A';
+        if (unchecked((uint)providerDataSize) > (uint)(MaxProviderDataLengthInChars / 4))
+        {
+            return false;
+        }
+
+        start = anchor - signatureOffset;
+        length = lengthWithoutProviderData + providerDataSize * 4;
+        int end = start + length;
+
+        // The character before the key must be in this buffer, or the key
+        // must be at the start of the stream. Otherwise, a key that straddles
+        // a boundary is found when scanning across the boundary instead.
+        bool delimitedBefore = start > 0 ? !IsBase64Character(text[start - 1]) : start == 0 && isStreamStart;
+        bool delimitedAfter = end < text.Length ? !IsBase64Character(text[end]) : end == text.Length && isStreamEnd;
+
+        Debug.Assert(length <= MaxKeyLengthInChars);
+        return delimitedBefore && delimitedAfter;
+    }
+
+    /// <summary>
+    /// Determines if the character is in either the base64 or base64url
+    /// alphabet. Keys that are adjacent to such characters are not matched
+    /// because they are likely part of some longer base64 data.
+    /// </summary>
+    private static bool IsBase64Character(byte c)
+    {
+        return unchecked((uint)((c | 0x20) - 'a') <= 'z' - 'a' ||
+                         (uint)(c - '0') <= '9' - '0') ||
+               c is (byte)'-' or (byte)'_' or (byte)'+' or (byte)'/';
+    }
+
+    [DoesNotReturn]
+    private static void ThrowCompleted()
+    {
+        throw new InvalidOperationException("The final block has already been scanned. Call Reset to scan another stream.");
+    }
+}
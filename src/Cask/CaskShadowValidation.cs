@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Globalization;
+using System.Runtime.CompilerServices;
+using System.Text;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Shadow validation runs a simple reference implementation of validation
+/// next to <see cref="Cask.Validate(ReadOnlySpan{char}, out int)"/>, <see
+/// cref="Cask.ValidateUtf8"/>, <see cref="Cask.ValidateBytes"/> and the
+/// IsCask methods that call them, on a sample of calls, and reports any call
+/// where the two disagree on whether the input is a valid key.
+/// </summary>
+/// <remarks>
+/// <para>
+/// This is meant for rolling out changes to the optimized validation code:
+/// enable it in production at a low rate and watch for mismatches. Each
+/// sampled call is counted by the <c>cask.validation.shadow.checks</c>
+/// counter with a <c>cask.outcome</c> of <c>match</c> or <c>mismatch</c>,
+/// and each mismatch raises a warning event from the event source named
+/// <see cref="CaskTelemetry.Name"/> with the fingerprint of the input, which
+/// identifies it without revealing it. The fingerprint is computed as for
+/// <see cref="CaskKeyFingerprint"/>, from the input bytes as given or, for
+/// text, from its UTF-8 encoding.
+/// </para>
+/// <para>
+/// When shadow validation is disabled, which is the default, the cost to
+/// each call is one read of a static field and one branch. When enabled,
+/// unsampled calls also increment a thread-local counter. The sampling
+/// interval can be set with <see cref="SamplingInterval"/> or, without a
+/// code change, with the <see cref="AppContext"/> data named by <see
+/// cref="SamplingIntervalConfigName"/>, for example in runtimeconfig.json.
+/// </para>
+/// </remarks>
+public static class CaskShadowValidation
+{
+    private const string ConfigName = "CommonAnnotatedSecurityKeys.ShadowValidationSamplingInterval";
+    private const int MaxSamplingInterval = 1 << 30;
+
+    // One less than the sampling interval, or -1 when disabled, so that a
+    // call is sampled when the low bits of a counter are all zero.
+    private static int s_sampleMask = ToSampleMask(GetConfiguredSamplingInterval());
+
+    [ThreadStatic]
+    private static int t_calls;
+
+    /// <summary>
+    /// The name of the <see cref="AppContext"/> data that sets the initial
+    /// <see cref="SamplingInterval"/>.
+    /// </summary>
+    public static string SamplingIntervalConfigName => ConfigName;
+
+    /// <summary>
+    /// Checks one in this many validations, per thread, against the
+    /// reference implementation, or none if zero. Values are rounded up to a
+    /// power of two. Defaults to zero.
+    /// </summary>
+    public static int SamplingInterval
+    {
+        get => s_sampleMask + 1;
+        set
+        {
+            ThrowIfNegative(value);
+            Volatile.Write(ref s_sampleMask, ToSampleMask(value));
+        }
+    }
+
+    [MethodImpl(MethodImplOptions.AggressiveInlining)]
+    internal static bool ShouldSample()
+    {
+        int mask = s_sampleMask;
+        return mask >= 0 && (unchecked(++t_calls) & mask) == 0;
+    }
+
+    internal static void Check(ReadOnlySpan<char> encodedKey, CaskValidationError error)
+    {
+        bool referenceIsValid = CaskReferenceValidator.IsCask(encodedKey);
+
+        if (!CaskTelemetry.RecordShadowValidation(error, referenceIsValid))
+        {
+            return;
+        }
+
+        byte[] utf8 = Encoding.UTF8.GetBytes(encodedKey.ToString());
+        CaskTelemetry.RecordShadowValidationMismatch(CaskKeyFingerprint.Compute(utf8), error, referenceIsValid);
+    }
+
+    internal static void CheckUtf8(ReadOnlySpan<byte> encodedKey, CaskValidationError error)
+    {
+        bool referenceIsValid = CaskReferenceValidator.IsCaskUtf8(encodedKey);
+
+        if (CaskTelemetry.RecordShadowValidation(error, referenceIsValid))
+        {
+            CaskTelemetry.RecordShadowValidationMismatch(CaskKeyFingerprint.Compute(encodedKey), error, referenceIsValid);
+        }
+    }
+
+    internal static void CheckBytes(ReadOnlySpan<byte> decodedKey, CaskValidationError error)
+    {
+        bool referenceIsValid = CaskReferenceValidator.IsCaskBytes(decodedKey);
+
+        if (CaskTelemetry.RecordShadowValidation(error, referenceIsValid))
+        {
+            CaskTelemetry.RecordShadowValidationMismatch(CaskKeyFingerprint.Compute(decodedKey), error, referenceIsValid);
+        }
+    }
+
+    private static int ToSampleMask(int samplingInterval)
+    {
+        if (samplingInterval == 0)
+        {
+            return -1;
+        }
+
+        int interval = 1;
+        while (interval < samplingInterval && interval < MaxSamplingInterval)
+        {
+            interval <<= 1;
+        }
+
+        return interval - 1;
+    }
+
+    private static int GetConfiguredSamplingInterval()
+    {
+        object? data = AppContext.GetData(ConfigName);
+
+        return data switch
+        {
+            int value when value >= 0 => value,
+            string text when int.TryParse(text, NumberStyles.None, CultureInfo.InvariantCulture, out int value) && value >= 0 => value,
+            _ => 0,
+        };
+    }
+}
@@ -0,0 +1,224 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics;
+using System.Diagnostics.Metrics;
+using System.Diagnostics.Tracing;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Metrics and diagnostic events published by the library.
+/// </summary>
+/// <remarks>
+/// Metrics are published through a <see cref="Meter"/> named <see
+/// cref="Name"/> and can be collected with dotnet-counters or OpenTelemetry.
+/// Diagnostic events are published through an <see cref="EventSource"/> of the
+/// same name.
+/// </remarks>
+public static class CaskTelemetry
+{
+    /// <summary>
+    /// The name of the <see cref="Meter"/> and <see cref="EventSource"/> that
+    /// publish CASK telemetry.
+    /// </summary>
+    public static string Name { get; } = "CommonAnnotatedSecurityKeys";
+
+    /*
+     * PERF: Every recording method below first checks the instrument's cached
+     * `Enabled` flag (or the event source's cached `IsEnabled` state) and does
+     * nothing else when there is no listener. Tags are passed as individual
+     * KeyValuePair arguments with cached string values so that recording a
+     * measurement does not allocate.
+     */
+
+    private const string OutcomeTag = "cask.outcome";
+    private const string ReasonTag = "cask.reason";
+    private const string SecretSizeTag = "cask.secret_size";
+
+    private static readonly Meter s_meter = new(Name, typeof(CaskTelemetry).Assembly.GetName().Version?.ToString());
+
+    private static readonly Counter<long> s_keysGenerated = s_meter.CreateCounter<long>(
+        "cask.keys.generated",
+        unit: "{key}",
+        description: "The number of keys generated.");
+
+    private static readonly Histogram<double> s_generateDuration = s_meter.CreateHistogram<double>(
+        "cask.generate.duration",
+        unit: "s",
+        description: "The time taken to generate a key.");
+
+    private static readonly Counter<long> s_keysValidated = s_meter.CreateCounter<long>(
+        "cask.keys.validated",
+        unit: "{key}",
+        description: "The number of keys validated, by outcome and reason.");
+
+    private static readonly Counter<long> s_bytesScanned = s_meter.CreateCounter<long>(
+        "cask.scan.bytes",
+        unit: "By",
+        description: "The number of bytes of text scanned for keys.");
+
+    private static readonly Counter<long> s_keysFound = s_meter.CreateCounter<long>(
+        "cask.scan.matches",
+        unit: "{key}",
+        description: "The number of keys found by scanning.");
+
+    private static readonly Counter<long> s_shadowChecks = s_meter.CreateCounter<long>(
+        "cask.validation.shadow.checks",
+        unit: "{key}",
+        description: "The number of validations checked against the reference implementation, by outcome.");
+
+    private static readonly Counter<long> s_entropyBlocksTested = s_meter.CreateCounter<long>(
+        "cask.entropy.health.blocks",
+        unit: "{block}",
+        description: "The number of blocks of entropy health tested, by outcome and failed test.");
+
+    private static readonly Counter<long> s_entropyBytesTested = s_meter.CreateCounter<long>(
+        "cask.entropy.health.bytes",
+        unit: "By",
+        description: "The number of bytes of entropy health tested.");
+
+    internal static long StartGenerate()
+    {
+        return s_generateDuration.Enabled ? Stopwatch.GetTimestamp() : 0;
+    }
+
+    internal static void RecordGenerate(string providerSignature, SecretSize secretSize, long startTimestamp)
+    {
+        if (startTimestamp != 0)
+        {
+            double elapsed = (Stopwatch.GetTimestamp() - startTimestamp) / (double)Stopwatch.Frequency;
+            s_generateDuration.Record(elapsed, new KeyValuePair<string, object?>(SecretSizeTag, GetSecretSizeTagValue(secretSize)));
+        }
+
+        if (s_keysGenerated.Enabled)
+        {
+            s_keysGenerated.Add(1, new KeyValuePair<string, object?>(SecretSizeTag, GetSecretSizeTagValue(secretSize)));
+        }
+
+        if (CaskEventSource.Log.IsEnabled(EventLevel.Verbose, CaskEventSource.Keywords.Generation))
+        {
+            CaskEventSource.Log.KeyGenerated(providerSignature, (int)secretSize);
+        }
+    }
+
+    /// <summary>
+    /// Counts keys generated in bulk by <see cref="Cask.Reissue(ReadOnlySpan{CaskKey}, Span{CaskKey})"/>,
+    /// which are not timed or traced one by one.
+    /// </summary>
+    internal static void RecordReissue(SecretSize secretSize, long count)
+    {
+        if (count > 0 && s_keysGenerated.Enabled)
+        {
+            s_keysGenerated.Add(count, new KeyValuePair<string, object?>(SecretSizeTag, GetSecretSizeTagValue(secretSize)));
+        }
+    }
+
+    internal static void RecordValidation(CaskValidationError error, int errorOffset, int length)
+    {
+        if (s_keysValidated.Enabled)
+        {
+            s_keysValidated.Add(1,
+                                new KeyValuePair<string, object?>(OutcomeTag, error == CaskValidationError.None ? "valid" : "invalid"),
+                                new KeyValuePair<string, object?>(ReasonTag, GetReasonTagValue(error)));
+        }
+
+        if (error != CaskValidationError.None && CaskEventSource.Log.IsEnabled(EventLevel.Verbose, CaskEventSource.Keywords.Validation))
+        {
+            CaskEventSource.Log.KeyValidationFailed(error, errorOffset, length);
+        }
+    }
+
+    /// <summary>
+    /// Records a shadow validation and returns whether it was a mismatch.
+    /// </summary>
+    internal static bool RecordShadowValidation(CaskValidationError error, bool referenceIsValid)
+    {
+        bool mismatch = (error == CaskValidationError.None) != referenceIsValid;
+
+        if (s_shadowChecks.Enabled)
+        {
+            s_shadowChecks.Add(1, new KeyValuePair<string, object?>(OutcomeTag, mismatch ? "mismatch" : "match"));
+        }
+
+        return mismatch;
+    }
+
+    internal static void RecordShadowValidationMismatch(CaskKeyFingerprint fingerprint, CaskValidationError error, bool referenceIsValid)
+    {
+        if (CaskEventSource.Log.IsEnabled(EventLevel.Warning, CaskEventSource.Keywords.Validation))
+        {
+            CaskEventSource.Log.ShadowValidationMismatch(fingerprint.ToString(), error, referenceIsValid);
+        }
+    }
+
+    internal static void RecordEntropyHealthTest(int length, CaskEntropyHealthFailure failure)
+    {
+        if (s_entropyBlocksTested.Enabled)
+        {
+            s_entropyBlocksTested.Add(1,
+                                      new KeyValuePair<string, object?>(OutcomeTag, failure == CaskEntropyHealthFailure.None ? "pass" : "fail"),
+                                      new KeyValuePair<string, object?>(ReasonTag, GetReasonTagValue(failure)));
+        }
+
+        if (s_entropyBytesTested.Enabled)
+        {
+            s_entropyBytesTested.Add(length);
+        }
+
+        if (failure != CaskEntropyHealthFailure.None && CaskEventSource.Log.IsEnabled(EventLevel.Error, CaskEventSource.Keywords.Generation))
+        {
+            CaskEventSource.Log.EntropyHealthTestFailed(failure, length);
+        }
+    }
+
+    internal static void RecordScan(long bytes, int matches)
+    {
+        if (s_bytesScanned.Enabled)
+        {
+            s_bytesScanned.Add(bytes);
+        }
+
+        if (matches > 0 && s_keysFound.Enabled)
+        {
+            s_keysFound.Add(matches);
+        }
+    }
+
+    private static string GetReasonTagValue(CaskValidationError error)
+    {
+        return error switch
+        {
+            CaskValidationError.None => "none",
+            CaskValidationError.InvalidLength => "length",
+            CaskValidationError.InvalidCharacter => "character",
+            CaskValidationError.InvalidCaskSignature => "signature",
+            CaskValidationError.InvalidPadding => "padding",
+            CaskValidationError.SecretSizeMismatch => "secret_size",
+            CaskValidationError.ProviderDataSizeMismatch => "provider_data_size",
+            CaskValidationError.InvalidTimestamp => "timestamp",
+            _ => "unknown",
+        };
+    }
+
+    private static string GetReasonTagValue(CaskEntropyHealthFailure failure)
+    {
+        return failure switch
+        {
+            CaskEntropyHealthFailure.None => "none",
+            CaskEntropyHealthFailure.RepetitionCount => "repetition_count",
+            CaskEntropyHealthFailure.AdaptiveProportion => "adaptive_proportion",
+            _ => "unknown",
+        };
+    }
+
+    private static string GetSecretSizeTagValue(SecretSize secretSize)
+    {
+        return secretSize switch
+        {
+            SecretSize.Bits256 => "256",
+            SecretSize.Bits512 => "512",
+            _ => "unknown",
+        };
+    }
+}
@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// The reason that input is not a valid CASK key, as returned by <see
+/// cref="Cask.Validate(ReadOnlySpan{char}, out int)"/> and related methods.
+/// </summary>
+public enum CaskValidationError
+{
+    /// <summary>
+    /// The key is valid.
+    /// </summary>
+    None = 0,
+
+    /// <summary>
+    /// The input is too short, too long, or not aligned to a 3-byte (4
+    /// character) boundary.
+    /// </summary>
+    InvalidLength,
+
+    /// <summary>
+    /// The encoded input contains a character that is not a printable
+    /// base64url character. Whitespace and '=' padding are not allowed.
+    /// </summary>
+    InvalidCharacter,
+
+    /// <summary>
+    /// The fixed CASK signature, "QJJQ", is not at the position implied by
+    /// the input length.
+    /// </summary>
+    InvalidCaskSignature,
+
+    /// <summary>
+    /// The zero padding after the sensitive data, or one of the reserved zero
+    /// fields, is not zero.
+    /// </summary>
+    InvalidPadding,
+
+    /// <summary>
+    /// The encoded secret size does not match the secret size implied by the
+    /// input length.
+    /// </summary>
+    SecretSizeMismatch,
+
+    /// <summary>
+    /// The encoded provider data size does not match the input length.
+    /// </summary>
+    ProviderDataSizeMismatch,
+
+    /// <summary>
+    /// A month, day, hour, minute, or second field of the timestamp is out
+    /// of range.
+    /// </summary>
+    InvalidTimestamp,
+}
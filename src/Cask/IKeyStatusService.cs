@@ -0,0 +1,17 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// A remote service that reports the status of keys by fingerprint. Wrap it
+/// in a <see cref="KeyStatusClient"/> rather than calling it for each key.
+/// </summary>
+public interface IKeyStatusService
+{
+    /// <summary>
+    /// Looks up the status of a batch of keys in one request.
+    /// </summary>
+    /// <returns>The status of each key, in the same order.</returns>
+    Task<IReadOnlyList<KeyStatus>> GetStatusesAsync(IReadOnlyList<CaskKeyFingerprint> fingerprints, CancellationToken cancellationToken);
+}
@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Collections.Concurrent;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// An in-process stand-in for a remote <see cref="IKeyStatusService"/>, for
+/// testing and measuring code that looks up key statuses without a network.
+/// </summary>
+public sealed class InMemoryKeyStatusService : IKeyStatusService
+{
+    private readonly ConcurrentDictionary<CaskKeyFingerprint, KeyStatus> _statuses = new();
+    private readonly TimeSpan _latency;
+
+    private long _requests;
+    private long _requestedKeys;
+
+    /// <param name="latency">
+    /// How long each request takes, to simulate the round trip to a remote
+    /// service.
+    /// </param>
+    public InMemoryKeyStatusService(TimeSpan latency = default)
+    {
+        _latency = latency;
+    }
+
+    /// <summary>
+    /// The number of requests received.
+    /// </summary>
+    public long Requests => Interlocked.Read(ref _requests);
+
+    /// <summary>
+    /// The number of keys in all requests received.
+    /// </summary>
+    public long RequestedKeys => Interlocked.Read(ref _requestedKeys);
+
+    /// <summary>
+    /// Sets the status that is reported for a key.
+    /// </summary>
+    public void SetStatus(CaskKey key, KeyStatus status)
+    {
+        SetStatus(CaskKeyFingerprint.Create(key), status);
+    }
+
+    /// <inheritdoc cref="SetStatus(CaskKey, KeyStatus)"/>
+    public void SetStatus(CaskKeyFingerprint fingerprint, KeyStatus status)
+    {
+        _statuses[fingerprint] = status;
+    }
+
+    public async Task<IReadOnlyList<KeyStatus>> GetStatusesAsync(IReadOnlyList<CaskKeyFingerprint> fingerprints, CancellationToken cancellationToken)
+    {
+        ThrowIfNull(fingerprints);
+
+        Interlocked.Increment(ref _requests);
+        Interlocked.Add(ref _requestedKeys, fingerprints.Count);
+
+        if (_latency > TimeSpan.Zero)
+        {
+            await Task.Delay(_latency, cancellationToken).ConfigureAwait(false);
+        }
+
+        var statuses = new KeyStatus[fingerprints.Count];
+        for (int i = 0; i < statuses.Length; i++)
+        {
+            _statuses.TryGetValue(fingerprints[i], out statuses[i]);
+        }
+
+        return statuses;
+    }
+}
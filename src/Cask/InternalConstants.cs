@@ -8,6 +8,9 @@ namespace CommonAnnotatedSecurityKeys;
 /// <remarks>
 /// Move things elsewhere if/when they need to be made public, and avoid `const` in 
 /// public API in favor of static readonly properties.
+///
+/// PERF: Prefer `const` here over `static readonly` fields computed by helper
+/// methods so that this class needs no static initialization at startup.
 /// </remarks>
 internal static partial class InternalConstants
 {
@@ -57,7 +60,7 @@ internal static partial class InternalConstants
     /// followed by the secret size, the optional provider data size, and
     /// provider key kind.
     /// </summary>
-    public static readonly int PaddingSizesAndProviderKindInChars = BytesToBase64Chars(PaddingSizesAndProviderKindInBytes);
+    public const int PaddingSizesAndProviderKindInChars = PaddingSizesAndProviderKindInBytes / 3 * 4;
 
     /// <summary>
     /// The number of bytes required to express 12 bits of padding followed by
@@ -70,7 +73,7 @@ internal static partial class InternalConstants
     /// followed by the secret time-of-allocation (year, month, day, hour,
     /// minute, second).
     /// </summary>
-    public static readonly int PaddingAndTimestampSizeInChars = BytesToBase64Chars(PaddingAndTimestampSizeInBytes);
+    public const int PaddingAndTimestampSizeInChars = PaddingAndTimestampSizeInBytes / 3 * 4;
 
     /// <summary>
     /// The number of bytes in the fixed components of a primary key, from the
@@ -0,0 +1,397 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Tracks when live keys reach a maximum age, from the timestamps in the keys
+/// themselves, and reports them in batches as they expire.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Keys are kept in a hierarchical timer wheel: five levels of 64 slots,
+/// where a slot at level L covers 64^L ticks of <see cref="Resolution"/>.
+/// A key is placed at the lowest level whose range reaches its deadline,
+/// and is moved down a level each time the wheel reaches the start of its
+/// slot, until it expires from level 0. Adding and removing a key takes
+/// constant time, and advancing the wheel only touches the keys that expire
+/// or move down, so there is no periodic scan of all keys. Ticks in which no
+/// occupied slot is reached are skipped over rather than visited, so
+/// catching up on a long gap costs no more than the keys it moves. With the
+/// default resolution of 1 second, the wheel spans 34 years; keys with later
+/// deadlines wait at the top level.
+/// </para>
+/// <para>
+/// Entries are stored in parallel arrays linked by index rather than as
+/// objects, and each costs about 32 bytes plus its entry in a dictionary
+/// from fingerprint to index.
+/// </para>
+/// <para>
+/// The scheduler does not keep time itself: call <see cref="Advance"/>
+/// periodically, for example from a timer, with the current time. All
+/// members are thread-safe.
+/// </para>
+/// </remarks>
+public sealed class KeyExpiryScheduler
+{
+    private const int SlotBits = 6;
+    private const int SlotCount = 1 << SlotBits;
+    private const int SlotMask = SlotCount - 1;
+    private const int LevelCount = 5;
+    private const int None = -1;
+
+    // The slot of entries that were already due when they were added.
+    private const int DueSlot = LevelCount * SlotCount;
+
+    private readonly object _lock = new();
+    private readonly long _resolutionTicks;
+    private readonly long _maxKeyAgeInTicks;
+    private readonly Dictionary<CaskKeyFingerprint, int> _indexes = [];
+
+    // The head entry of each slot, by level and then slot, and of the due
+    // slot.
+    private readonly int[] _slots = new int[DueSlot + 1];
+
+    // The entries, linked into the list of the slot they are in or, when
+    // unused, into the free list. The previous entry of the head of a list
+    // is the complement of its slot, so any entry can be unlinked in
+    // constant time.
+    private CaskKeyFingerprint[] _fingerprints = new CaskKeyFingerprint[16];
+    private long[] _deadlines = new long[16];
+    private int[] _next = new int[16];
+    private int[] _previous = new int[16];
+    private int _free = None;
+    private int _used;
+
+    private long _currentTick;
+
+    /// <param name="maxKeyAge">The age at which keys expire.</param>
+    /// <param name="now">The current time.</param>
+    /// <param name="resolution">
+    /// The granularity of deadlines. Defaults to 1 second, which is the
+    /// granularity of key timestamps.
+    /// </param>
+    public KeyExpiryScheduler(TimeSpan maxKeyAge, DateTimeOffset now, TimeSpan? resolution = null)
+    {
+        TimeSpan tick = resolution ?? TimeSpan.FromSeconds(1);
+
+        if (maxKeyAge < TimeSpan.Zero)
+        {
+            throw new ArgumentOutOfRangeException(nameof(maxKeyAge), "The maximum key age must not be negative.");
+        }
+
+        if (tick <= TimeSpan.Zero)
+        {
+            throw new ArgumentOutOfRangeException(nameof(resolution), "The resolution must be positive.");
+        }
+
+        MaxKeyAge = maxKeyAge;
+        Resolution = tick;
+        _resolutionTicks = tick.Ticks;
+        _maxKeyAgeInTicks = (maxKeyAge.Ticks / tick.Ticks) + (maxKeyAge.Ticks % tick.Ticks == 0 ? 0 : 1);
+        _currentTick = ToTick(now);
+        _slots.AsSpan().Fill(None);
+    }
+
+    /// <summary>
+    /// The age at which keys expire.
+    /// </summary>
+    public TimeSpan MaxKeyAge { get; }
+
+    /// <summary>
+    /// The granularity of deadlines.
+    /// </summary>
+    public TimeSpan Resolution { get; }
+
+    /// <summary>
+    /// The number of keys that have not expired or been removed.
+    /// </summary>
+    public int Count
+    {
+        get
+        {
+            lock (_lock)
+            {
+                return _indexes.Count;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Schedules a key to expire at its timestamp plus <see cref="MaxKeyAge"/>.
+    /// A key that is already that old expires at the next <see cref="Advance"/>.
+    /// </summary>
+    /// <returns>False if the key was already scheduled.</returns>
+    public bool Add(CaskKey key)
+    {
+        return Add(CaskKeyFingerprint.Create(key), key.Timestamp);
+    }
+
+    /// <summary>
+    /// Schedules a key, identified by its fingerprint, that was generated at
+    /// the given time.
+    /// </summary>
+    /// <inheritdoc cref="Add(CaskKey)"/>
+    public bool Add(CaskKeyFingerprint fingerprint, DateTimeOffset timestamp)
+    {
+        long generated = ToTick(timestamp);
+        long deadline = generated > long.MaxValue - _maxKeyAgeInTicks ? long.MaxValue : generated + _maxKeyAgeInTicks;
+
+        lock (_lock)
+        {
+            if (_indexes.ContainsKey(fingerprint))
+            {
+                return false;
+            }
+
+            int index = Allocate();
+            _fingerprints[index] = fingerprint;
+            _deadlines[index] = deadline;
+            _indexes.Add(fingerprint, index);
+            Place(index);
+            return true;
+        }
+    }
+
+    /// <summary>
+    /// Stops tracking a key, for example because it was revoked.
+    /// </summary>
+    /// <returns>False if the key was not scheduled.</returns>
+    public bool Remove(CaskKey key)
+    {
+        return Remove(CaskKeyFingerprint.Create(key));
+    }
+
+    /// <inheritdoc cref="Remove(CaskKey)"/>
+    public bool Remove(CaskKeyFingerprint fingerprint)
+    {
+        lock (_lock)
+        {
+            if (!_indexes.TryGetValue(fingerprint, out int index))
+            {
+                return false;
+            }
+
+            _indexes.Remove(fingerprint);
+            Unlink(index);
+            Free(index);
+            return true;
+        }
+    }
+
+    /// <summary>
+    /// Advances the wheel to the given time and reports the keys that
+    /// expired, if any, in one call to <paramref name="onExpired"/>, which is
+    /// made after the keys are removed and outside of any lock.
+    /// </summary>
+    /// <returns>The number of keys that expired.</returns>
+    public int Advance(DateTimeOffset now, Action<IReadOnlyList<CaskKeyFingerprint>> onExpired)
+    {
+        ThrowIfNull(onExpired);
+
+        long targetTick = ToTick(now);
+        var expired = new List<CaskKeyFingerprint>();
+
+        lock (_lock)
+        {
+            Expire(DueSlot, expired);
+
+            while (_currentTick < targetTick)
+            {
+                // Nothing moves or expires in the ticks before the next one
+                // that reaches an occupied slot, so go straight to it.
+                long nextTick = _indexes.Count == 0 ? long.MaxValue : GetNextOccupiedTick();
+                if (nextTick > targetTick)
+                {
+                    _currentTick = targetTick;
+                    break;
+                }
+
+                _currentTick = nextTick;
+
+                // Move keys down from the slots that start at this tick,
+                // highest level first, so that keys can move down several
+                // levels in one tick.
+                int level = 0;
+                while (level + 1 < LevelCount && (_currentTick & ((1L << (SlotBits * (level + 1))) - 1)) == 0)
+                {
+                    level++;
+                }
+
+                for (; level > 0; level--)
+                {
+                    Cascade(level);
+                }
+
+                // Keys moved down with a deadline of this very tick are put
+                // in the due slot.
+                Expire((int)(_currentTick & SlotMask), expired);
+                Expire(DueSlot, expired);
+            }
+        }
+
+        if (expired.Count > 0)
+        {
+            onExpired(expired);
+        }
+
+        return expired.Count;
+    }
+
+    /// <summary>
+    /// Finds the next tick that reaches a slot with entries in it, either to
+    /// expire them from level 0 or to move them down from a higher level.
+    /// </summary>
+    private long GetNextOccupiedTick()
+    {
+        long nextTick = long.MaxValue;
+
+        for (int level = 0; level < LevelCount; level++)
+        {
+            int shift = SlotBits * level;
+            long position = _currentTick >> shift;
+
+            // The slots of a level are reached at multiples of its span, and
+            // higher levels have longer spans, so if the next slot of this
+            // level is no sooner, neither is any slot above it.
+            if ((position + 1) << shift >= nextTick)
+            {
+                break;
+            }
+
+            // A full turn, since the top level's current slot can hold keys
+            // due in later turns of the wheel.
+            for (int step = 1; step <= SlotCount; step++)
+            {
+                if (_slots[(level * SlotCount) + (int)((position + step) & SlotMask)] != None)
+                {
+                    nextTick = Math.Min(nextTick, (position + step) << shift);
+                    break;
+                }
+            }
+        }
+
+        return nextTick;
+    }
+
+    private long ToTick(DateTimeOffset time)
+    {
+        return time.UtcTicks / _resolutionTicks;
+    }
+
+    /// <summary>
+    /// Links an entry into the slot for its deadline at the lowest level
+    /// that shares all higher deadline bits with the current tick.
+    /// </summary>
+    private void Place(int index)
+    {
+        long deadline = _deadlines[index];
+
+        if (deadline <= _currentTick)
+        {
+            Link(DueSlot, index);
+            return;
+        }
+
+        int level = 0;
+        while (level < LevelCount - 1 && (deadline >> (SlotBits * (level + 1))) != (_currentTick >> (SlotBits * (level + 1))))
+        {
+            level++;
+        }
+
+        int slot = (int)((deadline >> (SlotBits * level)) & SlotMask);
+        Link((level * SlotCount) + slot, index);
+    }
+
+    private void Cascade(int level)
+    {
+        int slot = (level * SlotCount) + (int)((_currentTick >> (SlotBits * level)) & SlotMask);
+
+        int index = _slots[slot];
+        _slots[slot] = None;
+
+        while (index != None)
+        {
+            int next = _next[index];
+            Place(index);
+            index = next;
+        }
+    }
+
+    private void Expire(int slot, List<CaskKeyFingerprint> expired)
+    {
+        int index = _slots[slot];
+        _slots[slot] = None;
+
+        while (index != None)
+        {
+            int next = _next[index];
+            expired.Add(_fingerprints[index]);
+            _indexes.Remove(_fingerprints[index]);
+            Free(index);
+            index = next;
+        }
+    }
+
+    private void Link(int slot, int index)
+    {
+        int head = _slots[slot];
+        _previous[index] = ~slot;
+        _next[index] = head;
+
+        if (head != None)
+        {
+            _previous[head] = index;
+        }
+
+        _slots[slot] = index;
+    }
+
+    private void Unlink(int index)
+    {
+        int previous = _previous[index];
+        int next = _next[index];
+
+        if (next != None)
+        {
+            _previous[next] = previous;
+        }
+
+        if (previous >= 0)
+        {
+            _next[previous] = next;
+        }
+        else
+        {
+            _slots[~previous] = next;
+        }
+    }
+
+    private int Allocate()
+    {
+        if (_free != None)
+        {
+            int index = _free;
+            _free = _next[index];
+            return index;
+        }
+
+        if (_used == _fingerprints.Length)
+        {
+            int capacity = _used * 2;
+            Array.Resize(ref _fingerprints, capacity);
+            Array.Resize(ref _deadlines, capacity);
+            Array.Resize(ref _next, capacity);
+            Array.Resize(ref _previous, capacity);
+        }
+
+        return _used++;
+    }
+
+    private void Free(int index)
+    {
+        _fingerprints[index] = default;
+        _next[index] = _free;
+        _free = index;
+    }
+}
@@ -0,0 +1,153 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+using System.Runtime.InteropServices;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// What an issuer records about a key it issued, as kept by a <see
+/// cref="KeyMetadataStore"/>.
+/// </summary>
+public readonly record struct KeyMetadata
+{
+    // A record is the fingerprint, the owner, the timestamp in ticks, the
+    // provider signature in ASCII, the provider key kind, the status and
+    // flags, padded to 48 bytes.
+    internal const int RecordSize = 48;
+    internal const byte PresentFlag = 0x01;
+    internal const byte RemovedFlag = 0x02;
+
+    private readonly string? _providerSignature;
+    private readonly char _providerKeyKind;
+
+    /// <summary>
+    /// The four-character signature of the provider that issued the key.
+    /// </summary>
+    public string ProviderSignature
+    {
+        get => _providerSignature ?? "AAAA";
+        init
+        {
+            ThrowIfNull(value);
+
+            if (value.Length != 4 || !IsValidForBase64Url(value))
+            {
+                throw new ArgumentException("The provider signature must be 4 base64url characters.", nameof(value));
+            }
+
+            _providerSignature = value;
+        }
+    }
+
+    /// <summary>
+    /// The provider-defined kind of the key.
+    /// </summary>
+    public char ProviderKeyKind
+    {
+        get => _providerKeyKind;
+        init
+        {
+            if (value > 0x7F)
+            {
+                throw new ArgumentOutOfRangeException(nameof(value), value, "The provider key kind must be an ASCII character.");
+            }
+
+            _providerKeyKind = value;
+        }
+    }
+
+    /// <summary>
+    /// When the key was issued, stored to the tick in UTC.
+    /// </summary>
+    public DateTimeOffset Timestamp { get; init; }
+
+    /// <summary>
+    /// The principal, tenant or other owner to which the key was issued.
+    /// </summary>
+    public Guid Owner { get; init; }
+
+    /// <summary>
+    /// The status of the key.
+    /// </summary>
+    public KeyStatus Status { get; init; }
+
+    /// <summary>
+    /// Gets the metadata of a newly issued key from the key itself.
+    /// </summary>
+    public static KeyMetadata FromKey(CaskKey key, Guid owner, KeyStatus status = KeyStatus.Active)
+    {
+        return new KeyMetadata
+        {
+            ProviderSignature = key.ProviderSignature,
+            ProviderKeyKind = key.ProviderKeyKind,
+            Timestamp = key.Timestamp,
+            Owner = owner,
+            Status = status,
+        };
+    }
+
+    /// <summary>
+    /// Writes a record of this metadata for a key.
+    /// </summary>
+    internal void WriteRecord(Span<byte> record, CaskKeyFingerprint fingerprint)
+    {
+        record = record[..RecordSize];
+        fingerprint.WriteTo(record);
+        MemoryMarshal.Cast<byte, Guid>(record.Slice(16, 16))[0] = Owner;
+        BinaryPrimitives.WriteInt64LittleEndian(record[32..], Timestamp.UtcTicks);
+
+        string providerSignature = ProviderSignature;
+        for (int i = 0; i < 4; i++)
+        {
+            record[40 + i] = (byte)providerSignature[i];
+        }
+
+        record[44] = (byte)ProviderKeyKind;
+        record[45] = (byte)Status;
+        record[46] = PresentFlag;
+        record[47] = 0;
+    }
+
+    /// <summary>
+    /// Writes a record that marks a key as removed.
+    /// </summary>
+    internal static void WriteRemovedRecord(Span<byte> record, CaskKeyFingerprint fingerprint)
+    {
+        record = record[..RecordSize];
+        record.Clear();
+        fingerprint.WriteTo(record);
+        record[46] = PresentFlag | RemovedFlag;
+    }
+
+    /// <summary>
+    /// Reads the metadata in a record.
+    /// </summary>
+    /// <returns>False if the record marks the key as removed.</returns>
+    internal static bool TryReadRecord(ReadOnlySpan<byte> record, out KeyMetadata metadata)
+    {
+        if ((record[46] & RemovedFlag) != 0)
+        {
+            metadata = default;
+            return false;
+        }
+
+        Span<char> providerSignature = stackalloc char[4];
+        for (int i = 0; i < 4; i++)
+        {
+            providerSignature[i] = (char)record[40 + i];
+        }
+
+        metadata = new KeyMetadata
+        {
+            ProviderSignature = providerSignature.ToString(),
+            ProviderKeyKind = (char)record[44],
+            Timestamp = new DateTimeOffset(BinaryPrimitives.ReadInt64LittleEndian(record[32..]), TimeSpan.Zero),
+            Owner = MemoryMarshal.Cast<byte, Guid>(record.Slice(16, 16))[0],
+            Status = (KeyStatus)record[45],
+        };
+
+        return true;
+    }
+}
@@ -0,0 +1,367 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+using System.Diagnostics.CodeAnalysis;
+using System.IO.MemoryMappedFiles;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// An immutable, memory-mapped file of <see cref="KeyMetadata"/> records
+/// sorted by fingerprint, one level of a <see cref="KeyMetadataStore"/>.
+/// </summary>
+/// <remarks>
+/// <para>
+/// The format, with all numbers little-endian, is a 64-byte header (magic
+/// "CKMR", version, record count, the first and last generation of the
+/// writes in the run, the number of filter blocks and the bits of filter per
+/// key), the records, a blocked Bloom filter of 64-byte blocks, and a fence
+/// pointer for every <see cref="BlockSize"/> records, which is the first 64
+/// bits of the first fingerprint in the block.
+/// </para>
+/// <para>
+/// A lookup of a key that is not in the run reads one cache line of the
+/// filter most of the time. Otherwise it searches the fence pointers that
+/// a directory on their leading bits, built when the run is opened, narrows
+/// to a block or two, and then one block of records.
+/// </para>
+/// <para>
+/// A run is referenced by each version of the store that includes it, and
+/// is unmapped when the last of them is released, and deleted if it was
+/// replaced by compaction.
+/// </para>
+/// </remarks>
+internal sealed unsafe class KeyMetadataRun
+{
+    internal const uint Magic = 0x524D4B43; // "CKMR"
+    internal const uint Version = 2;
+    internal const int HeaderSize = 64;
+    internal const int BlockSize = 64;
+    internal const int FilterBlockSize = 64;
+    internal const int MaxFilterBitsPerKey = 64;
+    private const int FilterProbesPerHash = 7;
+    private const int MaxBucketBits = 24;
+
+    private readonly MemoryMappedFile _file;
+    private readonly MemoryMappedViewAccessor _view;
+    private readonly byte* _records;
+    private readonly byte* _filter;
+    private readonly byte* _fences;
+    private readonly long _filterBlocks;
+    private readonly int _filterProbes;
+    private readonly long _blockCount;
+    private readonly BucketDirectory _directory;
+    private int _references = 1;
+    private volatile bool _obsolete;
+
+    private KeyMetadataRun(string path, MemoryMappedFile file, MemoryMappedViewAccessor view, byte* pointer, long length)
+    {
+        ReadOnlySpan<byte> header = new(pointer, HeaderSize);
+
+        if (BinaryPrimitives.ReadUInt32LittleEndian(header) != Magic ||
+            BinaryPrimitives.ReadUInt32LittleEndian(header[4..]) != Version)
+        {
+            ThrowInvalidRun();
+        }
+
+        Count = BinaryPrimitives.ReadInt64LittleEndian(header[8..]);
+        MinGeneration = BinaryPrimitives.ReadInt64LittleEndian(header[16..]);
+        MaxGeneration = BinaryPrimitives.ReadInt64LittleEndian(header[24..]);
+        _filterBlocks = BinaryPrimitives.ReadInt64LittleEndian(header[32..]);
+        int filterBitsPerKey = BinaryPrimitives.ReadInt32LittleEndian(header[40..]);
+        _blockCount = (Count + BlockSize - 1) / BlockSize;
+
+        if (Count < 0 || Count > length / KeyMetadata.RecordSize ||
+            _filterBlocks < 1 || _filterBlocks > uint.MaxValue || _blockCount > int.MaxValue ||
+            filterBitsPerKey < 1 || filterBitsPerKey > MaxFilterBitsPerKey ||
+            MinGeneration > MaxGeneration ||
+            GetLength(Count, _filterBlocks) != length)
+        {
+            ThrowInvalidRun();
+        }
+
+        Path = path;
+        _file = file;
+        _view = view;
+        _records = pointer + HeaderSize;
+        _filter = _records + (Count * KeyMetadata.RecordSize);
+        _fences = _filter + (_filterBlocks * FilterBlockSize);
+        _filterProbes = GetFilterProbes(filterBitsPerKey);
+
+        // A directory of buckets on the leading bits of the fences, sized to
+        // about one block per bucket, narrows the search of the fences to a
+        // block or two, so a lookup touches few of their pages.
+        _directory = new BucketDirectory((int)_blockCount, MaxBucketBits, block => ReadUInt64((ulong*)_fences, block));
+    }
+
+    public string Path { get; }
+
+    public long Count { get; }
+
+    /// <summary>
+    /// The generation of the oldest write log whose writes are in the run.
+    /// </summary>
+    public long MinGeneration { get; }
+
+    /// <summary>
+    /// The generation of the newest write log whose writes are in the run.
+    /// </summary>
+    public long MaxGeneration { get; }
+
+    /// <summary>
+    /// Maps a run file, with one reference, which the caller owns.
+    /// </summary>
+    /// <exception cref="InvalidDataException">The file is not a valid run.</exception>
+    public static KeyMetadataRun Open(string path)
+    {
+        long length = new FileInfo(path).Length;
+        if (length < HeaderSize)
+        {
+            ThrowInvalidRun();
+        }
+
+        var file = MemoryMappedFile.CreateFromFile(path, FileMode.Open, mapName: null, capacity: 0, MemoryMappedFileAccess.Read);
+        MemoryMappedViewAccessor? view = null;
+        byte* pointer = null;
+
+        try
+        {
+            view = file.CreateViewAccessor(0, length, MemoryMappedFileAccess.Read);
+            view.SafeMemoryMappedViewHandle.AcquirePointer(ref pointer);
+            return new KeyMetadataRun(path, file, view, pointer + view.PointerOffset, length);
+        }
+        catch
+        {
+            if (pointer != null)
+            {
+                view!.SafeMemoryMappedViewHandle.ReleasePointer();
+            }
+
+            view?.Dispose();
+            file.Dispose();
+            throw;
+        }
+    }
+
+    /// <summary>
+    /// Gets the length of a run file.
+    /// </summary>
+    public static long GetLength(long count, long filterBlocks)
+    {
+        long blockCount = (count + BlockSize - 1) / BlockSize;
+        return HeaderSize + (count * KeyMetadata.RecordSize) + (filterBlocks * FilterBlockSize) + (blockCount * sizeof(ulong));
+    }
+
+    /// <summary>
+    /// Chooses the number of filter blocks for a number of keys.
+    /// </summary>
+    public static long GetFilterBlocks(long count, int bitsPerKey)
+    {
+        return Math.Max(1, ((count * bitsPerKey) + (FilterBlockSize * 8) - 1) / (FilterBlockSize * 8));
+    }
+
+    /// <summary>
+    /// Chooses the number of bits of the filter set for each key, which for
+    /// b bits per key is about b ln 2, the number with the fewest false
+    /// positives.
+    /// </summary>
+    public static int GetFilterProbes(int bitsPerKey)
+    {
+        return Math.Max(1, (int)Math.Round(bitsPerKey * 0.69));
+    }
+
+    /// <summary>
+    /// Gets the filter block of a key. The block is chosen by the first 64
+    /// bits of the fingerprint and the bits within it by the last 64, which
+    /// are independent and uniformly distributed.
+    /// </summary>
+    public static long GetFilterBlock(CaskKeyFingerprint fingerprint, long filterBlocks)
+    {
+        return (long)(((fingerprint.High >> 32) * (ulong)filterBlocks) >> 32);
+    }
+
+    /// <summary>
+    /// Gets the bit of its filter block that a probe of a key sets. Probes
+    /// are taken in order, starting from a hash that is the last 64 bits of
+    /// the fingerprint.
+    /// </summary>
+    /// <remarks>
+    /// Each hash gives seven probes of 9 bits, and is mixed again for the
+    /// next seven, so that every probe is independent of the others.
+    /// </remarks>
+    public static int GetFilterBit(ref ulong hash, int probe)
+    {
+        int slice = probe % FilterProbesPerHash;
+
+        if (slice == 0 && probe > 0)
+        {
+            // The finalizer of SplitMix64.
+            ulong mixed = unchecked(hash + 0x9E3779B97F4A7C15);
+            mixed = unchecked((mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9);
+            mixed = unchecked((mixed ^ (mixed >> 27)) * 0x94D049BB133111EB);
+            hash = mixed ^ (mixed >> 31);
+        }
+
+        return (int)((hash >> (slice * 9)) & ((FilterBlockSize * 8) - 1));
+    }
+
+    /// <summary>
+    /// Finds the record of a key.
+    /// </summary>
+    public bool TryFind(CaskKeyFingerprint fingerprint, out ReadOnlySpan<byte> record)
+    {
+        if (Count == 0 || !MayContain(fingerprint))
+        {
+            record = default;
+            return false;
+        }
+
+        // Find the blocks whose fences admit the key. More than one only if
+        // fingerprints that share their first 64 bits straddle blocks.
+        ulong high = fingerprint.High;
+        _directory.GetRange(high, out int start, out int end);
+        long bucketStart = Math.Max(0, start - 1);
+        long bucketEnd = Math.Max(0, end - 1);
+        long first = LastBlockBefore(high, inclusive: false, bucketStart, bucketEnd);
+        long last = LastBlockBefore(high, inclusive: true, bucketStart, bucketEnd);
+
+        long low = first * BlockSize;
+        long top = Math.Min(Count, (last + 1) * BlockSize) - 1;
+
+        while (low <= top)
+        {
+            long middle = low + ((top - low) >> 1);
+            ReadOnlySpan<byte> candidate = GetRecord(middle);
+            int comparison = CaskKeyFingerprint.Compare(CaskKeyFingerprint.Read(candidate), fingerprint);
+
+            if (comparison == 0)
+            {
+                record = candidate;
+                return true;
+            }
+
+            if (comparison < 0)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                top = middle - 1;
+            }
+        }
+
+        record = default;
+        return false;
+    }
+
+    public ReadOnlySpan<byte> GetRecord(long index)
+    {
+        return new ReadOnlySpan<byte>(_records + (index * KeyMetadata.RecordSize), KeyMetadata.RecordSize);
+    }
+
+    public void AddReference()
+    {
+        Interlocked.Increment(ref _references);
+    }
+
+    /// <summary>
+    /// Releases a reference, and unmaps the run if it was the last one.
+    /// </summary>
+    public void Release()
+    {
+        if (Interlocked.Decrement(ref _references) != 0)
+        {
+            return;
+        }
+
+        _view.SafeMemoryMappedViewHandle.ReleasePointer();
+        _view.Dispose();
+        _file.Dispose();
+
+        if (_obsolete)
+        {
+            DeleteFile(Path);
+        }
+    }
+
+    /// <summary>
+    /// Marks the run to be deleted once it is unmapped.
+    /// </summary>
+    public void MarkObsolete()
+    {
+        _obsolete = true;
+    }
+
+    internal static void DeleteFile(string path)
+    {
+        try
+        {
+            File.Delete(path);
+        }
+        catch (IOException)
+        {
+            // A file that cannot be deleted now is deleted when the store is
+            // next opened.
+        }
+        catch (UnauthorizedAccessException)
+        {
+        }
+    }
+
+    private bool MayContain(CaskKeyFingerprint fingerprint)
+    {
+        ulong* block = (ulong*)(_filter + (GetFilterBlock(fingerprint, _filterBlocks) * FilterBlockSize));
+        ulong hash = fingerprint.Low;
+
+        for (int probe = 0; probe < _filterProbes; probe++)
+        {
+            int bit = GetFilterBit(ref hash, probe);
+            if ((ReadUInt64(block, bit >> 6) & (1UL << (bit & 63))) == 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /// <summary>
+    /// Finds the last block whose first key is less than, or with <paramref
+    /// name="inclusive"/> at most, the given leading 64 bits, or the first
+    /// block of the range.
+    /// </summary>
+    private long LastBlockBefore(ulong high, bool inclusive, long low, long top)
+    {
+        ulong* fences = (ulong*)_fences;
+
+        while (low < top)
+        {
+            long middle = low + ((top - low + 1) >> 1);
+            ulong fence = ReadUInt64(fences, middle);
+
+            if (fence < high || (inclusive && fence == high))
+            {
+                low = middle;
+            }
+            else
+            {
+                top = middle - 1;
+            }
+        }
+
+        return low;
+    }
+
+    private static ulong ReadUInt64(ulong* values, long index)
+    {
+        ulong value = values[index];
+        return BitConverter.IsLittleEndian ? value : BinaryPrimitives.ReverseEndianness(value);
+    }
+
+    [DoesNotReturn]
+    private static void ThrowInvalidRun()
+    {
+        throw new InvalidDataException("The file is not a valid key metadata run.");
+    }
+}
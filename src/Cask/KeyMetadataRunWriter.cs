@@ -0,0 +1,160 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+using System.Diagnostics;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Writes a <see cref="KeyMetadataRun"/> from records added in order of
+/// fingerprint.
+/// </summary>
+/// <remarks>
+/// The run is written to a temporary file that is flushed to disk and then
+/// renamed, so a run file is either complete or absent. Records are
+/// streamed to the file, and only the filter and fence pointers are kept in
+/// memory, which for 100 million keys take about 140 MB.
+/// </remarks>
+internal sealed class KeyMetadataRunWriter : IDisposable
+{
+    private const int BufferRecords = 1024;
+
+    private readonly string _path;
+    private readonly string _temporaryPath;
+    private readonly FileStream _stream;
+    private readonly long _minGeneration;
+    private readonly long _maxGeneration;
+    private readonly long _filterBlocks;
+    private readonly int _filterBitsPerKey;
+    private readonly int _filterProbes;
+    private readonly ulong[] _filter;
+    private readonly List<ulong> _fences = [];
+    private readonly byte[] _buffer = new byte[BufferRecords * KeyMetadata.RecordSize];
+    private int _bufferedBytes;
+    private long _count;
+    private CaskKeyFingerprint _last;
+    private bool _completed;
+
+    /// <param name="path">The path of the run file.</param>
+    /// <param name="minGeneration">The generation of the oldest write log whose writes are in the run.</param>
+    /// <param name="maxGeneration">The generation of the newest write log whose writes are in the run.</param>
+    /// <param name="maxCount">The most records that will be added, which sizes the filter.</param>
+    /// <param name="bitsPerKey">
+    /// The bits of filter per record, which are stored in the run so that
+    /// readers set the same number of probes.
+    /// </param>
+    public KeyMetadataRunWriter(string path, long minGeneration, long maxGeneration, long maxCount, int bitsPerKey)
+    {
+        _path = path;
+        _temporaryPath = path + ".tmp";
+        _minGeneration = minGeneration;
+        _maxGeneration = maxGeneration;
+        _filterBlocks = KeyMetadataRun.GetFilterBlocks(maxCount, bitsPerKey);
+        _filterBitsPerKey = bitsPerKey;
+        _filterProbes = KeyMetadataRun.GetFilterProbes(bitsPerKey);
+        _filter = new ulong[_filterBlocks * KeyMetadataRun.FilterBlockSize / sizeof(ulong)];
+
+        _stream = new FileStream(_temporaryPath, FileMode.Create, FileAccess.Write, FileShare.None, bufferSize: 1);
+        _stream.Write(new byte[KeyMetadataRun.HeaderSize], 0, KeyMetadataRun.HeaderSize);
+    }
+
+    public long Count => _count;
+
+    /// <summary>
+    /// Adds a record, whose fingerprint must be greater than that of the
+    /// previous one.
+    /// </summary>
+    public void Add(ReadOnlySpan<byte> record)
+    {
+        CaskKeyFingerprint fingerprint = CaskKeyFingerprint.Read(record);
+        Debug.Assert(_count == 0 || CaskKeyFingerprint.Compare(_last, fingerprint) < 0, "Records must be added in order.");
+
+        if (_count % KeyMetadataRun.BlockSize == 0)
+        {
+            _fences.Add(fingerprint.High);
+        }
+
+        long block = KeyMetadataRun.GetFilterBlock(fingerprint, _filterBlocks) * (KeyMetadataRun.FilterBlockSize / sizeof(ulong));
+        ulong hash = fingerprint.Low;
+        for (int probe = 0; probe < _filterProbes; probe++)
+        {
+            int bit = KeyMetadataRun.GetFilterBit(ref hash, probe);
+            _filter[block + (bit >> 6)] |= 1UL << (bit & 63);
+        }
+
+        record[..KeyMetadata.RecordSize].CopyTo(_buffer.AsSpan(_bufferedBytes));
+        _bufferedBytes += KeyMetadata.RecordSize;
+        if (_bufferedBytes == _buffer.Length)
+        {
+            FlushBuffer();
+        }
+
+        _last = fingerprint;
+        _count++;
+    }
+
+    /// <summary>
+    /// Finishes the run file and maps it.
+    /// </summary>
+    public KeyMetadataRun Complete()
+    {
+        FlushBuffer();
+        WriteUInt64s(_filter);
+        WriteUInt64s(_fences.ToArray());
+
+        byte[] header = new byte[KeyMetadataRun.HeaderSize];
+        BinaryPrimitives.WriteUInt32LittleEndian(header, KeyMetadataRun.Magic);
+        BinaryPrimitives.WriteUInt32LittleEndian(header.AsSpan(4), KeyMetadataRun.Version);
+        BinaryPrimitives.WriteInt64LittleEndian(header.AsSpan(8), _count);
+        BinaryPrimitives.WriteInt64LittleEndian(header.AsSpan(16), _minGeneration);
+        BinaryPrimitives.WriteInt64LittleEndian(header.AsSpan(24), _maxGeneration);
+        BinaryPrimitives.WriteInt64LittleEndian(header.AsSpan(32), _filterBlocks);
+        BinaryPrimitives.WriteInt32LittleEndian(header.AsSpan(40), _filterBitsPerKey);
+
+        _stream.Position = 0;
+        _stream.Write(header, 0, header.Length);
+        _stream.Flush(flushToDisk: true);
+        _stream.Dispose();
+
+        File.Move(_temporaryPath, _path);
+        _completed = true;
+
+        return KeyMetadataRun.Open(_path);
+    }
+
+    /// <summary>
+    /// Deletes the temporary file unless the run was completed.
+    /// </summary>
+    public void Dispose()
+    {
+        _stream.Dispose();
+
+        if (!_completed)
+        {
+            KeyMetadataRun.DeleteFile(_temporaryPath);
+        }
+    }
+
+    private void WriteUInt64s(ReadOnlySpan<ulong> values)
+    {
+        foreach (ulong value in values)
+        {
+            BinaryPrimitives.WriteUInt64LittleEndian(_buffer.AsSpan(_bufferedBytes), value);
+            _bufferedBytes += sizeof(ulong);
+
+            if (_bufferedBytes == _buffer.Length)
+            {
+                FlushBuffer();
+            }
+        }
+
+        FlushBuffer();
+    }
+
+    private void FlushBuffer()
+    {
+        _stream.Write(_buffer, 0, _bufferedBytes);
+        _bufferedBytes = 0;
+    }
+}
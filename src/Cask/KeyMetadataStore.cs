@@ -0,0 +1,790 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Collections.Concurrent;
+using System.Diagnostics.CodeAnalysis;
+using System.Globalization;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// A local, persistent store of the <see cref="KeyMetadata"/> of issued
+/// keys by fingerprint, for high rates of writes from issuance and point
+/// lookups from authentication.
+/// </summary>
+/// <remarks>
+/// <para>
+/// The store is a log-structured merge tree specialized for fixed-width
+/// 48-byte records. Writes are appended to a write log and applied to a
+/// table in memory. When the table has <see
+/// cref="KeyMetadataStoreOptions.MemtableCapacity"/> writes, it is frozen,
+/// a new log and table are started, and a background task sorts the frozen
+/// table into an immutable run file and deletes its log. The background
+/// task also merges each <see cref="KeyMetadataStoreOptions.CompactionFanIn"/>
+/// consecutive runs of about the same size into one, so the number of runs
+/// grows with the logarithm of the number of keys.
+/// </para>
+/// <para>
+/// A lookup checks the tables in memory and then the runs from newest to
+/// oldest. Runs are memory-mapped, and each has a Bloom filter and fence
+/// pointers, so a run without the key usually costs one cache line and the
+/// run with it one search of the fences and one block of records. With the
+/// default options, 100 million keys are in about 20 runs, and a lookup of
+/// a key whose pages are cached takes a few microseconds. Lookups take no
+/// locks and never wait for writes or compaction.
+/// </para>
+/// <para>
+/// Each write is flushed to the operating system before it returns, and,
+/// with <see cref="KeyMetadataStoreOptions.SyncWrites"/>, to disk. When the
+/// store is opened, logs that were not yet written to runs are replayed, and
+/// files left by a crash during a flush or compaction are deleted. Run files
+/// are written to temporary files and renamed, so they are never partial.
+/// Only one store at a time can open a directory.
+/// </para>
+/// </remarks>
+public sealed class KeyMetadataStore : IDisposable
+{
+    private const string LockFileName = "LOCK";
+    private const string LogExtension = ".log";
+    private const string RunExtension = ".run";
+    private const string TemporaryExtension = ".tmp";
+
+    // Writes stall when this many tables are waiting to be written to runs.
+    private const int MaxFrozenMemtables = 2;
+
+    private readonly string _directory;
+    private readonly int _memtableCapacity;
+    private readonly int _compactionFanIn;
+    private readonly int _filterBitsPerKey;
+    private readonly bool _syncWrites;
+    private readonly FileStream _lockFile;
+    private readonly object _writeLock = new();
+    private readonly object _stateLock = new();
+    private readonly byte[] _record = new byte[KeyMetadata.RecordSize];
+    private State _state;
+    private Task _backgroundWork = Task.CompletedTask;
+    private Exception? _backgroundError;
+    private volatile bool _disposed;
+
+    private KeyMetadataStore(string directory, KeyMetadataStoreOptions options, FileStream lockFile, State state)
+    {
+        _directory = directory;
+        _memtableCapacity = options.MemtableCapacity;
+        _compactionFanIn = options.CompactionFanIn;
+        _filterBitsPerKey = options.FilterBitsPerKey;
+        _syncWrites = options.SyncWrites;
+        _lockFile = lockFile;
+        _state = state;
+    }
+
+    /// <summary>
+    /// The number of run files.
+    /// </summary>
+    internal int RunCount => Volatile.Read(ref _state).Runs.Length;
+
+    /// <summary>
+    /// Opens a store in a directory, creating it if it does not exist, and
+    /// recovers the writes that were not yet in run files.
+    /// </summary>
+    /// <exception cref="IOException">Another store has the directory open.</exception>
+    /// <exception cref="InvalidDataException">A run file is not valid.</exception>
+    public static KeyMetadataStore Open(string directory, KeyMetadataStoreOptions? options = null)
+    {
+        ThrowIfNull(directory);
+        options ??= new KeyMetadataStoreOptions();
+
+        if (options.MemtableCapacity < 1)
+        {
+            throw new ArgumentOutOfRangeException(nameof(options), "The memtable capacity must be at least 1.");
+        }
+
+        if (options.CompactionFanIn < 2)
+        {
+            throw new ArgumentOutOfRangeException(nameof(options), "The compaction fan-in must be at least 2.");
+        }
+
+        if (options.FilterBitsPerKey < 1 || options.FilterBitsPerKey > KeyMetadataRun.MaxFilterBitsPerKey)
+        {
+            throw new ArgumentOutOfRangeException(nameof(options), $"The filter bits per key must be between 1 and {KeyMetadataRun.MaxFilterBitsPerKey}.");
+        }
+
+        Directory.CreateDirectory(directory);
+        var lockFile = new FileStream(Path.Combine(directory, LockFileName), FileMode.OpenOrCreate, FileAccess.ReadWrite, FileShare.None);
+        var opened = new List<KeyMetadataRun>();
+
+        try
+        {
+            foreach (string path in Directory.GetFiles(directory, "*" + TemporaryExtension))
+            {
+                File.Delete(path);
+            }
+
+            foreach (string path in Directory.GetFiles(directory, "*" + RunExtension))
+            {
+                opened.Add(KeyMetadataRun.Open(path));
+            }
+
+            // A run whose writes are all in another run is the input of a
+            // compaction that completed.
+            var runs = new List<KeyMetadataRun>();
+            opened.Sort((x, y) => x.MaxGeneration != y.MaxGeneration ? y.MaxGeneration.CompareTo(x.MaxGeneration) : x.MinGeneration.CompareTo(y.MinGeneration));
+
+            foreach (KeyMetadataRun run in opened)
+            {
+                if (runs.Any(r => r.MinGeneration <= run.MinGeneration && r.MaxGeneration >= run.MaxGeneration))
+                {
+                    run.MarkObsolete();
+                }
+                else
+                {
+                    runs.Add(run);
+                }
+            }
+
+            long generation = runs.Count > 0 ? runs[0].MaxGeneration : 0;
+            var memtables = new List<Memtable>();
+
+            foreach ((long logGeneration, string path) in GetLogs(directory))
+            {
+                if (logGeneration <= generation)
+                {
+                    File.Delete(path);
+                }
+                else
+                {
+                    memtables.Insert(0, Memtable.Replay(path, logGeneration));
+                    generation = logGeneration;
+                }
+            }
+
+            Memtable active;
+            if (memtables.Count > 0)
+            {
+                active = memtables[0];
+                memtables.RemoveAt(0);
+                active.OpenLog();
+            }
+            else
+            {
+                active = Memtable.Create(GetLogPath(directory, generation + 1), generation + 1);
+            }
+
+            var store = new KeyMetadataStore(directory, options, lockFile, new State(active, [.. memtables], [.. runs]));
+
+            lock (store._writeLock)
+            {
+                store.ScheduleBackgroundWork();
+            }
+
+            return store;
+        }
+        catch
+        {
+            lockFile.Dispose();
+            throw;
+        }
+        finally
+        {
+            // The state holds its own references to the runs.
+            foreach (KeyMetadataRun run in opened)
+            {
+                run.Release();
+            }
+        }
+    }
+
+    /// <summary>
+    /// Looks up the metadata of a key.
+    /// </summary>
+    /// <returns>False if the key is not in the store or was removed.</returns>
+    public bool TryGet(CaskKey key, out KeyMetadata metadata)
+    {
+        return TryGet(CaskKeyFingerprint.Create(key), out metadata);
+    }
+
+    /// <inheritdoc cref="TryGet(CaskKey, out KeyMetadata)"/>
+    public bool TryGet(CaskKeyFingerprint fingerprint, out KeyMetadata metadata)
+    {
+        State state = AcquireState();
+
+        try
+        {
+            KeyMetadata? found;
+            if (state.Active.Entries.TryGetValue(fingerprint, out found))
+            {
+                return GetResult(found, out metadata);
+            }
+
+            foreach (Memtable memtable in state.Frozen)
+            {
+                if (memtable.Entries.TryGetValue(fingerprint, out found))
+                {
+                    return GetResult(found, out metadata);
+                }
+            }
+
+            foreach (KeyMetadataRun run in state.Runs)
+            {
+                if (run.TryFind(fingerprint, out ReadOnlySpan<byte> record))
+                {
+                    return KeyMetadata.TryReadRecord(record, out metadata);
+                }
+            }
+
+            metadata = default;
+            return false;
+        }
+        finally
+        {
+            state.Release();
+        }
+    }
+
+    /// <summary>
+    /// Adds or replaces the metadata of a key.
+    /// </summary>
+    /// <exception cref="IOException">
+    /// The write could not be logged, or writing a run failed in the
+    /// background.
+    /// </exception>
+    public void Put(CaskKeyFingerprint fingerprint, KeyMetadata metadata)
+    {
+        lock (_writeLock)
+        {
+            Memtable active = BeginWrite();
+            metadata.WriteRecord(_record, fingerprint);
+            active.Append(_record, _syncWrites);
+            active.Entries[fingerprint] = metadata;
+            EndWrite(active);
+        }
+    }
+
+    /// <summary>
+    /// Changes the status of a key.
+    /// </summary>
+    /// <returns>False if the key is not in the store.</returns>
+    /// <inheritdoc cref="Put" path="/exception"/>
+    public bool TrySetStatus(CaskKeyFingerprint fingerprint, KeyStatus status)
+    {
+        lock (_writeLock)
+        {
+            if (!TryGet(fingerprint, out KeyMetadata metadata))
+            {
+                return false;
+            }
+
+            Put(fingerprint, metadata with { Status = status });
+            return true;
+        }
+    }
+
+    /// <summary>
+    /// Removes the metadata of a key, if any.
+    /// </summary>
+    /// <inheritdoc cref="Put" path="/exception"/>
+    public void Remove(CaskKeyFingerprint fingerprint)
+    {
+        lock (_writeLock)
+        {
+            Memtable active = BeginWrite();
+            KeyMetadata.WriteRemovedRecord(_record, fingerprint);
+            active.Append(_record, _syncWrites);
+            active.Entries[fingerprint] = null;
+            EndWrite(active);
+        }
+    }
+
+    /// <summary>
+    /// Writes all writes so far to run files and waits for compaction to
+    /// finish, for example before copying the directory.
+    /// </summary>
+    /// <inheritdoc cref="Put" path="/exception"/>
+    public void Flush()
+    {
+        lock (_writeLock)
+        {
+            Memtable active = BeginWrite();
+            if (active.Writes > 0)
+            {
+                FreezeActive();
+            }
+
+            WaitForBackgroundWork();
+        }
+    }
+
+    /// <summary>
+    /// Waits for background work and closes the store. Writes still in memory
+    /// are recovered from their logs when the store is next opened. Lookups
+    /// in progress on other threads complete.
+    /// </summary>
+    public void Dispose()
+    {
+        lock (_writeLock)
+        {
+            if (_disposed)
+            {
+                return;
+            }
+
+            _disposed = true;
+            _backgroundWork.Wait();
+
+            State state = _state;
+            state.Active.CloseLog();
+            state.Release();
+            _lockFile.Dispose();
+        }
+    }
+
+    private Memtable BeginWrite()
+    {
+        ThrowIf(_disposed, this);
+        ThrowIfBackgroundFailed();
+        return _state.Active;
+    }
+
+    private void EndWrite(Memtable active)
+    {
+        if (++active.Writes >= _memtableCapacity)
+        {
+            FreezeActive();
+        }
+    }
+
+    /// <summary>
+    /// Starts a new table and log and writes the current ones to a run in the
+    /// background. Called under the write lock.
+    /// </summary>
+    private void FreezeActive()
+    {
+        if (_state.Frozen.Length >= MaxFrozenMemtables)
+        {
+            WaitForBackgroundWork();
+        }
+
+        Memtable frozen = _state.Active;
+        Memtable active = Memtable.Create(GetLogPath(_directory, frozen.Generation + 1), frozen.Generation + 1);
+        frozen.CloseLog();
+
+        Publish(state => new State(active, [frozen, .. state.Frozen], state.Runs));
+        ScheduleBackgroundWork();
+    }
+
+    /// <summary>
+    /// Called under the write lock, so that background work runs one at a
+    /// time.
+    /// </summary>
+    private void ScheduleBackgroundWork()
+    {
+        _backgroundWork = _backgroundWork.ContinueWith(_ => RunBackgroundWork(),
+                                                      CancellationToken.None,
+                                                      TaskContinuationOptions.None,
+                                                      TaskScheduler.Default);
+    }
+
+    private void WaitForBackgroundWork()
+    {
+        _backgroundWork.Wait();
+        ThrowIfBackgroundFailed();
+    }
+
+    private void ThrowIfBackgroundFailed()
+    {
+        Exception? error = Volatile.Read(ref _backgroundError);
+        if (error != null)
+        {
+            throw new IOException("Writing a key metadata run failed. Reopen the store to retry.", error);
+        }
+    }
+
+    [SuppressMessage("Design", "CA1031:Do not catch general exception types", Justification = "The error is thrown by the next write.")]
+    private void RunBackgroundWork()
+    {
+        if (_disposed || Volatile.Read(ref _backgroundError) != null)
+        {
+            return;
+        }
+
+        try
+        {
+            while (Volatile.Read(ref _state).Frozen is { Length: > 0 } frozen)
+            {
+                FlushMemtable(frozen[^1]);
+            }
+
+            while (TryCompact())
+            {
+            }
+        }
+        catch (Exception e)
+        {
+            Volatile.Write(ref _backgroundError, e);
+        }
+    }
+
+    private void FlushMemtable(Memtable memtable)
+    {
+        KeyValuePair<CaskKeyFingerprint, KeyMetadata?>[] entries = memtable.Entries.ToArray();
+        Array.Sort(entries, static (x, y) => CaskKeyFingerprint.Compare(x.Key, y.Key));
+
+        KeyMetadataRun run;
+        byte[] record = new byte[KeyMetadata.RecordSize];
+
+        using (var writer = new KeyMetadataRunWriter(GetRunPath(memtable.Generation, memtable.Generation),
+                                                     memtable.Generation,
+                                                     memtable.Generation,
+                                                     entries.Length,
+                                                     _filterBitsPerKey))
+        {
+            foreach (KeyValuePair<CaskKeyFingerprint, KeyMetadata?> entry in entries)
+            {
+                if (entry.Value is KeyMetadata metadata)
+                {
+                    metadata.WriteRecord(record, entry.Key);
+                }
+                else
+                {
+                    KeyMetadata.WriteRemovedRecord(record, entry.Key);
+                }
+
+                writer.Add(record);
+            }
+
+            run = writer.Complete();
+        }
+
+        Publish(state => new State(state.Active, state.Frozen.Where(m => m != memtable).ToArray(), [run, .. state.Runs]));
+        run.Release();
+        KeyMetadataRun.DeleteFile(memtable.LogPath);
+    }
+
+    /// <summary>
+    /// Merges the first group of consecutive runs of the same size class
+    /// that has at least the fan-in number of runs.
+    /// </summary>
+    private bool TryCompact()
+    {
+        KeyMetadataRun[] runs = Volatile.Read(ref _state).Runs;
+
+        for (int start = 0; start < runs.Length;)
+        {
+            int level = GetLevel(runs[start]);
+            int end = start + 1;
+
+            while (end < runs.Length && GetLevel(runs[end]) == level)
+            {
+                end++;
+            }
+
+            if (end - start >= _compactionFanIn)
+            {
+                Merge(runs, start, end - start);
+                return true;
+            }
+
+            start = end;
+        }
+
+        return false;
+    }
+
+    /// <summary>
+    /// Gets the size class of a run: 0 for up to one table of writes, and
+    /// one more for each factor of the fan-in.
+    /// </summary>
+    private int GetLevel(KeyMetadataRun run)
+    {
+        int level = 0;
+        for (long size = _memtableCapacity; run.Count > size && size < long.MaxValue / _compactionFanIn; size *= _compactionFanIn)
+        {
+            level++;
+        }
+
+        return level;
+    }
+
+    /// <summary>
+    /// Merges consecutive runs, newest first, into one. Where runs have the
+    /// same key, the record in the newest is kept. Records of removed keys are
+    /// dropped once there is no older run in which they could hide a key.
+    /// </summary>
+    private void Merge(KeyMetadataRun[] runs, int start, int count)
+    {
+        KeyMetadataRun newest = runs[start];
+        KeyMetadataRun oldest = runs[start + count - 1];
+        bool dropRemoved = start + count == runs.Length;
+        long[] positions = new long[count];
+        KeyMetadataRun merged;
+
+        using (var writer = new KeyMetadataRunWriter(GetRunPath(oldest.MinGeneration, newest.MaxGeneration),
+                                                     oldest.MinGeneration,
+                                                     newest.MaxGeneration,
+                                                     runs.Skip(start).Take(count).Sum(r => r.Count),
+                                                     _filterBitsPerKey))
+        {
+            while (true)
+            {
+                int next = -1;
+                CaskKeyFingerprint nextFingerprint = default;
+
+                for (int i = 0; i < count; i++)
+                {
+                    if (positions[i] < runs[start + i].Count)
+                    {
+                        CaskKeyFingerprint fingerprint = CaskKeyFingerprint.Read(runs[start + i].GetRecord(positions[i]));
+                        if (next < 0 || CaskKeyFingerprint.Compare(fingerprint, nextFingerprint) < 0)
+                        {
+                            next = i;
+                            nextFingerprint = fingerprint;
+                        }
+                    }
+                }
+
+                if (next < 0)
+                {
+                    break;
+                }
+
+                ReadOnlySpan<byte> record = runs[start + next].GetRecord(positions[next]);
+                if (!dropRemoved || (record[46] & KeyMetadata.RemovedFlag) == 0)
+                {
+                    writer.Add(record);
+                }
+
+                for (int i = 0; i < count; i++)
+                {
+                    if (positions[i] < runs[start + i].Count &&
+                        CaskKeyFingerprint.Read(runs[start + i].GetRecord(positions[i])) == nextFingerprint)
+                    {
+                        positions[i]++;
+                    }
+                }
+            }
+
+            merged = writer.Complete();
+        }
+
+        // The inputs are deleted once the last lookup that uses them is done.
+        for (int i = start; i < start + count; i++)
+        {
+            runs[i].MarkObsolete();
+        }
+
+        Publish(state =>
+        {
+            KeyMetadataRun[] next = [.. state.Runs];
+            int index = Array.IndexOf(next, newest);
+            return new State(state.Active, state.Frozen, [.. next.Take(index), merged, .. next.Skip(index + count)]);
+        });
+
+        merged.Release();
+    }
+
+    private void Publish(Func<State, State> update)
+    {
+        lock (_stateLock)
+        {
+            State previous = _state;
+            Volatile.Write(ref _state, update(previous));
+            previous.Release();
+        }
+    }
+
+    private State AcquireState()
+    {
+        while (true)
+        {
+            ThrowIf(_disposed, this);
+
+            State state = Volatile.Read(ref _state);
+            if (state.TryAddReference())
+            {
+                return state;
+            }
+        }
+    }
+
+    private static bool GetResult(KeyMetadata? found, out KeyMetadata metadata)
+    {
+        metadata = found.GetValueOrDefault();
+        return found.HasValue;
+    }
+
+    private string GetRunPath(long minGeneration, long maxGeneration)
+    {
+        return Path.Combine(_directory, FormatGeneration(minGeneration) + "-" + FormatGeneration(maxGeneration) + RunExtension);
+    }
+
+    private static string GetLogPath(string directory, long generation)
+    {
+        return Path.Combine(directory, FormatGeneration(generation) + LogExtension);
+    }
+
+    private static string FormatGeneration(long generation)
+    {
+        return generation.ToString("D19", CultureInfo.InvariantCulture);
+    }
+
+    private static List<(long Generation, string Path)> GetLogs(string directory)
+    {
+        var logs = new List<(long Generation, string Path)>();
+
+        foreach (string path in Directory.GetFiles(directory, "*" + LogExtension))
+        {
+            if (long.TryParse(Path.GetFileNameWithoutExtension(path), NumberStyles.None, CultureInfo.InvariantCulture, out long generation))
+            {
+                logs.Add((generation, path));
+            }
+        }
+
+        logs.Sort((x, y) => x.Generation.CompareTo(y.Generation));
+        return logs;
+    }
+
+    /// <summary>
+    /// A table of writes in memory and its log. A removed key maps to null.
+    /// </summary>
+    [SuppressMessage("Design", "CA1001:Types that own disposable fields should be disposable", Justification = "The log is closed when the table is frozen or the store is disposed, and the table is still read after that.")]
+    private sealed class Memtable
+    {
+        private FileStream? _log;
+
+        private Memtable(string logPath, long generation)
+        {
+            LogPath = logPath;
+            Generation = generation;
+        }
+
+        public string LogPath { get; }
+
+        public long Generation { get; }
+
+        public ConcurrentDictionary<CaskKeyFingerprint, KeyMetadata?> Entries { get; } = new();
+
+        /// <summary>
+        /// The number of writes, which may be more than the number of keys.
+        /// Written under the write lock.
+        /// </summary>
+        public int Writes { get; set; }
+
+        public static Memtable Create(string logPath, long generation)
+        {
+            var memtable = new Memtable(logPath, generation);
+            memtable._log = new FileStream(logPath, FileMode.CreateNew, FileAccess.Write, FileShare.Read, bufferSize: 1);
+            return memtable;
+        }
+
+        /// <summary>
+        /// Reads the complete records of a log. A record that was only partly
+        /// written, or not at all, ends the log.
+        /// </summary>
+        public static Memtable Replay(string logPath, long generation)
+        {
+            var memtable = new Memtable(logPath, generation);
+            byte[] log = File.ReadAllBytes(logPath);
+            int length = 0;
+
+            for (; length + KeyMetadata.RecordSize <= log.Length; length += KeyMetadata.RecordSize)
+            {
+                ReadOnlySpan<byte> record = log.AsSpan(length, KeyMetadata.RecordSize);
+                if ((record[46] & KeyMetadata.PresentFlag) == 0)
+                {
+                    break;
+                }
+
+                KeyMetadata? metadata = KeyMetadata.TryReadRecord(record, out KeyMetadata value) ? value : null;
+                memtable.Entries[CaskKeyFingerprint.Read(record)] = metadata;
+                memtable.Writes++;
+            }
+
+            if (length < log.Length)
+            {
+                using var stream = new FileStream(logPath, FileMode.Open, FileAccess.Write, FileShare.Read);
+                stream.SetLength(length);
+            }
+
+            return memtable;
+        }
+
+        /// <summary>
+        /// Reopens a replayed log to append to it.
+        /// </summary>
+        public void OpenLog()
+        {
+            _log = new FileStream(LogPath, FileMode.Append, FileAccess.Write, FileShare.Read, bufferSize: 1);
+        }
+
+        public void Append(byte[] record, bool sync)
+        {
+            _log!.Write(record, 0, record.Length);
+            _log.Flush(sync);
+        }
+
+        public void CloseLog()
+        {
+            _log?.Dispose();
+            _log = null;
+        }
+    }
+
+    /// <summary>
+    /// A version of the store. Lookups hold a reference to the version they
+    /// use, and each version holds a reference to its runs.
+    /// </summary>
+    private sealed class State
+    {
+        private int _references = 1;
+
+        public State(Memtable active, Memtable[] frozen, KeyMetadataRun[] runs)
+        {
+            Active = active;
+            Frozen = frozen;
+            Runs = runs;
+
+            foreach (KeyMetadataRun run in runs)
+            {
+                run.AddReference();
+            }
+        }
+
+        public Memtable Active { get; }
+
+        /// <summary>
+        /// Tables waiting to be written to runs, newest first.
+        /// </summary>
+        public Memtable[] Frozen { get; }
+
+        /// <summary>
+        /// Runs, newest first.
+        /// </summary>
+        public KeyMetadataRun[] Runs { get; }
+
+        public bool TryAddReference()
+        {
+            int references;
+            do
+            {
+                references = Volatile.Read(ref _references);
+                if (references == 0)
+                {
+                    return false;
+                }
+            }
+            while (Interlocked.CompareExchange(ref _references, references + 1, references) != references);
+
+            return true;
+        }
+
+        public void Release()
+        {
+            if (Interlocked.Decrement(ref _references) == 0)
+            {
+                foreach (KeyMetadataRun run in Runs)
+                {
+                    run.Release();
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,35 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Options for <see cref="KeyMetadataStore"/>.
+/// </summary>
+public sealed class KeyMetadataStoreOptions
+{
+    /// <summary>
+    /// The number of writes held in memory before they are written to a run
+    /// file. Each costs about 150 bytes of memory. Defaults to 262,144.
+    /// </summary>
+    public int MemtableCapacity { get; set; } = 256 * 1024;
+
+    /// <summary>
+    /// The number of runs of about the same size that are merged into one.
+    /// Larger values write less and read more. Defaults to 4.
+    /// </summary>
+    public int CompactionFanIn { get; set; } = 4;
+
+    /// <summary>
+    /// The bits of filter per key in each run. 10 bits rules out about 99% of
+    /// the runs that do not have a key. Defaults to 10.
+    /// </summary>
+    public int FilterBitsPerKey { get; set; } = 10;
+
+    /// <summary>
+    /// Whether each write is flushed to disk before it returns, rather than
+    /// only to the operating system, which survives the process but not the
+    /// machine crashing. Defaults to false.
+    /// </summary>
+    public bool SyncWrites { get; set; }
+}
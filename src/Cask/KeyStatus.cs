@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// The status of a key as reported by a <see cref="IKeyStatusService"/>.
+/// </summary>
+public enum KeyStatus
+{
+    /// <summary>
+    /// The service does not know the key.
+    /// </summary>
+    Unknown = 0,
+
+    /// <summary>
+    /// The key was issued and has not been revoked.
+    /// </summary>
+    Active = 1,
+
+    /// <summary>
+    /// The key has been revoked.
+    /// </summary>
+    Revoked = 2,
+}
@@ -0,0 +1,383 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Collections.Concurrent;
+using System.Diagnostics;
+using System.Diagnostics.CodeAnalysis;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Looks up key statuses in a <see cref="IKeyStatusService"/> with far fewer
+/// requests than one per key.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Statuses are cached for a time that depends on the status. A lookup of a
+/// key that is already being looked up waits for the same result instead of
+/// sending another request. Lookups of distinct keys are batched: the first
+/// lookup that misses the cache starts a batch, and the batch is sent when it
+/// has <see cref="KeyStatusClientOptions.MaxBatchSize"/> keys or <see
+/// cref="KeyStatusClientOptions.MaxBatchDelay"/> has passed, whichever is
+/// first.
+/// </para>
+/// <para>
+/// Cache hits take no locks and do not allocate. Failed requests are not
+/// cached, and fail every lookup that waited for them.
+/// </para>
+/// </remarks>
+public sealed class KeyStatusClient : IDisposable
+{
+    private static readonly Task<KeyStatus>[] s_completed =
+    [
+        Task.FromResult(KeyStatus.Unknown),
+        Task.FromResult(KeyStatus.Active),
+        Task.FromResult(KeyStatus.Revoked),
+    ];
+
+    private readonly IKeyStatusService _service;
+    private readonly int _maxBatchSize;
+    private readonly TimeSpan _maxBatchDelay;
+    private readonly long[] _timeToLive;
+    private readonly int _maxCacheEntries;
+    private readonly CancellationTokenSource _disposed = new();
+
+    // Written only under _lock, read without it.
+    private readonly ConcurrentDictionary<CaskKeyFingerprint, CacheEntry> _cache = new();
+
+    private readonly object _lock = new();
+    private readonly Dictionary<CaskKeyFingerprint, TaskCompletionSource<KeyStatus>> _inFlight = [];
+    private List<CaskKeyFingerprint>? _batch;
+    private int _cacheCount;
+    private bool _isDisposed;
+
+    private long _lookups;
+    private long _cacheHits;
+    private long _coalesced;
+    private long _requests;
+    private long _requestedKeys;
+
+    public KeyStatusClient(IKeyStatusService service, KeyStatusClientOptions? options = null)
+    {
+        ThrowIfNull(service);
+        options ??= new KeyStatusClientOptions();
+
+        if (options.MaxBatchSize < 1)
+        {
+            throw new ArgumentOutOfRangeException(nameof(options), "The maximum batch size must be at least 1.");
+        }
+
+        if (options.MaxCacheEntries < 0)
+        {
+            throw new ArgumentOutOfRangeException(nameof(options), "The maximum number of cache entries must not be negative.");
+        }
+
+        _service = service;
+        _maxBatchSize = options.MaxBatchSize;
+        _maxBatchDelay = options.MaxBatchDelay;
+        _maxCacheEntries = options.MaxCacheEntries;
+        _timeToLive =
+        [
+            ToTimestampTicks(options.UnknownTimeToLive),
+            ToTimestampTicks(options.ActiveTimeToLive),
+            ToTimestampTicks(options.RevokedTimeToLive),
+        ];
+    }
+
+    /// <summary>
+    /// Counts of lookups and requests so far.
+    /// </summary>
+    public KeyStatusClientStatistics Statistics => new(Interlocked.Read(ref _lookups),
+                                                       Interlocked.Read(ref _cacheHits),
+                                                       Interlocked.Read(ref _coalesced),
+                                                       Interlocked.Read(ref _requests),
+                                                       Interlocked.Read(ref _requestedKeys));
+
+    /// <summary>
+    /// Looks up the status of a key.
+    /// </summary>
+    /// <remarks>
+    /// Canceling stops waiting for the status, but not the request, which
+    /// other lookups may be waiting for.
+    /// </remarks>
+    public Task<KeyStatus> GetStatusAsync(CaskKey key, CancellationToken cancellationToken = default)
+    {
+        return GetStatusAsync(CaskKeyFingerprint.Create(key), cancellationToken);
+    }
+
+    /// <inheritdoc cref="GetStatusAsync(CaskKey, CancellationToken)"/>
+    public Task<KeyStatus> GetStatusAsync(CaskKeyFingerprint fingerprint, CancellationToken cancellationToken = default)
+    {
+        Interlocked.Increment(ref _lookups);
+
+        if (TryGetCached(fingerprint, out KeyStatus status))
+        {
+            return s_completed[(int)status];
+        }
+
+        Task<KeyStatus> lookup;
+        List<CaskKeyFingerprint>? full = null;
+
+        lock (_lock)
+        {
+            ThrowIf(_isDisposed, this);
+
+            // A request may have completed since the cache was checked.
+            if (TryGetCached(fingerprint, out status))
+            {
+                return s_completed[(int)status];
+            }
+
+            if (_inFlight.TryGetValue(fingerprint, out TaskCompletionSource<KeyStatus>? completion))
+            {
+                Interlocked.Increment(ref _coalesced);
+                lookup = completion.Task;
+            }
+            else
+            {
+                completion = new TaskCompletionSource<KeyStatus>(TaskCreationOptions.RunContinuationsAsynchronously);
+                _inFlight.Add(fingerprint, completion);
+                lookup = completion.Task;
+
+                if (_batch == null)
+                {
+                    _batch = new List<CaskKeyFingerprint>(Math.Min(_maxBatchSize, 64));
+                    if (_maxBatchDelay > TimeSpan.Zero)
+                    {
+                        StartBatchTimer(_batch);
+                    }
+                }
+
+                _batch.Add(fingerprint);
+
+                if (_batch.Count >= _maxBatchSize || _maxBatchDelay <= TimeSpan.Zero)
+                {
+                    full = _batch;
+                    _batch = null;
+                }
+            }
+        }
+
+        if (full != null)
+        {
+            Send(full);
+        }
+
+        return lookup.WaitAsync(cancellationToken);
+    }
+
+    /// <summary>
+    /// Stops sending requests. Lookups that have not been sent fail with
+    /// <see cref="ObjectDisposedException"/>, and requests that have been
+    /// sent are canceled.
+    /// </summary>
+    public void Dispose()
+    {
+        List<CaskKeyFingerprint>? batch;
+
+        lock (_lock)
+        {
+            if (_isDisposed)
+            {
+                return;
+            }
+
+            _isDisposed = true;
+            batch = _batch;
+            _batch = null;
+        }
+
+        if (batch != null)
+        {
+            Complete(batch, statuses: null, new ObjectDisposedException(nameof(KeyStatusClient)));
+        }
+
+        _disposed.Cancel();
+        _disposed.Dispose();
+    }
+
+    private bool TryGetCached(CaskKeyFingerprint fingerprint, out KeyStatus status)
+    {
+        if (_cache.TryGetValue(fingerprint, out CacheEntry entry) && Stopwatch.GetTimestamp() < entry.ExpiresAt)
+        {
+            Interlocked.Increment(ref _cacheHits);
+            status = entry.Status;
+            return true;
+        }
+
+        status = default;
+        return false;
+    }
+
+    private void StartBatchTimer(List<CaskKeyFingerprint> batch)
+    {
+        Task.Delay(_maxBatchDelay, _disposed.Token)
+            .ContinueWith((_, state) => SendIfPending((List<CaskKeyFingerprint>)state!),
+                          batch,
+                          CancellationToken.None,
+                          TaskContinuationOptions.ExecuteSynchronously,
+                          TaskScheduler.Default);
+    }
+
+    private void SendIfPending(List<CaskKeyFingerprint> batch)
+    {
+        lock (_lock)
+        {
+            // The batch may have been sent when it filled up.
+            if (_batch != batch)
+            {
+                return;
+            }
+
+            _batch = null;
+        }
+
+        Send(batch);
+    }
+
+    [SuppressMessage("Design", "CA1031:Do not catch general exception types", Justification = "The exception is passed to the waiting lookups.")]
+    private void Send(List<CaskKeyFingerprint> batch)
+    {
+        Interlocked.Increment(ref _requests);
+        Interlocked.Add(ref _requestedKeys, batch.Count);
+
+        Task<IReadOnlyList<KeyStatus>> request;
+        try
+        {
+            request = _service.GetStatusesAsync(batch, _disposed.Token);
+        }
+        catch (Exception e)
+        {
+            Complete(batch, statuses: null, e);
+            return;
+        }
+
+        request.ContinueWith((completed, state) => OnResponse((List<CaskKeyFingerprint>)state!, completed),
+                             batch,
+                             CancellationToken.None,
+                             TaskContinuationOptions.ExecuteSynchronously,
+                             TaskScheduler.Default);
+    }
+
+    private void OnResponse(List<CaskKeyFingerprint> batch, Task<IReadOnlyList<KeyStatus>> request)
+    {
+        if (request.IsFaulted)
+        {
+            Complete(batch, statuses: null, request.Exception!.InnerException!);
+        }
+        else if (request.IsCanceled)
+        {
+            Complete(batch, statuses: null, new OperationCanceledException());
+        }
+        else if (request.Result.Count != batch.Count)
+        {
+            Complete(batch, statuses: null, new InvalidOperationException($"The key status service returned {request.Result.Count} statuses for {batch.Count} keys."));
+        }
+        else
+        {
+            Complete(batch, request.Result, error: null);
+        }
+    }
+
+    private void Complete(List<CaskKeyFingerprint> batch, IReadOnlyList<KeyStatus>? statuses, Exception? error)
+    {
+        var completions = new TaskCompletionSource<KeyStatus>[batch.Count];
+        long now = Stopwatch.GetTimestamp();
+
+        lock (_lock)
+        {
+            for (int i = 0; i < batch.Count; i++)
+            {
+                CaskKeyFingerprint fingerprint = batch[i];
+
+                if (statuses != null)
+                {
+                    AddToCache(fingerprint, statuses[i], now);
+                }
+
+                completions[i] = _inFlight[fingerprint];
+                _inFlight.Remove(fingerprint);
+            }
+        }
+
+        // Completing outside the lock keeps waiters' continuations, which
+        // run asynchronously anyway, from being scheduled while it is held.
+        for (int i = 0; i < completions.Length; i++)
+        {
+            if (statuses != null)
+            {
+                completions[i].TrySetResult(statuses[i]);
+            }
+            else
+            {
+                completions[i].TrySetException(error!);
+            }
+        }
+    }
+
+    private void AddToCache(CaskKeyFingerprint fingerprint, KeyStatus status, long now)
+    {
+        long timeToLive = (uint)status < (uint)_timeToLive.Length ? _timeToLive[(int)status] : 0;
+        if (timeToLive <= 0 || _maxCacheEntries == 0)
+        {
+            return;
+        }
+
+        var entry = new CacheEntry(status, now + timeToLive);
+        if (_cache.TryAdd(fingerprint, entry))
+        {
+            _cacheCount++;
+            if (_cacheCount > _maxCacheEntries)
+            {
+                TrimCache(now);
+            }
+        }
+        else
+        {
+            _cache[fingerprint] = entry;
+        }
+    }
+
+    /// <summary>
+    /// Removes expired entries, and then the entries closest to expiring,
+    /// until the cache is three-quarters full, so that trimming runs at most
+    /// once per quarter of the capacity added.
+    /// </summary>
+    private void TrimCache(long now)
+    {
+        int target = _maxCacheEntries - (_maxCacheEntries / 4);
+        var live = new List<KeyValuePair<CaskKeyFingerprint, CacheEntry>>(_cacheCount);
+
+        foreach (KeyValuePair<CaskKeyFingerprint, CacheEntry> pair in _cache)
+        {
+            if (pair.Value.ExpiresAt <= now)
+            {
+                _cache.TryRemove(pair.Key, out _);
+                _cacheCount--;
+            }
+            else
+            {
+                live.Add(pair);
+            }
+        }
+
+        if (_cacheCount <= target)
+        {
+            return;
+        }
+
+        live.Sort((x, y) => x.Value.ExpiresAt.CompareTo(y.Value.ExpiresAt));
+        for (int i = 0; _cacheCount > target; i++)
+        {
+            _cache.TryRemove(live[i].Key, out _);
+            _cacheCount--;
+        }
+    }
+
+    private static long ToTimestampTicks(TimeSpan timeSpan)
+    {
+        return timeSpan <= TimeSpan.Zero ? 0 : (long)Math.Min(timeSpan.TotalSeconds * Stopwatch.Frequency, long.MaxValue / 2);
+    }
+
+    private readonly record struct CacheEntry(KeyStatus Status, long ExpiresAt);
+}
@@ -0,0 +1,43 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Options for <see cref="KeyStatusClient"/>.
+/// </summary>
+public sealed class KeyStatusClientOptions
+{
+    /// <summary>
+    /// The most keys to look up in one request. Defaults to 256.
+    /// </summary>
+    public int MaxBatchSize { get; set; } = 256;
+
+    /// <summary>
+    /// The longest a lookup waits for other lookups to batch with before its
+    /// request is sent. Zero sends each request immediately. Defaults to 2
+    /// milliseconds.
+    /// </summary>
+    public TimeSpan MaxBatchDelay { get; set; } = TimeSpan.FromMilliseconds(2);
+
+    /// <summary>
+    /// How long an active status is cached, which bounds how long a revoked
+    /// key can still be reported as active. Defaults to 1 minute.
+    /// </summary>
+    public TimeSpan ActiveTimeToLive { get; set; } = TimeSpan.FromMinutes(1);
+
+    /// <summary>
+    /// How long a revoked status is cached. Defaults to 1 hour.
+    /// </summary>
+    public TimeSpan RevokedTimeToLive { get; set; } = TimeSpan.FromHours(1);
+
+    /// <summary>
+    /// How long an unknown status is cached. Defaults to 10 seconds.
+    /// </summary>
+    public TimeSpan UnknownTimeToLive { get; set; } = TimeSpan.FromSeconds(10);
+
+    /// <summary>
+    /// The most statuses to cache. Defaults to 100,000.
+    /// </summary>
+    public int MaxCacheEntries { get; set; } = 100_000;
+}
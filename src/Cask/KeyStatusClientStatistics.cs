@@ -0,0 +1,15 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Counts of the lookups made through a <see cref="KeyStatusClient"/> and the
+/// requests it sent for them.
+/// </summary>
+/// <param name="Lookups">The number of lookups.</param>
+/// <param name="CacheHits">The number of lookups answered from the cache.</param>
+/// <param name="Coalesced">The number of lookups that waited for a lookup of the same key.</param>
+/// <param name="Requests">The number of requests sent to the service.</param>
+/// <param name="RequestedKeys">The number of keys in all requests sent to the service.</param>
+public readonly record struct KeyStatusClientStatistics(long Lookups, long CacheHits, long Coalesced, long Requests, long RequestedKeys);
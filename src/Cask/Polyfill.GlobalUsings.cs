@@ -8,4 +8,8 @@ global using Polyfill;
 
 global using static Polyfill.ArgumentValidation;
 
+global using Base64Url = Polyfill.Base64Url;
+
 global using RandomNumberGenerator = Polyfill.RandomNumberGenerator;
+
+global using SHA256 = Polyfill.SHA256;
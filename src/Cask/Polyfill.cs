@@ -55,7 +55,9 @@
 using System.Buffers;
 using System.Diagnostics;
 using System.Diagnostics.CodeAnalysis;
+using System.Numerics;
 using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
 using System.Security.Cryptography;
 using System.Text;
 using System.Text.RegularExpressions;
@@ -103,6 +105,60 @@ namespace Polyfill
                 return encoding.GetBytes(charPtr, chars.Length, bytePtr, bytes.Length);
             }
         }
+
+        public static int Count(this ReadOnlySpan<byte> span, byte value)
+        {
+            int count = 0;
+
+            foreach (byte b in span)
+            {
+                if (b == value)
+                {
+                    count++;
+                }
+            }
+
+            return count;
+        }
+
+        public static Task<T> WaitAsync<T>(this Task<T> task, CancellationToken cancellationToken)
+        {
+            if (task.IsCompleted || !cancellationToken.CanBeCanceled)
+            {
+                return task;
+            }
+
+            if (cancellationToken.IsCancellationRequested)
+            {
+                return Task.FromCanceled<T>(cancellationToken);
+            }
+
+            var completion = new TaskCompletionSource<T>(TaskCreationOptions.RunContinuationsAsynchronously);
+            CancellationTokenRegistration registration = cancellationToken.Register(() => completion.TrySetCanceled(cancellationToken));
+
+            task.ContinueWith(t =>
+                              {
+                                  registration.Dispose();
+
+                                  if (t.IsFaulted)
+                                  {
+                                      completion.TrySetException(t.Exception!.InnerExceptions);
+                                  }
+                                  else if (t.IsCanceled)
+                                  {
+                                      completion.TrySetCanceled();
+                                  }
+                                  else
+                                  {
+                                      completion.TrySetResult(t.Result);
+                                  }
+                              },
+                              CancellationToken.None,
+                              TaskContinuationOptions.ExecuteSynchronously,
+                              TaskScheduler.Default);
+
+            return completion.Task;
+        }
     }
 
     internal static class ArgumentValidation
@@ -115,11 +171,39 @@ namespace Polyfill
             }
         }
 
+        public static void ThrowIfNegative(int value, [CallerArgumentExpression(nameof(value))] string? paramName = null)
+        {
+            if (value < 0)
+            {
+                ThrowArgumentOutOfRange(value, paramName);
+            }
+        }
+
+        public static void ThrowIf([DoesNotReturnIf(true)] bool condition, object instance)
+        {
+            if (condition)
+            {
+                ThrowObjectDisposed(instance);
+            }
+        }
+
         [DoesNotReturn]
         private static void ThrowArgumentNull(string? paramName)
         {
             throw new ArgumentNullException(paramName);
         }
+
+        [DoesNotReturn]
+        private static void ThrowArgumentOutOfRange(int value, string? paramName)
+        {
+            throw new ArgumentOutOfRangeException(paramName, value, $"{paramName} ('{value}') must be a non-negative value.");
+        }
+
+        [DoesNotReturn]
+        private static void ThrowObjectDisposed(object instance)
+        {
+            throw new ObjectDisposedException(instance.GetType().FullName);
+        }
     }
 
     internal static class RandomNumberGenerator
@@ -133,12 +217,310 @@ namespace Polyfill
         // https://learn.microsoft.com/en-us/dotnet/api/system.security.cryptography.rngcryptoserviceprovider?view=netframework-4.7.2#thread-safety
         private static readonly RNGCryptoServiceProvider s_rng = new();
 
+        // RNGCryptoServiceProvider only fills whole arrays, so small requests
+        // reuse a per-thread array of the same size instead of allocating
+        // one per key. The array is cleared as soon as it has been copied, so
+        // no random data is kept for future keys. Drawing entropy for many
+        // keys at once, which keeps it in memory until they are generated, is
+        // opt-in with CaskEntropyHealthMode.Pooled, whose blocks are large
+        // requests that are used right away.
+        private const int MaxScratchSize = 256;
+
+#pragma warning disable IDE1006 // https://github.com/dotnet/roslyn/issues/32955
+        [ThreadStatic] private static byte[]? t_scratch;
+#pragma warning restore IDE1006
+
         public static void Fill(Span<byte> buffer)
         {
-            byte[] bytes = new byte[buffer.Length];
-            s_rng.GetBytes(bytes);
-            bytes.CopyTo(buffer);
+            if (buffer.Length > MaxScratchSize)
+            {
+                FillUnpooled(buffer);
+                return;
+            }
+
+            byte[]? scratch = t_scratch;
+            if (scratch == null || scratch.Length != buffer.Length)
+            {
+                t_scratch = scratch = new byte[buffer.Length];
+            }
+
+            s_rng.GetBytes(scratch);
+            scratch.AsSpan().CopyTo(buffer);
+            Array.Clear(scratch, 0, scratch.Length);
+        }
+
+        private static void FillUnpooled(Span<byte> buffer)
+        {
+            byte[] bytes = ArrayPool<byte>.Shared.Rent(buffer.Length);
+            try
+            {
+                s_rng.GetBytes(bytes);
+                bytes.AsSpan(0, buffer.Length).CopyTo(buffer);
+            }
+            finally
+            {
+                Array.Clear(bytes, 0, bytes.Length);
+                ArrayPool<byte>.Shared.Return(bytes);
+            }
+        }
+    }
+
+    internal static class SHA256
+    {
+        public static int HashData(ReadOnlySpan<byte> source, Span<byte> destination)
+        {
+            using System.Security.Cryptography.SHA256 sha256 = System.Security.Cryptography.SHA256.Create();
+            byte[] hash = sha256.ComputeHash(source.ToArray());
+            hash.CopyTo(destination);
+            return hash.Length;
+        }
+    }
+
+    /// <summary>
+    /// Shadows System.Buffers.Text.Base64Url from Microsoft.Bcl.Memory, which
+    /// has no hardware acceleration on .NET Framework. Decoding of
+    /// 4-character aligned input that contains only printable base64url
+    /// characters (i.e. every valid CASK key) is handled here using
+    /// System.Numerics.Vector. Everything else, including all error
+    /// handling, is forwarded to Microsoft.Bcl.Memory so that behavior is
+    /// identical.
+    /// </summary>
+    internal static class Base64Url
+    {
+        public static OperationStatus DecodeFromChars(ReadOnlySpan<char> source, Span<byte> destination, out int charsConsumed, out int bytesWritten, bool isFinalBlock = true)
+        {
+            if (TryDecodeAligned(source, destination, out bytesWritten))
+            {
+                charsConsumed = source.Length;
+                return OperationStatus.Done;
+            }
+
+            return System.Buffers.Text.Base64Url.DecodeFromChars(source, destination, out charsConsumed, out bytesWritten, isFinalBlock);
+        }
+
+        public static OperationStatus DecodeFromUtf8(ReadOnlySpan<byte> source, Span<byte> destination, out int bytesConsumed, out int bytesWritten, bool isFinalBlock = true)
+        {
+            if (TryDecodeAligned(source, destination, out bytesWritten))
+            {
+                bytesConsumed = source.Length;
+                return OperationStatus.Done;
+            }
+
+            return System.Buffers.Text.Base64Url.DecodeFromUtf8(source, destination, out bytesConsumed, out bytesWritten, isFinalBlock);
+        }
+
+        public static int DecodeFromChars(ReadOnlySpan<char> source, Span<byte> destination)
+        {
+            if (TryDecodeAligned(source, destination, out int bytesWritten))
+            {
+                return bytesWritten;
+            }
+
+            return System.Buffers.Text.Base64Url.DecodeFromChars(source, destination);
+        }
+
+        public static bool TryDecodeFromChars(ReadOnlySpan<char> source, Span<byte> destination, out int bytesWritten)
+        {
+            return TryDecodeAligned(source, destination, out bytesWritten) ||
+                   System.Buffers.Text.Base64Url.TryDecodeFromChars(source, destination, out bytesWritten);
+        }
+
+        public static byte[] DecodeFromChars(ReadOnlySpan<char> source)
+        {
+            return System.Buffers.Text.Base64Url.DecodeFromChars(source);
+        }
+
+        public static byte[] DecodeFromUtf8(ReadOnlySpan<byte> source)
+        {
+            return System.Buffers.Text.Base64Url.DecodeFromUtf8(source);
+        }
+
+        public static int EncodeToChars(ReadOnlySpan<byte> source, Span<char> destination)
+        {
+            return System.Buffers.Text.Base64Url.EncodeToChars(source, destination);
+        }
+
+        public static int EncodeToUtf8(ReadOnlySpan<byte> source, Span<byte> destination)
+        {
+            return System.Buffers.Text.Base64Url.EncodeToUtf8(source, destination);
+        }
+
+        public static string EncodeToString(ReadOnlySpan<byte> source)
+        {
+            return System.Buffers.Text.Base64Url.EncodeToString(source);
+        }
+
+        private static bool TryDecodeAligned(ReadOnlySpan<char> source, Span<byte> destination, out int bytesWritten)
+        {
+            bytesWritten = 0;
+
+            if (source.Length % 4 != 0 || destination.Length < source.Length / 4 * 3)
+            {
+                return false;
+            }
+
+            ReadOnlySpan<ushort> chars = MemoryMarshal.Cast<char, ushort>(source);
+            Span<ushort> sextets = stackalloc ushort[Vector<ushort>.Count];
+            int i = 0;
+
+            if (Vector.IsHardwareAccelerated)
+            {
+                var upperA = new Vector<ushort>('A');
+                var lowerA = new Vector<ushort>('a');
+                var zero = new Vector<ushort>('0');
+                var dash = new Vector<ushort>('-');
+                var underscore = new Vector<ushort>('_');
+
+                for (; i <= chars.Length - Vector<ushort>.Count; i += Vector<ushort>.Count)
+                {
+                    Vector<ushort> c = MemoryMarshal.Read<Vector<ushort>>(MemoryMarshal.AsBytes(chars.Slice(i, Vector<ushort>.Count)));
+
+                    // Unsigned wraparound turns each range check into a single comparison.
+                    Vector<ushort> isUpper = Vector.LessThanOrEqual(c - upperA, new Vector<ushort>(25));
+                    Vector<ushort> isLower = Vector.LessThanOrEqual(c - lowerA, new Vector<ushort>(25));
+                    Vector<ushort> isDigit = Vector.LessThanOrEqual(c - zero, new Vector<ushort>(9));
+                    Vector<ushort> isDash = Vector.Equals(c, dash);
+                    Vector<ushort> isUnderscore = Vector.Equals(c, underscore);
+
+                    if (!Vector.EqualsAll(isUpper | isLower | isDigit | isDash | isUnderscore, new Vector<ushort>(ushort.MaxValue)))
+                    {
+                        return false;
+                    }
+
+                    Vector<ushort> values = (isUpper & (c - upperA))
+                                          | (isLower & (c - new Vector<ushort>('a' - 26)))
+                                          | (isDigit & (c + new Vector<ushort>(52 - '0')))
+                                          | (isDash & new Vector<ushort>(62))
+                                          | (isUnderscore & new Vector<ushort>(63));
+
+                    MemoryMarshal.Write(MemoryMarshal.AsBytes(sextets), ref values);
+
+                    for (int j = 0; j < sextets.Length; j += 4)
+                    {
+                        WriteQuantum(sextets[j], sextets[j + 1], sextets[j + 2], sextets[j + 3], destination[(bytesWritten + j / 4 * 3)..]);
+                    }
+                    bytesWritten += Vector<ushort>.Count / 4 * 3;
+                }
+            }
+
+            for (; i < chars.Length; i += 4)
+            {
+                if (!TryDecodeQuantum(chars[i], chars[i + 1], chars[i + 2], chars[i + 3], destination[bytesWritten..]))
+                {
+                    bytesWritten = 0;
+                    return false;
+                }
+                bytesWritten += 3;
+            }
+
+            return true;
+        }
+
+        private static bool TryDecodeAligned(ReadOnlySpan<byte> source, Span<byte> destination, out int bytesWritten)
+        {
+            bytesWritten = 0;
+
+            if (source.Length % 4 != 0 || destination.Length < source.Length / 4 * 3)
+            {
+                return false;
+            }
+
+            Span<byte> sextets = stackalloc byte[Vector<byte>.Count];
+            int i = 0;
+
+            if (Vector.IsHardwareAccelerated)
+            {
+                var upperA = new Vector<byte>((byte)'A');
+                var lowerA = new Vector<byte>((byte)'a');
+                var zero = new Vector<byte>((byte)'0');
+                var dash = new Vector<byte>((byte)'-');
+                var underscore = new Vector<byte>((byte)'_');
+
+                for (; i <= source.Length - Vector<byte>.Count; i += Vector<byte>.Count)
+                {
+                    Vector<byte> c = MemoryMarshal.Read<Vector<byte>>(source.Slice(i, Vector<byte>.Count));
+
+                    // Unsigned wraparound turns each range check into a single comparison.
+                    Vector<byte> isUpper = Vector.LessThanOrEqual(c - upperA, new Vector<byte>(25));
+                    Vector<byte> isLower = Vector.LessThanOrEqual(c - lowerA, new Vector<byte>(25));
+                    Vector<byte> isDigit = Vector.LessThanOrEqual(c - zero, new Vector<byte>(9));
+                    Vector<byte> isDash = Vector.Equals(c, dash);
+                    Vector<byte> isUnderscore = Vector.Equals(c, underscore);
+
+                    if (!Vector.EqualsAll(isUpper | isLower | isDigit | isDash | isUnderscore, new Vector<byte>(byte.MaxValue)))
+                    {
+                        return false;
+                    }
+
+                    Vector<byte> values = (isUpper & (c - upperA))
+                                        | (isLower & (c - new Vector<byte>('a' - 26)))
+                                        | (isDigit & (c + new Vector<byte>(52 - '0')))
+                                        | (isDash & new Vector<byte>(62))
+                                        | (isUnderscore & new Vector<byte>(63));
+
+                    MemoryMarshal.Write(sextets, ref values);
+
+                    for (int j = 0; j < sextets.Length; j += 4)
+                    {
+                        WriteQuantum(sextets[j], sextets[j + 1], sextets[j + 2], sextets[j + 3], destination[(bytesWritten + j / 4 * 3)..]);
+                    }
+                    bytesWritten += Vector<byte>.Count / 4 * 3;
+                }
+            }
+
+            for (; i < source.Length; i += 4)
+            {
+                if (!TryDecodeQuantum(source[i], source[i + 1], source[i + 2], source[i + 3], destination[bytesWritten..]))
+                {
+                    bytesWritten = 0;
+                    return false;
+                }
+                bytesWritten += 3;
+            }
+
+            return true;
+        }
+
+        private static bool TryDecodeQuantum(int c0, int c1, int c2, int c3, Span<byte> destination)
+        {
+            int s0 = DecodeSextet(c0);
+            int s1 = DecodeSextet(c1);
+            int s2 = DecodeSextet(c2);
+            int s3 = DecodeSextet(c3);
+
+            if ((s0 | s1 | s2 | s3) < 0)
+            {
+                return false;
+            }
+
+            WriteQuantum(s0, s1, s2, s3, destination);
+            return true;
         }
+
+        private static void WriteQuantum(int s0, int s1, int s2, int s3, Span<byte> destination)
+        {
+            int bits = (s0 << 18) | (s1 << 12) | (s2 << 6) | s3;
+            destination[0] = unchecked((byte)(bits >> 16));
+            destination[1] = unchecked((byte)(bits >> 8));
+            destination[2] = unchecked((byte)bits);
+        }
+
+        private static int DecodeSextet(int c)
+        {
+            return c < DecodeMap.Length ? DecodeMap[c] : -1;
+        }
+
+        // Maps ASCII to the 6-bit value of each printable base64url character, -1 otherwise.
+        private static ReadOnlySpan<sbyte> DecodeMap => [
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1,
+            52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+            -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+            15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, 63,
+            -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+            41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+        ];
     }
 }
 
@@ -147,11 +529,17 @@ namespace CommonAnnotatedSecurityKeys
     partial record struct CaskKey
     {
         // On modern .NET, the regex will be compiled into this partial method
-        // by a source generator. For .NET Framework, fill it in by newing up a
-        // Regex that is compiled at runtime.
+        // by a source generator, which also caches the instance. For .NET
+        // Framework, fill it in by newing up a Regex that is compiled at
+        // runtime the first time it is requested and cache it ourselves.
         private static partial Regex CompiledRegex()
         {
-            return new Regex(RegexPattern, RegexFlags);
+            return LazyRegex.Instance;
+        }
+
+        private static class LazyRegex
+        {
+            public static readonly Regex Instance = new(RegexPattern, RegexFlags);
         }
     }
 }
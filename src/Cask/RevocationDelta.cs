@@ -0,0 +1,230 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+using System.Diagnostics.CodeAnalysis;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// The keys revoked and unrevoked between two versions of a revocation list,
+/// applied to a <see cref="RevocationSet"/> to bring it to the later version.
+/// </summary>
+/// <remarks>
+/// The binary format, with all numbers little-endian, is a 32-byte header
+/// (magic "CRVD", format version, base version, version, number of added
+/// and of removed fingerprints) followed by the added and then the removed
+/// fingerprints, each 16 bytes and in ascending order.
+/// </remarks>
+public sealed class RevocationDelta
+{
+    internal const uint Magic = 0x44565243; // "CRVD"
+    internal const uint FormatVersion = 1;
+    internal const int HeaderSize = 32;
+
+    private readonly CaskKeyFingerprint[] _added;
+    private readonly CaskKeyFingerprint[] _removed;
+
+    /// <summary>
+    /// Creates a delta from one version of a revocation list to another.
+    /// </summary>
+    /// <param name="baseVersion">The version to which the delta applies.</param>
+    /// <param name="version">The version that results, which must be greater.</param>
+    /// <param name="added">The fingerprints of keys revoked since the base version.</param>
+    /// <param name="removed">The fingerprints of keys no longer revoked since the base version.</param>
+    public RevocationDelta(long baseVersion,
+                           long version,
+                           IEnumerable<CaskKeyFingerprint> added,
+                           IEnumerable<CaskKeyFingerprint> removed)
+    {
+        ThrowIfNull(added);
+        ThrowIfNull(removed);
+
+        if (version <= baseVersion)
+        {
+            throw new ArgumentOutOfRangeException(nameof(version), "The version must be greater than the base version.");
+        }
+
+        BaseVersion = baseVersion;
+        Version = version;
+        _added = SortDistinct(added);
+        _removed = SortDistinct(removed);
+
+        if (Intersects(_added, _removed))
+        {
+            throw new ArgumentException("A fingerprint cannot be both added and removed.", nameof(removed));
+        }
+    }
+
+    private RevocationDelta(long baseVersion, long version, CaskKeyFingerprint[] added, CaskKeyFingerprint[] removed)
+    {
+        BaseVersion = baseVersion;
+        Version = version;
+        _added = added;
+        _removed = removed;
+    }
+
+    /// <summary>
+    /// The version of the revocation list to which the delta applies.
+    /// </summary>
+    public long BaseVersion { get; }
+
+    /// <summary>
+    /// The version of the revocation list after the delta is applied.
+    /// </summary>
+    public long Version { get; }
+
+    /// <summary>
+    /// The fingerprints of keys revoked since the base version, in ascending
+    /// order.
+    /// </summary>
+    public IReadOnlyList<CaskKeyFingerprint> Added => _added;
+
+    /// <summary>
+    /// The fingerprints of keys no longer revoked since the base version, in
+    /// ascending order.
+    /// </summary>
+    public IReadOnlyList<CaskKeyFingerprint> Removed => _removed;
+
+    internal ReadOnlySpan<CaskKeyFingerprint> AddedSpan => _added;
+
+    internal ReadOnlySpan<CaskKeyFingerprint> RemovedSpan => _removed;
+
+    /// <summary>
+    /// Reads a delta written by <see cref="ToArray"/> or <see cref="WriteTo"/>.
+    /// </summary>
+    /// <exception cref="InvalidDataException">The data is not a valid delta.</exception>
+    public static RevocationDelta Read(ReadOnlySpan<byte> data)
+    {
+        if (data.Length < HeaderSize ||
+            BinaryPrimitives.ReadUInt32LittleEndian(data) != Magic ||
+            BinaryPrimitives.ReadUInt32LittleEndian(data[4..]) != FormatVersion)
+        {
+            ThrowInvalidDelta();
+        }
+
+        long baseVersion = BinaryPrimitives.ReadInt64LittleEndian(data[8..]);
+        long version = BinaryPrimitives.ReadInt64LittleEndian(data[16..]);
+        uint addedCount = BinaryPrimitives.ReadUInt32LittleEndian(data[24..]);
+        uint removedCount = BinaryPrimitives.ReadUInt32LittleEndian(data[28..]);
+
+        if (version <= baseVersion ||
+            HeaderSize + (((long)addedCount + removedCount) * CaskKeyFingerprint.SizeInBytes) != data.Length)
+        {
+            ThrowInvalidDelta();
+        }
+
+        ReadOnlySpan<byte> entries = data[HeaderSize..];
+        CaskKeyFingerprint[] added = ReadSorted(ref entries, (int)addedCount);
+        CaskKeyFingerprint[] removed = ReadSorted(ref entries, (int)removedCount);
+
+        if (Intersects(added, removed))
+        {
+            ThrowInvalidDelta();
+        }
+
+        return new RevocationDelta(baseVersion, version, added, removed);
+    }
+
+    /// <summary>
+    /// Writes the delta in its binary format.
+    /// </summary>
+    public byte[] ToArray()
+    {
+        byte[] data = new byte[HeaderSize + ((_added.Length + _removed.Length) * CaskKeyFingerprint.SizeInBytes)];
+        Span<byte> span = data;
+
+        BinaryPrimitives.WriteUInt32LittleEndian(span, Magic);
+        BinaryPrimitives.WriteUInt32LittleEndian(span[4..], FormatVersion);
+        BinaryPrimitives.WriteInt64LittleEndian(span[8..], BaseVersion);
+        BinaryPrimitives.WriteInt64LittleEndian(span[16..], Version);
+        BinaryPrimitives.WriteUInt32LittleEndian(span[24..], (uint)_added.Length);
+        BinaryPrimitives.WriteUInt32LittleEndian(span[28..], (uint)_removed.Length);
+
+        span = span[HeaderSize..];
+        foreach (CaskKeyFingerprint fingerprint in _added.Concat(_removed))
+        {
+            fingerprint.WriteTo(span);
+            span = span[CaskKeyFingerprint.SizeInBytes..];
+        }
+
+        return data;
+    }
+
+    /// <inheritdoc cref="ToArray"/>
+    public void WriteTo(Stream destination)
+    {
+        ThrowIfNull(destination);
+
+        byte[] data = ToArray();
+        destination.Write(data, 0, data.Length);
+    }
+
+    private static CaskKeyFingerprint[] SortDistinct(IEnumerable<CaskKeyFingerprint> fingerprints)
+    {
+        CaskKeyFingerprint[] sorted = fingerprints.ToArray();
+        Array.Sort(sorted, CaskKeyFingerprint.Compare);
+
+        int count = 0;
+        for (int i = 0; i < sorted.Length; i++)
+        {
+            if (count == 0 || sorted[i] != sorted[count - 1])
+            {
+                sorted[count++] = sorted[i];
+            }
+        }
+
+        Array.Resize(ref sorted, count);
+        return sorted;
+    }
+
+    private static CaskKeyFingerprint[] ReadSorted(ref ReadOnlySpan<byte> entries, int count)
+    {
+        var fingerprints = new CaskKeyFingerprint[count];
+
+        for (int i = 0; i < count; i++)
+        {
+            fingerprints[i] = CaskKeyFingerprint.Read(entries);
+            entries = entries[CaskKeyFingerprint.SizeInBytes..];
+
+            if (i > 0 && CaskKeyFingerprint.Compare(fingerprints[i - 1], fingerprints[i]) >= 0)
+            {
+                ThrowInvalidDelta();
+            }
+        }
+
+        return fingerprints;
+    }
+
+    private static bool Intersects(CaskKeyFingerprint[] x, CaskKeyFingerprint[] y)
+    {
+        int i = 0;
+        int j = 0;
+
+        while (i < x.Length && j < y.Length)
+        {
+            int comparison = CaskKeyFingerprint.Compare(x[i], y[j]);
+            if (comparison == 0)
+            {
+                return true;
+            }
+
+            if (comparison < 0)
+            {
+                i++;
+            }
+            else
+            {
+                j++;
+            }
+        }
+
+        return false;
+    }
+
+    [DoesNotReturn]
+    private static void ThrowInvalidDelta()
+    {
+        throw new InvalidDataException("The data is not a valid revocation delta.");
+    }
+}
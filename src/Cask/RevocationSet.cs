@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// The current version of a revocation list, updated by deltas while it is
+/// being read.
+/// </summary>
+/// <remarks>
+/// <para>
+/// Readers use the current <see cref="RevocationSnapshot"/>, which never
+/// changes. Each delta is merged into a new snapshot, which then replaces the
+/// current one with a single reference write, so lookups never take locks or
+/// wait for an update, and a reader holding <see cref="Current"/> sees one
+/// consistent version for as long as it keeps it.
+/// </para>
+/// <para>
+/// The previous snapshot is garbage once the readers that had it are done,
+/// so memory stays bounded to about two snapshots while deltas are applied.
+/// </para>
+/// </remarks>
+public sealed class RevocationSet
+{
+    private readonly object _updateLock = new();
+    private RevocationSnapshot _current;
+
+    /// <param name="snapshot">
+    /// The initial version of the list, or null for an empty list at version
+    /// zero.
+    /// </param>
+    public RevocationSet(RevocationSnapshot? snapshot = null)
+    {
+        _current = snapshot ?? RevocationSnapshot.Empty;
+    }
+
+    /// <summary>
+    /// The current version of the list.
+    /// </summary>
+    public RevocationSnapshot Current => Volatile.Read(ref _current);
+
+    /// <summary>
+    /// Determines whether a key is revoked in the current version.
+    /// </summary>
+    public bool IsRevoked(CaskKey key)
+    {
+        return Current.Contains(CaskKeyFingerprint.Create(key));
+    }
+
+    /// <inheritdoc cref="IsRevoked(CaskKey)"/>
+    public bool IsRevoked(CaskKeyFingerprint fingerprint)
+    {
+        return Current.Contains(fingerprint);
+    }
+
+    /// <summary>
+    /// Applies a delta to the current version and publishes the result.
+    /// Deltas are applied one at a time.
+    /// </summary>
+    /// <exception cref="InvalidOperationException">
+    /// The delta does not apply to the current version.
+    /// </exception>
+    public void Apply(RevocationDelta delta)
+    {
+        ThrowIfNull(delta);
+
+        lock (_updateLock)
+        {
+            Volatile.Write(ref _current, _current.Apply(delta));
+        }
+    }
+
+    /// <summary>
+    /// Replaces the current version with a full snapshot, for example to
+    /// recover after a delta was missed.
+    /// </summary>
+    public void Publish(RevocationSnapshot snapshot)
+    {
+        ThrowIfNull(snapshot);
+
+        lock (_updateLock)
+        {
+            Volatile.Write(ref _current, snapshot);
+        }
+    }
+}
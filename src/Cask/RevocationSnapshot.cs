@@ -0,0 +1,162 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// An immutable version of a revocation list.
+/// </summary>
+/// <remarks>
+/// Fingerprints are kept in one sorted array with a directory of buckets on
+/// their leading bits, sized to a few fingerprints per bucket, so a lookup
+/// reads two directory entries and searches a handful of fingerprints. A
+/// snapshot is never modified, so it can be read from any number of threads
+/// without locks.
+/// </remarks>
+public sealed class RevocationSnapshot
+{
+    private const int MaxBucketBits = 22;
+
+    private readonly CaskKeyFingerprint[] _fingerprints;
+    private readonly int _count;
+    private readonly BucketDirectory _directory;
+
+    private RevocationSnapshot(long version, CaskKeyFingerprint[] fingerprints, int count)
+    {
+        Version = version;
+        _fingerprints = fingerprints;
+        _count = count;
+        _directory = new BucketDirectory(count, MaxBucketBits, index => fingerprints[index].High);
+    }
+
+    /// <summary>
+    /// An empty revocation list at version zero.
+    /// </summary>
+    public static RevocationSnapshot Empty { get; } = new(0, [], 0);
+
+    /// <summary>
+    /// The version of the revocation list.
+    /// </summary>
+    public long Version { get; }
+
+    /// <summary>
+    /// The number of revoked keys.
+    /// </summary>
+    public int Count => _count;
+
+    /// <summary>
+    /// Creates a snapshot of a full revocation list.
+    /// </summary>
+    public static RevocationSnapshot Create(long version, IEnumerable<CaskKeyFingerprint> revoked)
+    {
+        ThrowIfNull(revoked);
+
+        var delta = new RevocationDelta(long.MinValue, version, revoked, []);
+        return Empty.Apply(delta, checkVersion: false);
+    }
+
+    /// <summary>
+    /// Determines whether a key is revoked.
+    /// </summary>
+    public bool Contains(CaskKeyFingerprint fingerprint)
+    {
+        _directory.GetRange(fingerprint.High, out int low, out int end);
+        int high = end - 1;
+
+        while (low <= high)
+        {
+            int middle = low + ((high - low) >> 1);
+            int comparison = CaskKeyFingerprint.Compare(_fingerprints[middle], fingerprint);
+
+            if (comparison == 0)
+            {
+                return true;
+            }
+
+            if (comparison < 0)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle - 1;
+            }
+        }
+
+        return false;
+    }
+
+    /// <summary>
+    /// Builds the next version by merging the delta into this one. This
+    /// snapshot is not changed.
+    /// </summary>
+    /// <remarks>
+    /// The fingerprints in a snapshot and in a delta are both sorted, so
+    /// applying a delta of m changes to a snapshot of n keys takes one O(n + m)
+    /// pass with no hashing or sorting.
+    /// </remarks>
+    /// <exception cref="InvalidOperationException">
+    /// The delta does not apply to this version.
+    /// </exception>
+    public RevocationSnapshot Apply(RevocationDelta delta)
+    {
+        ThrowIfNull(delta);
+        return Apply(delta, checkVersion: true);
+    }
+
+    private RevocationSnapshot Apply(RevocationDelta delta, bool checkVersion)
+    {
+        if (checkVersion && delta.BaseVersion != Version)
+        {
+            throw new InvalidOperationException($"The delta applies to version {delta.BaseVersion}, not {Version}.");
+        }
+
+        ReadOnlySpan<CaskKeyFingerprint> current = _fingerprints.AsSpan(0, _count);
+        ReadOnlySpan<CaskKeyFingerprint> added = delta.AddedSpan;
+        ReadOnlySpan<CaskKeyFingerprint> removed = delta.RemovedSpan;
+
+        var next = new CaskKeyFingerprint[current.Length + added.Length];
+        int count = 0;
+        int i = 0;
+        int j = 0;
+        int k = 0;
+
+        while (i < current.Length || j < added.Length)
+        {
+            CaskKeyFingerprint fingerprint;
+
+            if (j == added.Length)
+            {
+                fingerprint = current[i++];
+            }
+            else if (i == current.Length)
+            {
+                fingerprint = added[j++];
+            }
+            else
+            {
+                int comparison = CaskKeyFingerprint.Compare(current[i], added[j]);
+                fingerprint = comparison <= 0 ? current[i++] : added[j++];
+
+                if (comparison == 0)
+                {
+                    j++;
+                }
+            }
+
+            while (k < removed.Length && CaskKeyFingerprint.Compare(removed[k], fingerprint) < 0)
+            {
+                k++;
+            }
+
+            if (k < removed.Length && removed[k] == fingerprint)
+            {
+                continue;
+            }
+
+            next[count++] = fingerprint;
+        }
+
+        return new RevocationSnapshot(delta.Version, next, count);
+    }
+}
@@ -0,0 +1,345 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers;
+using System.Buffers.Binary;
+using System.Diagnostics.CodeAnalysis;
+using System.IO.MemoryMappedFiles;
+using System.Text;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// A reverse index from the hash prefixes of <see cref="TenantProviderData"/>
+/// to the regions and tenant IDs that have them, for attributing keys to
+/// tenants without hashing every known tenant ID for every key.
+/// </summary>
+/// <remarks>
+/// <para>
+/// An index is built by <see cref="TenantIndexBuilder"/> into a single
+/// read-only block of bytes that is used in place, so an index written to a
+/// file can be memory-mapped with <see cref="Open"/> and shared by any number
+/// of threads and processes without being parsed or copied onto the heap.
+/// </para>
+/// <para>
+/// For each of regions and tenants, entries are sorted by the 30-bit hash
+/// prefix, and a directory of buckets on the leading bits of the prefix,
+/// sized to about one entry per bucket, points to where each bucket starts.
+/// A lookup reads two directory entries and compares the few entries between
+/// them, so it takes constant time regardless of the size of the index.
+/// </para>
+/// <para>
+/// The format, with all numbers little-endian, is a 48-byte header (magic
+/// "CTIX", version, heap offset, total length, then the entry count, bucket
+/// bits, directory offset and entries offset of regions and of tenants), the
+/// directories and entries (30-bit hash and heap offset of the name), and a
+/// heap of names, each a 16-bit length and UTF-8 bytes.
+/// </para>
+/// </remarks>
+public sealed class TenantIndex : IDisposable
+{
+    internal const uint Magic = 0x58495443; // "CTIX"
+    internal const uint Version = 1;
+    internal const int HeaderSize = 48;
+    internal const int EntrySize = 8;
+    internal const int MaxBucketBits = 16;
+
+    private readonly ReadOnlyMemory<byte> _data;
+    private readonly IDisposable? _owner;
+    private readonly Table _regions;
+    private readonly Table _tenants;
+    private readonly int _heapOffset;
+
+    private TenantIndex(ReadOnlyMemory<byte> data, IDisposable? owner)
+    {
+        ReadOnlySpan<byte> span = data.Span;
+
+        if (span.Length < HeaderSize ||
+            BinaryPrimitives.ReadUInt32LittleEndian(span) != Magic ||
+            BinaryPrimitives.ReadUInt32LittleEndian(span[4..]) != Version)
+        {
+            ThrowInvalidIndex();
+        }
+
+        _heapOffset = ReadOffset(span, 8, span.Length);
+        int length = ReadOffset(span, 12, span.Length);
+
+        _data = data[..length];
+        _owner = owner;
+        _regions = Table.Read(_data.Span, 16, _heapOffset);
+        _tenants = Table.Read(_data.Span, 32, _heapOffset);
+    }
+
+    /// <summary>
+    /// The number of regions in the index.
+    /// </summary>
+    public int RegionCount => _regions.Count;
+
+    /// <summary>
+    /// The number of tenants in the index.
+    /// </summary>
+    public int TenantCount => _tenants.Count;
+
+    /// <summary>
+    /// Uses an index that was built into memory.
+    /// </summary>
+    /// <exception cref="InvalidDataException">The data is not a valid index.</exception>
+    public static TenantIndex Load(ReadOnlyMemory<byte> data)
+    {
+        return new TenantIndex(data, owner: null);
+    }
+
+    /// <summary>
+    /// Memory-maps an index file. The file is not read until it is used, and
+    /// only the pages that lookups touch are loaded.
+    /// </summary>
+    /// <exception cref="InvalidDataException">The file is not a valid index.</exception>
+    public static TenantIndex Open(string path)
+    {
+        var manager = new MappedMemoryManager(path);
+        try
+        {
+            return new TenantIndex(manager.Memory, manager);
+        }
+        catch
+        {
+            ((IDisposable)manager).Dispose();
+            throw;
+        }
+    }
+
+    /// <summary>
+    /// Finds the regions whose names have the given 5-character hash prefix.
+    /// </summary>
+    public IReadOnlyList<string> FindRegions(string regionHash)
+    {
+        return Find(_regions, regionHash);
+    }
+
+    /// <summary>
+    /// Finds the tenants whose IDs have the given 5-character hash prefix.
+    /// </summary>
+    public IReadOnlyList<string> FindTenants(string tenantHash)
+    {
+        return Find(_tenants, tenantHash);
+    }
+
+    /// <summary>
+    /// Finds the candidate regions and tenants to which a key was issued.
+    /// </summary>
+    /// <returns>
+    /// True if the key has <see cref="TenantProviderData"/>, even if no
+    /// candidates were found.
+    /// </returns>
+    public bool TryAttribute(CaskKey key, out IReadOnlyList<string> regions, out IReadOnlyList<string> tenants)
+    {
+        if (!TenantProviderData.TryDecode(key, out TenantProviderData data))
+        {
+            regions = [];
+            tenants = [];
+            return false;
+        }
+
+        regions = FindRegions(data.RegionHash);
+        tenants = FindTenants(data.TenantHash);
+        return true;
+    }
+
+    /// <summary>
+    /// Releases the memory-mapped file, if any. Lists returned by lookups
+    /// remain valid.
+    /// </summary>
+    public void Dispose()
+    {
+        _owner?.Dispose();
+    }
+
+    internal int GetCount(bool tenants)
+    {
+        return (tenants ? _tenants : _regions).Count;
+    }
+
+    /// <summary>
+    /// Gets an entry in order of hash prefix, with its name as UTF-8.
+    /// </summary>
+    internal (uint Hash, ReadOnlyMemory<byte> NameUtf8) GetEntry(bool tenants, int index)
+    {
+        Table table = tenants ? _tenants : _regions;
+        ReadOnlySpan<byte> entry = _data.Span.Slice(table.EntriesOffset + (index * EntrySize), EntrySize);
+        return (BinaryPrimitives.ReadUInt32LittleEndian(entry), GetName(BinaryPrimitives.ReadUInt32LittleEndian(entry[4..])));
+    }
+
+    internal bool Contains(bool tenants, uint hash, ReadOnlySpan<byte> nameUtf8)
+    {
+        Table table = tenants ? _tenants : _regions;
+        GetBucket(table, hash, out int start, out int end);
+
+        for (int i = start; i < end; i++)
+        {
+            (uint entryHash, ReadOnlyMemory<byte> name) = GetEntry(tenants, i);
+            if (entryHash == hash && name.Span.SequenceEqual(nameUtf8))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    private List<string> Find(Table table, string hashPrefix)
+    {
+        if (!TenantProviderData.TryPackHash(hashPrefix.AsSpan(), out uint hash))
+        {
+            return [];
+        }
+
+        GetBucket(table, hash, out int start, out int end);
+        ReadOnlySpan<byte> data = _data.Span;
+        var found = new List<string>();
+
+        for (int i = start; i < end; i++)
+        {
+            ReadOnlySpan<byte> entry = data.Slice(table.EntriesOffset + (i * EntrySize), EntrySize);
+            if (BinaryPrimitives.ReadUInt32LittleEndian(entry) == hash)
+            {
+                found.Add(Encoding.UTF8.GetString(GetName(BinaryPrimitives.ReadUInt32LittleEndian(entry[4..])).Span));
+            }
+        }
+
+        return found;
+    }
+
+    private void GetBucket(Table table, uint hash, out int start, out int end)
+    {
+        ReadOnlySpan<byte> directory = _data.Span[table.DirectoryOffset..];
+        int bucket = BucketDirectory.GetBucket((ulong)hash << (64 - TenantProviderData.HashBits), table.BucketBits);
+
+        start = (int)BinaryPrimitives.ReadUInt32LittleEndian(directory[(bucket * 4)..]);
+        end = (int)BinaryPrimitives.ReadUInt32LittleEndian(directory[((bucket + 1) * 4)..]);
+
+        if (start < 0 || end > table.Count || start > end)
+        {
+            ThrowInvalidIndex();
+        }
+    }
+
+    private ReadOnlyMemory<byte> GetName(uint heapOffset)
+    {
+        int offset = _heapOffset + (int)Math.Min(heapOffset, int.MaxValue);
+        ReadOnlySpan<byte> data = _data.Span;
+
+        if (offset < _heapOffset || offset + 2 > data.Length)
+        {
+            ThrowInvalidIndex();
+        }
+
+        int length = BinaryPrimitives.ReadUInt16LittleEndian(data[offset..]);
+        if (offset + 2 + length > data.Length)
+        {
+            ThrowInvalidIndex();
+        }
+
+        return _data.Slice(offset + 2, length);
+    }
+
+    private static int ReadOffset(ReadOnlySpan<byte> data, int position, int limit)
+    {
+        uint value = BinaryPrimitives.ReadUInt32LittleEndian(data[position..]);
+        if (value > (uint)limit)
+        {
+            ThrowInvalidIndex();
+        }
+
+        return (int)value;
+    }
+
+    [DoesNotReturn]
+    private static void ThrowInvalidIndex()
+    {
+        throw new InvalidDataException("The data is not a valid tenant index.");
+    }
+
+    private readonly record struct Table(int Count, int BucketBits, int DirectoryOffset, int EntriesOffset)
+    {
+        public static Table Read(ReadOnlySpan<byte> data, int position, int heapOffset)
+        {
+            int count = ReadOffset(data, position, int.MaxValue / EntrySize);
+            int bucketBits = ReadOffset(data, position + 4, MaxBucketBits);
+            int directoryOffset = ReadOffset(data, position + 8, heapOffset);
+            int entriesOffset = ReadOffset(data, position + 12, heapOffset);
+
+            if (directoryOffset + (((1L << bucketBits) + 1) * 4) > heapOffset ||
+                entriesOffset + ((long)count * EntrySize) > heapOffset)
+            {
+                ThrowInvalidIndex();
+            }
+
+            return new Table(count, bucketBits, directoryOffset, entriesOffset);
+        }
+    }
+
+    /// <summary>
+    /// Exposes a read-only memory-mapped file as <see cref="Memory{T}"/>.
+    /// </summary>
+    private sealed unsafe class MappedMemoryManager : MemoryManager<byte>
+    {
+        private readonly MemoryMappedFile _file;
+        private readonly MemoryMappedViewAccessor _view;
+        private readonly byte* _pointer;
+        private readonly int _length;
+
+        public MappedMemoryManager(string path)
+        {
+            long length = new FileInfo(path).Length;
+            if (length is < HeaderSize or > int.MaxValue)
+            {
+                ThrowInvalidIndex();
+            }
+
+            var file = MemoryMappedFile.CreateFromFile(path, FileMode.Open, mapName: null, capacity: 0, MemoryMappedFileAccess.Read);
+            MemoryMappedViewAccessor? view = null;
+            try
+            {
+                view = file.CreateViewAccessor(0, length, MemoryMappedFileAccess.Read);
+
+                byte* pointer = null;
+                view.SafeMemoryMappedViewHandle.AcquirePointer(ref pointer);
+                _pointer = pointer + view.PointerOffset;
+            }
+            catch
+            {
+                view?.Dispose();
+                file.Dispose();
+                throw;
+            }
+
+            _file = file;
+            _view = view;
+            _length = (int)length;
+        }
+
+        public override Span<byte> GetSpan()
+        {
+            return new Span<byte>(_pointer, _length);
+        }
+
+        public override MemoryHandle Pin(int elementIndex = 0)
+        {
+            return new MemoryHandle(_pointer + elementIndex);
+        }
+
+        public override void Unpin()
+        {
+        }
+
+        protected override void Dispose(bool disposing)
+        {
+            if (disposing)
+            {
+                _view.SafeMemoryMappedViewHandle.ReleasePointer();
+                _view.Dispose();
+                _file.Dispose();
+            }
+        }
+    }
+}
@@ -0,0 +1,230 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+using System.Text;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Builds a <see cref="TenantIndex"/>, either from scratch or incrementally
+/// from an existing index.
+/// </summary>
+/// <remarks>
+/// When built from an existing index, only the regions and tenants added
+/// since are hashed and sorted. The entries of the existing index are
+/// already sorted and are merged with the new ones without being decoded, so
+/// adding a few tenants to an index of millions costs little more than
+/// copying it.
+/// </remarks>
+public sealed class TenantIndexBuilder
+{
+    private const int MaxNameLengthInBytes = ushort.MaxValue;
+
+    private readonly TenantIndex? _baseIndex;
+    private readonly List<(uint Hash, byte[] NameUtf8)> _regions = [];
+    private readonly List<(uint Hash, byte[] NameUtf8)> _tenants = [];
+    private readonly HashSet<string> _addedRegions = new(StringComparer.Ordinal);
+    private readonly HashSet<string> _addedTenants = new(StringComparer.Ordinal);
+
+    /// <summary>
+    /// Creates a builder for a new, empty index.
+    /// </summary>
+    public TenantIndexBuilder()
+    {
+    }
+
+    /// <summary>
+    /// Creates a builder for an index that has all the entries of an
+    /// existing one. The existing index must not be disposed until the new
+    /// one is built.
+    /// </summary>
+    public TenantIndexBuilder(TenantIndex baseIndex)
+    {
+        ThrowIfNull(baseIndex);
+        _baseIndex = baseIndex;
+    }
+
+    /// <summary>
+    /// The number of regions in the index that would be built.
+    /// </summary>
+    public int RegionCount => (_baseIndex?.RegionCount ?? 0) + _regions.Count;
+
+    /// <summary>
+    /// The number of tenants in the index that would be built.
+    /// </summary>
+    public int TenantCount => (_baseIndex?.TenantCount ?? 0) + _tenants.Count;
+
+    /// <summary>
+    /// Adds a region by name.
+    /// </summary>
+    /// <returns>False if the region was already in the index.</returns>
+    public bool AddRegion(string region)
+    {
+        return Add(region, tenants: false, _regions, _addedRegions);
+    }
+
+    /// <summary>
+    /// Adds a tenant by ID.
+    /// </summary>
+    /// <returns>False if the tenant was already in the index.</returns>
+    public bool AddTenant(string tenantId)
+    {
+        return Add(tenantId, tenants: true, _tenants, _addedTenants);
+    }
+
+    /// <summary>
+    /// Builds the index into memory.
+    /// </summary>
+    public TenantIndex Build()
+    {
+        return TenantIndex.Load(ToArray());
+    }
+
+    /// <summary>
+    /// Writes the index, for example to a file that can later be opened with
+    /// <see cref="TenantIndex.Open"/>.
+    /// </summary>
+    public void WriteTo(Stream destination)
+    {
+        ThrowIfNull(destination);
+
+        byte[] index = ToArray();
+        destination.Write(index, 0, index.Length);
+    }
+
+    /// <summary>
+    /// Builds the index into an array.
+    /// </summary>
+    public byte[] ToArray()
+    {
+        List<(uint Hash, ReadOnlyMemory<byte> NameUtf8)> regions = Merge(tenants: false, _regions);
+        List<(uint Hash, ReadOnlyMemory<byte> NameUtf8)> tenants = Merge(tenants: true, _tenants);
+
+        int regionBucketBits = BucketDirectory.GetBucketBits(regions.Count, TenantIndex.MaxBucketBits);
+        int tenantBucketBits = BucketDirectory.GetBucketBits(tenants.Count, TenantIndex.MaxBucketBits);
+
+        int regionDirectoryOffset = TenantIndex.HeaderSize;
+        int regionEntriesOffset = checked(regionDirectoryOffset + (((1 << regionBucketBits) + 1) * 4));
+        int tenantDirectoryOffset = checked(regionEntriesOffset + (regions.Count * TenantIndex.EntrySize));
+        int tenantEntriesOffset = checked(tenantDirectoryOffset + (((1 << tenantBucketBits) + 1) * 4));
+        int heapOffset = checked(tenantEntriesOffset + (tenants.Count * TenantIndex.EntrySize));
+        long length = heapOffset + regions.Sum(entry => 2L + entry.NameUtf8.Length) + tenants.Sum(entry => 2L + entry.NameUtf8.Length);
+
+        if (length > int.MaxValue)
+        {
+            throw new InvalidOperationException("The index would be larger than 2 GB.");
+        }
+
+        byte[] index = new byte[length];
+        Span<byte> span = index;
+
+        BinaryPrimitives.WriteUInt32LittleEndian(span, TenantIndex.Magic);
+        BinaryPrimitives.WriteUInt32LittleEndian(span[4..], TenantIndex.Version);
+        BinaryPrimitives.WriteUInt32LittleEndian(span[8..], (uint)heapOffset);
+        BinaryPrimitives.WriteUInt32LittleEndian(span[12..], (uint)length);
+
+        int heapPosition = heapOffset;
+        WriteTable(span, 16, regions, regionBucketBits, regionDirectoryOffset, regionEntriesOffset, heapOffset, ref heapPosition);
+        WriteTable(span, 32, tenants, tenantBucketBits, tenantDirectoryOffset, tenantEntriesOffset, heapOffset, ref heapPosition);
+
+        return index;
+    }
+
+    private bool Add(string name, bool tenants, List<(uint Hash, byte[] NameUtf8)> added, HashSet<string> addedNames)
+    {
+        ThrowIfNull(name);
+
+        if (string.IsNullOrWhiteSpace(name))
+        {
+            throw new ArgumentException("Regions and tenant IDs must not be empty.", nameof(name));
+        }
+
+        byte[] nameUtf8 = Encoding.UTF8.GetBytes(name);
+        if (nameUtf8.Length > MaxNameLengthInBytes)
+        {
+            throw new ArgumentException($"Regions and tenant IDs must be at most {MaxNameLengthInBytes} bytes of UTF-8.", nameof(name));
+        }
+
+        uint hash = TenantProviderData.PackHash(name);
+
+        if (addedNames.Contains(name) || (_baseIndex?.Contains(tenants, hash, nameUtf8) ?? false))
+        {
+            return false;
+        }
+
+        addedNames.Add(name);
+        added.Add((hash, nameUtf8));
+        return true;
+    }
+
+    /// <summary>
+    /// Sorts the added entries and merges them with those of the base index.
+    /// </summary>
+    private List<(uint Hash, ReadOnlyMemory<byte> NameUtf8)> Merge(bool tenants, List<(uint Hash, byte[] NameUtf8)> added)
+    {
+        added.Sort((x, y) => x.Hash.CompareTo(y.Hash));
+
+        int baseCount = _baseIndex?.GetCount(tenants) ?? 0;
+        var merged = new List<(uint Hash, ReadOnlyMemory<byte> NameUtf8)>(baseCount + added.Count);
+        int baseIndex = 0;
+        int addedIndex = 0;
+
+        while (baseIndex < baseCount || addedIndex < added.Count)
+        {
+            if (baseIndex < baseCount)
+            {
+                (uint Hash, ReadOnlyMemory<byte> NameUtf8) entry = _baseIndex!.GetEntry(tenants, baseIndex);
+                if (addedIndex == added.Count || entry.Hash <= added[addedIndex].Hash)
+                {
+                    merged.Add(entry);
+                    baseIndex++;
+                    continue;
+                }
+            }
+
+            merged.Add(added[addedIndex]);
+            addedIndex++;
+        }
+
+        return merged;
+    }
+
+    private static void WriteTable(Span<byte> index,
+                                   int headerPosition,
+                                   List<(uint Hash, ReadOnlyMemory<byte> NameUtf8)> entries,
+                                   int bucketBits,
+                                   int directoryOffset,
+                                   int entriesOffset,
+                                   int heapOffset,
+                                   ref int heapPosition)
+    {
+        Span<byte> header = index[headerPosition..];
+        BinaryPrimitives.WriteUInt32LittleEndian(header, (uint)entries.Count);
+        BinaryPrimitives.WriteUInt32LittleEndian(header[4..], (uint)bucketBits);
+        BinaryPrimitives.WriteUInt32LittleEndian(header[8..], (uint)directoryOffset);
+        BinaryPrimitives.WriteUInt32LittleEndian(header[12..], (uint)entriesOffset);
+
+        int[] starts = new int[(1 << bucketBits) + 1];
+        BucketDirectory.Fill(starts, entries.Count, bucketBits, i => (ulong)entries[i].Hash << (64 - TenantProviderData.HashBits));
+
+        Span<byte> directory = index[directoryOffset..];
+        for (int bucket = 0; bucket < starts.Length; bucket++)
+        {
+            BinaryPrimitives.WriteUInt32LittleEndian(directory[(bucket * 4)..], (uint)starts[bucket]);
+        }
+
+        for (int i = 0; i < entries.Count; i++)
+        {
+            (uint hash, ReadOnlyMemory<byte> nameUtf8) = entries[i];
+
+            Span<byte> slot = index.Slice(entriesOffset + (i * TenantIndex.EntrySize), TenantIndex.EntrySize);
+            BinaryPrimitives.WriteUInt32LittleEndian(slot, hash);
+            BinaryPrimitives.WriteUInt32LittleEndian(slot[4..], (uint)(heapPosition - heapOffset));
+
+            BinaryPrimitives.WriteUInt16LittleEndian(index[heapPosition..], (ushort)nameUtf8.Length);
+            nameUtf8.Span.CopyTo(index[(heapPosition + 2)..]);
+            heapPosition += 2 + nameUtf8.Length;
+        }
+    }
+}
@@ -0,0 +1,164 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+using System.Buffers.Text;
+using System.Security.Cryptography;
+using System.Text;
+
+namespace CommonAnnotatedSecurityKeys;
+
+/// <summary>
+/// Encodes and decodes provider data that identifies the region and tenant
+/// to which a key was issued without revealing either.
+/// </summary>
+/// <remarks>
+/// The provider data is 16 characters: "AC", the first 5 base64url characters
+/// of the SHA-256 hash of the UTF-8 region name, the same for the tenant ID,
+/// and the reserved characters "AAAA". Each hash prefix holds 30 bits, so
+/// different tenants can share one; use <see cref="TenantIndex"/> to find the
+/// candidates for a prefix.
+/// </remarks>
+public readonly record struct TenantProviderData
+{
+    internal const int LengthInChars = 16;
+    internal const int HashLengthInChars = 5;
+    internal const int HashBits = HashLengthInChars * 6;
+
+    private const string Prefix = "AC";
+    private const string Reserved = "AAAA";
+    private const string EmptyHash = "AAAAA";
+
+    private TenantProviderData(string regionHash, string tenantHash)
+    {
+        RegionHash = regionHash;
+        TenantHash = tenantHash;
+    }
+
+    /// <summary>
+    /// The 5-character hash prefix of the region.
+    /// </summary>
+    public string RegionHash { get; }
+
+    /// <summary>
+    /// The 5-character hash prefix of the tenant ID.
+    /// </summary>
+    public string TenantHash { get; }
+
+    /// <summary>
+    /// Computes the 5-character hash prefix of a region or tenant ID. Empty
+    /// identifiers are encoded as "AAAAA".
+    /// </summary>
+    public static string HashIdentifier(string? identifier)
+    {
+        if (string.IsNullOrWhiteSpace(identifier))
+        {
+            return EmptyHash;
+        }
+
+        Span<byte> hash = stackalloc byte[32];
+        ComputeHash(identifier!, hash);
+        return Base64Url.EncodeToString(hash)[..HashLengthInChars];
+    }
+
+    /// <summary>
+    /// Encodes provider data for a key issued to the given tenant in the
+    /// given region.
+    /// </summary>
+    public static string Encode(string? region, string? tenantId)
+    {
+        return $"{Prefix}{HashIdentifier(region)}{HashIdentifier(tenantId)}{Reserved}";
+    }
+
+    /// <summary>
+    /// Decodes provider data in this layout.
+    /// </summary>
+    /// <returns>
+    /// True if the provider data has the length and prefix of this layout.
+    /// </returns>
+    public static bool TryDecode(ReadOnlySpan<char> providerData, out TenantProviderData data)
+    {
+        if (providerData.Length != LengthInChars ||
+            !providerData.StartsWith(Prefix.AsSpan(), StringComparison.Ordinal) ||
+            !TryPackHash(providerData.Slice(2, HashLengthInChars), out _) ||
+            !TryPackHash(providerData.Slice(2 + HashLengthInChars, HashLengthInChars), out _))
+        {
+            data = default;
+            return false;
+        }
+
+        data = new TenantProviderData(providerData.Slice(2, HashLengthInChars).ToString(),
+                                      providerData.Slice(2 + HashLengthInChars, HashLengthInChars).ToString());
+        return true;
+    }
+
+    /// <summary>
+    /// Decodes the provider data of a key in this layout.
+    /// </summary>
+    public static bool TryDecode(CaskKey key, out TenantProviderData data)
+    {
+        if (!key.IsInitialized)
+        {
+            data = default;
+            return false;
+        }
+
+        string text = key.ToString();
+        Cask.ExtractSecretSizeFromKeyChars(text.AsSpan(), out Range caskSignatureCharRange);
+
+        int signatureOffset = caskSignatureCharRange.Start.Value;
+        int providerDataLength = (text[signatureOffset + 6] - 'A') * 4;
+        return TryDecode(text.AsSpan(signatureOffset + 12, providerDataLength), out data);
+    }
+
+    /// <summary>
+    /// Computes the hash prefix of an identifier as a 30-bit number, which
+    /// is the number encoded by <see cref="HashIdentifier"/>.
+    /// </summary>
+    internal static uint PackHash(string identifier)
+    {
+        Span<byte> hash = stackalloc byte[32];
+        ComputeHash(identifier, hash);
+        return BinaryPrimitives.ReadUInt32BigEndian(hash) >> (32 - HashBits);
+    }
+
+    /// <summary>
+    /// Converts a 5-character hash prefix to the 30-bit number it encodes.
+    /// </summary>
+    internal static bool TryPackHash(ReadOnlySpan<char> hash, out uint packed)
+    {
+        packed = 0;
+        if (hash.Length != HashLengthInChars)
+        {
+            return false;
+        }
+
+        foreach (char c in hash)
+        {
+            int sextet = c switch
+            {
+                >= 'A' and <= 'Z' => c - 'A',
+                >= 'a' and <= 'z' => c - 'a' + 26,
+                >= '0' and <= '9' => c - '0' + 52,
+                '-' => 62,
+                '_' => 63,
+                _ => -1,
+            };
+
+            if (sextet < 0)
+            {
+                return false;
+            }
+
+            packed = (packed << 6) | (uint)sextet;
+        }
+
+        return true;
+    }
+
+    private static void ComputeHash(string identifier, Span<byte> hash)
+    {
+        byte[] utf8 = Encoding.UTF8.GetBytes(identifier);
+        SHA256.HashData(utf8, hash);
+    }
+}
@@ -0,0 +1,157 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Globalization;
+using System.Security.Claims;
+
+using Microsoft.AspNetCore.Authentication;
+using Microsoft.AspNetCore.Http;
+using Microsoft.Extensions.DependencyInjection;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore.Tests;
+
+public sealed class CaskAuthenticationHandlerTests : IDisposable
+{
+    private readonly InMemoryKeyStatusService _service = new();
+    private readonly ServiceProvider _services;
+
+    public CaskAuthenticationHandlerTests()
+    {
+        var services = new ServiceCollection();
+        services.AddLogging();
+        services.AddSingleton<IKeyStatusService>(_service);
+        services.AddAuthentication().AddCask();
+        services.AddAuthentication().AddCask("ApiKey", options =>
+        {
+            options.HeaderName = "X-Api-Key";
+            options.HeaderScheme = null;
+        });
+
+        _services = services.BuildServiceProvider();
+    }
+
+    public void Dispose()
+    {
+        _services.Dispose();
+    }
+
+    [Fact]
+    public async Task CaskAuthenticationHandler_ActiveKey_SetsClaims()
+    {
+        CaskKey key = CreateKey(KeyStatus.Active);
+
+        AuthenticateResult result = await AuthenticateAsync("Authorization", $"Bearer {key}");
+
+        Assert.True(result.Succeeded);
+        ClaimsPrincipal principal = result.Principal!;
+        Assert.Equal(CaskKeyFingerprint.Create(key).ToString(), principal.FindFirstValue(ClaimTypes.NameIdentifier));
+        Assert.Equal("TEST", principal.FindFirstValue(CaskClaimTypes.ProviderSignature));
+        Assert.Equal("M", principal.FindFirstValue(CaskClaimTypes.ProviderKeyKind));
+        Assert.Equal(key.Timestamp, DateTimeOffset.Parse(principal.FindFirstValue(CaskClaimTypes.Timestamp)!, CultureInfo.InvariantCulture));
+    }
+
+    [Fact]
+    public async Task CaskAuthenticationHandler_SameKey_ReusesLookupButNotPrincipal()
+    {
+        CaskKey key = CreateKey(KeyStatus.Active);
+
+        AuthenticateResult first = await AuthenticateAsync("Authorization", $"Bearer {key}");
+        AuthenticateResult second = await AuthenticateAsync("Authorization", $"bearer   {key}");
+
+        Assert.True(second.Succeeded);
+        Assert.NotSame(first.Ticket, second.Ticket);
+        Assert.NotSame(first.Principal, second.Principal);
+        Assert.NotSame(first.Principal!.Identity, second.Principal!.Identity);
+        Assert.Equal(1, _service.RequestedKeys);
+    }
+
+    [Fact]
+    public async Task CaskAuthenticationHandler_ModifiedPrincipal_IsNotSeenByOtherRequests()
+    {
+        CaskKey key = CreateKey(KeyStatus.Active);
+
+        AuthenticateResult first = await AuthenticateAsync("Authorization", $"Bearer {key}");
+        var identity = (ClaimsIdentity)first.Principal!.Identity!;
+        identity.AddClaim(new Claim(ClaimTypes.Role, "admin"));
+        identity.RemoveClaim(identity.FindFirst(CaskClaimTypes.ProviderKeyKind));
+        first.Principal.AddIdentity(new ClaimsIdentity([new Claim(ClaimTypes.Name, "other")]));
+
+        AuthenticateResult second = await AuthenticateAsync("Authorization", $"Bearer {key}");
+
+        Assert.True(second.Succeeded);
+        Assert.Single(second.Principal!.Identities);
+        Assert.False(second.Principal.IsInRole("admin"));
+        Assert.Equal("M", second.Principal.FindFirstValue(CaskClaimTypes.ProviderKeyKind));
+        Assert.Equal(CaskKeyFingerprint.Create(key).ToString(), second.Principal.FindFirstValue(ClaimTypes.NameIdentifier));
+    }
+
+    [Fact]
+    public async Task CaskAuthenticationHandler_KeyWithoutScheme_UsesConfiguredHeader()
+    {
+        CaskKey key = CreateKey(KeyStatus.Active);
+
+        AuthenticateResult result = await AuthenticateAsync("X-Api-Key", key.ToString(), scheme: "ApiKey");
+
+        Assert.True(result.Succeeded);
+        Assert.Equal("ApiKey", result.Ticket!.AuthenticationScheme);
+    }
+
+    [Theory]
+    [InlineData(null)]
+    [InlineData("Basic dXNlcjpwYXNzd29yZA==")]
+    [InlineData("Bearer")]
+    public async Task CaskAuthenticationHandler_NoKey_ReturnsNoResult(string? header)
+    {
+        AuthenticateResult result = await AuthenticateAsync("Authorization", header);
+
+        Assert.True(result.None);
+    }
+
+    [Theory]
+    [InlineData(KeyStatus.Revoked)]
+    [InlineData(KeyStatus.Unknown)]
+    public async Task CaskAuthenticationHandler_InactiveKey_Fails(KeyStatus status)
+    {
+        CaskKey key = CreateKey(status);
+
+        AuthenticateResult result = await AuthenticateAsync("Authorization", $"Bearer {key}");
+
+        Assert.False(result.Succeeded);
+        Assert.NotNull(result.Failure);
+    }
+
+    [Fact]
+    public async Task CaskAuthenticationHandler_InvalidKey_FailsWithoutLookup()
+    {
+        string key = CreateKey(KeyStatus.Active).ToString();
+
+        AuthenticateResult result = await AuthenticateAsync("Authorization", $"Bearer {key[..^1]}");
+
+        Assert.NotNull(result.Failure);
+        Assert.Equal(0, _service.Requests);
+    }
+
+    private CaskKey CreateKey(KeyStatus status)
+    {
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+        _service.SetStatus(key, status);
+        return key;
+    }
+
+    private async Task<AuthenticateResult> AuthenticateAsync(string headerName, string? headerValue, string scheme = "Cask")
+    {
+        // Each request has its own scope, and so its own handler, as in an
+        // application.
+        await using AsyncServiceScope scope = _services.CreateAsyncScope();
+        var context = new DefaultHttpContext { RequestServices = scope.ServiceProvider };
+
+        if (headerValue != null)
+        {
+            context.Request.Headers[headerName] = headerValue;
+        }
+
+        return await context.AuthenticateAsync(scheme);
+    }
+}
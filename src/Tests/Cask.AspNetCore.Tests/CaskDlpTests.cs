@@ -0,0 +1,189 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers;
+using System.Net;
+using System.Text;
+
+using Microsoft.AspNetCore.Http;
+using Microsoft.Extensions.Options;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.AspNetCore.Tests;
+
+public class CaskDlpTests
+{
+    private static readonly string s_key = Cask.GenerateKey("TEST", 'M').ToString();
+    private static readonly string s_text = $"{{\"key\":\"{s_key}\",\"next\":\"{s_key}\"}}";
+    private static readonly string s_redacted = s_text.Replace(s_key, new string('*', s_key.Length), StringComparison.Ordinal);
+
+    [Fact]
+    public void CaskDlpReadStream_AnyBufferSize_RedactsKeys()
+    {
+        for (int bufferSize = 1; bufferSize <= s_text.Length + 1; bufferSize++)
+        {
+            var options = new CaskDlpOptions { BufferSize = bufferSize };
+            using var stream = new CaskDlpReadStream(new MemoryStream(Encoding.UTF8.GetBytes(s_text)), CaskDlpAction.Redact, options, leaveOpen: false);
+            using var reader = new StreamReader(stream);
+
+            Assert.Equal(s_redacted, reader.ReadToEnd());
+            Assert.Equal(2, stream.KeysFound);
+        }
+    }
+
+    [Fact]
+    public async Task CaskDlpWriteStream_AnyWriteSize_RedactsKeys()
+    {
+        byte[] text = Encoding.UTF8.GetBytes(s_text);
+
+        for (int writeSize = 1; writeSize <= text.Length; writeSize++)
+        {
+            using var output = new MemoryStream();
+            using var stream = new CaskDlpWriteStream(output, CaskDlpAction.Redact, new CaskDlpOptions { BufferSize = 64 });
+
+            for (int i = 0; i < text.Length; i += writeSize)
+            {
+                await stream.WriteAsync(text.AsMemory(i, Math.Min(writeSize, text.Length - i)));
+            }
+
+            await stream.CompleteAsync();
+
+            Assert.Equal(s_redacted, Encoding.UTF8.GetString(output.ToArray()));
+        }
+    }
+
+    [Fact]
+    public void CaskDlpReadStream_Reject_ThrowsBeforeKeyIsRead()
+    {
+        var output = new MemoryStream();
+        using var stream = new CaskDlpReadStream(new MemoryStream(Encoding.UTF8.GetBytes(s_text)), CaskDlpAction.Reject, new CaskDlpOptions { BufferSize = 7 }, leaveOpen: false);
+
+        CaskKeyDetectedException exception = Assert.Throws<CaskKeyDetectedException>(() => stream.CopyTo(output, 5));
+
+        Assert.Equal(s_text.IndexOf(s_key, StringComparison.Ordinal), exception.Offset);
+        Assert.True(output.Length < exception.Offset + s_key.Length);
+        Assert.True(stream.IsRejected);
+    }
+
+    [Fact]
+    public async Task CaskDlpMiddleware_KeyInRequest_Returns400()
+    {
+        var middleware = new CaskDlpMiddleware(async context =>
+        {
+            using var reader = new StreamReader(context.Request.Body);
+            await reader.ReadToEndAsync();
+            context.Response.StatusCode = StatusCodes.Status201Created;
+        }, Options.Create(new CaskDlpOptions()));
+
+        var context = new DefaultHttpContext();
+        context.Request.Body = new MemoryStream(Encoding.UTF8.GetBytes(s_text));
+
+        await middleware.InvokeAsync(context);
+
+        Assert.Equal(StatusCodes.Status400BadRequest, context.Response.StatusCode);
+    }
+
+    [Fact]
+    public async Task CaskDlpMiddleware_KeyInResponse_IsRedacted()
+    {
+        var middleware = new CaskDlpMiddleware(context => context.Response.WriteAsync(s_text), Options.Create(new CaskDlpOptions()));
+
+        var context = new DefaultHttpContext();
+        var body = new MemoryStream();
+        context.Response.Body = body;
+
+        await middleware.InvokeAsync(context);
+
+        Assert.Equal(StatusCodes.Status200OK, context.Response.StatusCode);
+        Assert.Equal(s_redacted, Encoding.UTF8.GetString(body.ToArray()));
+        Assert.Same(body, context.Response.Body);
+    }
+
+    [Fact]
+    public async Task CaskDlpMiddleware_UnflushedBodyWriter_IsRedacted()
+    {
+        var middleware = new CaskDlpMiddleware(context =>
+        {
+            // Left in the pipe for the middleware to flush.
+            context.Response.BodyWriter.Write(Encoding.UTF8.GetBytes(s_text));
+            return Task.CompletedTask;
+        }, Options.Create(new CaskDlpOptions()));
+
+        var context = new DefaultHttpContext();
+        var body = new MemoryStream();
+        context.Response.Body = body;
+
+        await middleware.InvokeAsync(context);
+
+        Assert.Equal(StatusCodes.Status200OK, context.Response.StatusCode);
+        Assert.Equal(s_redacted, Encoding.UTF8.GetString(body.ToArray()));
+    }
+
+    [Fact]
+    public async Task CaskDlpMiddleware_UnflushedBodyWriter_IsRejected()
+    {
+        var middleware = new CaskDlpMiddleware(context =>
+        {
+            context.Response.BodyWriter.Write(Encoding.UTF8.GetBytes(s_text));
+            return Task.CompletedTask;
+        }, Options.Create(new CaskDlpOptions { ResponseAction = CaskDlpAction.Reject }));
+
+        var context = new DefaultHttpContext();
+        var body = new MemoryStream();
+        context.Response.Body = body;
+
+        await middleware.InvokeAsync(context);
+
+        Assert.Equal(StatusCodes.Status500InternalServerError, context.Response.StatusCode);
+        Assert.DoesNotContain(s_key, Encoding.UTF8.GetString(body.ToArray()), StringComparison.Ordinal);
+    }
+
+    [Theory]
+    [InlineData(CaskDlpAction.Redact, CaskDlpAction.None)]
+    [InlineData(CaskDlpAction.None, CaskDlpAction.Redact)]
+    [InlineData(CaskDlpAction.Redact, CaskDlpAction.Redact)]
+    public async Task CaskDlpHandler_Redact_RedactsRequestAndResponse(CaskDlpAction requestAction, CaskDlpAction responseAction)
+    {
+        var options = new CaskDlpOptions { RequestAction = requestAction, ResponseAction = responseAction };
+
+        // The handler responds with the request body followed by the text, so
+        // the echoed body is redacted by either action and the rest only by
+        // the response action.
+        string echoed = requestAction == CaskDlpAction.Redact || responseAction == CaskDlpAction.Redact ? s_redacted : s_text;
+        string rest = responseAction == CaskDlpAction.Redact ? s_redacted : s_text;
+
+        Assert.Equal(echoed + rest, await PostAsync(options));
+    }
+
+    [Fact]
+    public async Task CaskDlpHandler_Reject_FailsRequest()
+    {
+        HttpRequestException exception = await Assert.ThrowsAsync<HttpRequestException>(() => PostAsync(new CaskDlpOptions()));
+
+        Assert.IsType<CaskKeyDetectedException>(exception.InnerException);
+    }
+
+    private static async Task<string> PostAsync(CaskDlpOptions options)
+    {
+        using var echo = new EchoHandler();
+        using var handler = new CaskDlpHandler(echo, options);
+        using var client = new HttpClient(handler, disposeHandler: false);
+        using var content = new StringContent(s_text);
+
+        using HttpResponseMessage response = await client.PostAsync(new Uri("http://localhost/"), content);
+        return await response.Content.ReadAsStringAsync();
+    }
+
+    /// <summary>
+    /// Responds with the request body followed by the text with the keys.
+    /// </summary>
+    private sealed class EchoHandler : HttpMessageHandler
+    {
+        protected override async Task<HttpResponseMessage> SendAsync(HttpRequestMessage request, CancellationToken cancellationToken)
+        {
+            string body = await request.Content!.ReadAsStringAsync(cancellationToken);
+            return new HttpResponseMessage(HttpStatusCode.OK) { Content = new StringContent(body + s_text) };
+        }
+    }
+}
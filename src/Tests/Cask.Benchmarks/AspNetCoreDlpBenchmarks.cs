@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics.CodeAnalysis;
+using System.Security.Cryptography;
+using System.Text;
+
+using BenchmarkDotNet.Attributes;
+
+using CommonAnnotatedSecurityKeys.AspNetCore;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Measures the latency that <see cref="CaskDlpMiddleware"/> and
+/// <see cref="CaskDlpHandler"/> add to 1 MB of body with a key every 64 KB, by
+/// copying it in 16 KB reads directly and through the streams that they
+/// redact it with.
+/// </summary>
+[MemoryDiagnoser]
+[SuppressMessage("Design", "CA1001:Types that own disposable fields should be disposable", Justification = "Disposed in GlobalCleanup.")]
+public class AspNetCoreDlpBenchmarks
+{
+    private const int BodyLength = 1024 * 1024;
+    private const int KeyInterval = 64 * 1024;
+    private const int CopyBufferLength = 16 * 1024;
+
+    private static readonly byte[] s_body = CreateBody();
+
+    private readonly CaskDlpOptions _options = new() { RequestAction = CaskDlpAction.Redact };
+    private readonly byte[] _copyBuffer = new byte[CopyBufferLength];
+    private readonly MemoryStream _input = new(s_body, writable: false);
+    private readonly MemoryStream _output = new(BodyLength);
+
+    [GlobalCleanup]
+    public void Cleanup()
+    {
+        _input.Dispose();
+        _output.Dispose();
+    }
+
+    [Benchmark(Baseline = true)]
+    public long Copy()
+    {
+        return CopyTo(_input, _output);
+    }
+
+    [Benchmark]
+    public long Copy_ReadStream()
+    {
+        using var stream = new CaskDlpReadStream(_input, _options.RequestAction, _options, leaveOpen: true);
+        return CopyTo(stream, _output);
+    }
+
+    [Benchmark]
+    public long Copy_WriteStream()
+    {
+        using var stream = new CaskDlpWriteStream(_output, _options.RequestAction, _options);
+        CopyTo(_input, stream);
+        stream.Complete();
+        return _output.Position;
+    }
+
+    private long CopyTo(Stream source, Stream destination)
+    {
+        _input.Position = 0;
+        _output.Position = 0;
+
+        int read;
+        while ((read = source.Read(_copyBuffer, 0, _copyBuffer.Length)) > 0)
+        {
+            destination.Write(_copyBuffer, 0, read);
+        }
+
+        return _output.Position;
+    }
+
+    private static byte[] CreateBody()
+    {
+        byte[] body = new byte[BodyLength];
+        RandomNumberGenerator.Fill(body);
+
+        // Printable ASCII that is mostly not Base64 text, like JSON or a
+        // multipart upload of text files.
+        for (int i = 0; i < body.Length; i++)
+        {
+            body[i] = (byte)(' ' + (body[i] % 95));
+        }
+
+        for (int i = KeyInterval / 2; i + 100 < body.Length; i += KeyInterval)
+        {
+            body[i - 1] = (byte)'"';
+            int length = Encoding.ASCII.GetBytes(Cask.GenerateKey("TEST", 'M').ToString(), body.AsSpan(i));
+            body[i + length] = (byte)'"';
+        }
+
+        return body;
+    }
+}
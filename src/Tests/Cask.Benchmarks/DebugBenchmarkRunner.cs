@@ -24,19 +24,25 @@ internal static class DebugBenchmarkRunner
                 continue;
             }
 
+            MethodInfo[] methods = type.GetMethods(BindingFlags.Public | BindingFlags.Instance)
+                                       .Where(m => m.IsDefined(typeof(BenchmarkAttribute)))
+                                       .ToArray();
+
+            if (methods.Length == 0)
+            {
+                continue;
+            }
+
             object instance = Activator.CreateInstance(type)!;
-            foreach (MethodInfo method in type.GetMethods(BindingFlags.Public | BindingFlags.Instance))
+            foreach (MethodInfo method in methods)
             {
-                if (method.IsDefined(typeof(BenchmarkAttribute)))
+                Console.Write($"{type.Name}.{method.Name}");
+                for (int i = 0; i < Iterations; i++)
                 {
-                    Console.Write($"{type.Name}.{method.Name}");
-                    for (int i = 0; i < Iterations; i++)
-                    {
-                        method.Invoke(instance, null);
-                        Console.Write(".");
-                    }
-                    Console.WriteLine();
+                    method.Invoke(instance, null);
+                    Console.Write(".");
                 }
+                Console.WriteLine();
             }
         }
     }
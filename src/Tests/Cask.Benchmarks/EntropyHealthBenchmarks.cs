@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Security.Cryptography;
+
+using BenchmarkDotNet.Attributes;
+
+using static CommonAnnotatedSecurityKeys.Benchmarks.BenchmarkTestData;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Measures key generation with entropy health tests disabled, per call and
+/// pooled, and the cost of testing a pooled block compared to drawing it.
+/// </summary>
+[MemoryDiagnoser]
+public class EntropyHealthBenchmarks
+{
+    private readonly byte[] _block = new byte[CaskEntropyHealth.PoolSize];
+
+    public EntropyHealthBenchmarks()
+    {
+        RandomNumberGenerator.Fill(_block);
+    }
+
+    [Params(CaskEntropyHealthMode.Disabled, CaskEntropyHealthMode.PerCall, CaskEntropyHealthMode.Pooled)]
+    public CaskEntropyHealthMode Mode { get; set; }
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        CaskEntropyHealth.Mode = Mode;
+    }
+
+    [GlobalCleanup]
+    public void Cleanup()
+    {
+        CaskEntropyHealth.Mode = CaskEntropyHealthMode.Disabled;
+    }
+
+    [Benchmark]
+    public CaskKey GenerateKey()
+    {
+        return Cask.GenerateKey(TestProviderSignature, TestProviderKeyKind, TestProviderData);
+    }
+
+    [Benchmark]
+    public void FillBlock()
+    {
+        RandomNumberGenerator.Fill(_block);
+    }
+
+    [Benchmark]
+    public bool TestBlock()
+    {
+        return CaskEntropyHealth.Test(_block, CaskEntropyHealth.RepetitionCountCutoff, CaskEntropyHealth.AdaptiveProportionCutoff) == CaskEntropyHealthFailure.None;
+    }
+}
@@ -0,0 +1,91 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics.CodeAnalysis;
+
+using BenchmarkDotNet.Attributes;
+
+using CommonAnnotatedSecurityKeys.Ipc;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Measures validating a batch of keys with <see cref="CaskIpcClient"/>
+/// against a <see cref="CaskIpcServer"/> in the same process, one batch at a
+/// time and with several batches pipelined on one connection. Divide by
+/// <see cref="BatchSize"/> for the cost per key.
+/// </summary>
+[MemoryDiagnoser]
+[SuppressMessage("Design", "CA1001:Types that own disposable fields should be disposable", Justification = "Disposed in GlobalCleanup.")]
+public class IpcBenchmarks
+{
+    private const int PipelineDepth = 8;
+
+    private readonly CancellationTokenSource _stop = new();
+    private readonly CaskIpcServer _server;
+    private readonly Task _serverTask;
+    private readonly CaskIpcClient _client;
+    private string[] _keys = [];
+
+    [SuppressMessage("Reliability", "CA2000:Dispose objects before losing scope", Justification = "Disposed in GlobalCleanup.")]
+    public IpcBenchmarks()
+    {
+        _server = new CaskIpcServer(Path.Combine(Path.GetTempPath(), $"cask-bench-{Environment.ProcessId}.sock"));
+        _serverTask = _server.RunAsync(_stop.Token);
+        _client = CaskIpcClient.ConnectAsync(_server.SocketPath).GetAwaiter().GetResult();
+        CreateKeys();
+    }
+
+    [Params(1, 64, 1024)]
+    public int BatchSize { get; set; } = 64;
+
+    [GlobalSetup]
+    public void CreateKeys()
+    {
+        _keys = Enumerable.Range(0, BatchSize).Select(_ => Cask.GenerateKey("TEST", 'M').ToString()).ToArray();
+    }
+
+    [GlobalCleanup]
+    public void Cleanup()
+    {
+        _client.Dispose();
+        _stop.Cancel();
+        _serverTask.GetAwaiter().GetResult();
+        _server.Dispose();
+        _stop.Dispose();
+    }
+
+    [Benchmark(Baseline = true)]
+    public int InProcess()
+    {
+        int valid = 0;
+
+        foreach (string key in _keys)
+        {
+            valid += Cask.IsCask(key) ? 1 : 0;
+        }
+
+        return valid;
+    }
+
+    [Benchmark]
+    public async Task<int> Ipc()
+    {
+        CaskValidationError[] errors = await _client.ValidateAsync(_keys).ConfigureAwait(false);
+        return errors.Length;
+    }
+
+    [Benchmark(OperationsPerInvoke = PipelineDepth)]
+    public async Task<int> Ipc_Pipelined()
+    {
+        var batches = new Task<CaskValidationError[]>[PipelineDepth];
+
+        for (int i = 0; i < batches.Length; i++)
+        {
+            batches[i] = _client.ValidateAsync(_keys);
+        }
+
+        CaskValidationError[][] errors = await Task.WhenAll(batches).ConfigureAwait(false);
+        return errors.Length;
+    }
+}
@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics.CodeAnalysis;
+
+using BenchmarkDotNet.Attributes;
+
+using CommonAnnotatedSecurityKeys.Ipc;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Measures eight workers that each look up the same batch of keys, as the
+/// worker processes of one host would, against a stand-in service with a
+/// 1 ms round trip: each worker asking the service, and each worker asking
+/// its own <see cref="SharedKeyStatusCache"/> over one file. Also measures a
+/// single worker's lookup of a batch that is already cached.
+/// </summary>
+/// <remarks>
+/// The number of requests the service received per operation is printed at
+/// the end of each benchmark.
+/// </remarks>
+[MemoryDiagnoser]
+[SuppressMessage("Design", "CA1001:Types that own disposable fields should be disposable", Justification = "Disposed in GlobalCleanup.")]
+public class IpcSharedCacheBenchmarks
+{
+    private const int WorkerCount = 8;
+    private const int BatchSize = 64;
+
+    private static readonly CaskKeyFingerprint[] s_keys =
+        Enumerable.Range(0, BatchSize).Select(_ => CaskKeyFingerprint.Create(Cask.GenerateKey("TEST", 'M'))).ToArray();
+
+    private readonly string _path = Path.Combine(Path.GetTempPath(), $"cask-bench-{Environment.ProcessId}.cache");
+    private readonly InMemoryKeyStatusService _service = new(TimeSpan.FromMilliseconds(1));
+    private readonly SharedKeyStatusCache[] _caches;
+    private long _operations;
+
+    public IpcSharedCacheBenchmarks()
+    {
+        var options = new SharedKeyStatusCacheOptions
+        {
+            Path = _path,
+            UnknownTimeToLive = TimeSpan.FromHours(1),
+        };
+
+        _caches = new SharedKeyStatusCache[WorkerCount];
+        for (int i = 0; i < _caches.Length; i++)
+        {
+            _caches[i] = new SharedKeyStatusCache(_service, options);
+        }
+    }
+
+    [Benchmark(Baseline = true)]
+    public Task Workers_Service()
+    {
+        _operations++;
+        return Task.WhenAll(_caches.Select(_ => _service.GetStatusesAsync(s_keys, CancellationToken.None)));
+    }
+
+    [Benchmark]
+    public Task Workers_SharedCache()
+    {
+        _operations++;
+        return Task.WhenAll(_caches.Select(c => c.GetStatusesAsync(s_keys, CancellationToken.None)));
+    }
+
+    [Benchmark]
+    public Task<IReadOnlyList<KeyStatus>> Lookup_Cached()
+    {
+        return _caches[0].GetStatusesAsync(s_keys, CancellationToken.None);
+    }
+
+    [GlobalCleanup]
+    public void Cleanup()
+    {
+        if (_operations > 0)
+        {
+            Console.WriteLine($"// Service requests per operation: {(double)_service.Requests / _operations:F3}");
+        }
+
+        foreach (SharedKeyStatusCache cache in _caches)
+        {
+            cache.Dispose();
+        }
+
+        File.Delete(_path);
+    }
+}
@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 using System.Buffers.Text;
+using System.Text;
 
 using BenchmarkDotNet.Attributes;
 
@@ -13,6 +14,7 @@ namespace CommonAnnotatedSecurityKeys.Benchmarks;
 public class IsCaskBenchmarks
 {
     private static readonly byte[] s_testCaskKeyUtf8 = Base64Url.DecodeFromChars(TestCaskSecret.AsSpan());
+    private static readonly byte[] s_testCaskSecretUtf8 = Encoding.UTF8.GetBytes(TestCaskSecret);
 
     [Benchmark]
     public bool IsCaskString()
@@ -20,6 +22,12 @@ public class IsCaskBenchmarks
         return Cask.IsCask(TestCaskSecret);
     }
 
+    [Benchmark]
+    public bool IsCaskUtf8()
+    {
+        return Cask.IsCaskUtf8(s_testCaskSecretUtf8);
+    }
+
     [Benchmark]
     public bool IsCaskBytes()
     {
@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics.CodeAnalysis;
+
+using BenchmarkDotNet.Attributes;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Measures lookups of keys that are and are not in a key metadata store of
+/// ten million keys, spread over runs of several sizes, and writes to it.
+/// </summary>
+[MemoryDiagnoser]
+[SuppressMessage("Design", "CA1001:Types that own disposable fields should be disposable", Justification = "Disposed in GlobalCleanup.")]
+public class KeyMetadataStoreBenchmarks
+{
+    private const int KeyCount = 10_000_000;
+    private const int ProbeCount = 1 << 16;
+
+    private readonly string _directory = Path.Combine(Path.GetTempPath(), $"cask-bench-{Guid.NewGuid():N}");
+    private readonly KeyMetadata _metadata = new() { ProviderSignature = "TEST", ProviderKeyKind = 'M', Status = KeyStatus.Active };
+    private KeyMetadataStore? _store;
+    private CaskKeyFingerprint[] _present = [];
+    private CaskKeyFingerprint[] _absent = [];
+    private int _next;
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        var random = new Random(42);
+        var present = new List<CaskKeyFingerprint>(ProbeCount);
+        _store = KeyMetadataStore.Open(_directory);
+
+        for (int i = 0; i < KeyCount; i++)
+        {
+            CaskKeyFingerprint fingerprint = CreateFingerprint(random);
+            _store.Put(fingerprint, _metadata);
+
+            if (i % (KeyCount / ProbeCount) == 0)
+            {
+                present.Add(fingerprint);
+            }
+        }
+
+        _store.Flush();
+        _present = [.. present];
+        _absent = Enumerable.Range(0, ProbeCount).Select(_ => CreateFingerprint(random)).ToArray();
+        Console.WriteLine($"// Runs: {_store.RunCount}");
+    }
+
+    [GlobalCleanup]
+    public void Cleanup()
+    {
+        _store?.Dispose();
+        Directory.Delete(_directory, recursive: true);
+    }
+
+    [Benchmark(Baseline = true)]
+    public bool TryGet_Present()
+    {
+        _next = (_next + 1) % _present.Length;
+        return _store!.TryGet(_present[_next], out _);
+    }
+
+    [Benchmark]
+    public bool TryGet_Absent()
+    {
+        _next = (_next + 1) % _absent.Length;
+        return _store!.TryGet(_absent[_next], out _);
+    }
+
+    [Benchmark]
+    public void Put()
+    {
+        _next = (_next + 1) % _absent.Length;
+        _store!.Put(_absent[_next], _metadata);
+    }
+
+    private static CaskKeyFingerprint CreateFingerprint(Random random)
+    {
+        byte[] bytes = new byte[16];
+        random.NextBytes(bytes);
+        return CaskKeyFingerprint.Read(bytes);
+    }
+}
@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics;
+using System.Diagnostics.CodeAnalysis;
+
+using BenchmarkDotNet.Attributes;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Measures a burst of concurrent key status lookups, most of them of a few
+/// hot keys, against a stand-in service with a 1 ms round trip: one request
+/// per lookup, through a <see cref="KeyStatusClient"/> with a cold cache, and
+/// through one with a warm cache.
+/// </summary>
+/// <remarks>
+/// The number of requests per burst and the percentiles of the latency of
+/// individual lookups are printed at the end of each benchmark.
+/// </remarks>
+[MemoryDiagnoser]
+[SuppressMessage("Design", "CA1001:Types that own disposable fields should be disposable", Justification = "Disposed in GlobalCleanup.")]
+public class KeyStatusBenchmarks
+{
+    private const int BurstSize = 1000;
+    private const int KeyCount = 10_000;
+    private const int HotKeyCount = 20;
+    private const int HotKeyPercent = 80;
+
+    private static readonly CaskKeyFingerprint[] s_keys = CreateKeys();
+    private static readonly CaskKeyFingerprint[] s_burst = CreateBurst();
+
+    private readonly InMemoryKeyStatusService _service = new(TimeSpan.FromMilliseconds(1));
+    private readonly KeyStatusClient _warmClient;
+    private readonly long[] _latencies = new long[BurstSize];
+    private readonly List<long> _allLatencies = [];
+    private long _bursts;
+    private long _requestsAtStart;
+
+    public KeyStatusBenchmarks()
+    {
+        _warmClient = new KeyStatusClient(_service);
+    }
+
+    [Benchmark(Baseline = true)]
+    public Task Burst_RequestPerLookup()
+    {
+        return RunBurst(key => _service.GetStatusesAsync([key], CancellationToken.None));
+    }
+
+    [Benchmark]
+    public async Task Burst_Client_ColdCache()
+    {
+        using var client = new KeyStatusClient(_service);
+        await RunBurst(key => client.GetStatusAsync(key)).ConfigureAwait(false);
+    }
+
+    [Benchmark]
+    public Task Burst_Client_WarmCache()
+    {
+        return RunBurst(key => _warmClient.GetStatusAsync(key));
+    }
+
+    [IterationSetup]
+    public void StartIteration()
+    {
+        _requestsAtStart = _service.Requests;
+        _bursts = 0;
+    }
+
+    [IterationCleanup]
+    public void EndIteration()
+    {
+        if (_bursts > 0)
+        {
+            Console.WriteLine($"// Requests per burst: {(double)(_service.Requests - _requestsAtStart) / _bursts:F1}");
+        }
+    }
+
+    [GlobalCleanup]
+    public void Cleanup()
+    {
+        _warmClient.Dispose();
+
+        if (_allLatencies.Count > 0)
+        {
+            _allLatencies.Sort();
+            Console.WriteLine($"// Lookup latency: p50 {Percentile(0.50):F3} ms, p90 {Percentile(0.90):F3} ms, p99 {Percentile(0.99):F3} ms, max {Percentile(1):F3} ms");
+        }
+    }
+
+    private async Task RunBurst<T>(Func<CaskKeyFingerprint, Task<T>> lookup)
+    {
+        var lookups = new Task[BurstSize];
+        for (int i = 0; i < lookups.Length; i++)
+        {
+            lookups[i] = Measure(i, lookup(s_burst[i]), Stopwatch.GetTimestamp());
+        }
+
+        await Task.WhenAll(lookups).ConfigureAwait(false);
+        _allLatencies.AddRange(_latencies);
+        _bursts++;
+    }
+
+    private async Task Measure(int index, Task lookup, long start)
+    {
+        await lookup.ConfigureAwait(false);
+        _latencies[index] = Stopwatch.GetTimestamp() - start;
+    }
+
+    private double Percentile(double percentile)
+    {
+        int index = Math.Min(_allLatencies.Count - 1, (int)(percentile * _allLatencies.Count));
+        return _allLatencies[index] * 1000.0 / Stopwatch.Frequency;
+    }
+
+    private static CaskKeyFingerprint[] CreateKeys()
+    {
+        var keys = new CaskKeyFingerprint[KeyCount];
+        for (int i = 0; i < keys.Length; i++)
+        {
+            keys[i] = CaskKeyFingerprint.Create(Cask.GenerateKey("TEST", 'M'));
+        }
+
+        return keys;
+    }
+
+    private static CaskKeyFingerprint[] CreateBurst()
+    {
+        var random = new Random(42);
+        var burst = new CaskKeyFingerprint[BurstSize];
+
+        for (int i = 0; i < burst.Length; i++)
+        {
+            burst[i] = random.Next(100) < HotKeyPercent
+                ? s_keys[random.Next(HotKeyCount)]
+                : s_keys[random.Next(KeyCount)];
+        }
+
+        return burst;
+    }
+}
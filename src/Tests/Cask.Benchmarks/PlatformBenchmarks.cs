@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers;
+using System.Buffers.Text;
+using System.Security.Cryptography;
+using System.Text;
+
+using BenchmarkDotNet.Attributes;
+
+using static CommonAnnotatedSecurityKeys.Benchmarks.BenchmarkTestData;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Measures the platform primitives that key generation and validation are
+/// built on. On .NET Framework these are provided by Polyfill.cs, so running
+/// with both `-f net8.0` and `-f net472` shows the remaining gap between them.
+/// </summary>
+[MemoryDiagnoser]
+public class PlatformBenchmarks
+{
+    private static readonly byte[] s_testCaskSecretUtf8 = Encoding.UTF8.GetBytes(TestCaskSecret);
+    private readonly byte[] _destination = new byte[TestCaskSecret.Length];
+
+    [Benchmark]
+    public void RandomNumberGenerator_Fill()
+    {
+        Span<byte> bytes = stackalloc byte[TestSecretEntropyInBytes];
+        RandomNumberGenerator.Fill(bytes);
+    }
+
+    [Benchmark]
+    public OperationStatus Base64Url_DecodeFromChars()
+    {
+        return Base64Url.DecodeFromChars(TestCaskSecret.AsSpan(), _destination, out _, out _);
+    }
+
+    [Benchmark]
+    public OperationStatus Base64Url_DecodeFromUtf8()
+    {
+        return Base64Url.DecodeFromUtf8(s_testCaskSecretUtf8, _destination, out _, out _);
+    }
+}
@@ -20,6 +20,13 @@
  *
  * NOTE: '--' delimiter ensures --help goes to BenchmarkDotNet, not dotnet.
  *
+ * StartupBenchmarks measure the first call into the library in a fresh
+ * process. Run them once per target framework (-f net8.0 and -f net472) to
+ * compare startup cost. The process exits with a non-zero code if any of them
+ * exceeds its [StartupBudget]:
+ *
+ *   dotnet run -c Release -f net8.0 --filter *Startup*
+ *
  * To debug these benchmarks, you can set this project as the startup project in
  * Each benchmark will be run a few times without measuring anything.git 
  */
@@ -27,6 +34,7 @@
 using BenchmarkDotNet.Configs;
 using BenchmarkDotNet.Environments;
 using BenchmarkDotNet.Jobs;
+using BenchmarkDotNet.Reports;
 using BenchmarkDotNet.Running;
 
 using CommonAnnotatedSecurityKeys.Benchmarks;
@@ -41,11 +49,17 @@ debug = System.Diagnostics.Debugger.IsAttached;
 if (debug)
 {
     DebugBenchmarkRunner.Run();
-    return;
+    return 0;
 }
 
 // Turn off changing the power plan to High Performance. It can get stuck there when process dies
 // prematurely. See https://benchmarkdotnet.org/articles/configs/powerplans.html
-IConfig config = DefaultConfig.Instance.AddJob(Job.Default.WithPowerPlan(PowerPlan.UserPowerPlan));
+// The job is a mutator so that it changes the jobs that benchmarks declare,
+// such as the cold-start job of StartupBenchmarks, rather than adding a
+// default job next to them.
+IConfig config = DefaultConfig.Instance.AddJob(Job.Default.WithPowerPlan(PowerPlan.UserPowerPlan).AsMutator());
+
+IEnumerable<Summary> summaries = BenchmarkSwitcher.FromAssembly(typeof(Program).Assembly).Run(args, config);
 
-BenchmarkSwitcher.FromAssembly(typeof(Program).Assembly).Run(args, config);
+// Fail the run if any cold-start benchmark exceeded its startup budget.
+return StartupBudgetAttribute.Enforce(summaries) ? 0 : 1;
@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using BenchmarkDotNet.Attributes;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+[CaskProvider("TEST", Kinds = "AM", ProviderDataLayout = "Version=AC,Region:5,Tenant:5,Reserved=AAAA")]
+public readonly partial struct BenchmarkProviderKey { }
+
+/// <summary>
+/// Compares the validator generated by [CaskProvider] to checking the
+/// provider's layout with string comparisons after <see cref="Cask.IsCask(string)"/>.
+/// </summary>
+[MemoryDiagnoser]
+public class ProviderKeyBenchmarks
+{
+    private static readonly string s_providerKey = BenchmarkProviderKey.Generate('M', "abcde", "fghij").ToString();
+    private static readonly string s_otherProviderKey = Cask.GenerateKey("ABCD", 'M', "ACabcdefghijAAAA").ToString();
+
+    [Benchmark]
+    public bool IsValid_Generated()
+    {
+        return BenchmarkProviderKey.IsValid(s_providerKey);
+    }
+
+    [Benchmark]
+    public bool IsValid_Handwritten()
+    {
+        return IsValidHandwritten(s_providerKey);
+    }
+
+    [Benchmark]
+    public bool IsValid_OtherProvider_Generated()
+    {
+        return BenchmarkProviderKey.IsValid(s_otherProviderKey);
+    }
+
+    [Benchmark]
+    public bool IsValid_OtherProvider_Handwritten()
+    {
+        return IsValidHandwritten(s_otherProviderKey);
+    }
+
+    private static bool IsValidHandwritten(string key)
+    {
+        return Cask.IsCask(key) &&
+               key.Length == 80 &&
+               key.AsSpan(52, 4).SequenceEqual("TEST".AsSpan()) &&
+               (key[51] == 'A' || key[51] == 'M') &&
+               key.AsSpan(56, 2).SequenceEqual("AC".AsSpan()) &&
+               key.AsSpan(68, 4).SequenceEqual("AAAA".AsSpan());
+    }
+}
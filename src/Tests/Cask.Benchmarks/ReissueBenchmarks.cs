@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Text;
+
+using BenchmarkDotNet.Attributes;
+
+using static CommonAnnotatedSecurityKeys.Benchmarks.BenchmarkTestData;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Measures replacing a batch of keys with fresh keys that keep their
+/// provider signature, kind, secret size and provider data, per key.
+/// </summary>
+[MemoryDiagnoser]
+public class ReissueBenchmarks
+{
+    private const int KeyCount = 1024;
+
+    private readonly CaskKey[] _oldKeys = new CaskKey[KeyCount];
+    private readonly CaskKey[] _freshKeys = new CaskKey[KeyCount];
+    private byte[] _text = [];
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        for (int i = 0; i < KeyCount; i++)
+        {
+            _oldKeys[i] = Cask.GenerateKey(TestProviderSignature, TestProviderKeyKind, TestProviderData);
+        }
+
+        _text = Encoding.UTF8.GetBytes(string.Join("\n", _oldKeys.Select(key => key.ToString())));
+    }
+
+    // What a rotation job does without Reissue: parse each key and generate
+    // a new one from its parts.
+    [Benchmark(Baseline = true, OperationsPerInvoke = KeyCount)]
+    public void Reissue_GenerateKey()
+    {
+        for (int i = 0; i < KeyCount; i++)
+        {
+            CaskKey key = _oldKeys[i];
+            string text = key.ToString();
+            int providerDataStart = key.SecretSize == SecretSize.Bits512 ? 100 : 56;
+            string providerData = text[providerDataStart..^8];
+
+            _freshKeys[i] = Cask.GenerateKey(key.ProviderSignature, key.ProviderKeyKind, providerData, key.SecretSize);
+        }
+    }
+
+    [Benchmark(OperationsPerInvoke = KeyCount)]
+    public void Reissue_Keys()
+    {
+        Cask.Reissue(_oldKeys, _freshKeys);
+    }
+
+    [Benchmark(OperationsPerInvoke = KeyCount)]
+    public int Reissue_Utf8InPlace()
+    {
+        return Cask.ReissueUtf8(_text, _text);
+    }
+}
@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using BenchmarkDotNet.Attributes;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Measures lookups in a revocation list of a million keys, and applying a
+/// delta of a thousand changes to it compared with rebuilding it.
+/// </summary>
+[MemoryDiagnoser]
+public class RevocationBenchmarks
+{
+    private const int KeyCount = 1_000_000;
+    private const int DeltaCount = 1000;
+
+    private static readonly CaskKeyFingerprint[] s_keys = CreateFingerprints(KeyCount + DeltaCount);
+    private static readonly RevocationSnapshot s_snapshot = RevocationSnapshot.Create(1, s_keys.Take(KeyCount));
+    private static readonly RevocationDelta s_delta = new(1, 2, s_keys.Skip(KeyCount), s_keys.Take(DeltaCount));
+
+    private int _next;
+
+    [Benchmark]
+    public bool Contains()
+    {
+        _next = (_next + 1) % s_keys.Length;
+        return s_snapshot.Contains(s_keys[_next]);
+    }
+
+    [Benchmark(Baseline = true)]
+    public RevocationSnapshot Rebuild()
+    {
+        return RevocationSnapshot.Create(2, s_keys.Skip(DeltaCount));
+    }
+
+    [Benchmark]
+    public RevocationSnapshot ApplyDelta()
+    {
+        return s_snapshot.Apply(s_delta);
+    }
+
+    private static CaskKeyFingerprint[] CreateFingerprints(int count)
+    {
+        var fingerprints = new CaskKeyFingerprint[count];
+        byte[] bytes = new byte[16];
+        var random = new Random(42);
+
+        for (int i = 0; i < count; i++)
+        {
+            random.NextBytes(bytes);
+            fingerprints[i] = CaskKeyFingerprint.Read(bytes);
+        }
+
+        return fingerprints;
+    }
+}
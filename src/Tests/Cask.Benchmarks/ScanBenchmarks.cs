@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Security.Cryptography;
+using System.Text;
+
+using BenchmarkDotNet.Attributes;
+
+using static CommonAnnotatedSecurityKeys.Benchmarks.BenchmarkTestData;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Compares finding keys in 1 MB of text with <see cref="CaskKey.Regex"/> and
+/// with <see cref="CaskScanner"/>, in one buffer and streamed in 64 KB
+/// buffers.
+/// </summary>
+[MemoryDiagnoser]
+public class ScanBenchmarks
+{
+    private const int TextLength = 1024 * 1024;
+    private const int KeyInterval = 4096;
+    private const int StreamBufferLength = 64 * 1024;
+    private const string FillerChars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_+/=\"' \n";
+
+    private static readonly string s_text = CreateText();
+    private static readonly byte[] s_textUtf8 = Encoding.UTF8.GetBytes(s_text);
+
+    private readonly CaskScanner _scanner = new();
+    private readonly List<CaskMatch> _matches = new(capacity: TextLength / KeyInterval);
+
+    [Benchmark(Baseline = true)]
+    public int Scan_Regex()
+    {
+        return CaskKey.Regex.Matches(s_text).Count;
+    }
+
+    [Benchmark]
+    public int Scan_CaskScanner()
+    {
+        _matches.Clear();
+        return CaskScanner.ScanUtf8(s_textUtf8, _matches);
+    }
+
+    [Benchmark]
+    public int Scan_CaskScanner_Streaming()
+    {
+        _matches.Clear();
+        _scanner.Reset();
+
+        int count = 0;
+        for (int i = 0; i < s_textUtf8.Length; i += StreamBufferLength)
+        {
+            int length = Math.Min(StreamBufferLength, s_textUtf8.Length - i);
+            count += _scanner.ScanUtf8(s_textUtf8.AsSpan(i, length), isFinalBlock: false, _matches);
+        }
+
+        return count + _scanner.ScanUtf8([], isFinalBlock: true, _matches);
+    }
+
+    private static string CreateText()
+    {
+        byte[] random = new byte[TextLength];
+        RandomNumberGenerator.Fill(random);
+
+        char[] text = new char[TextLength];
+        for (int i = 0; i < text.Length; i++)
+        {
+            text[i] = FillerChars[random[i] % FillerChars.Length];
+        }
+
+        for (int i = KeyInterval; i + TestCaskSecret.Length + 2 < text.Length; i += KeyInterval)
+        {
+            text[i] = ' ';
+            TestCaskSecret.CopyTo(0, text, i + 1, TestCaskSecret.Length);
+            text[i + TestCaskSecret.Length + 1] = '\n';
+        }
+
+        return new string(text);
+    }
+}
@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Text;
+
+using BenchmarkDotNet.Attributes;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Compares finding keys in 100,000 cells of 10 to 500 bytes, such as a
+/// database column, one cell at a time with <see cref="CaskKey.Regex"/> and
+/// <see cref="CaskScanner.ScanUtf8(ReadOnlySpan{byte}, ICollection{CaskMatch})"/>,
+/// and all at once packed in one buffer with
+/// <see cref="CaskScanner.ScanManyUtf8(ReadOnlySpan{byte}, ReadOnlySpan{int}, ICollection{CaskCellMatch})"/>,
+/// on one thread and on all of them.
+/// </summary>
+[MemoryDiagnoser]
+public class ScanManyBenchmarks
+{
+    private const int CellCount = 100_000;
+    private const int KeyInterval = 1000;
+
+    private static readonly string[] s_cells = CreateCells();
+    private static readonly byte[] s_data = Encoding.UTF8.GetBytes(string.Concat(s_cells));
+    private static readonly int[] s_offsets = CreateOffsets();
+
+    private readonly List<CaskMatch> _matches = [];
+    private readonly List<CaskCellMatch> _cellMatches = [];
+    private readonly ParallelOptions _parallelOptions = new();
+
+    [Benchmark(Baseline = true)]
+    public int PerCell_Regex()
+    {
+        int count = 0;
+
+        foreach (string cell in s_cells)
+        {
+            count += CaskKey.Regex.IsMatch(cell) ? 1 : 0;
+        }
+
+        return count;
+    }
+
+    [Benchmark]
+    public int PerCell_CaskScanner()
+    {
+        _matches.Clear();
+        int count = 0;
+
+        for (int i = 0; i < CellCount; i++)
+        {
+            count += CaskScanner.ScanUtf8(s_data.AsSpan(s_offsets[i], s_offsets[i + 1] - s_offsets[i]), _matches);
+        }
+
+        return count;
+    }
+
+    [Benchmark]
+    public int ScanMany()
+    {
+        _cellMatches.Clear();
+        return CaskScanner.ScanManyUtf8(s_data, s_offsets, _cellMatches);
+    }
+
+    [Benchmark]
+    public int ScanMany_Parallel()
+    {
+        _cellMatches.Clear();
+        return CaskScanner.ScanManyUtf8(s_data, s_offsets, _cellMatches, _parallelOptions);
+    }
+
+    private static string[] CreateCells()
+    {
+        const string FillerChars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789 ,.:-";
+
+        var random = new Random(42);
+        string[] cells = new string[CellCount];
+        char[] buffer = new char[500];
+
+        for (int i = 0; i < cells.Length; i++)
+        {
+            int length = random.Next(10, 500);
+            for (int j = 0; j < length; j++)
+            {
+                buffer[j] = FillerChars[random.Next(FillerChars.Length)];
+            }
+
+            cells[i] = i % KeyInterval == 0 ? $"key: {BenchmarkTestData.TestCaskSecret}" : new string(buffer, 0, length);
+        }
+
+        return cells;
+    }
+
+    private static int[] CreateOffsets()
+    {
+        int[] offsets = new int[CellCount + 1];
+
+        for (int i = 0; i < CellCount; i++)
+        {
+            offsets[i + 1] = offsets[i] + Encoding.UTF8.GetByteCount(s_cells[i]);
+        }
+
+        return offsets;
+    }
+}
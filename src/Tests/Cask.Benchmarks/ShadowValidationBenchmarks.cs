@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using BenchmarkDotNet.Attributes;
+
+using static CommonAnnotatedSecurityKeys.Benchmarks.BenchmarkTestData;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Measures the cost of shadow validation to IsCask when it is disabled,
+/// sampling at a production rate, and checking every call.
+/// </summary>
+[MemoryDiagnoser]
+public class ShadowValidationBenchmarks
+{
+    [Params(0, 1024, 1)]
+    public int SamplingInterval { get; set; }
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        CaskShadowValidation.SamplingInterval = SamplingInterval;
+    }
+
+    [GlobalCleanup]
+    public void Cleanup()
+    {
+        CaskShadowValidation.SamplingInterval = 0;
+    }
+
+    [Benchmark]
+    public bool IsCaskString()
+    {
+        return Cask.IsCask(TestCaskSecret);
+    }
+}
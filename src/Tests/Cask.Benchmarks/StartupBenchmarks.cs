@@ -0,0 +1,43 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using BenchmarkDotNet.Attributes;
+using BenchmarkDotNet.Engines;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Measures the time to the first call into the library in a fresh process,
+/// including assembly loading, JIT and static initialization. Each launch is
+/// a new process that runs the benchmark exactly once.
+/// </summary>
+/// <remarks>
+/// Do not use <see cref="BenchmarkTestData"/> here. Its static initializer
+/// generates keys and would warm up the library before the measurement.
+/// </remarks>
+[SimpleJob(RunStrategy.ColdStart, launchCount: 20, warmupCount: 0, iterationCount: 1)]
+public class StartupBenchmarks
+{
+    private const string Key = "__________________________________________8AQJJQABBMTESTABCDAAAAAAAA";
+
+    [Benchmark]
+    [StartupBudget(milliseconds: 50)]
+    public bool FirstIsCask()
+    {
+        return Cask.IsCask(Key);
+    }
+
+    [Benchmark]
+    [StartupBudget(milliseconds: 50)]
+    public bool FirstTryCreate()
+    {
+        return CaskKey.TryCreate(Key, out _);
+    }
+
+    [Benchmark]
+    [StartupBudget(milliseconds: 75)]
+    public CaskKey FirstGenerateKey()
+    {
+        return Cask.GenerateKey("TEST", 'M');
+    }
+}
@@ -0,0 +1,52 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Reflection;
+
+using BenchmarkDotNet.Engines;
+using BenchmarkDotNet.Reports;
+
+namespace CommonAnnotatedSecurityKeys.Benchmarks;
+
+/// <summary>
+/// Specifies the maximum median time that a cold-start benchmark may take.
+/// Budgets are checked by <see cref="Enforce"/> after all benchmarks have run.
+/// </summary>
+[AttributeUsage(AttributeTargets.Method, AllowMultiple = false, Inherited = false)]
+internal sealed class StartupBudgetAttribute(double milliseconds) : Attribute
+{
+    public double Milliseconds { get; } = milliseconds;
+
+    /// <summary>
+    /// Checks every cold-start benchmark that has a budget against the
+    /// measured median and reports those that exceeded it.
+    /// </summary>
+    /// <returns>True if all budgets were met.</returns>
+    public static bool Enforce(IEnumerable<Summary> summaries)
+    {
+        bool withinBudget = true;
+
+        foreach (BenchmarkReport report in summaries.SelectMany(s => s.Reports))
+        {
+            if (report.BenchmarkCase.Job.Run.RunStrategy != RunStrategy.ColdStart)
+            {
+                continue;
+            }
+
+            StartupBudgetAttribute? budget = report.BenchmarkCase.Descriptor.WorkloadMethod.GetCustomAttribute<StartupBudgetAttribute>();
+            if (budget == null || report.ResultStatistics == null)
+            {
+                continue;
+            }
+
+            double medianMilliseconds = report.ResultStatistics.Median / 1_000_000;
+            if (medianMilliseconds > budget.Milliseconds)
+            {
+                Console.WriteLine($"STARTUP BUDGET EXCEEDED: {report.BenchmarkCase.DisplayInfo} took {medianMilliseconds:F2} ms (budget: {budget.Milliseconds:F2} ms).");
+                withinBudget = false;
+            }
+        }
+
+        return withinBudget;
+    }
+}
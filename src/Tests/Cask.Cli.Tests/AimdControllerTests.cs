@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+public class AimdControllerTests
+{
+    [Fact]
+    public void AimdController_Update_IncreasesWhileThroughputRises()
+    {
+        var controller = new AimdController(minimum: 1, maximum: 8, initial: 4);
+
+        Assert.True(controller.Update(100, underMemoryPressure: false));
+        Assert.Equal(5, controller.Limit);
+
+        Assert.True(controller.Update(200, underMemoryPressure: false));
+        Assert.Equal(6, controller.Limit);
+    }
+
+    [Fact]
+    public void AimdController_Update_UndoesIncreaseThatDoesNotHelpAndHolds()
+    {
+        var controller = new AimdController(minimum: 1, maximum: 8, initial: 4);
+        controller.Update(100, underMemoryPressure: false);
+
+        // Within 5% of before, so the increase to 5 is undone.
+        Assert.True(controller.Update(104, underMemoryPressure: false));
+        Assert.Equal(4, controller.Limit);
+
+        for (int i = 0; i < 4; i++)
+        {
+            Assert.False(controller.Update(104, underMemoryPressure: false));
+            Assert.Equal(4, controller.Limit);
+        }
+
+        Assert.True(controller.Update(104, underMemoryPressure: false));
+        Assert.Equal(5, controller.Limit);
+    }
+
+    [Fact]
+    public void AimdController_Update_BacksOffOnThroughputDrop()
+    {
+        var controller = new AimdController(minimum: 1, maximum: 16, initial: 8);
+        controller.Update(100, underMemoryPressure: false);
+
+        Assert.True(controller.Update(50, underMemoryPressure: false));
+        Assert.Equal(6, controller.Limit); // 9 * 0.75, rounded down.
+    }
+
+    [Fact]
+    public void AimdController_Update_BacksOffUnderMemoryPressure()
+    {
+        var controller = new AimdController(minimum: 2, maximum: 16, initial: 8);
+
+        Assert.True(controller.Update(100, underMemoryPressure: true));
+        Assert.Equal(6, controller.Limit);
+
+        Assert.True(controller.Update(100, underMemoryPressure: true));
+        Assert.Equal(4, controller.Limit);
+
+        Assert.True(controller.Update(100, underMemoryPressure: true));
+        Assert.Equal(3, controller.Limit);
+
+        Assert.True(controller.Update(100, underMemoryPressure: true));
+        Assert.Equal(2, controller.Limit);
+
+        // Never below the minimum.
+        Assert.False(controller.Update(100, underMemoryPressure: true));
+        Assert.Equal(2, controller.Limit);
+    }
+
+    [Fact]
+    public void AimdController_Update_StaysWithinMaximum()
+    {
+        var controller = new AimdController(minimum: 1, maximum: 3, initial: 10);
+        Assert.Equal(3, controller.Limit);
+
+        Assert.False(controller.Update(100, underMemoryPressure: false));
+        Assert.False(controller.Update(200, underMemoryPressure: false));
+        Assert.Equal(3, controller.Limit);
+    }
+}
@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+public sealed class CGroupLimitsTests : IDisposable
+{
+    private readonly string _root = Directory.CreateTempSubdirectory("cask-cgroup-").FullName;
+
+    public void Dispose()
+    {
+        Directory.Delete(_root, recursive: true);
+    }
+
+    [Fact]
+    public void CGroupLimits_Read_TakesLowestLimitAlongPath()
+    {
+        string leaf = CreateCGroup("system.slice/scan.service");
+        Write("", "cpu.max", "max 100000\n");
+        Write("", "memory.max", "max\n");
+        Write("system.slice", "cpu.max", "400000 100000\n");
+        Write("system.slice", "memory.max", "1073741824\n");
+        Write("system.slice/scan.service", "cpu.max", "150000 100000\n");
+        Write("system.slice/scan.service", "memory.max", "2147483648\n");
+
+        CGroupLimits limits = CGroupLimits.Read(_root, leaf);
+
+        Assert.Equal(1.5, limits.CpuLimit);
+        Assert.Equal(1073741824, limits.MemoryLimitBytes);
+    }
+
+    [Fact]
+    public void CGroupLimits_Read_MaxIsUnlimited()
+    {
+        string leaf = CreateCGroup("a");
+        Write("a", "cpu.max", "max 100000\n");
+        Write("a", "memory.max", "max\n");
+
+        CGroupLimits limits = CGroupLimits.Read(_root, leaf);
+
+        Assert.Null(limits.CpuLimit);
+        Assert.Null(limits.MemoryLimitBytes);
+    }
+
+    [Fact]
+    public void CGroupLimits_Read_MissingOrMalformedFilesAreUnlimited()
+    {
+        string leaf = CreateCGroup("a/b");
+        Write("a", "cpu.max", "100000\n");
+        Write("a", "memory.max", "lots\n");
+
+        CGroupLimits limits = CGroupLimits.Read(_root, leaf);
+
+        Assert.Null(limits.CpuLimit);
+        Assert.Null(limits.MemoryLimitBytes);
+    }
+
+    [Fact]
+    public void CGroupLimits_GetMemoryPressure_ReadsCGroupThatSetsLimit()
+    {
+        string leaf = CreateCGroup("a/b");
+        Write("a", "memory.max", "1000000\n");
+        Write("a", "memory.current", "250000\n");
+        Write("a/b", "memory.current", "900000\n");
+
+        CGroupLimits limits = CGroupLimits.Read(_root, leaf);
+
+        Assert.Equal(0.25, limits.GetMemoryPressure());
+
+        Write("a", "memory.current", "2000000\n");
+        Assert.Equal(1.0, limits.GetMemoryPressure());
+    }
+
+    private string CreateCGroup(string path)
+    {
+        return Directory.CreateDirectory(Path.Combine(_root, path)).FullName;
+    }
+
+    private void Write(string cgroup, string name, string content)
+    {
+        File.WriteAllText(Path.Combine(_root, cgroup, name), content);
+    }
+}
@@ -0,0 +1,41 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Text.Json;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+public class FindingWriterTests
+{
+    [Theory]
+    [InlineData(false)]
+    [InlineData(true)]
+    public void FindingWriter_Json_WritesPlaceholderAsBoolean(bool isLikelyPlaceholder)
+    {
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+        using var stream = new MemoryStream();
+
+        using (var writer = new FindingWriter(stream))
+        {
+            writer.Write("file.env", 4, key, isLikelyPlaceholder, ("flow", "a > b"));
+            Assert.Equal((byte)'\n', stream.ToArray()[^1]);
+        }
+
+        using JsonDocument document = JsonDocument.Parse(stream.ToArray());
+        JsonElement finding = document.RootElement;
+
+        Assert.Equal("a > b", finding.GetProperty("flow").GetString());
+        Assert.Equal(key.ToString()[44..], finding.GetProperty("key").GetString());
+
+        if (isLikelyPlaceholder)
+        {
+            Assert.Equal(JsonValueKind.True, finding.GetProperty("placeholder").ValueKind);
+        }
+        else
+        {
+            Assert.False(finding.TryGetProperty("placeholder", out _));
+        }
+    }
+}
@@ -0,0 +1,236 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Collections.Concurrent;
+using System.Formats.Tar;
+using System.Text;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+public sealed class ImageScannerTests : IDisposable
+{
+    private readonly string _directory = Directory.CreateTempSubdirectory("cask-image-").FullName;
+    private readonly string _key = Cask.GenerateKey("TEST", 'M').ToString();
+    private readonly string _otherKey = Cask.GenerateKey("ABCD", 'Q').ToString();
+
+    public void Dispose()
+    {
+        Directory.Delete(_directory, recursive: true);
+    }
+
+    [Theory]
+    [InlineData(false)]
+    [InlineData(true)]
+    public async Task ImageScanner_Layout_ScansEachPlatformOfNestedIndex(bool gzip)
+    {
+        TestImage.Layer baseLayer = TestImage.CreateLayer(("etc/app.env", $"KEY={_key}\n"), ("etc/empty", ""));
+        TestImage.Layer app = TestImage.CreateLayer(("app/settings.json", $"{{\"key\":\"{_otherKey}\"}}"));
+        string layout = Path.Combine(_directory, "layout");
+        TestImage.WriteLayout(layout, "app:1", ["linux/amd64", "linux/arm64"], gzip, baseLayer, app);
+
+        (ImageScanner.ImageSummary summary, ImageScanner.ImageFinding[] findings, Exception[] errors) = await ScanAsync(layout);
+
+        Assert.Empty(errors);
+        Assert.Equal(2, summary.Images);
+        Assert.Equal(4, summary.LayerReferences);
+        Assert.Equal(2, summary.UniqueLayers);
+        Assert.Equal(2, summary.Files);
+        Assert.Equal(4, summary.Matches);
+
+        AssertFindings(
+            findings,
+            ("app:1 (linux/amd64)", app.DiffId, "app/settings.json", 8, _otherKey),
+            ("app:1 (linux/arm64)", app.DiffId, "app/settings.json", 8, _otherKey),
+            ("app:1 (linux/amd64)", baseLayer.DiffId, "etc/app.env", 4, _key),
+            ("app:1 (linux/arm64)", baseLayer.DiffId, "etc/app.env", 4, _key));
+    }
+
+    [Fact]
+    public async Task ImageScanner_DockerArchive_FindsKeys()
+    {
+        TestImage.Layer layer = TestImage.CreateLayer(("root/.env", $"KEY={_key}\n"));
+        string archive = WriteArchive("app.tar", TestImage.CreateArchive("app:2", layer));
+
+        (ImageScanner.ImageSummary summary, ImageScanner.ImageFinding[] findings, Exception[] errors) = await ScanAsync(archive);
+
+        Assert.Empty(errors);
+        Assert.Equal(1, summary.Images);
+        AssertFindings(findings, ("app:2", layer.DiffId, "root/.env", 4, _key));
+        Assert.Equal(archive, findings[0].Source);
+    }
+
+    [Fact]
+    public async Task ImageScanner_LayerSharedBySources_IsScannedOnce()
+    {
+        TestImage.Layer shared = TestImage.CreateLayer(("etc/app.env", $"KEY={_key}\n"));
+        string layout = Path.Combine(_directory, "layout");
+        TestImage.WriteLayout(layout, "app:1", ["linux/amd64"], gzip: true, shared);
+        WriteArchive("app.tar", TestImage.CreateArchive("app:2", shared));
+
+        // The directory holds both the layout and the archive.
+        (ImageScanner.ImageSummary summary, ImageScanner.ImageFinding[] findings, Exception[] errors) = await ScanAsync(_directory);
+
+        Assert.Empty(errors);
+        Assert.Equal(2, summary.Images);
+        Assert.Equal(2, summary.LayerReferences);
+        Assert.Equal(1, summary.UniqueLayers);
+        Assert.Equal(1, summary.Files);
+        AssertFindings(
+            findings,
+            ("app:1 (linux/amd64)", shared.DiffId, "etc/app.env", 4, _key),
+            ("app:2", shared.DiffId, "etc/app.env", 4, _key));
+    }
+
+    [Fact]
+    public async Task ImageScanner_HardlinksAndWhiteouts_AreNotScannedAsFiles()
+    {
+        TestImage.Layer layer = TestImage.CreateLayer(
+            TestImage.CreateEntry(TarEntryType.Directory, "etc/"),
+            TestImage.CreateEntry(TarEntryType.RegularFile, "etc/app.env", $"KEY={_key}\n"),
+            TestImage.CreateEntry(TarEntryType.HardLink, "etc/app.env.bak", linkName: "etc/app.env"),
+            TestImage.CreateEntry(TarEntryType.SymbolicLink, "etc/current.env", linkName: "app.env"),
+            TestImage.CreateEntry(TarEntryType.RegularFile, "etc/.wh.old.env"),
+            TestImage.CreateEntry(TarEntryType.RegularFile, "var/.wh..wh..opq"));
+
+        string archive = WriteArchive("app.tar", TestImage.CreateArchive("app:3", layer));
+
+        (ImageScanner.ImageSummary summary, ImageScanner.ImageFinding[] findings, Exception[] errors) = await ScanAsync(archive);
+
+        // Whiteouts are empty files, so like links they have no data to scan.
+        Assert.Empty(errors);
+        Assert.Equal(1, summary.Files);
+        AssertFindings(findings, ("app:3", layer.DiffId, "etc/app.env", 4, _key));
+    }
+
+    [Fact]
+    public async Task ImageScanner_LongEntryNames_AreFound()
+    {
+        string name = string.Join('/', Enumerable.Repeat("directory", 20)) + "/app.env";
+        TestImage.Layer layer = TestImage.CreateLayer((name, $"KEY={_key}\n"));
+
+        // The archive is written with pax headers so that the long layer path
+        // is kept.
+        string layerPath = $"{new string('l', 120)}/layer.tar";
+        string archive = WriteArchive("app.tar", CreatePaxArchive(
+            ("manifest.json", Encoding.UTF8.GetBytes($$"""[{"Config":"none.json","RepoTags":["app:4"],"Layers":["{{layerPath}}"]}]""")),
+            ("none.json", "{}"u8.ToArray()),
+            (layerPath, layer.Tar)));
+
+        (ImageScanner.ImageSummary summary, ImageScanner.ImageFinding[] findings, Exception[] errors) = await ScanAsync(archive);
+
+        Assert.Empty(errors);
+        Assert.Equal(1, summary.Images);
+
+        // Without diff IDs, the layer is named by where it is.
+        AssertFindings(findings, ("app:4", $"{archive}!{layerPath}", name, 4, _key));
+    }
+
+    [Theory]
+    [InlineData(false)]
+    [InlineData(true)]
+    public async Task ImageScanner_TruncatedLayer_ReportsError(bool gzip)
+    {
+        TestImage.Layer layer = TestImage.CreateLayer(("etc/app.env", $"KEY={_key}\n{new string('x', 4096)}"));
+        TestImage.Layer truncated = new(layer.Tar[..1024]);
+        string layout = Path.Combine(_directory, "layout");
+        TestImage.WriteLayout(layout, "app:1", ["linux/amd64"], gzip, truncated);
+
+        (ImageScanner.ImageSummary summary, _, Exception[] errors) = await ScanAsync(layout);
+
+        Assert.IsAssignableFrom<IOException>(Assert.Single(errors));
+        Assert.Equal(1, summary.Errors);
+    }
+
+    [Fact]
+    public async Task ImageScanner_CorruptLayer_ReportsErrorAndScansOtherLayers()
+    {
+        byte[] garbage = new byte[2048];
+        new Random(42).NextBytes(garbage);
+        garbage[0] = 0x7F; // Neither gzip nor zstd.
+
+        TestImage.Layer corrupt = new(garbage);
+        TestImage.Layer layer = TestImage.CreateLayer(("etc/app.env", $"KEY={_key}\n"));
+        string archive = WriteArchive("app.tar", TestImage.CreateArchive("app:5", corrupt, layer));
+
+        (ImageScanner.ImageSummary summary, ImageScanner.ImageFinding[] findings, Exception[] errors) = await ScanAsync(archive);
+
+        Assert.Single(errors);
+        Assert.Equal(1, summary.Errors);
+        AssertFindings(findings, ("app:5", layer.DiffId, "etc/app.env", 4, _key));
+    }
+
+    [Theory]
+    [InlineData(100)]
+    [InlineData(700)]
+    [InlineData(-10)]
+    public async Task ImageScanner_TruncatedArchive_ReportsError(int cut)
+    {
+        TestImage.Layer layer = TestImage.CreateLayer(("etc/app.env", $"KEY={_key}\n"));
+        byte[] image = TestImage.CreateArchive("app:6", layer);
+
+        // Cut into the manifest, into a header, or into the final layer.
+        string archive = WriteArchive("app.tar", cut > 0 ? image[..cut] : image[..(image.Length - 1024 + cut)]);
+
+        (ImageScanner.ImageSummary summary, ImageScanner.ImageFinding[] findings, Exception[] errors) = await ScanAsync(archive);
+
+        Assert.Single(errors);
+        Assert.Equal(1, summary.Errors);
+        Assert.Empty(findings);
+    }
+
+    [Fact]
+    public async Task ImageScanner_NotAnImage_ReportsError()
+    {
+        string archive = WriteArchive("notes.tar", "not an image"u8.ToArray());
+
+        (ImageScanner.ImageSummary summary, _, Exception[] errors) = await ScanAsync(archive);
+
+        Assert.Single(errors);
+        Assert.Equal(0, summary.Images);
+    }
+
+    private static async Task<(ImageScanner.ImageSummary, ImageScanner.ImageFinding[], Exception[])> ScanAsync(string path)
+    {
+        var findings = new ConcurrentBag<ImageScanner.ImageFinding>();
+        var errors = new ConcurrentBag<Exception>();
+
+        ImageScanner.ImageSummary summary = await new ImageScanner(threads: 2, byteRate: null).RunAsync(
+            [path],
+            findings.Add,
+            (_, e) => errors.Add(e),
+            CancellationToken.None).WaitAsync(TimeSpan.FromSeconds(30));
+
+        return (summary, [.. findings], [.. errors]);
+    }
+
+    private static void AssertFindings(ImageScanner.ImageFinding[] findings, params (string Image, string Layer, string Path, long Offset, string Key)[] expected)
+    {
+        Assert.Equal(expected, findings.Select(finding => (finding.Image, finding.Layer, finding.Path, finding.Offset, finding.Key.ToString()))
+                                       .OrderBy(finding => finding.Path, StringComparer.Ordinal)
+                                       .ThenBy(finding => finding.Image, StringComparer.Ordinal));
+    }
+
+    private static byte[] CreatePaxArchive(params (string Name, byte[] Content)[] files)
+    {
+        using var stream = new MemoryStream();
+
+        using (var writer = new TarWriter(stream, TarEntryFormat.Pax, leaveOpen: true))
+        {
+            foreach ((string name, byte[] content) in files)
+            {
+                writer.WriteEntry(new PaxTarEntry(TarEntryType.RegularFile, name) { DataStream = new MemoryStream(content) });
+            }
+        }
+
+        return stream.ToArray();
+    }
+
+    private string WriteArchive(string name, byte[] content)
+    {
+        string path = Path.Combine(_directory, name);
+        File.WriteAllBytes(path, content);
+        return path;
+    }
+}
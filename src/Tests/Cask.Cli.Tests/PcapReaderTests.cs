@@ -0,0 +1,175 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+using System.Net;
+using System.Text;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+public class PcapReaderTests
+{
+    public static TheoryData<string, bool> Formats => new()
+    {
+        { "pcap", false },
+        { "pcap", true },
+        { "pcap-ns", false },
+        { "pcap-ns", true },
+        { "pcapng", false },
+        { "pcapng", true },
+    };
+
+    [Theory]
+    [MemberData(nameof(Formats))]
+    public void PcapReader_ReadsPacketsAndTimestamps(string format, bool bigEndian)
+    {
+        byte[][] packets =
+        [
+            TestCapture.Tcp(ipv6: false, 1000, TcpFlags.Syn),
+            TestCapture.Tcp(ipv6: true, 2000, TcpFlags.None, "hello"),
+            TestCapture.Udp("datagram"),
+        ];
+
+        var reader = new PcapReader(new MemoryStream(Build(format, packets, bigEndian)));
+
+        for (int i = 0; i < packets.Length; i++)
+        {
+            Assert.True(reader.TryReadPacket(out PcapPacket packet));
+            Assert.Equal(TestCapture.LinkTypeRaw, packet.LinkType);
+            Assert.Equal(TestCapture.GetTimestamp(i), packet.Timestamp);
+            Assert.Equal(packets[i], packet.Data.ToArray());
+        }
+
+        Assert.False(reader.TryReadPacket(out _));
+    }
+
+    [Theory]
+    [MemberData(nameof(Formats))]
+    public void PcapReader_TruncatedFinalRecord_Throws(string format, bool bigEndian)
+    {
+        byte[][] packets =
+        [
+            TestCapture.Tcp(ipv6: false, 1000, TcpFlags.None, "first"),
+            TestCapture.Tcp(ipv6: false, 1005, TcpFlags.None, "second"),
+        ];
+
+        byte[] capture = Build(format, packets, bigEndian);
+
+        // Cut into the body and into the header of the final record.
+        foreach (int cut in new[] { 3, capture.Length - Build(format, packets[..1], bigEndian).Length - 2 })
+        {
+            var reader = new PcapReader(new MemoryStream(capture[..^cut]));
+
+            Assert.True(reader.TryReadPacket(out PcapPacket packet));
+            Assert.Equal(packets[0], packet.Data.ToArray());
+            Assert.Throws<EndOfStreamException>(() => reader.TryReadPacket(out _));
+        }
+    }
+
+    [Theory]
+    [InlineData(6u, 0, false)]
+    [InlineData(6u, 16, true)]
+    [InlineData(2u, 16, false)]
+    [InlineData(3u, 0, true)]
+    [InlineData(1u, 4, false)]
+    public void PcapReader_PcapngBlockTooShort_ThrowsInvalidData(uint blockType, int bodyLength, bool bigEndian)
+    {
+        byte[] packet = TestCapture.Udp("datagram");
+        byte[] capture = [.. TestCapture.Pcapng([packet], bigEndian), .. TestCapture.PcapngBlock(blockType, new byte[bodyLength], bigEndian)];
+
+        var reader = new PcapReader(new MemoryStream(capture));
+
+        Assert.True(reader.TryReadPacket(out PcapPacket first));
+        Assert.Equal(packet, first.Data.ToArray());
+        Assert.Throws<InvalidDataException>(() => reader.TryReadPacket(out _));
+    }
+
+    [Fact]
+    public void PcapReader_PcapngCapturedLengthBeyondBlock_ThrowsInvalidData()
+    {
+        // Interface, timestamp, a captured and original length of 100, and
+        // only 4 bytes of data.
+        byte[] body = new byte[24];
+        BinaryPrimitives.WriteUInt32LittleEndian(body.AsSpan(12), 100);
+        BinaryPrimitives.WriteUInt32LittleEndian(body.AsSpan(16), 100);
+
+        byte[] capture = [.. TestCapture.Pcapng([], bigEndian: false), .. TestCapture.PcapngBlock(6, body, bigEndian: false)];
+
+        var reader = new PcapReader(new MemoryStream(capture));
+
+        Assert.Throws<InvalidDataException>(() => reader.TryReadPacket(out _));
+    }
+
+    [Fact]
+    public void PcapReader_PcapngTimestampOutOfRange_IsClamped()
+    {
+        // Nanoseconds read as seconds are far beyond the year 9999.
+        byte[] packet = TestCapture.Udp("datagram");
+        var reader = new PcapReader(new MemoryStream(TestCapture.Pcapng([packet], bigEndian: false, timestampResolution: 0)));
+
+        Assert.True(reader.TryReadPacket(out PcapPacket read));
+        Assert.Equal(DateTimeOffset.MaxValue, read.Timestamp);
+        Assert.Equal(packet, read.Data.ToArray());
+    }
+
+    [Fact]
+    public void PcapReader_NotACapture_Throws()
+    {
+        Assert.Throws<InvalidDataException>(() => new PcapReader(new MemoryStream(Encoding.UTF8.GetBytes("not a capture"))));
+    }
+
+    [Theory]
+    [InlineData(false)]
+    [InlineData(true)]
+    public void PacketDecoder_DecodesTcp(bool ipv6)
+    {
+        byte[] data = TestCapture.Tcp(ipv6, 0xFFFF_FFF0, TcpFlags.Fin, "payload");
+
+        Assert.True(PacketDecoder.TryDecode(new PcapPacket(TestCapture.LinkTypeRaw, default, data), out PacketSegment segment));
+
+        Assert.False(segment.Flow.IsUdp);
+        Assert.Equal(ipv6, segment.Flow.IsIPv6);
+        Assert.Equal(0xFFFF_FFF0, segment.Sequence);
+        Assert.Equal(TcpFlags.Fin, segment.Flags);
+        Assert.Equal("payload", Encoding.UTF8.GetString(segment.Payload.Span));
+
+        IPAddress source = ipv6 ? TestCapture.SourceIPv6 : TestCapture.SourceIPv4;
+        IPAddress destination = ipv6 ? TestCapture.DestinationIPv6 : TestCapture.DestinationIPv4;
+        Assert.Equal(new IPEndPoint(source, TestCapture.SourcePort).ToString(), segment.Flow.SourceEndPoint);
+        Assert.Equal(new IPEndPoint(destination, TestCapture.DestinationPort).ToString(), segment.Flow.DestinationEndPoint);
+    }
+
+    [Fact]
+    public void PacketDecoder_DecodesUdp()
+    {
+        byte[] data = TestCapture.Udp("datagram");
+
+        Assert.True(PacketDecoder.TryDecode(new PcapPacket(TestCapture.LinkTypeRaw, default, data), out PacketSegment segment));
+
+        Assert.True(segment.Flow.IsUdp);
+        Assert.Equal("datagram", Encoding.UTF8.GetString(segment.Payload.Span));
+    }
+
+    [Fact]
+    public void PacketDecoder_SkipsFragments()
+    {
+        byte[] data = TestCapture.Tcp(ipv6: false, 1000, TcpFlags.None, "payload");
+
+        // More fragments.
+        BinaryPrimitives.WriteUInt16BigEndian(data.AsSpan(6), 0x2000);
+
+        Assert.False(PacketDecoder.TryDecode(new PcapPacket(TestCapture.LinkTypeRaw, default, data), out _));
+    }
+
+    internal static byte[] Build(string format, byte[][] packets, bool bigEndian)
+    {
+        return format switch
+        {
+            "pcap" => TestCapture.Pcap(packets, bigEndian),
+            "pcap-ns" => TestCapture.Pcap(packets, bigEndian, nanoseconds: true),
+            _ => TestCapture.Pcapng(packets, bigEndian),
+        };
+    }
+}
@@ -0,0 +1,168 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Collections.Concurrent;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+public sealed class PcapScannerTests : IDisposable
+{
+    private readonly string _directory = Directory.CreateTempSubdirectory("cask-pcap-").FullName;
+    private readonly string _ipv4Key = Cask.GenerateKey("TEST", 'M').ToString();
+    private readonly string _ipv6Key = Cask.GenerateKey("ABCD", 'Q').ToString();
+    private readonly string _udpKey = Cask.GenerateKey("Z_9-", 'x').ToString();
+
+    public void Dispose()
+    {
+        Directory.Delete(_directory, recursive: true);
+    }
+
+    [Theory]
+    [MemberData(nameof(PcapReaderTests.Formats), MemberType = typeof(PcapReaderTests))]
+    public async Task PcapScanner_FindsKeysInReassembledStreams(string format, bool bigEndian)
+    {
+        string path = WriteCapture(PcapReaderTests.Build(format, CreatePackets(), bigEndian));
+        var findings = new ConcurrentBag<PcapScanner.PcapFinding>();
+        var errors = new ConcurrentBag<Exception>();
+
+        PcapScanner.PcapSummary summary = await new PcapScanner(shards: 2, byteRate: null).RunAsync(
+            [path],
+            (_, finding) => findings.Add(finding),
+            (_, e) => errors.Add(e),
+            CancellationToken.None);
+
+        Assert.Empty(errors);
+        Assert.Equal(1, summary.Captures);
+        Assert.Equal(2, summary.Streams);
+        Assert.Equal(0, summary.Gaps);
+        Assert.Equal(3, summary.Matches);
+        AssertFindings(findings);
+    }
+
+    [Theory]
+    [MemberData(nameof(PcapReaderTests.Formats), MemberType = typeof(PcapReaderTests))]
+    public async Task PcapScanner_TruncatedFinalRecord_ReportsErrorAndEarlierKeys(string format, bool bigEndian)
+    {
+        // The truncated record is the FIN of the IPv6 stream, which ends with
+        // the capture instead.
+        byte[] capture = PcapReaderTests.Build(format, CreatePackets(), bigEndian);
+        string path = WriteCapture(capture[..^3]);
+        var findings = new ConcurrentBag<PcapScanner.PcapFinding>();
+        var errors = new ConcurrentBag<Exception>();
+
+        PcapScanner.PcapSummary summary = await new PcapScanner(shards: 2, byteRate: null).RunAsync(
+            [path],
+            (_, finding) => findings.Add(finding),
+            (_, e) => errors.Add(e),
+            CancellationToken.None);
+
+        Assert.IsType<EndOfStreamException>(Assert.Single(errors));
+        Assert.Equal(0, summary.Captures);
+        Assert.Equal(1, summary.Errors);
+        AssertFindings(findings);
+    }
+
+    [Fact]
+    public async Task PcapScanner_ShardFails_ThrowsInsteadOfHanging()
+    {
+        // Far more batches than the queue of the only shard holds, so the
+        // reader would wait for room forever if the shard stopped silently.
+        byte[][] packets = [.. Enumerable.Range(0, 20_000).Select(_ => TestCapture.Udp($" {_udpKey} "))];
+        string path = WriteCapture(TestCapture.Pcap(packets, bigEndian: false));
+
+        Task<PcapScanner.PcapSummary> scan = new PcapScanner(shards: 1, byteRate: null).RunAsync(
+            [path],
+            (_, _) => throw new InvalidOperationException("Output failed."),
+            (_, _) => { },
+            CancellationToken.None);
+
+        InvalidOperationException e = await Assert.ThrowsAsync<InvalidOperationException>(() => scan.WaitAsync(TimeSpan.FromSeconds(30)));
+        Assert.Equal("Output failed.", e.Message);
+    }
+
+    [Fact]
+    public async Task PcapScanner_MalformedCapture_ReportsErrorAndScansOthers()
+    {
+        string malformed = WriteCapture([.. TestCapture.Pcapng([], bigEndian: false), .. TestCapture.PcapngBlock(6, new byte[4], bigEndian: false)]);
+        string path = WriteCapture(TestCapture.Pcapng(CreatePackets(), bigEndian: false));
+        var findings = new ConcurrentBag<PcapScanner.PcapFinding>();
+        var errors = new ConcurrentBag<Exception>();
+
+        PcapScanner.PcapSummary summary = await new PcapScanner(shards: 2, byteRate: null).RunAsync(
+            [malformed, path],
+            (_, finding) => findings.Add(finding),
+            (_, e) => errors.Add(e),
+            CancellationToken.None).WaitAsync(TimeSpan.FromSeconds(30));
+
+        Assert.IsType<InvalidDataException>(Assert.Single(errors));
+        Assert.Equal(1, summary.Captures);
+        Assert.Equal(1, summary.Errors);
+        AssertFindings(findings);
+    }
+
+    [Fact]
+    public async Task PcapScanner_OutputIOError_IsReportedForCapture()
+    {
+        string path = WriteCapture(TestCapture.Pcap(CreatePackets(), bigEndian: false));
+        var errors = new ConcurrentBag<Exception>();
+
+        PcapScanner.PcapSummary summary = await new PcapScanner(shards: 2, byteRate: null).RunAsync(
+            [path, path],
+            (_, _) => throw new IOException("Disk full."),
+            (_, e) => errors.Add(e),
+            CancellationToken.None).WaitAsync(TimeSpan.FromSeconds(30));
+
+        Assert.Equal(2, errors.Count);
+        Assert.Equal(2, summary.Errors);
+    }
+
+    private byte[][] CreatePackets()
+    {
+        string ipv4Data = $"token={_ipv4Key}\n";
+        string ipv6Data = $"{{\"key\":\"{_ipv6Key}\"}}";
+
+        return
+        [
+            TestCapture.Tcp(ipv6: false, 1000, TcpFlags.Syn),
+            TestCapture.Tcp(ipv6: true, 5000, TcpFlags.Syn),
+            TestCapture.Tcp(ipv6: false, 1041, TcpFlags.None, ipv4Data[40..]),        // Out of order.
+            TestCapture.Tcp(ipv6: false, 1001, TcpFlags.None, ipv4Data[..25]),        // Key split across segments.
+            TestCapture.Tcp(ipv6: true, 5001, TcpFlags.None, ipv6Data[..30]),
+            TestCapture.Tcp(ipv6: false, 1001, TcpFlags.None, ipv4Data[..25]),        // Duplicate.
+            TestCapture.Udp($"udp {_udpKey}"),
+            TestCapture.Tcp(ipv6: false, 1011, TcpFlags.None, ipv4Data[10..40]),      // Retransmission overlapping held data.
+            TestCapture.Tcp(ipv6: false, 1001 + (uint)ipv4Data.Length, TcpFlags.Fin),
+            TestCapture.Tcp(ipv6: true, 5031, TcpFlags.None, ipv6Data[30..]),
+            TestCapture.Tcp(ipv6: true, 5001 + (uint)ipv6Data.Length, TcpFlags.Fin),
+        ];
+    }
+
+    private void AssertFindings(IEnumerable<PcapScanner.PcapFinding> findings)
+    {
+        PcapScanner.PcapFinding[] sorted = [.. findings.OrderBy(finding => finding.Timestamp)];
+        Assert.Equal(3, sorted.Length);
+
+        Assert.Equal(("udp", "10.0.0.1:40000", 4L, _udpKey), Describe(sorted[0]));
+        Assert.Equal(TestCapture.GetTimestamp(6), sorted[0].Timestamp);
+
+        Assert.Equal(("tcp", "10.0.0.1:40000", 6L, _ipv4Key), Describe(sorted[1]));
+        Assert.Equal(TestCapture.GetTimestamp(7), sorted[1].Timestamp);
+
+        Assert.Equal(("tcp", "[2001:db8::1]:40000", 8L, _ipv6Key), Describe(sorted[2]));
+        Assert.Equal("[2001:db8::2]:443", sorted[2].Flow.DestinationEndPoint);
+    }
+
+    private static (string, string, long, string) Describe(PcapScanner.PcapFinding finding)
+    {
+        return (finding.Flow.Protocol, finding.Flow.SourceEndPoint, finding.Offset, finding.Key.ToString());
+    }
+
+    private string WriteCapture(byte[] capture)
+    {
+        string path = Path.Combine(_directory, $"{Guid.NewGuid():N}.pcap");
+        File.WriteAllBytes(path, capture);
+        return path;
+    }
+}
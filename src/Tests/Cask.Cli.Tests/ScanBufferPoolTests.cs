@@ -0,0 +1,96 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+public class ScanBufferPoolTests
+{
+    private static readonly TimeSpan s_timeout = TimeSpan.FromSeconds(10);
+
+    [Fact]
+    public async Task ScanBufferPool_Rent_StaysWithinBudget()
+    {
+        var pool = new ScanBufferPool(budgetBytes: 4096, bufferSize: 1024);
+        var rented = new List<byte[]>();
+
+        for (int i = 0; i < 4; i++)
+        {
+            rented.Add(await pool.RentAsync(CancellationToken.None));
+        }
+
+        Assert.Equal(4, pool.RentedCount);
+        Assert.False(pool.TryRent(out _));
+
+        ValueTask<byte[]> waiting = pool.RentAsync(CancellationToken.None);
+        Assert.False(waiting.IsCompleted);
+
+        pool.Return(rented[0]);
+
+        // The returned buffer is reused.
+        Assert.Same(rented[0], await waiting.AsTask().WaitAsync(s_timeout));
+        Assert.Equal(4, pool.RentedCount);
+    }
+
+    [Fact]
+    public void ScanBufferPool_Rent_OneBufferEvenIfOverBudget()
+    {
+        var pool = new ScanBufferPool(budgetBytes: 100, bufferSize: 1024);
+
+        Assert.True(pool.TryRent(out byte[]? buffer));
+        Assert.Equal(1024, buffer.Length);
+        Assert.False(pool.TryRent(out _));
+    }
+
+    [Fact]
+    public async Task ScanBufferPool_Return_SkipsCancelledWaiter()
+    {
+        var pool = new ScanBufferPool(budgetBytes: 1024, bufferSize: 1024);
+        byte[] buffer = await pool.RentAsync(CancellationToken.None);
+
+        using var cancellation = new CancellationTokenSource();
+        ValueTask<byte[]> cancelled = pool.RentAsync(cancellation.Token);
+        ValueTask<byte[]> waiting = pool.RentAsync(CancellationToken.None);
+
+        await cancellation.CancelAsync();
+        await Assert.ThrowsAnyAsync<OperationCanceledException>(() => cancelled.AsTask());
+
+        // The return wakes the waiter behind the cancelled one.
+        pool.Return(buffer);
+        Assert.Same(buffer, await waiting.AsTask().WaitAsync(s_timeout));
+    }
+
+    [Fact]
+    public async Task ScanBufferPool_Resize_DropsBuffersThatNoLongerFit()
+    {
+        var pool = new ScanBufferPool(budgetBytes: 4096, bufferSize: 1024);
+        byte[] first = await pool.RentAsync(CancellationToken.None);
+        byte[] second = await pool.RentAsync(CancellationToken.None);
+
+        pool.Resize(budgetBytes: 4096, bufferSize: 2048);
+        pool.Return(first);
+        pool.Return(second);
+        Assert.Equal(0, pool.RentedCount);
+
+        // Buffers of the old size are not handed out again.
+        Assert.True(pool.TryRent(out byte[]? resized));
+        Assert.Equal(2048, resized.Length);
+        Assert.True(pool.TryRent(out _));
+        Assert.False(pool.TryRent(out _));
+    }
+
+    [Fact]
+    public async Task ScanBufferPool_Resize_WakesWaiters()
+    {
+        var pool = new ScanBufferPool(budgetBytes: 1024, bufferSize: 1024);
+        await pool.RentAsync(CancellationToken.None);
+
+        ValueTask<byte[]> waiting = pool.RentAsync(CancellationToken.None);
+        Assert.False(waiting.IsCompleted);
+
+        pool.Resize(budgetBytes: 2048, bufferSize: 1024);
+
+        Assert.Equal(1024, (await waiting.AsTask().WaitAsync(s_timeout)).Length);
+    }
+}
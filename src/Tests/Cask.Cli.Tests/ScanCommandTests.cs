@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+public sealed class ScanCommandTests : IDisposable
+{
+    private readonly string _directory = Directory.CreateTempSubdirectory("cask-scan-").FullName;
+
+    public void Dispose()
+    {
+        Directory.Delete(_directory, recursive: true);
+    }
+
+    [Theory]
+    [InlineData(true, false)]
+    [InlineData(false, true)]
+    public void ScanCommand_MaxFileRate_WithPcapOrImages_IsRejected(bool pcap, bool images)
+    {
+        var options = new ScanOptions
+        {
+            Paths = [],
+            Pcap = pcap,
+            Images = images,
+            MaxFileRate = 10,
+        };
+
+        Assert.Equal(1, ScanCommand.Run(options));
+    }
+
+    [Theory]
+    [InlineData("files")]
+    [InlineData("pcap")]
+    [InlineData("images")]
+    public void ScanCommand_PlaceholderKeys_AreTagged(string input)
+    {
+        string key = Cask.GenerateKey("TEST", 'M').ToString();
+        string generated = Cask.GenerateKey("ABCD", 'Q').ToString();
+        string placeholder = new string('A', 42) + generated[42..];
+        string text = $"key = \"{key}\"\nexample = \"{placeholder}\"\n";
+
+        string path = Path.Combine(_directory, "input");
+        switch (input)
+        {
+            case "pcap":
+                File.WriteAllBytes(path, TestCapture.Pcap([TestCapture.Udp(text)], bigEndian: false));
+                break;
+
+            case "images":
+                File.WriteAllBytes(path, TestImage.CreateArchive("app:1", TestImage.CreateLayer(("app.env", text))));
+                break;
+
+            default:
+                File.WriteAllText(path, text);
+                break;
+        }
+
+        string[] lines = Scan(new ScanOptions { Paths = [path], Pcap = input == "pcap", Images = input == "images" });
+
+        Assert.Equal(2, lines.Length);
+        Assert.DoesNotContain("placeholder", Assert.Single(lines, line => line.EndsWith(key[44..], StringComparison.Ordinal)), StringComparison.Ordinal);
+        Assert.Contains(" placeholder=true: ", Assert.Single(lines, line => line.EndsWith(placeholder[44..], StringComparison.Ordinal)), StringComparison.Ordinal);
+    }
+
+    private static string[] Scan(ScanOptions options)
+    {
+        TextWriter stdout = Console.Out;
+        using var output = new StringWriter();
+        Console.SetOut(output);
+
+        try
+        {
+            Assert.Equal(0, ScanCommand.Run(options));
+        }
+        finally
+        {
+            Console.SetOut(stdout);
+        }
+
+        return output.ToString().Split('\n', StringSplitOptions.RemoveEmptyEntries);
+    }
+}
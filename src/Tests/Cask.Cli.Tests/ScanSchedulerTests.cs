@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Collections.Concurrent;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+public sealed class ScanSchedulerTests : IDisposable
+{
+    private readonly string _directory = Directory.CreateTempSubdirectory("cask-scheduler-").FullName;
+
+    public void Dispose()
+    {
+        Directory.Delete(_directory, recursive: true);
+    }
+
+    [Fact]
+    public async Task ScanScheduler_Run_FindsKeysInEveryFile()
+    {
+        string key = Cask.GenerateKey("TEST", 'M').ToString();
+        string[] files = Enumerable.Range(0, 20).Select(i => WriteFile($"{i}.env", $"{new string('x', i * 1000)}KEY={key}\n")).ToArray();
+        var matches = new ConcurrentBag<string>();
+
+        ScanScheduler.ScanSummary summary = await new ScanScheduler(workers: 0, memoryBudgetBytes: 0, null, null, log: null)
+            .RunAsync(files, (path, _) => matches.Add(path), (_, e) => Assert.Fail(e.Message), CancellationToken.None)
+            .WaitAsync(TimeSpan.FromSeconds(30));
+
+        Assert.Equal(20, summary.Files);
+        Assert.Equal(20, summary.Matches);
+        Assert.Equal(files.Order(StringComparer.Ordinal).ToArray(), matches.Order(StringComparer.Ordinal).ToArray());
+    }
+
+    [Fact]
+    public async Task ScanScheduler_Run_EnumerationFailure_StopsWorkers()
+    {
+        string file = WriteFile("a.env", "nothing");
+
+        // Workers waiting for files must see the failure rather than wait
+        // forever for a channel that is never completed.
+        await Assert.ThrowsAsync<InvalidOperationException>(
+            () => new ScanScheduler(workers: 2, memoryBudgetBytes: 0, null, null, log: null)
+                .RunAsync(Fail(file), (_, _) => { }, (_, _) => { }, CancellationToken.None)
+                .WaitAsync(TimeSpan.FromSeconds(30)));
+
+        static IEnumerable<string> Fail(string file)
+        {
+            yield return file;
+            throw new InvalidOperationException();
+        }
+    }
+
+    [Fact]
+    public async Task ScanScheduler_RunPrioritized_EnumerationFailure_StopsWorkers()
+    {
+        string file = WriteFile("a.env", "nothing");
+
+        await Assert.ThrowsAsync<InvalidOperationException>(
+            () => new ScanScheduler(workers: 2, memoryBudgetBytes: 0, null, null, log: null)
+                .RunAsync(Fail(file), (_, _) => { }, (_, _) => { }, CancellationToken.None)
+                .WaitAsync(TimeSpan.FromSeconds(30)));
+
+        static IEnumerable<(string, ScanPriority)> Fail(string file)
+        {
+            yield return (file, new ScanPriority(0, 0));
+            throw new InvalidOperationException();
+        }
+    }
+
+    private string WriteFile(string name, string content)
+    {
+        string path = Path.Combine(_directory, name);
+        File.WriteAllText(path, content);
+        return path;
+    }
+}
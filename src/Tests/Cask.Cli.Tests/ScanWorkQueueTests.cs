@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+public class ScanWorkQueueTests
+{
+    private static readonly TimeSpan s_timeout = TimeSpan.FromSeconds(10);
+    private static readonly DateTime s_now = new(2024, 6, 1, 12, 0, 0, DateTimeKind.Utc);
+
+    [Fact]
+    public void ScanPriority_Get_RanksRecentThenRiskyThenOther()
+    {
+        DateTime old = s_now.AddDays(-30);
+
+        Assert.Equal(0, ScanPriority.Get("/src/Program.cs", s_now.AddHours(-1), s_now).Tier);
+        Assert.Equal(1, ScanPriority.Get("/src/appsettings.Production.json", old, s_now).Tier);
+        Assert.Equal(1, ScanPriority.Get("/home/user/.env.local", old, s_now).Tier);
+        Assert.Equal(1, ScanPriority.Get("/home/user/.aws/anything", old, s_now).Tier);
+        Assert.Equal(2, ScanPriority.Get("/src/Program.cs", old, s_now).Tier);
+    }
+
+    [Fact]
+    public void ScanWorkQueue_TryRead_ReturnsTiersInOrderAndNewestFirst()
+    {
+        var queue = new ScanWorkQueue();
+        Add(queue, "/src/old.cs", s_now.AddDays(-30));
+        Add(queue, "/src/settings.json", s_now.AddDays(-20));
+        Add(queue, "/src/new.cs", s_now.AddHours(-2));
+        Add(queue, "/src/newer.cs", s_now.AddHours(-1));
+        Add(queue, "/src/older.cs", s_now.AddDays(-40));
+        Add(queue, "/src/app.log", s_now.AddDays(-10));
+
+        Assert.Equal(6, queue.Count);
+        Assert.Equal(["/src/newer.cs", "/src/new.cs", "/src/app.log", "/src/settings.json", "/src/old.cs", "/src/older.cs"], ReadAll(queue));
+    }
+
+    [Fact]
+    public async Task ScanWorkQueue_CompleteAdding_CompletesOnceEmpty()
+    {
+        var queue = new ScanWorkQueue();
+        Add(queue, "/src/a.cs", s_now);
+        queue.CompleteAdding();
+
+        Assert.False(queue.Completion.IsCompleted);
+        Assert.True(await queue.WaitToReadAsync());
+        Assert.True(queue.TryRead(out _));
+
+        await queue.Completion.WaitAsync(s_timeout);
+        Assert.False(await queue.WaitToReadAsync());
+        Assert.Throws<InvalidOperationException>(() => Add(queue, "/src/b.cs", s_now));
+    }
+
+    [Fact]
+    public async Task ScanWorkQueue_CompleteAdding_WakesWaitingReaders()
+    {
+        var queue = new ScanWorkQueue();
+        ValueTask<bool> first = queue.WaitToReadAsync();
+        ValueTask<bool> second = queue.WaitToReadAsync();
+        Assert.False(first.IsCompleted);
+
+        queue.CompleteAdding();
+
+        Assert.False(await first.AsTask().WaitAsync(s_timeout));
+        Assert.False(await second.AsTask().WaitAsync(s_timeout));
+        await queue.Completion.WaitAsync(s_timeout);
+    }
+
+    [Fact]
+    public async Task ScanWorkQueue_CompleteAddingWithError_IsSeenOnceEmpty()
+    {
+        var queue = new ScanWorkQueue();
+        ValueTask<bool> waiting = queue.WaitToReadAsync();
+        Add(queue, "/src/a.cs", s_now);
+        Assert.True(await waiting.AsTask().WaitAsync(s_timeout));
+
+        queue.CompleteAdding(new IOException("enumeration failed"));
+
+        // Files added before the failure are still read.
+        Assert.True(await queue.WaitToReadAsync());
+        Assert.True(queue.TryRead(out string? path));
+        Assert.Equal("/src/a.cs", path);
+
+        await Assert.ThrowsAsync<IOException>(() => queue.WaitToReadAsync().AsTask());
+        await Assert.ThrowsAsync<IOException>(() => queue.Completion.WaitAsync(s_timeout));
+    }
+
+    [Fact]
+    public async Task ScanWorkQueue_WaitToRead_Cancelled_Throws()
+    {
+        var queue = new ScanWorkQueue();
+        using var cancellation = new CancellationTokenSource();
+        ValueTask<bool> waiting = queue.WaitToReadAsync(cancellation.Token);
+
+        await cancellation.CancelAsync();
+
+        await Assert.ThrowsAnyAsync<OperationCanceledException>(() => waiting.AsTask().WaitAsync(s_timeout));
+        Assert.False(queue.Completion.IsCompleted);
+    }
+
+    [Fact]
+    public async Task ScanWorkQueue_Add_SkipsCancelledWaiter()
+    {
+        var queue = new ScanWorkQueue();
+        using var cancellation = new CancellationTokenSource();
+        ValueTask<bool> cancelled = queue.WaitToReadAsync(cancellation.Token);
+        ValueTask<bool> waiting = queue.WaitToReadAsync();
+
+        await cancellation.CancelAsync();
+        await Assert.ThrowsAnyAsync<OperationCanceledException>(() => cancelled.AsTask());
+
+        // The add wakes the reader behind the cancelled one.
+        Add(queue, "/src/a.cs", s_now);
+        Assert.True(await waiting.AsTask().WaitAsync(s_timeout));
+    }
+
+    private static void Add(ScanWorkQueue queue, string path, DateTime lastWriteTimeUtc)
+    {
+        queue.Add(path, ScanPriority.Get(path, lastWriteTimeUtc, s_now));
+    }
+
+    private static string[] ReadAll(ScanWorkQueue queue)
+    {
+        var paths = new List<string>();
+        while (queue.TryRead(out string? path))
+        {
+            paths.Add(path);
+        }
+
+        return [.. paths];
+    }
+}
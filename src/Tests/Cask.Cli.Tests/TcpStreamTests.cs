@@ -0,0 +1,104 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Text;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+public class TcpStreamTests
+{
+    private const uint InitialSequence = 0xFFFF_FF00; // Wraps around within the stream.
+
+    private readonly string _key = Cask.GenerateKey("TEST", 'M').ToString();
+    private readonly TcpStream _stream = new();
+    private readonly List<(long Offset, CaskKey Key, bool IsLikelyPlaceholder)> _found = [];
+
+    [Fact]
+    public void TcpStream_KeySplitAcrossSegments_IsFound()
+    {
+        string data = $"key={_key}\n";
+
+        Add(TcpFlags.Syn, 0, "");
+        Add(TcpFlags.None, 1, data[..20]);
+        Add(TcpFlags.None, 21, data[20..40]);
+        Add(TcpFlags.Fin, 41, data[40..]);
+
+        AssertFound((4, _key));
+        Assert.True(_stream.IsClosed);
+        Assert.Equal(0, _stream.Gaps);
+    }
+
+    [Fact]
+    public void TcpStream_OutOfOrderDuplicateAndRetransmittedSegments_AreReassembled()
+    {
+        string data = $"key={_key}\n";
+
+        Add(TcpFlags.Syn, 0, "");
+        Add(TcpFlags.None, 41, data[40..]);     // Out of order.
+        Add(TcpFlags.None, 1, data[..20]);
+        Add(TcpFlags.None, 1, data[..20]);      // Duplicate.
+        Add(TcpFlags.Syn, 0, "");               // Retransmitted SYN.
+        Add(TcpFlags.None, 11, data[10..40]);   // Retransmission overlapping the first segment.
+        Add(TcpFlags.None, 41, data[40..]);     // Duplicate of held data.
+        Add(TcpFlags.Fin, 1 + (uint)data.Length, "");
+
+        AssertFound((4, _key));
+        Assert.Equal(0, _stream.Gaps);
+    }
+
+    [Fact]
+    public void TcpStream_Gap_RestartsScanAndKeepsOffsets()
+    {
+        string other = Cask.GenerateKey("ABCD", 'Q').ToString();
+        string first = $"a={_key}\n";
+        string second = $"{_key[34..]}\n{other}\n";
+        int gap = 70;
+
+        Add(TcpFlags.Syn, 0, "");
+        Add(TcpFlags.None, 1, first);
+
+        // The end of a key after the gap is not reported as a key.
+        Add(TcpFlags.None, 1 + (uint)(first.Length + gap), second);
+        _stream.Close(_found);
+
+        AssertFound((2, _key), (first.Length + gap + 31, other));
+        Assert.Equal(1, _stream.Gaps);
+    }
+
+    [Fact]
+    public void TcpStream_MissingHandshake_StartsAtFirstSegment()
+    {
+        Add(TcpFlags.None, 500, $" {_key}"[..30]);
+        Add(TcpFlags.None, 530, $" {_key}"[30..]);
+        _stream.Close(_found);
+
+        AssertFound((1, _key));
+    }
+
+    [Fact]
+    public void TcpStream_TooMuchHeldData_SkipsGap()
+    {
+        Add(TcpFlags.Syn, 0, "");
+
+        // Held data beyond the limit gives up on the missing first byte.
+        var held = new string('.', TcpStream.MaxPendingBytes / 2);
+        Add(TcpFlags.None, 2, held);
+        Add(TcpFlags.None, 2 + (uint)held.Length, held + _key + "\n");
+        _stream.Close(_found);
+
+        AssertFound((1 + (2 * held.Length), _key));
+        Assert.Equal(1, _stream.Gaps);
+    }
+
+    private void Add(TcpFlags flags, uint relativeSequence, string payload)
+    {
+        _stream.Add(unchecked(InitialSequence + relativeSequence), flags, Encoding.UTF8.GetBytes(payload), _found);
+    }
+
+    private void AssertFound(params (long Offset, string Key)[] expected)
+    {
+        Assert.Equal(expected, _found.Select(found => (found.Offset, found.Key.ToString())));
+    }
+}
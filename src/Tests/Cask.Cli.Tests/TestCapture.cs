@@ -0,0 +1,220 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+using System.Net;
+using System.Text;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+/// <summary>
+/// Builds small pcap and pcapng captures of raw IP packets.
+/// </summary>
+internal static class TestCapture
+{
+    public const int LinkTypeRaw = 101;
+    public const ushort SourcePort = 40000;
+    public const ushort DestinationPort = 443;
+
+    public static readonly IPAddress SourceIPv4 = IPAddress.Parse("10.0.0.1");
+    public static readonly IPAddress DestinationIPv4 = IPAddress.Parse("10.0.0.2");
+    public static readonly IPAddress SourceIPv6 = IPAddress.Parse("2001:db8::1");
+    public static readonly IPAddress DestinationIPv6 = IPAddress.Parse("2001:db8::2");
+
+    /// <summary>
+    /// The time of the packet at the given index in a capture.
+    /// </summary>
+    public static DateTimeOffset GetTimestamp(int index)
+    {
+        return DateTimeOffset.FromUnixTimeSeconds(1_750_000_000 + index).AddTicks(2_345_670);
+    }
+
+    public static byte[] Tcp(bool ipv6, uint sequence, TcpFlags flags, string payload = "")
+    {
+        byte[] data = Encoding.UTF8.GetBytes(payload);
+        var tcp = new byte[20 + data.Length];
+
+        BinaryPrimitives.WriteUInt16BigEndian(tcp, SourcePort);
+        BinaryPrimitives.WriteUInt16BigEndian(tcp.AsSpan(2), DestinationPort);
+        BinaryPrimitives.WriteUInt32BigEndian(tcp.AsSpan(4), sequence);
+        tcp[12] = 5 << 4;
+        tcp[13] = (byte)(0x10 | (byte)flags); // ACK, and the given flags.
+        data.CopyTo(tcp, 20);
+
+        return ipv6 ? IPv6(6, tcp) : IPv4(6, tcp);
+    }
+
+    public static byte[] Udp(string payload)
+    {
+        byte[] data = Encoding.UTF8.GetBytes(payload);
+        var udp = new byte[8 + data.Length];
+
+        BinaryPrimitives.WriteUInt16BigEndian(udp, SourcePort);
+        BinaryPrimitives.WriteUInt16BigEndian(udp.AsSpan(2), DestinationPort);
+        BinaryPrimitives.WriteUInt16BigEndian(udp.AsSpan(4), (ushort)udp.Length);
+        data.CopyTo(udp, 8);
+
+        return IPv4(17, udp);
+    }
+
+    public static byte[] Pcap(IReadOnlyList<byte[]> packets, bool bigEndian, bool nanoseconds = false)
+    {
+        using var stream = new MemoryStream();
+
+        Write32(stream, nanoseconds ? 0xA1B23C4Du : 0xA1B2C3D4u, bigEndian);
+        Write16(stream, 2, bigEndian);
+        Write16(stream, 4, bigEndian);
+        Write32(stream, 0, bigEndian);
+        Write32(stream, 0, bigEndian);
+        Write32(stream, 65535, bigEndian);
+        Write32(stream, LinkTypeRaw, bigEndian);
+
+        for (int i = 0; i < packets.Count; i++)
+        {
+            DateTimeOffset timestamp = GetTimestamp(i);
+            long ticks = timestamp.Ticks % TimeSpan.TicksPerSecond;
+
+            Write32(stream, (uint)timestamp.ToUnixTimeSeconds(), bigEndian);
+            Write32(stream, (uint)(nanoseconds ? ticks * 100 : ticks / 10), bigEndian);
+            Write32(stream, (uint)packets[i].Length, bigEndian);
+            Write32(stream, (uint)packets[i].Length, bigEndian);
+            stream.Write(packets[i]);
+        }
+
+        return stream.ToArray();
+    }
+
+    /// <param name="timestampResolution">
+    /// The <c>if_tsresol</c> of the interface, as a power of ten.
+    /// Timestamps are always written in nanoseconds.
+    /// </param>
+    public static byte[] Pcapng(IReadOnlyList<byte[]> packets, bool bigEndian, byte timestampResolution = 9)
+    {
+        using var stream = new MemoryStream();
+
+        // Section header with a section length of -1 (unknown).
+        WriteBlock(stream, 0x0A0D0D0A, bigEndian, body =>
+        {
+            Write32(body, 0x1A2B3C4D, bigEndian);
+            Write16(body, 1, bigEndian);
+            Write16(body, 0, bigEndian);
+            Write32(body, uint.MaxValue, bigEndian);
+            Write32(body, uint.MaxValue, bigEndian);
+        });
+
+        // Interface description with nanosecond timestamps.
+        WriteBlock(stream, 1, bigEndian, body =>
+        {
+            Write16(body, LinkTypeRaw, bigEndian);
+            Write16(body, 0, bigEndian);
+            Write32(body, 65535, bigEndian);
+            Write16(body, 9, bigEndian);
+            Write16(body, 1, bigEndian);
+            body.Write([timestampResolution, 0, 0, 0]);
+            Write32(body, 0, bigEndian);
+        });
+
+        for (int i = 0; i < packets.Count; i++)
+        {
+            byte[] packet = packets[i];
+            ulong units = (ulong)(GetTimestamp(i) - DateTimeOffset.UnixEpoch).Ticks * 100;
+
+            WriteBlock(stream, 6, bigEndian, body =>
+            {
+                Write32(body, 0, bigEndian);
+                Write32(body, (uint)(units >> 32), bigEndian);
+                Write32(body, unchecked((uint)units), bigEndian);
+                Write32(body, (uint)packet.Length, bigEndian);
+                Write32(body, (uint)packet.Length, bigEndian);
+                body.Write(packet);
+                body.Write(new byte[(4 - (packet.Length % 4)) % 4]);
+            });
+        }
+
+        return stream.ToArray();
+    }
+
+    /// <summary>
+    /// Writes a pcapng block of the given type around a body.
+    /// </summary>
+    public static byte[] PcapngBlock(uint type, byte[] body, bool bigEndian)
+    {
+        using var stream = new MemoryStream();
+        WriteBlock(stream, type, bigEndian, block => block.Write(body));
+        return stream.ToArray();
+    }
+
+    private static byte[] IPv4(byte protocol, byte[] transport)
+    {
+        var packet = new byte[20 + transport.Length];
+
+        packet[0] = 0x45;
+        BinaryPrimitives.WriteUInt16BigEndian(packet.AsSpan(2), (ushort)packet.Length);
+        packet[8] = 64;
+        packet[9] = protocol;
+        SourceIPv4.TryWriteBytes(packet.AsSpan(12), out _);
+        DestinationIPv4.TryWriteBytes(packet.AsSpan(16), out _);
+        transport.CopyTo(packet, 20);
+
+        return packet;
+    }
+
+    private static byte[] IPv6(byte protocol, byte[] transport)
+    {
+        var packet = new byte[40 + transport.Length];
+
+        packet[0] = 0x60;
+        BinaryPrimitives.WriteUInt16BigEndian(packet.AsSpan(4), (ushort)transport.Length);
+        packet[6] = protocol;
+        packet[7] = 64;
+        SourceIPv6.TryWriteBytes(packet.AsSpan(8), out _);
+        DestinationIPv6.TryWriteBytes(packet.AsSpan(24), out _);
+        transport.CopyTo(packet, 40);
+
+        return packet;
+    }
+
+    private static void WriteBlock(MemoryStream stream, uint type, bool bigEndian, Action<MemoryStream> writeBody)
+    {
+        using var body = new MemoryStream();
+        writeBody(body);
+
+        uint length = (uint)body.Length + 12;
+        Write32(stream, type, bigEndian);
+        Write32(stream, length, bigEndian);
+        body.WriteTo(stream);
+        Write32(stream, length, bigEndian);
+    }
+
+    private static void Write16(MemoryStream stream, ushort value, bool bigEndian)
+    {
+        Span<byte> bytes = stackalloc byte[2];
+
+        if (bigEndian)
+        {
+            BinaryPrimitives.WriteUInt16BigEndian(bytes, value);
+        }
+        else
+        {
+            BinaryPrimitives.WriteUInt16LittleEndian(bytes, value);
+        }
+
+        stream.Write(bytes);
+    }
+
+    private static void Write32(MemoryStream stream, uint value, bool bigEndian)
+    {
+        Span<byte> bytes = stackalloc byte[4];
+
+        if (bigEndian)
+        {
+            BinaryPrimitives.WriteUInt32BigEndian(bytes, value);
+        }
+        else
+        {
+            BinaryPrimitives.WriteUInt32LittleEndian(bytes, value);
+        }
+
+        stream.Write(bytes);
+    }
+}
@@ -0,0 +1,183 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Formats.Tar;
+using System.Globalization;
+using System.IO.Compression;
+using System.Security.Cryptography;
+using System.Text;
+using System.Text.Json;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+/// <summary>
+/// Builds small OCI image layouts and <c>docker save</c> archives.
+/// </summary>
+internal static class TestImage
+{
+    /// <summary>
+    /// A layer as a tar of the given files, and its digest.
+    /// </summary>
+    public sealed record Layer(byte[] Tar)
+    {
+        public string DiffId => Digest(Tar);
+    }
+
+    public static Layer CreateLayer(params (string Name, string Content)[] files)
+    {
+        return CreateLayer(files.Select(file => CreateEntry(TarEntryType.RegularFile, file.Name, file.Content)).ToArray());
+    }
+
+    public static Layer CreateLayer(params TarEntry[] entries)
+    {
+        using var stream = new MemoryStream();
+
+        using (var writer = new TarWriter(stream, leaveOpen: true))
+        {
+            foreach (TarEntry entry in entries)
+            {
+                writer.WriteEntry(entry);
+            }
+        }
+
+        return new Layer(stream.ToArray());
+    }
+
+    public static TarEntry CreateEntry(TarEntryType type, string name, string content = "", string? linkName = null)
+    {
+        var entry = new PaxTarEntry(type, name);
+
+        if (linkName != null)
+        {
+            entry.LinkName = linkName;
+        }
+
+        if (type == TarEntryType.RegularFile)
+        {
+            entry.DataStream = new MemoryStream(Encoding.UTF8.GetBytes(content));
+        }
+
+        return entry;
+    }
+
+    public static byte[] Gzip(byte[] data)
+    {
+        using var stream = new MemoryStream();
+
+        using (var gzip = new GZipStream(stream, CompressionLevel.Fastest, leaveOpen: true))
+        {
+            gzip.Write(data);
+        }
+
+        return stream.ToArray();
+    }
+
+    /// <summary>
+    /// Writes an OCI image layout whose index holds one image index with an
+    /// image for each platform, all with the same layers.
+    /// </summary>
+    /// <param name="gzip">Whether the layer blobs are compressed.</param>
+    public static void WriteLayout(string directory, string name, string[] platforms, bool gzip, params Layer[] layers)
+    {
+        Directory.CreateDirectory(directory);
+        File.WriteAllText(Path.Combine(directory, "oci-layout"), """{"imageLayoutVersion":"1.0.0"}""");
+
+        string config = WriteBlob(directory, Config(layers));
+
+        object[] layerDescriptors = layers.Select(layer => new
+        {
+            mediaType = gzip ? "application/vnd.oci.image.layer.v1.tar+gzip" : "application/vnd.oci.image.layer.v1.tar",
+            digest = WriteBlob(directory, gzip ? Gzip(layer.Tar) : layer.Tar),
+        }).ToArray<object>();
+
+        string manifest = WriteBlob(directory, JsonSerializer.SerializeToUtf8Bytes(new
+        {
+            schemaVersion = 2,
+            mediaType = "application/vnd.oci.image.manifest.v1+json",
+            config = new { mediaType = "application/vnd.oci.image.config.v1+json", digest = config },
+            layers = layerDescriptors,
+        }));
+
+        string platformIndex = WriteBlob(directory, JsonSerializer.SerializeToUtf8Bytes(new
+        {
+            schemaVersion = 2,
+            manifests = platforms.Select(platform => new
+            {
+                mediaType = "application/vnd.oci.image.manifest.v1+json",
+                digest = manifest,
+                platform = new { os = platform.Split('/')[0], architecture = platform.Split('/')[1] },
+            }),
+        }));
+
+        File.WriteAllBytes(Path.Combine(directory, "index.json"), JsonSerializer.SerializeToUtf8Bytes(new
+        {
+            schemaVersion = 2,
+            manifests = new[]
+            {
+                new
+                {
+                    mediaType = "application/vnd.oci.image.index.v1+json",
+                    digest = platformIndex,
+                    annotations = new Dictionary<string, string> { ["org.opencontainers.image.ref.name"] = name },
+                },
+            },
+        }));
+    }
+
+    /// <summary>
+    /// Writes a <c>docker save</c> archive of one image.
+    /// </summary>
+    public static byte[] CreateArchive(string tag, params Layer[] layers)
+    {
+        using var stream = new MemoryStream();
+
+        using (var writer = new TarWriter(stream, TarEntryFormat.Ustar, leaveOpen: true))
+        {
+            string[] layerPaths = layers.Select(layer => $"{layer.DiffId[7..]}/layer.tar").ToArray();
+
+            Write(writer, "manifest.json", JsonSerializer.SerializeToUtf8Bytes(new[]
+            {
+                new { Config = "config.json", RepoTags = new[] { tag }, Layers = layerPaths },
+            }));
+
+            Write(writer, "config.json", Config(layers));
+
+            for (int i = 0; i < layers.Length; i++)
+            {
+                Write(writer, layerPaths[i], layers[i].Tar);
+            }
+        }
+
+        return stream.ToArray();
+
+        static void Write(TarWriter writer, string name, byte[] content)
+        {
+            writer.WriteEntry(new UstarTarEntry(TarEntryType.RegularFile, name) { DataStream = new MemoryStream(content) });
+        }
+    }
+
+    private static byte[] Config(Layer[] layers)
+    {
+        return JsonSerializer.SerializeToUtf8Bytes(new
+        {
+            architecture = "amd64",
+            os = "linux",
+            rootfs = new { type = "layers", diff_ids = layers.Select(layer => layer.DiffId).ToArray() },
+        });
+    }
+
+    private static string WriteBlob(string directory, byte[] content)
+    {
+        string digest = Digest(content);
+        string path = Path.Combine(directory, "blobs", "sha256", digest[7..]);
+
+        Directory.CreateDirectory(Path.GetDirectoryName(path)!);
+        File.WriteAllBytes(path, content);
+        return digest;
+    }
+
+    private static string Digest(byte[] content)
+    {
+        return "sha256:" + string.Concat(SHA256.HashData(content).Select(b => b.ToString("x2", CultureInfo.InvariantCulture)));
+    }
+}
@@ -0,0 +1,75 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Cli.Tests;
+
+public class TokenBucketTests
+{
+    private readonly ManualTimeProvider _time = new();
+
+    [Fact]
+    public void TokenBucket_Take_WaitsOnlyBeyondBurst()
+    {
+        var bucket = new TokenBucket(tokensPerSecond: 100, burst: 10, _time);
+
+        // The burst is free, and each token after it costs 10 ms.
+        Assert.Equal(TimeSpan.Zero, bucket.Take(10));
+        Assert.Equal(TimeSpan.FromMilliseconds(100), bucket.Take(10));
+        Assert.Equal(TimeSpan.FromMilliseconds(150), bucket.Take(5));
+    }
+
+    [Fact]
+    public void TokenBucket_Take_PaysBackOverTime()
+    {
+        var bucket = new TokenBucket(tokensPerSecond: 100, burst: 10, _time);
+
+        Assert.Equal(TimeSpan.FromMilliseconds(100), bucket.Take(20));
+
+        _time.Advance(TimeSpan.FromMilliseconds(100));
+        Assert.Equal(TimeSpan.FromMilliseconds(50), bucket.Take(5));
+
+        _time.Advance(TimeSpan.FromMilliseconds(150));
+        Assert.Equal(TimeSpan.Zero, bucket.Take(10));
+    }
+
+    [Fact]
+    public void TokenBucket_Take_DoesNotSaveUpBeyondBurst()
+    {
+        var bucket = new TokenBucket(tokensPerSecond: 100, burst: 10, _time);
+
+        _time.Advance(TimeSpan.FromMinutes(1));
+
+        // Idle time only ever earns back the burst.
+        Assert.Equal(TimeSpan.FromMilliseconds(100), bucket.Take(20));
+    }
+
+    [Fact]
+    public void TokenBucket_Take_Concurrent_ChargesEveryToken()
+    {
+        var bucket = new TokenBucket(tokensPerSecond: 1000, burst: 0, _time);
+
+        Parallel.For(0, 10_000, _ => bucket.Take(1));
+
+        Assert.Equal(TimeSpan.FromSeconds(10) + TimeSpan.FromMilliseconds(1), bucket.Take(1));
+    }
+
+    [Fact]
+    public void TokenBucket_InvalidArguments_Throw()
+    {
+        Assert.Throws<ArgumentOutOfRangeException>(() => new TokenBucket(0, 1));
+        Assert.Throws<ArgumentOutOfRangeException>(() => new TokenBucket(1, -1));
+    }
+
+    private sealed class ManualTimeProvider : TimeProvider
+    {
+        private long _timestamp;
+
+        public override long TimestampFrequency => 1_000_000;
+
+        public override long GetTimestamp() => _timestamp;
+
+        public void Advance(TimeSpan delta) => _timestamp += delta.Ticks / 10;
+    }
+}
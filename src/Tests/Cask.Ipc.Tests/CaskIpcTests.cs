@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Binary;
+using System.Text;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Ipc.Tests;
+
+public sealed class CaskIpcTests : IDisposable
+{
+    private readonly CancellationTokenSource _stop = new();
+    private readonly CaskIpcServer _server;
+    private readonly Task _serverTask;
+
+    public CaskIpcTests()
+    {
+        _server = new CaskIpcServer(Path.Combine(Path.GetTempPath(), $"cask-{Guid.NewGuid():N}.sock"));
+        _serverTask = _server.RunAsync(_stop.Token);
+    }
+
+    public void Dispose()
+    {
+        _stop.Cancel();
+        _serverTask.GetAwaiter().GetResult();
+        _server.Dispose();
+        _stop.Dispose();
+    }
+
+    [Fact]
+    public async Task CaskIpcClient_Validate_MatchesLibrary()
+    {
+        string key = Cask.GenerateKey("TEST", 'M').ToString();
+        string[] keys = [key, key[..^1], key.Replace('Q', '?'), ""];
+
+        await using CaskIpcClient client = await CaskIpcClient.ConnectAsync(_server.SocketPath);
+        CaskValidationError[] errors = await client.ValidateAsync(keys);
+
+        Assert.Equal(keys.Select(k => Cask.Validate(k, out _)).ToArray(), errors);
+        Assert.Equal(CaskValidationError.None, errors[0]);
+    }
+
+    [Fact]
+    public async Task CaskIpcClient_Fingerprint_MatchesLibrary()
+    {
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+
+        await using CaskIpcClient client = await CaskIpcClient.ConnectAsync(_server.SocketPath);
+        CaskKeyFingerprint?[] fingerprints = await client.FingerprintAsync([key.ToString(), "not a key"]);
+
+        Assert.Equal(CaskKeyFingerprint.Create(key), fingerprints[0]);
+        Assert.Null(fingerprints[1]);
+    }
+
+    [Fact]
+    public async Task CaskIpcClient_Scan_FindsKeysInEachText()
+    {
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+        byte[] text = Encoding.UTF8.GetBytes($"key={key}\nother={key}\n");
+
+        await using CaskIpcClient client = await CaskIpcClient.ConnectAsync(_server.SocketPath);
+        IReadOnlyList<CaskMatch>[] matches = await client.ScanAsync([text, Encoding.UTF8.GetBytes("no keys")]);
+
+        Assert.Equal([4L, 4L + key.ToString().Length + 7], matches[0].Select(m => m.Offset).ToArray());
+        Assert.Equal([key, key], matches[0].Select(m => m.Key).ToArray());
+        Assert.Empty(matches[1]);
+    }
+
+    [Fact]
+    public async Task CaskIpcClient_ConcurrentRequests_AreMatchedToTheirResponses()
+    {
+        string[] keys = Enumerable.Range(0, 64).Select(_ => Cask.GenerateKey("TEST", 'M').ToString()).ToArray();
+
+        await using CaskIpcClient client = await CaskIpcClient.ConnectAsync(_server.SocketPath);
+        CaskKeyFingerprint?[][] results = await Task.WhenAll(keys.Select(k => client.FingerprintAsync([k])));
+
+        for (int i = 0; i < keys.Length; i++)
+        {
+            Assert.Equal(CaskKeyFingerprint.Create(CaskKey.Create(keys[i])), results[i][0]);
+        }
+    }
+
+    [Fact]
+    public async Task CaskIpcClient_ServerStopped_FailsRequests()
+    {
+        await using CaskIpcClient client = await CaskIpcClient.ConnectAsync(_server.SocketPath);
+        await client.ValidateAsync(["key"]);
+
+        await _stop.CancelAsync();
+        await _serverTask;
+
+        await Assert.ThrowsAnyAsync<IOException>(() => client.ValidateAsync(["key"]));
+    }
+
+    [Theory]
+    [InlineData(new byte[] { 1, 0, 0, 0, (byte)CaskIpcOperation.Validate, 1, 0, 0, 0, 5, 0, 0, 0 }, 1)]
+    [InlineData(new byte[] { 1, 0, 0, 0, (byte)CaskIpcOperation.Validate, 0, 0, 0, 0, 0 }, 1)]
+    [InlineData(new byte[] { 1, 0, 0, 0, 99, 0, 0, 0, 0 }, 2)]
+    [InlineData(new byte[] { 1, 0 }, 1)]
+    public void CaskIpcServer_InvalidRequest_RespondsWithError(byte[] frame, byte status)
+    {
+        var output = new CaskIpcFrameWriter(64);
+
+        CaskIpcServer.ProcessRequest(frame, output, []);
+
+        ReadOnlySpan<byte> response = output.WrittenMemory.Span;
+        Assert.Equal(CaskIpcProtocol.HeaderLength, (int)BinaryPrimitives.ReadUInt32LittleEndian(response));
+        Assert.Equal(status, response[CaskIpcProtocol.LengthPrefixLength + 4]);
+    }
+
+    [Fact]
+    public void CaskIpcServer_ResponseOverMaxFrameLength_RespondsWithError()
+    {
+        // Each empty item takes 4 bytes and its fingerprint result 17, so a
+        // request of a quarter of the maximum has a response beyond it.
+        int count = (CaskIpcProtocol.MaxFrameLength / 16) + 1;
+        byte[] frame = new byte[9 + (count * 4)];
+        frame[0] = 1;
+        frame[4] = (byte)CaskIpcOperation.Fingerprint;
+        BinaryPrimitives.WriteUInt32LittleEndian(frame.AsSpan(5), (uint)count);
+
+        var output = new CaskIpcFrameWriter(64);
+
+        CaskIpcServer.ProcessRequest(frame, output, []);
+
+        ReadOnlySpan<byte> response = output.WrittenMemory.Span;
+        Assert.Equal(CaskIpcProtocol.LengthPrefixLength + CaskIpcProtocol.HeaderLength, response.Length);
+        Assert.Equal((byte)CaskIpcStatus.ResponseTooLarge, response[CaskIpcProtocol.LengthPrefixLength + 4]);
+    }
+
+    [Fact]
+    public void CaskIpcServer_Socket_IsOnlyAccessibleToOwner()
+    {
+        if (OperatingSystem.IsWindows())
+        {
+            return;
+        }
+
+        Assert.Equal(UnixFileMode.UserRead | UnixFileMode.UserWrite, File.GetUnixFileMode(_server.SocketPath));
+    }
+}
@@ -0,0 +1,246 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Ipc.Tests;
+
+public sealed class SharedKeyStatusCacheTests : IDisposable
+{
+    private readonly string _path = Path.Combine(Path.GetTempPath(), $"cask-{Guid.NewGuid():N}.cache");
+    private readonly ManualTimeProvider _time = new();
+
+    public void Dispose()
+    {
+        File.Delete(_path);
+    }
+
+    [Fact]
+    public async Task SharedKeyStatusCache_SecondProcess_UsesStatusesOfFirst()
+    {
+        CaskKeyFingerprint active = CreateFingerprint();
+        CaskKeyFingerprint revoked = CreateFingerprint();
+        var first = new InMemoryKeyStatusService();
+        first.SetStatus(active, KeyStatus.Active);
+        first.SetStatus(revoked, KeyStatus.Revoked);
+        var second = new InMemoryKeyStatusService();
+
+        using var firstCache = new SharedKeyStatusCache(first, CreateOptions());
+        using var secondCache = new SharedKeyStatusCache(second, CreateOptions());
+
+        Assert.Equal([KeyStatus.Active, KeyStatus.Revoked], (await firstCache.GetStatusesAsync([active, revoked], default)).ToArray());
+        Assert.Equal([KeyStatus.Revoked, KeyStatus.Active], (await secondCache.GetStatusesAsync([revoked, active], default)).ToArray());
+        Assert.Equal(0, second.Requests);
+    }
+
+    [Fact]
+    public async Task SharedKeyStatusCache_Misses_AreLookedUpInOneRequest()
+    {
+        CaskKeyFingerprint cached = CreateFingerprint();
+        var service = new InMemoryKeyStatusService();
+        service.SetStatus(cached, KeyStatus.Active);
+
+        using var cache = new SharedKeyStatusCache(service, CreateOptions());
+        await cache.GetStatusesAsync([cached], default);
+
+        IReadOnlyList<KeyStatus> statuses = await cache.GetStatusesAsync([CreateFingerprint(), cached, CreateFingerprint()], default);
+
+        Assert.Equal([KeyStatus.Unknown, KeyStatus.Active, KeyStatus.Unknown], statuses.ToArray());
+        Assert.Equal(2, service.Requests);
+        Assert.Equal(3, service.RequestedKeys);
+    }
+
+    [Fact]
+    public async Task SharedKeyStatusCache_ExpiredStatus_IsLookedUpAgain()
+    {
+        CaskKeyFingerprint fingerprint = CreateFingerprint();
+        var service = new InMemoryKeyStatusService();
+        service.SetStatus(fingerprint, KeyStatus.Active);
+
+        using var cache = new SharedKeyStatusCache(service, CreateOptions());
+        await cache.GetStatusesAsync([fingerprint], default);
+        _time.Advance(TimeSpan.FromSeconds(59));
+        await cache.GetStatusesAsync([fingerprint], default);
+        Assert.Equal(1, service.Requests);
+
+        service.SetStatus(fingerprint, KeyStatus.Revoked);
+        _time.Advance(TimeSpan.FromSeconds(1));
+
+        Assert.Equal([KeyStatus.Revoked], (await cache.GetStatusesAsync([fingerprint], default)).ToArray());
+        Assert.Equal(2, service.Requests);
+    }
+
+    [Fact]
+    public async Task SharedKeyStatusCache_StatusOutlivingTimeToLive_IsIgnored()
+    {
+        CaskKeyFingerprint fingerprint = CreateFingerprint();
+        var service = new InMemoryKeyStatusService();
+        service.SetStatus(fingerprint, KeyStatus.Active);
+
+        SharedKeyStatusCacheOptions longOptions = CreateOptions();
+        longOptions.ActiveTimeToLive = TimeSpan.FromHours(1);
+
+        using var longCache = new SharedKeyStatusCache(service, longOptions);
+        using var cache = new SharedKeyStatusCache(service, CreateOptions());
+
+        // An entry written by a process with a longer time to live, or before
+        // the clock was set back, is not trusted for longer than our own.
+        await longCache.GetStatusesAsync([fingerprint], default);
+
+        Assert.Equal([KeyStatus.Active], (await cache.GetStatusesAsync([fingerprint], default)).ToArray());
+        Assert.Equal(2, service.Requests);
+    }
+
+    [Fact]
+    public async Task SharedKeyStatusCache_Capacity_IsSetByFirstProcessAndBounded()
+    {
+        SharedKeyStatusCacheOptions options = CreateOptions();
+        options.Capacity = 5;
+
+        using var cache = new SharedKeyStatusCache(new InMemoryKeyStatusService(), options);
+        using var larger = new SharedKeyStatusCache(new InMemoryKeyStatusService(), CreateOptions());
+
+        Assert.Equal(8, cache.Capacity);
+        Assert.Equal(8, larger.Capacity);
+
+        CaskKeyFingerprint[] fingerprints = Enumerable.Range(0, 100).Select(_ => CreateFingerprint()).ToArray();
+        await larger.GetStatusesAsync(fingerprints, default);
+
+        Assert.Equal(64 + (8 * 32), new FileInfo(_path).Length);
+    }
+
+    [Fact]
+    public void SharedKeyStatusCache_OtherFile_Throws()
+    {
+        File.WriteAllBytes(_path, Enumerable.Repeat((byte)'x', 1024).ToArray());
+        if (!OperatingSystem.IsWindows())
+        {
+            File.SetUnixFileMode(_path, UnixFileMode.UserRead | UnixFileMode.UserWrite);
+        }
+
+        Assert.Throws<InvalidDataException>(() => new SharedKeyStatusCache(new InMemoryKeyStatusService(), CreateOptions()));
+    }
+
+    [Fact]
+    public void SharedKeyStatusCache_NewFile_IsOnlyAccessibleToOwner()
+    {
+        if (OperatingSystem.IsWindows())
+        {
+            return;
+        }
+
+        using (new SharedKeyStatusCache(new InMemoryKeyStatusService(), CreateOptions()))
+        {
+        }
+
+        Assert.Equal(UnixFileMode.UserRead | UnixFileMode.UserWrite, File.GetUnixFileMode(_path));
+    }
+
+    [Theory]
+    [InlineData(UnixFileMode.GroupRead)]
+    [InlineData(UnixFileMode.GroupWrite)]
+    [InlineData(UnixFileMode.OtherRead)]
+    [InlineData(UnixFileMode.OtherWrite)]
+    public void SharedKeyStatusCache_FileOpenToOtherUsers_IsRefused(UnixFileMode other)
+    {
+        if (OperatingSystem.IsWindows())
+        {
+            return;
+        }
+
+        using (new SharedKeyStatusCache(new InMemoryKeyStatusService(), CreateOptions()))
+        {
+        }
+
+        File.SetUnixFileMode(_path, UnixFileMode.UserRead | UnixFileMode.UserWrite | other);
+
+        Assert.Throws<UnauthorizedAccessException>(() => new SharedKeyStatusCache(new InMemoryKeyStatusService(), CreateOptions()));
+    }
+
+    [Fact]
+    public void SharedKeyStatusCache_FileOfOtherUser_IsRefused()
+    {
+        if (!OperatingSystem.IsLinux())
+        {
+            return;
+        }
+
+        using (new SharedKeyStatusCache(new InMemoryKeyStatusService(), CreateOptions()))
+        {
+        }
+
+        using FileStream stream = File.OpenRead(_path);
+
+        Assert.Throws<UnauthorizedAccessException>(() => SharedKeyStatusCache.CheckAccess(stream.SafeFileHandle, uint.MaxValue - 1));
+    }
+
+    [Fact]
+    public void SharedKeyStatusCacheOptions_Path_IsPerUser()
+    {
+        string path = new SharedKeyStatusCacheOptions().Path;
+        string? runtimeDirectory = Environment.GetEnvironmentVariable("XDG_RUNTIME_DIR");
+
+        if (OperatingSystem.IsLinux() && !string.IsNullOrEmpty(runtimeDirectory))
+        {
+            Assert.Equal(Path.Combine(runtimeDirectory, "cask-key-status"), path);
+        }
+        else
+        {
+            Assert.EndsWith($"cask-key-status-{Environment.UserName}", path, StringComparison.Ordinal);
+        }
+    }
+
+    [Fact]
+    public void SharedKeyStatusCache_ConcurrentWriters_NeverTearEntries()
+    {
+        SharedKeyStatusCacheOptions options = CreateOptions();
+        options.Capacity = 8;
+        CaskKeyFingerprint[] fingerprints = Enumerable.Range(0, 32).Select(_ => CreateFingerprint()).ToArray();
+
+        using var first = new SharedKeyStatusCache(new InMemoryKeyStatusService(), options);
+        using var second = new SharedKeyStatusCache(new InMemoryKeyStatusService(), options);
+        long now = _time.GetUtcNow().UtcTicks;
+        int torn = 0;
+
+        Parallel.For(0, 8, worker =>
+        {
+            SharedKeyStatusCache cache = worker % 2 == 0 ? first : second;
+
+            for (int i = 0; i < 20_000; i++)
+            {
+                int index = (i * 7 + worker) % fingerprints.Length;
+                var expected = (KeyStatus)(index % 3);
+
+                if (worker < 4)
+                {
+                    cache.Set(fingerprints[index], expected, now);
+                }
+                else if (cache.TryGet(fingerprints[index], now, out KeyStatus status) && status != expected)
+                {
+                    Interlocked.Increment(ref torn);
+                }
+            }
+        });
+
+        Assert.Equal(0, torn);
+    }
+
+    private SharedKeyStatusCacheOptions CreateOptions()
+    {
+        return new SharedKeyStatusCacheOptions { Path = _path, Capacity = 1024, TimeProvider = _time };
+    }
+
+    private static CaskKeyFingerprint CreateFingerprint()
+    {
+        return CaskKeyFingerprint.Create(Cask.GenerateKey("TEST", 'M'));
+    }
+
+    private sealed class ManualTimeProvider : TimeProvider
+    {
+        private DateTimeOffset _now = new(2025, 1, 1, 0, 0, 0, TimeSpan.Zero);
+
+        public override DateTimeOffset GetUtcNow() => _now;
+
+        public void Advance(TimeSpan delta) => _now += delta;
+    }
+}
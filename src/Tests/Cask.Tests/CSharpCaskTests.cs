@@ -64,7 +64,10 @@ public class CSharpCaskTests : CaskTestsBase
                 ("Cask.IsCask(string)", result),
                 ("Cask.IsCask(ReadOnlySpan<char>)", CSharpCask.IsCask(key.AsSpan())),
                 ("Cask.IsCaskBytes(ReadOnlySpan<byte>)", keyBytes != null && CSharpCask.IsCaskBytes(keyBytes)),
+                ("Cask.ValidateBytes(ReadOnlySpan<byte>)", keyBytes != null && CSharpCask.ValidateBytes(keyBytes, out _) == CaskValidationError.None),
                 ("Cask.IsCaskUtf8(ReadOnlySpan<byte>)", CSharpCask.IsCaskUtf8(keyUtf8)),
+                ("Cask.Validate(ReadOnlySpan<char>)", CSharpCask.Validate(key.AsSpan(), out _) == CaskValidationError.None),
+                ("Cask.ValidateUtf8(ReadOnlySpan<byte>)", CSharpCask.ValidateUtf8(keyUtf8, out _) == CaskValidationError.None),
                 ("CaskKey.TryCreate(string)", CaskKey.TryCreate(key, out _)),
                 ("CaskKey.TryCreate(ReadOnlySpan<char>)", CaskKey.TryCreate(key.AsSpan(), out _)),
                 ("CaskKey.TryCreateUtf8(ReadOnlySpan<byte>)", CaskKey.TryCreateUtf8(keyUtf8, out _)),
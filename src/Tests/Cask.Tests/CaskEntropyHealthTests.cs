@@ -0,0 +1,179 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics.Metrics;
+using System.Security.Cryptography;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Tests;
+
+public class CaskEntropyHealthTests
+{
+    [Fact]
+    public void CaskEntropyHealth_Test_RandomEntropyPasses()
+    {
+        byte[] entropy = RandomBytes(1024 * 1024, seed: 1);
+
+        Assert.Equal(CaskEntropyHealthFailure.None, CaskEntropyHealth.Test(entropy, repetitionCountCutoff: 6, adaptiveProportionCutoff: 20));
+    }
+
+    [Theory]
+    [InlineData(0, 6)]
+    [InlineData(1, 6)]
+    [InlineData(31, 6)]
+    [InlineData(100, 4)]
+    [InlineData(1000, 40)]
+    [InlineData(4090, 6)]
+    public void CaskEntropyHealth_Test_FailsRepetitionCountAtCutoff(int position, int cutoff)
+    {
+        byte[] entropy = RandomBytes(4096, seed: position);
+
+        WriteRun(entropy, position, cutoff - 1);
+        Assert.Equal(CaskEntropyHealthFailure.None, CaskEntropyHealth.Test(entropy, cutoff, adaptiveProportionCutoff: 512));
+
+        WriteRun(entropy, position, cutoff);
+        Assert.Equal(CaskEntropyHealthFailure.RepetitionCount, CaskEntropyHealth.Test(entropy, cutoff, adaptiveProportionCutoff: 512));
+    }
+
+    [Theory]
+    [InlineData(0, 20)]
+    [InlineData(512, 20)]
+    [InlineData(1024, 10)]
+    [InlineData(1536, 200)]
+    public void CaskEntropyHealth_Test_FailsAdaptiveProportionAtCutoff(int windowStart, int cutoff)
+    {
+        byte[] entropy = RandomBytes(2048, seed: windowStart);
+        Span<byte> window = entropy.AsSpan(windowStart, 512);
+
+        // Spread the occurrences of the first byte so that they do not form
+        // runs.
+        byte value = window[0];
+        for (int i = 1; i < window.Length; i++)
+        {
+            if (window[i] == value)
+            {
+                window[i] = (byte)(value ^ 0x55);
+            }
+        }
+
+        int stride = window.Length / cutoff;
+        for (int i = 1; i < cutoff - 1; i++)
+        {
+            window[i * stride] = value;
+        }
+
+        Assert.Equal(CaskEntropyHealthFailure.None, CaskEntropyHealth.Test(entropy, repetitionCountCutoff: 6, cutoff));
+
+        window[window.Length - 1] = value;
+        Assert.Equal(CaskEntropyHealthFailure.AdaptiveProportion, CaskEntropyHealth.Test(entropy, repetitionCountCutoff: 6, cutoff));
+    }
+
+    [Theory]
+    [InlineData(CaskEntropyHealthMode.PerCall)]
+    [InlineData(CaskEntropyHealthMode.Pooled)]
+    public void CaskEntropyHealth_Fill_StuckSource_FailsClosed(CaskEntropyHealthMode mode)
+    {
+        var outcomes = new List<(string Outcome, string Reason)>();
+
+        using var meterListener = new MeterListener();
+        meterListener.InstrumentPublished = (instrument, listener) =>
+        {
+            if (instrument.Name == "cask.entropy.health.blocks")
+            {
+                listener.EnableMeasurementEvents(instrument);
+            }
+        };
+
+        int threadId = Environment.CurrentManagedThreadId;
+        meterListener.SetMeasurementEventCallback<long>((_, _, tags, _) =>
+        {
+            if (Environment.CurrentManagedThreadId == threadId)
+            {
+                outcomes.Add(((string)tags[0].Value!, (string)tags[1].Value!));
+            }
+        });
+        meterListener.Start();
+
+        CaskEntropyHealth.DiscardPool();
+        byte[] buffer = new byte[32];
+
+        using (Cask.MockFillRandom(b => b.Fill(7)))
+        {
+            Assert.Throws<CryptographicException>(() => CaskEntropyHealth.Fill(buffer, mode));
+            Assert.All(buffer, b => Assert.Equal(0, b));
+        }
+
+        // The next call draws new entropy.
+        CaskEntropyHealth.Fill(buffer, mode);
+
+        Assert.Equal([("fail", "repetition_count"), ("pass", "none")], outcomes.ToArray());
+    }
+
+    [Fact]
+    public void CaskEntropyHealth_Fill_Pooled_HandsOutEachByteOnce()
+    {
+        CaskEntropyHealth.DiscardPool();
+
+        byte[] expected = RandomBytes(2 * CaskEntropyHealth.PoolSize, seed: 2);
+        int fills = 0;
+        var actual = new List<byte>();
+
+        using (Cask.MockFillRandom(b =>
+        {
+            expected.AsSpan(fills * CaskEntropyHealth.PoolSize, b.Length).CopyTo(b);
+            fills++;
+        }))
+        {
+            byte[] buffer = new byte[32];
+
+            for (int i = 0; i < expected.Length / buffer.Length; i++)
+            {
+                CaskEntropyHealth.Fill(buffer, CaskEntropyHealthMode.Pooled);
+                actual.AddRange(buffer);
+            }
+        }
+
+        Assert.Equal(2, fills);
+        Assert.Equal(expected, actual.ToArray());
+
+        CaskEntropyHealth.DiscardPool();
+    }
+
+    [Fact]
+    public void CaskEntropyHealth_Settings_AreValidated()
+    {
+        Assert.Equal(CaskEntropyHealthMode.Disabled, CaskEntropyHealth.Mode);
+        Assert.Throws<ArgumentOutOfRangeException>(() => CaskEntropyHealth.Mode = (CaskEntropyHealthMode)3);
+        Assert.Throws<ArgumentOutOfRangeException>(() => CaskEntropyHealth.RepetitionCountCutoff = 1);
+        Assert.Throws<ArgumentOutOfRangeException>(() => CaskEntropyHealth.AdaptiveProportionCutoff = 1);
+        Assert.Throws<ArgumentOutOfRangeException>(() => CaskEntropyHealth.AdaptiveProportionCutoff = 513);
+
+        Assert.Equal(6, CaskEntropyHealth.RepetitionCountCutoff);
+        Assert.Equal(20, CaskEntropyHealth.AdaptiveProportionCutoff);
+    }
+
+    private static byte[] RandomBytes(int length, int seed)
+    {
+        byte[] bytes = new byte[length];
+        new Random(seed).NextBytes(bytes);
+        return bytes;
+    }
+
+    // Writes a run of a value that differs from the bytes around it.
+    private static void WriteRun(byte[] entropy, int position, int length)
+    {
+        byte value = (byte)(entropy[position] ^ 0xAA);
+        entropy.AsSpan(position, length).Fill(value);
+
+        if (position > 0 && entropy[position - 1] == value)
+        {
+            entropy[position - 1] ^= 0x0F;
+        }
+
+        if (position + length < entropy.Length && entropy[position + length] == value)
+        {
+            entropy[position + length] ^= 0x0F;
+        }
+    }
+}
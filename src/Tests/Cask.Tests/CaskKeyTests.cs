@@ -207,4 +207,37 @@ public class CaskKeyTests
         Assert.Throws<FormatException>(() => CaskKey.Create(invalidKeyText.AsSpan()));
         Assert.Throws<FormatException>(() => CaskKey.CreateUtf8(invalidKeyUtf8Bytes));
     }
+
+    [Theory]
+    [InlineData(SecretSize.Bits256, "")]
+    [InlineData(SecretSize.Bits512, "ROSSROSS")]
+    public void CaskKey_ProviderFields(SecretSize secretSize, string providerData)
+    {
+        CaskKey key = Cask.GenerateKey("TEST", providerKeyKind: 'R', providerData, secretSize);
+
+        Assert.Equal("TEST", key.ProviderSignature);
+        Assert.Equal('R', key.ProviderKeyKind);
+    }
+
+    [Fact]
+    public void CaskKeyFingerprint_TryCreate_MatchesCreate()
+    {
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+        string header = $"Bearer {key}";
+
+        Assert.True(CaskKeyFingerprint.TryCreate(header.AsSpan(7), out CaskKeyFingerprint fingerprint));
+        Assert.Equal(CaskKeyFingerprint.Create(key), fingerprint);
+        Assert.False(CaskKeyFingerprint.TryCreate(header.AsSpan(), out _));
+    }
+
+    [Fact]
+    public void CaskKeyFingerprint_TryCreateUtf8_MatchesCreate()
+    {
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+        byte[] keyUtf8 = Encoding.UTF8.GetBytes(key.ToString());
+
+        Assert.True(CaskKeyFingerprint.TryCreateUtf8(keyUtf8, out CaskKeyFingerprint fingerprint));
+        Assert.Equal(CaskKeyFingerprint.Create(key), fingerprint);
+        Assert.False(CaskKeyFingerprint.TryCreateUtf8(keyUtf8.AsSpan(1), out _));
+    }
 }
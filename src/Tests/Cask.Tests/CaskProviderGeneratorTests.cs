@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Collections.Immutable;
+
+using CommonAnnotatedSecurityKeys.Generators;
+
+using Microsoft.CodeAnalysis;
+using Microsoft.CodeAnalysis.CSharp;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Tests;
+
+public class CaskProviderGeneratorTests
+{
+    [Theory]
+    [InlineData("Key:4")]
+    [InlineData("IsValid:4")]
+    [InlineData("Region:4,GetHashCode:4")]
+    [InlineData("_key:4")]
+    public void CaskProviderGenerator_FieldNamedLikeMember_IsReported(string layout)
+    {
+        (ImmutableArray<Diagnostic> diagnostics, Compilation output) = RunGenerator(
+            $$"""
+            using CommonAnnotatedSecurityKeys;
+
+            [CaskProvider("TEST", ProviderDataLayout = "{{layout}}")]
+            public readonly partial struct LayoutKey { }
+            """);
+
+        Assert.Equal("CASK005", Assert.Single(diagnostics).Id);
+        Assert.Single(output.SyntaxTrees);
+    }
+
+    [Fact]
+    public void CaskProviderGenerator_ValidLayout_Compiles()
+    {
+        (ImmutableArray<Diagnostic> diagnostics, Compilation output) = RunGenerator(
+            """
+            using CommonAnnotatedSecurityKeys;
+
+            [CaskProvider("TEST", ProviderDataLayout = "Region:4,Keys:4")]
+            public readonly partial struct LayoutKey { }
+            """);
+
+        Assert.Empty(diagnostics);
+        Assert.Equal(2, output.SyntaxTrees.Count());
+        Assert.Empty(output.GetDiagnostics().Where(diagnostic => diagnostic.Severity == DiagnosticSeverity.Error));
+    }
+
+    private static (ImmutableArray<Diagnostic>, Compilation) RunGenerator(string source)
+    {
+        // Reference everything loaded, which includes the Cask library and,
+        // on .NET Framework, the packages it depends on for spans.
+        IEnumerable<MetadataReference> references = AppDomain.CurrentDomain.GetAssemblies()
+            .Where(assembly => !assembly.IsDynamic && assembly.Location.Length > 0)
+            .Select(assembly => MetadataReference.CreateFromFile(assembly.Location));
+
+        var compilation = CSharpCompilation.Create(
+            "LayoutTest",
+            [CSharpSyntaxTree.ParseText(source)],
+            references,
+            new CSharpCompilationOptions(OutputKind.DynamicallyLinkedLibrary, allowUnsafe: true));
+
+        CSharpGeneratorDriver.Create(new CaskProviderGenerator())
+            .RunGeneratorsAndUpdateCompilation(compilation, out Compilation output, out ImmutableArray<Diagnostic> diagnostics);
+
+        return (diagnostics, output);
+    }
+}
@@ -0,0 +1,167 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Text;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Tests;
+
+// Character offsets of a TestProviderKey (80 characters):
+//
+//   [51]      provider key kind
+//   [52..56]  provider signature ('TEST')
+//   [56..58]  Version ('AC')
+//   [58..63]  Region
+//   [63..68]  Tenant
+//   [68..72]  Reserved ('AAAA')
+//   [72..80]  reserved ('AA') and timestamp
+[CaskProvider("TEST", Kinds = "AM", ProviderDataLayout = "Version=AC,Region:5,Tenant:5,Reserved=AAAA")]
+public readonly partial struct TestProviderKey { }
+
+[CaskProvider("TEST", SecretSize = SecretSize.Bits512)]
+public readonly partial struct TestProvider512Key { }
+
+public class CaskProviderTests
+{
+    [Fact]
+    public void CaskProvider_Generate_Basic()
+    {
+        TestProviderKey key = TestProviderKey.Generate('M', "abcde", "fghij");
+        string text = key.ToString();
+
+        Assert.Equal(80, text.Length);
+        Assert.Equal('M', key.ProviderKeyKind);
+        Assert.Equal("abcde", key.Region.ToString());
+        Assert.Equal("fghij", key.Tenant.ToString());
+        Assert.Equal("TEST", TestProviderKey.ProviderSignature);
+        Assert.Equal(SecretSize.Bits256, key.Key.SecretSize);
+        Assert.Equal("ACabcdefghijAAAA", text[56..72]);
+
+        Assert.True(Cask.IsCask(text));
+        Assert.True(TestProviderKey.IsValid(text));
+        Assert.True(TestProviderKey.IsValidUtf8(Encoding.UTF8.GetBytes(text)));
+    }
+
+    [Fact]
+    public void CaskProvider_Generate_512()
+    {
+        TestProvider512Key key = TestProvider512Key.Generate('Z');
+
+        Assert.Equal(SecretSize.Bits512, key.Key.SecretSize);
+        Assert.Equal('Z', key.ProviderKeyKind);
+        Assert.True(TestProvider512Key.IsValid(key.ToString()));
+        Assert.False(TestProviderKey.IsValid(key.ToString()));
+    }
+
+    [Fact]
+    public void CaskProvider_Generate_InvalidKind()
+    {
+        Assert.Throws<ArgumentOutOfRangeException>(() => TestProviderKey.Generate('B', "abcde", "fghij"));
+    }
+
+    [Theory]
+    [InlineData("abcd", "fghij")]
+    [InlineData("abcde", "fghijk")]
+    [InlineData("abc*e", "fghij")]
+    public void CaskProvider_Generate_InvalidField(string region, string tenant)
+    {
+        Assert.ThrowsAny<ArgumentException>(() => TestProviderKey.Generate('A', region, tenant));
+    }
+
+    [Fact]
+    public void CaskProvider_Create_RoundTrip()
+    {
+        TestProviderKey key = TestProviderKey.Generate('A', "abcde", "fghij");
+        string text = key.ToString();
+
+        Assert.True(TestProviderKey.TryCreate(text, out TestProviderKey fromString));
+        Assert.True(TestProviderKey.TryCreate(text.AsSpan(), out TestProviderKey fromSpan));
+        Assert.True(TestProviderKey.TryCreateUtf8(Encoding.UTF8.GetBytes(text), out TestProviderKey fromUtf8));
+
+        Assert.Equal(key, fromString);
+        Assert.Equal(key, fromSpan);
+        Assert.Equal(key, fromUtf8);
+        Assert.Equal(key, TestProviderKey.Create(text));
+        Assert.Equal(key.Key, (CaskKey)fromString);
+    }
+
+    [Theory]
+    [InlineData("ABCD", 'M', "ACabcdefghijAAAA")] // Other provider signature.
+    [InlineData("TEST", 'B', "ACabcdefghijAAAA")] // Kind not allowed.
+    [InlineData("TEST", 'M', "ADabcdefghijAAAA")] // Other version.
+    [InlineData("TEST", 'M', "ACabcdefghijAAAB")] // Reserved field not 'AAAA'.
+    [InlineData("TEST", 'M', "ACabcdefghij")]     // Other provider data length.
+    public void CaskProvider_IsValid_OtherLayout(string providerSignature, char providerKeyKind, string providerData)
+    {
+        string text = Cask.GenerateKey(providerSignature, providerKeyKind, providerData).ToString();
+
+        Assert.True(Cask.IsCask(text));
+        Assert.False(TestProviderKey.IsValid(text));
+        Assert.False(TestProviderKey.IsValidUtf8(Encoding.UTF8.GetBytes(text)));
+        Assert.False(TestProviderKey.TryCreate(text, out _));
+        Assert.Throws<FormatException>(() => TestProviderKey.Create(text));
+    }
+
+    [Fact]
+    public void CaskProvider_IsValid_MatchesReference()
+    {
+        string valid = TestProviderKey.Generate('M', "abcde", "fghij").ToString();
+
+        // Every single-character change must be judged the same as by
+        // Cask.IsCask followed by the provider checks done as string
+        // comparisons.
+        AssertEveryChangeMatches(valid, text => Cask.IsCask(text) &&
+                                                text[51] is 'A' or 'M' &&
+                                                text[52..56] == "TEST" &&
+                                                text[56..58] == "AC" &&
+                                                text[68..72] == "AAAA",
+                                 text => TestProviderKey.IsValid(text),
+                                 text => TestProviderKey.IsValidUtf8(Encoding.UTF8.GetBytes(text)));
+    }
+
+    [Fact]
+    public void CaskProvider_IsValid_512_MatchesReference()
+    {
+        string valid = TestProvider512Key.Generate('Z').ToString();
+
+        AssertEveryChangeMatches(valid, text => Cask.IsCask(text) && text[96..100] == "TEST",
+                                 text => TestProvider512Key.IsValid(text),
+                                 text => TestProvider512Key.IsValidUtf8(Encoding.UTF8.GetBytes(text)));
+    }
+
+    [Fact]
+    public void CaskProvider_Uninitialized_Throws()
+    {
+        TestProviderKey key = default;
+
+        Assert.False(key.IsInitialized);
+        Assert.Throws<InvalidOperationException>(() => key.ToString());
+        Assert.Throws<InvalidOperationException>(() => key.ProviderKeyKind);
+        Assert.Throws<InvalidOperationException>(() => key.Region.ToString());
+        Assert.Throws<InvalidOperationException>(() => key.Tenant.ToString());
+    }
+
+    private static void AssertEveryChangeMatches(string valid, Func<string, bool> expected, params Func<string, bool>[] actual)
+    {
+        // Every ASCII character and one that is not, at every offset, so
+        // that the alphabet, padding and timestamp ranges are all covered.
+        string replacements = new(Enumerable.Range(0, 128).Select(c => (char)c).Append('\u00E9').ToArray());
+
+        for (int i = 0; i < valid.Length; i++)
+        {
+            foreach (char c in replacements)
+            {
+                char[] chars = valid.ToCharArray();
+                chars[i] = c;
+                string text = new(chars);
+                bool isValid = expected(text);
+
+                foreach (Func<string, bool> isValidGenerated in actual)
+                {
+                    Assert.True(isValid == isValidGenerated(text), $"Offset {i}, character U+{(int)c:X4}: expected {isValid}.");
+                }
+            }
+        }
+    }
+}
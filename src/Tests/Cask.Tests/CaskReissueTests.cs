@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Text;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Tests;
+
+public class CaskReissueTests
+{
+    private static readonly DateTimeOffset s_issued = new(2025, 3, 4, 5, 6, 7, TimeSpan.Zero);
+    private static readonly DateTimeOffset s_reissued = new(2026, 10, 18, 19, 20, 21, TimeSpan.Zero);
+
+    [Fact]
+    public void Cask_Reissue_KeepsFixedPartsWithNewSecretAndTime()
+    {
+        CaskKey[] oldKeys = CreateKeys();
+        var freshKeys = new CaskKey[oldKeys.Length];
+
+        using (Cask.MockUtcNow(() => s_reissued))
+        {
+            Cask.Reissue(oldKeys, freshKeys);
+        }
+
+        for (int i = 0; i < oldKeys.Length; i++)
+        {
+            AssertReissued(oldKeys[i].ToString(), freshKeys[i].ToString());
+        }
+    }
+
+    [Fact]
+    public void Cask_Reissue_ValidatesArguments()
+    {
+        CaskKey[] oldKeys = CreateKeys();
+
+        Assert.Throws<ArgumentException>("freshKeys", () => Cask.Reissue(oldKeys, new CaskKey[oldKeys.Length - 1]));
+        Assert.Throws<ArgumentException>("oldKeys", () => Cask.Reissue([oldKeys[0], default], new CaskKey[2]));
+    }
+
+    [Fact]
+    public void Cask_ReissueUtf8_ReplacesKeysInPlaceAndKeepsLines()
+    {
+        CaskKey[] oldKeys = CreateKeys();
+        string oldText = string.Join("\r\n", oldKeys.Select(key => key.ToString())) + "\n\n";
+        byte[] text = Encoding.UTF8.GetBytes(oldText);
+
+        using (Cask.MockUtcNow(() => s_reissued))
+        {
+            Assert.Equal(oldKeys.Length, Cask.ReissueUtf8(text, text));
+        }
+
+        string[] oldLines = oldText.Split('\n');
+        string[] freshLines = Encoding.UTF8.GetString(text).Split('\n');
+        Assert.Equal(oldLines.Length, freshLines.Length);
+
+        for (int i = 0; i < oldKeys.Length; i++)
+        {
+            AssertReissued(oldLines[i].TrimEnd('\r'), freshLines[i].TrimEnd('\r'));
+            Assert.Equal(oldLines[i][^1] == '\r', freshLines[i][^1] == '\r');
+        }
+    }
+
+    [Fact]
+    public void Cask_ReissueUtf8_InvalidLine_Throws()
+    {
+        string key = Cask.GenerateKey("TEST", 'M').ToString();
+        byte[] text = Encoding.UTF8.GetBytes($"{key}\nnot a key\n");
+
+        FormatException ex = Assert.Throws<FormatException>(() => Cask.ReissueUtf8(text, new byte[text.Length]));
+        Assert.Contains("Line 2", ex.Message, StringComparison.Ordinal);
+    }
+
+    [Fact]
+    public void Cask_Reissue_Stream_ReissuesEveryLine()
+    {
+        var oldKeys = new List<string>();
+        for (int i = 0; i < 5000; i++)
+        {
+            oldKeys.AddRange(CreateKeys().Select(key => key.ToString()));
+        }
+
+        // No final newline, and more than one block of text.
+        using var source = new MemoryStream(Encoding.UTF8.GetBytes(string.Join("\n", oldKeys)));
+        using var destination = new MemoryStream();
+
+        using (Cask.MockUtcNow(() => s_reissued))
+        {
+            Assert.Equal(oldKeys.Count, Cask.Reissue(source, destination));
+        }
+
+        Assert.Equal(source.Length, destination.Length);
+        string[] freshKeys = Encoding.UTF8.GetString(destination.ToArray()).Split('\n');
+        Assert.Equal(oldKeys.Count, freshKeys.Length);
+
+        for (int i = 0; i < oldKeys.Count; i++)
+        {
+            AssertReissued(oldKeys[i], freshKeys[i]);
+        }
+    }
+
+    private static CaskKey[] CreateKeys()
+    {
+        using Mock mock = Cask.MockUtcNow(() => s_issued);
+
+        return [
+            Cask.GenerateKey("TEST", 'M'),
+            Cask.GenerateKey("ABCD", 'x', "abcd0123", SecretSize.Bits256),
+            Cask.GenerateKey("TEST", '-', secretSize: SecretSize.Bits512),
+            Cask.GenerateKey("Z_9-", 'Q', new string('p', 40), SecretSize.Bits512),
+        ];
+    }
+
+    private static void AssertReissued(string oldKey, string freshKey)
+    {
+        CaskKey old = CaskKey.Create(oldKey);
+        CaskKey fresh = CaskKey.Create(freshKey);
+        int secretLength = old.SecretSize == SecretSize.Bits512 ? 88 : 44;
+
+        Assert.Equal(old.ProviderSignature, fresh.ProviderSignature);
+        Assert.Equal(old.ProviderKeyKind, fresh.ProviderKeyKind);
+        Assert.Equal(old.SecretSize, fresh.SecretSize);
+        Assert.Equal(oldKey.Length, freshKey.Length);
+        Assert.Equal(oldKey[secretLength..^6], freshKey[secretLength..^6]);
+        Assert.NotEqual(oldKey[..secretLength], freshKey[..secretLength]);
+        Assert.Equal(s_issued, old.Timestamp);
+        Assert.Equal(s_reissued, fresh.Timestamp);
+    }
+}
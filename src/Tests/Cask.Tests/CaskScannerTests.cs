@@ -0,0 +1,277 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Text;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Tests;
+
+public class CaskScannerTests
+{
+    [Theory]
+    [InlineData(SecretSize.Bits256, "")]
+    [InlineData(SecretSize.Bits256, "ACabcdefghijAAAA")]
+    [InlineData(SecretSize.Bits512, "")]
+    [InlineData(SecretSize.Bits512, "abcdefghijklmnopqrstuvwxyz0123456789-_AA")]
+    public void CaskScanner_ScanUtf8_FindsKey(SecretSize secretSize, string providerData)
+    {
+        string key = Cask.GenerateKey("TEST", 'M', providerData, secretSize).ToString();
+        byte[] text = Encoding.UTF8.GetBytes($"secret = \"{key}\"\n");
+
+        var matches = new List<CaskMatch>();
+        Assert.Equal(1, CaskScanner.ScanUtf8(text, matches));
+
+        CaskMatch match = Assert.Single(matches);
+        Assert.Equal(10, match.Offset);
+        Assert.Equal(key, match.Key.ToString());
+    }
+
+    [Theory]
+    [InlineData("{0}", 1)]
+    [InlineData("{0} {0}", 2)]
+    [InlineData("{0}\n{0}", 2)]
+    [InlineData("x{0}", 0)]
+    [InlineData("{0}x", 0)]
+    [InlineData("+{0}", 0)]
+    [InlineData("{0}/", 0)]
+    [InlineData("-{0}", 0)]
+    [InlineData("{0}_", 0)]
+    [InlineData("{0}{0}", 0)]
+    [InlineData("=={0}==", 1)]
+    public void CaskScanner_ScanUtf8_RequiresDelimiters(string format, int expectedCount)
+    {
+        string key = Cask.GenerateKey("TEST", 'M', "ACabcdefghijAAAA").ToString();
+        string text = string.Format(null, format, key);
+
+        var matches = new List<CaskMatch>();
+        Assert.Equal(expectedCount, CaskScanner.ScanUtf8(Encoding.UTF8.GetBytes(text), matches));
+    }
+
+    [Fact]
+    public void CaskScanner_ScanUtf8_RejectsInvalidKey()
+    {
+        char[] key = Cask.GenerateKey("TEST", 'M').ToString().ToCharArray();
+        key[^3] = '~';
+
+        var matches = new List<CaskMatch>();
+        Assert.Equal(0, CaskScanner.ScanUtf8(Encoding.UTF8.GetBytes($" {new string(key)} "), matches));
+        Assert.Empty(matches);
+    }
+
+    [Fact]
+    public void CaskScanner_ScanUtf8_MatchesRegex()
+    {
+        string text = CreateText(keyCount: 50, seed: 42);
+        byte[] textUtf8 = Encoding.UTF8.GetBytes(text);
+
+        var matches = new List<CaskMatch>();
+        CaskScanner.ScanUtf8(textUtf8, matches);
+
+        // The regex includes the delimiters in the match.
+        string[] expected = [.. CaskKey.Regex.Matches(text).Select(m => m.Value.Trim(' ', '\n', '"', '='))];
+        string[] actual = [.. matches.Select(m => m.Key.ToString())];
+
+        Assert.Equal(50, actual.Length);
+        Assert.Equal(expected, actual);
+        Assert.All(matches, m => Assert.Equal(m.Key.ToString(), text.Substring((int)m.Offset, m.Key.ToString().Length)));
+    }
+
+    [Fact]
+    public void CaskScanner_Streaming_FindsKeysAcrossBoundaries()
+    {
+        string text = CreateText(keyCount: 20, seed: 7);
+        byte[] textUtf8 = Encoding.UTF8.GetBytes(text);
+
+        var expected = new List<CaskMatch>();
+        CaskScanner.ScanUtf8(textUtf8, expected);
+        Assert.Equal(20, expected.Count);
+
+        var scanner = new CaskScanner();
+
+        foreach (int chunkSize in new[] { 1, 2, 3, 7, 43, 44, 64, 100, 141, 142, 143, 150, 256, 1000, textUtf8.Length })
+        {
+            var actual = new List<CaskMatch>();
+            scanner.Reset();
+
+            for (int i = 0; i < textUtf8.Length; i += chunkSize)
+            {
+                int length = Math.Min(chunkSize, textUtf8.Length - i);
+                scanner.ScanUtf8(textUtf8.AsSpan(i, length), isFinalBlock: false, actual);
+            }
+
+            scanner.ScanUtf8([], isFinalBlock: true, actual);
+
+            Assert.Equal(textUtf8.Length, scanner.Position);
+            Assert.Equal(expected.ToArray(), actual.ToArray());
+        }
+    }
+
+    [Fact]
+    public void CaskScanner_Streaming_KeyAtEndOfBufferIsDeferred()
+    {
+        byte[] key = Encoding.UTF8.GetBytes(Cask.GenerateKey("TEST", 'M').ToString());
+        var scanner = new CaskScanner();
+        var matches = new List<CaskMatch>();
+
+        // The key could continue in the next buffer.
+        Assert.Equal(0, scanner.ScanUtf8(key, isFinalBlock: false, matches));
+
+        // It doesn't.
+        Assert.Equal(1, scanner.ScanUtf8("\n"u8, isFinalBlock: false, matches));
+        Assert.Equal(0, Assert.Single(matches).Offset);
+
+        // Now it's at the end of the stream.
+        matches.Clear();
+        scanner.Reset();
+        Assert.Equal(0, scanner.ScanUtf8(key, isFinalBlock: false, matches));
+        Assert.Equal(1, scanner.ScanUtf8([], isFinalBlock: true, matches));
+
+        // But here it continues.
+        matches.Clear();
+        scanner.Reset();
+        Assert.Equal(0, scanner.ScanUtf8(key, isFinalBlock: false, matches));
+        Assert.Equal(0, scanner.ScanUtf8("A"u8, isFinalBlock: true, matches));
+    }
+
+    [Fact]
+    public void CaskScanner_Streaming_ThrowsAfterFinalBlock()
+    {
+        var scanner = new CaskScanner();
+        var matches = new List<CaskMatch>();
+
+        scanner.ScanUtf8("text"u8, isFinalBlock: true, matches);
+        Assert.Throws<InvalidOperationException>(() => scanner.ScanUtf8("more"u8, isFinalBlock: false, matches));
+
+        scanner.Reset();
+        scanner.ScanUtf8("more"u8, isFinalBlock: false, matches);
+        Assert.Equal(4, scanner.Position);
+    }
+
+    [Fact]
+    public void CaskScanner_ScanManyUtf8_MapsKeysToCells()
+    {
+        string key = Cask.GenerateKey("TEST", 'M').ToString();
+
+        // Cells are delimited by their boundaries even when the neighboring
+        // cell continues with base64 characters, and a key that is split
+        // between cells is not found.
+        (byte[] data, int[] offsets) = Pack(["", $"id {key}", "no key", key, "x", "", key[..40], key[40..], $"{key} {key}"]);
+
+        var matches = new List<CaskCellMatch>();
+        Assert.Equal(4, CaskScanner.ScanManyUtf8(data, offsets, matches));
+
+        Assert.Equal([1, 3, 8, 8], matches.Select(m => m.Cell).ToArray());
+        Assert.Equal([3, 0, 0, key.Length + 1], matches.Select(m => m.Offset).ToArray());
+        Assert.All(matches, m => Assert.Equal(key, m.Key.ToString()));
+    }
+
+    [Fact]
+    public void CaskScanner_ScanManyUtf8_ParallelMatchesSequential()
+    {
+        var random = new Random(7);
+        string key = Cask.GenerateKey("TEST", 'M').ToString();
+        var cells = new List<string>();
+
+        for (int i = 0; i < 40_000; i++)
+        {
+            string filler = new((char)('a' + random.Next(26)), random.Next(10, 200));
+            cells.Add(random.Next(100) == 0 ? $"{filler} {key}" : filler);
+        }
+
+        (byte[] data, int[] offsets) = Pack(cells);
+
+        var sequential = new List<CaskCellMatch>();
+        var parallel = new List<CaskCellMatch>();
+        int count = CaskScanner.ScanManyUtf8(data, offsets, sequential);
+
+        Assert.Equal(count, CaskScanner.ScanManyUtf8(data, offsets, parallel, new ParallelOptions()));
+        Assert.Equal(sequential.ToArray(), parallel.ToArray());
+        Assert.True(count > 0);
+    }
+
+    [Fact]
+    public void CaskScanner_ScanManyUtf8_ValidatesOffsets()
+    {
+        var matches = new List<CaskCellMatch>();
+
+        Assert.Throws<ArgumentException>("offsets", () => CaskScanner.ScanManyUtf8("abc"u8, [0, 2, 1], matches));
+        Assert.Throws<ArgumentException>("offsets", () => CaskScanner.ScanManyUtf8("abc"u8, [0, 4], matches));
+        Assert.Equal(0, CaskScanner.ScanManyUtf8("abc"u8, [], matches));
+    }
+
+    [Theory]
+    [InlineData(SecretSize.Bits256, "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA")]
+    [InlineData(SecretSize.Bits256, "abcdefghijklmnopqrstuvwxyz0123456789-_ABCD")]
+    [InlineData(SecretSize.Bits256, "EXAMPLEKEYEXAMPLEKEYEXAMPLEKEYEXAMPLEKEYEX")]
+    [InlineData(SecretSize.Bits256, "Kp3xQ9vTz2LmW7yRb5NcA8dHfJ4gU6sYe1AAAAAAAA")]
+    [InlineData(SecretSize.Bits512, "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx")]
+    public void CaskScanner_ScanUtf8_ClassifiesPlaceholderKeys(SecretSize secretSize, string secretChars)
+    {
+        // Replace the characters that hold only bits of the secret.
+        string generated = Cask.GenerateKey("TEST", 'M', secretSize: secretSize).ToString();
+        string key = secretChars + generated[secretChars.Length..];
+        byte[] text = Encoding.UTF8.GetBytes($"secret = \"{key}\"\n");
+
+        var matches = new List<CaskMatch>();
+        Assert.Equal(1, CaskScanner.ScanUtf8(text, matches));
+        Assert.True(matches[0].IsLikelyPlaceholder);
+
+        var cellMatches = new List<CaskCellMatch>();
+        Assert.Equal(1, CaskScanner.ScanManyUtf8(text, [0, text.Length], cellMatches));
+        Assert.True(cellMatches[0].IsLikelyPlaceholder);
+    }
+
+    [Fact]
+    public void CaskScanner_ScanUtf8_ClassifiesGeneratedKeysAsReal()
+    {
+        var matches = new List<CaskMatch>();
+        byte[] text = Encoding.UTF8.GetBytes(CreateText(keyCount: 10_000, seed: 99));
+
+        CaskScanner.ScanUtf8(text, matches);
+
+        Assert.Equal(10_000, matches.Count);
+        Assert.DoesNotContain(matches, match => match.IsLikelyPlaceholder);
+    }
+
+    private static (byte[] Data, int[] Offsets) Pack(IReadOnlyList<string> cells)
+    {
+        var data = new List<byte>();
+        int[] offsets = new int[cells.Count + 1];
+
+        for (int i = 0; i < cells.Count; i++)
+        {
+            data.AddRange(Encoding.UTF8.GetBytes(cells[i]));
+            offsets[i + 1] = data.Count;
+        }
+
+        return (data.ToArray(), offsets);
+    }
+
+    /// <summary>
+    /// Creates text that resembles a config file with keys of both sizes and
+    /// with every provider data length, including decoys that have the CASK
+    /// signature but are not keys.
+    /// </summary>
+    private static string CreateText(int keyCount, int seed)
+    {
+        var random = new Random(seed);
+        var text = new StringBuilder();
+
+        for (int i = 0; i < keyCount; i++)
+        {
+            SecretSize secretSize = random.Next(2) == 0 ? SecretSize.Bits256 : SecretSize.Bits512;
+            string providerData = new('x', 4 * random.Next(11));
+            string key = Cask.GenerateKey("TEST", 'M', providerData, secretSize).ToString();
+
+            text.Append("setting").Append(i).Append(" = 12345 QJJQ QJJQAB ");
+            text.Append(random.Next(3) switch { 0 => "\"", 1 => "=", _ => "\n" });
+            text.Append(key);
+            text.Append(random.Next(2) == 0 ? "\"" : "\n");
+            text.Append(new string('-', random.Next(200)));
+            text.Append('\n');
+        }
+
+        return text.ToString();
+    }
+}
@@ -0,0 +1,146 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics.Metrics;
+using System.Diagnostics.Tracing;
+using System.Text;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Tests;
+
+public class CaskShadowValidationTests
+{
+    [Theory]
+    [InlineData(SecretSize.Bits256, "")]
+    [InlineData(SecretSize.Bits256, "abcdefghijklmnopqrstuvwxyz0123456789-_AA")]
+    [InlineData(SecretSize.Bits512, "")]
+    [InlineData(SecretSize.Bits512, "ACE6ioWU3a0MAAAA")]
+    public void CaskReferenceValidator_AgreesWithCask_OnKeysAndMutations(SecretSize secretSize, string providerData)
+    {
+        string key = Cask.GenerateKey("TEST", 'M', providerData, secretSize).ToString();
+        var random = new Random(key.Length);
+
+        AssertAgrees(key);
+
+        // Every character replaced with a random other character, which
+        // covers every kind of validation error.
+        for (int i = 0; i < key.Length; i++)
+        {
+            char[] chars = key.ToCharArray();
+            chars[i] = "AQgw_-=~é"[random.Next(9)];
+            AssertAgrees(new string(chars));
+        }
+
+        // Truncated and extended, so that the length implies another secret
+        // size or provider data size.
+        for (int length = 0; length <= key.Length + 48; length += 4)
+        {
+            AssertAgrees(length <= key.Length ? key[..length] : key + new string('A', length - key.Length));
+        }
+    }
+
+    [Fact]
+    public void CaskShadowValidation_Check_ReportsMismatchWithFingerprint()
+    {
+        string key = Cask.GenerateKey("TEST", 'M').ToString();
+        string expected = CaskKeyFingerprint.Compute(Encoding.UTF8.GetBytes(key)).ToString();
+        var outcomes = new List<string>();
+
+        using var meterListener = new MeterListener();
+        meterListener.InstrumentPublished = (instrument, listener) =>
+        {
+            if (instrument.Name == "cask.validation.shadow.checks")
+            {
+                listener.EnableMeasurementEvents(instrument);
+            }
+        };
+
+        int threadId = Environment.CurrentManagedThreadId;
+        meterListener.SetMeasurementEventCallback<long>((_, _, tags, _) =>
+        {
+            if (Environment.CurrentManagedThreadId == threadId)
+            {
+                outcomes.Add((string)tags[0].Value!);
+            }
+        });
+        meterListener.Start();
+
+        using var eventListener = new MismatchListener();
+
+        // A fast path that got it right, and one that got it wrong.
+        CaskShadowValidation.Check(key.AsSpan(), CaskValidationError.None);
+        CaskShadowValidation.Check(key.AsSpan(), CaskValidationError.InvalidTimestamp);
+
+        Assert.Equal(["match", "mismatch"], outcomes.ToArray());
+
+        EventWrittenEventArgs mismatch = Assert.Single(eventListener.Events.Where(e => (string)e.Payload![0]! == expected));
+        Assert.Equal(EventLevel.Warning, mismatch.Level);
+        Assert.Equal((int)CaskValidationError.InvalidTimestamp, (int)mismatch.Payload![1]!);
+        Assert.True((bool)mismatch.Payload[2]!);
+    }
+
+    [Fact]
+    public void CaskShadowValidation_SamplingInterval_RoundsUpToPowerOfTwo()
+    {
+        int original = CaskShadowValidation.SamplingInterval;
+
+        try
+        {
+            CaskShadowValidation.SamplingInterval = 5;
+            Assert.Equal(8, CaskShadowValidation.SamplingInterval);
+
+            CaskShadowValidation.SamplingInterval = 1;
+            Assert.Equal(1, CaskShadowValidation.SamplingInterval);
+            Assert.True(CaskShadowValidation.ShouldSample());
+
+            CaskShadowValidation.SamplingInterval = 0;
+            Assert.Equal(0, CaskShadowValidation.SamplingInterval);
+            Assert.False(CaskShadowValidation.ShouldSample());
+
+            Assert.Throws<ArgumentOutOfRangeException>(() => CaskShadowValidation.SamplingInterval = -1);
+        }
+        finally
+        {
+            CaskShadowValidation.SamplingInterval = original;
+        }
+    }
+
+    private static void AssertAgrees(string text)
+    {
+        byte[] utf8 = Encoding.UTF8.GetBytes(text);
+
+        Assert.Equal(Cask.IsCask(text), CaskReferenceValidator.IsCask(text.AsSpan()));
+        Assert.Equal(Cask.IsCaskUtf8(utf8), CaskReferenceValidator.IsCaskUtf8(utf8));
+
+        if (text.Length % 4 == 0 && text.All(c => c < 0x80 && Helpers.IsValidForBase64Url(c)))
+        {
+            byte[] bytes = Convert.FromBase64String(text.Replace('-', '+').Replace('_', '/'));
+            Assert.Equal(Cask.IsCaskBytes(bytes), CaskReferenceValidator.IsCaskBytes(bytes));
+        }
+    }
+
+    private sealed class MismatchListener : EventListener
+    {
+        public List<EventWrittenEventArgs> Events { get; } = [];
+
+        protected override void OnEventSourceCreated(EventSource eventSource)
+        {
+            if (eventSource.Name == CaskTelemetry.Name)
+            {
+                EnableEvents(eventSource, EventLevel.Warning);
+            }
+        }
+
+        protected override void OnEventWritten(EventWrittenEventArgs eventData)
+        {
+            if (eventData.EventName == "ShadowValidationMismatch")
+            {
+                lock (Events)
+                {
+                    Events.Add(eventData);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,110 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Buffers.Text;
+using System.Text;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Tests;
+
+public class CaskValidationTests
+{
+    // A 256-bit key with 3 bytes of provider data and the earliest possible
+    // timestamp. Character offsets of interest:
+    //
+    //   [..42]   sensitive data
+    //   [42]     sensitive data with two trailing zero bits ('8')
+    //   [43]     padding ('A')
+    //   [44..48] CASK signature ('QJJQ')
+    //   [48..52] reserved, secret size, provider data size, provider kind
+    //   [52..56] provider signature ('TEST')
+    //   [56..60] provider data ('ABCD')
+    //   [60..62] reserved ('AA')
+    //   [62..68] year, month, day, hour, minute, second
+    private const string ValidKey = "__________________________________________8AQJJQABBMTESTABCDAAAAAAAA";
+
+    [Fact]
+    public void Validate_ValidKey()
+    {
+        AssertValidation(ValidKey, CaskValidationError.None, expectedOffset: 0, expectedByteOffset: 0);
+    }
+
+    [Theory]
+    [InlineData(43, 'B', CaskValidationError.InvalidPadding, 42, 32)]
+    [InlineData(44, 'R', CaskValidationError.InvalidCaskSignature, 44, 33)]
+    [InlineData(48, 'B', CaskValidationError.InvalidPadding, 48, 36)]
+    [InlineData(49, 'C', CaskValidationError.SecretSizeMismatch, 49, 36)]
+    [InlineData(50, 'C', CaskValidationError.ProviderDataSizeMismatch, 50, 37)]
+    [InlineData(60, 'B', CaskValidationError.InvalidPadding, 60, 45)]
+    [InlineData(61, 'B', CaskValidationError.InvalidPadding, 61, 45)]
+    [InlineData(63, 'M', CaskValidationError.InvalidTimestamp, 63, 47)]
+    [InlineData(64, 'f', CaskValidationError.InvalidTimestamp, 64, 48)]
+    [InlineData(65, 'Y', CaskValidationError.InvalidTimestamp, 65, 48)]
+    [InlineData(66, '8', CaskValidationError.InvalidTimestamp, 66, 49)]
+    [InlineData(67, '9', CaskValidationError.InvalidTimestamp, 67, 50)]
+    public void Validate_InvalidField(int index, char replacement, CaskValidationError expectedError, int expectedOffset, int expectedByteOffset)
+    {
+        char[] key = ValidKey.ToCharArray();
+        key[index] = replacement;
+
+        AssertValidation(new string(key), expectedError, expectedOffset, expectedByteOffset);
+    }
+
+    [Theory]
+    [InlineData(10, '*')]
+    [InlineData(10, ' ')]
+    [InlineData(67, '=')]
+    public void Validate_InvalidCharacter(int index, char replacement)
+    {
+        char[] key = ValidKey.ToCharArray();
+        key[index] = replacement;
+
+        AssertValidation(new string(key), CaskValidationError.InvalidCharacter, index, expectedByteOffset: -1);
+    }
+
+    [Theory]
+    [InlineData("")]
+    [InlineData(ValidKey + ValidKey + ValidKey)]
+    [InlineData(ValidKey + "A")]
+    [InlineData("QJJQ")]
+    public void Validate_InvalidLength(string key)
+    {
+        AssertValidation(key, CaskValidationError.InvalidLength, expectedOffset: 0, expectedByteOffset: -1);
+    }
+
+    [Fact]
+    public void Validate_InvalidLength_Bytes()
+    {
+        byte[] decoded = Base64Url.DecodeFromChars(ValidKey.AsSpan());
+
+        CaskValidationError error = Cask.ValidateBytes(decoded.AsSpan()[..^1], out int errorOffset);
+
+        Assert.Equal(CaskValidationError.InvalidLength, error);
+        Assert.Equal(0, errorOffset);
+    }
+
+    private static void AssertValidation(string key, CaskValidationError expectedError, int expectedOffset, int expectedByteOffset)
+    {
+        CaskValidationError error = Cask.Validate(key, out int errorOffset);
+        Assert.Equal(expectedError, error);
+        Assert.Equal(expectedOffset, errorOffset);
+        Assert.Equal(error == CaskValidationError.None, Cask.IsCask(key));
+
+        error = Cask.ValidateUtf8(Encoding.UTF8.GetBytes(key), out errorOffset);
+        Assert.Equal(expectedError, error);
+        Assert.Equal(expectedOffset, errorOffset);
+
+        if (expectedByteOffset < 0)
+        {
+            // The text cannot be decoded to a key-length byte sequence.
+            return;
+        }
+
+        byte[] decoded = Base64Url.DecodeFromChars(key.AsSpan());
+        error = Cask.ValidateBytes(decoded, out errorOffset);
+        Assert.Equal(expectedError, error);
+        Assert.Equal(expectedByteOffset, errorOffset);
+        Assert.Equal(error == CaskValidationError.None, Cask.IsCaskBytes(decoded));
+    }
+}
@@ -0,0 +1,146 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Tests;
+
+public class KeyExpirySchedulerTests
+{
+    private static readonly DateTimeOffset s_start = new(2026, 3, 14, 15, 9, 26, TimeSpan.Zero);
+
+    [Theory]
+    [InlineData(SecretSize.Bits256, "")]
+    [InlineData(SecretSize.Bits256, "ACE6ioWU3a0MAAAA")]
+    [InlineData(SecretSize.Bits512, "abcdefghijklmnopqrstuvwxyz0123456789-_AA")]
+    public void CaskKey_Timestamp_IsGenerationTime(SecretSize secretSize, string providerData)
+    {
+        using Mock mock = Cask.MockUtcNow(() => s_start);
+        CaskKey key = Cask.GenerateKey("TEST", 'M', providerData, secretSize);
+
+        Assert.Equal(s_start, key.Timestamp);
+    }
+
+    [Fact]
+    public void KeyExpiryScheduler_Add_ExpiresKeyAtMaxAge()
+    {
+        CaskKey key;
+        using (Cask.MockUtcNow(() => s_start))
+        {
+            key = Cask.GenerateKey("TEST", 'M');
+        }
+
+        var scheduler = new KeyExpiryScheduler(TimeSpan.FromDays(90), s_start);
+        Assert.True(scheduler.Add(key));
+        Assert.False(scheduler.Add(key));
+
+        var expired = new List<CaskKeyFingerprint>();
+        Assert.Equal(0, scheduler.Advance(s_start.AddDays(90).AddSeconds(-1), expired.AddRange));
+        Assert.Equal(1, scheduler.Advance(s_start.AddDays(90), expired.AddRange));
+
+        Assert.Equal([CaskKeyFingerprint.Create(key)], expired.ToArray());
+        Assert.Equal(0, scheduler.Count);
+    }
+
+    [Fact]
+    public void KeyExpiryScheduler_Advance_ExpiresKeysInDeadlineOrder()
+    {
+        var scheduler = new KeyExpiryScheduler(TimeSpan.FromHours(1), s_start);
+        var random = new Random(42);
+        var deadlines = new Dictionary<CaskKeyFingerprint, DateTimeOffset>();
+
+        for (int i = 0; i < 2000; i++)
+        {
+            // Timestamps from 10 minutes before the start to 50 days after,
+            // so keys are placed at every level of the wheel.
+            DateTimeOffset timestamp = s_start.AddSeconds(random.Next(-600, 50 * 24 * 3600));
+            CaskKeyFingerprint fingerprint = CreateFingerprint(random);
+
+            Assert.True(scheduler.Add(fingerprint, timestamp));
+            deadlines.Add(fingerprint, timestamp.AddHours(1));
+        }
+
+        DateTimeOffset now = s_start;
+        int total = 0;
+
+        while (total < deadlines.Count)
+        {
+            now = now.AddSeconds(random.Next(1, 20_000));
+            total += scheduler.Advance(now, batch =>
+            {
+                foreach (CaskKeyFingerprint fingerprint in batch)
+                {
+                    Assert.True(deadlines[fingerprint] <= now);
+                }
+            });
+
+            Assert.Equal(deadlines.Count - total, scheduler.Count);
+            Assert.Equal(deadlines.Values.Count(deadline => deadline > now), scheduler.Count);
+        }
+    }
+
+    [Fact]
+    public void KeyExpiryScheduler_Advance_LongGap_SkipsEmptyTicks()
+    {
+        // Billions of millisecond ticks, which would take minutes to visit
+        // one at a time.
+        var scheduler = new KeyExpiryScheduler(TimeSpan.FromDays(90), s_start, TimeSpan.FromMilliseconds(1));
+        var random = new Random(3);
+        CaskKeyFingerprint soon = CreateFingerprint(random);
+        CaskKeyFingerprint later = CreateFingerprint(random);
+        CaskKeyFingerprint beyondWheel = CreateFingerprint(random);
+
+        scheduler.Add(soon, s_start);
+        scheduler.Add(later, s_start.AddDays(30).AddMilliseconds(7));
+        scheduler.Add(beyondWheel, s_start.AddYears(5));
+
+        var expired = new List<CaskKeyFingerprint>();
+        Assert.Equal(0, scheduler.Advance(s_start.AddDays(90).AddMilliseconds(-1), expired.AddRange));
+        Assert.Equal(1, scheduler.Advance(s_start.AddDays(90), expired.AddRange));
+        Assert.Equal(0, scheduler.Advance(s_start.AddDays(120).AddMilliseconds(6), expired.AddRange));
+        Assert.Equal(1, scheduler.Advance(s_start.AddDays(120).AddMilliseconds(7), expired.AddRange));
+        Assert.Equal(1, scheduler.Advance(s_start.AddYears(10), expired.AddRange));
+
+        Assert.Equal([soon, later, beyondWheel], expired.ToArray());
+    }
+
+    [Fact]
+    public void KeyExpiryScheduler_Remove_CancelsExpiry()
+    {
+        var scheduler = new KeyExpiryScheduler(TimeSpan.FromMinutes(5), s_start);
+        var random = new Random(7);
+        CaskKeyFingerprint[] fingerprints = Enumerable.Range(0, 10).Select(_ => CreateFingerprint(random)).ToArray();
+
+        foreach (CaskKeyFingerprint fingerprint in fingerprints)
+        {
+            scheduler.Add(fingerprint, s_start);
+        }
+
+        Assert.True(scheduler.Remove(fingerprints[0]));
+        Assert.True(scheduler.Remove(fingerprints[9]));
+        Assert.True(scheduler.Remove(fingerprints[5]));
+        Assert.False(scheduler.Remove(fingerprints[5]));
+
+        var expired = new List<CaskKeyFingerprint>();
+        Assert.Equal(7, scheduler.Advance(s_start.AddMinutes(5), expired.AddRange));
+        Assert.DoesNotContain(fingerprints[0], expired);
+        Assert.DoesNotContain(fingerprints[5], expired);
+        Assert.DoesNotContain(fingerprints[9], expired);
+    }
+
+    [Fact]
+    public void KeyExpiryScheduler_Add_ExpiresOldKeyAtNextAdvance()
+    {
+        var scheduler = new KeyExpiryScheduler(TimeSpan.FromDays(1), s_start);
+        scheduler.Add(CreateFingerprint(new Random(1)), s_start.AddDays(-2));
+
+        Assert.Equal(1, scheduler.Advance(s_start, _ => { }));
+    }
+
+    private static CaskKeyFingerprint CreateFingerprint(Random random)
+    {
+        byte[] bytes = new byte[16];
+        random.NextBytes(bytes);
+        return CaskKeyFingerprint.Read(bytes);
+    }
+}
@@ -0,0 +1,246 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Tests;
+
+public sealed class KeyMetadataStoreTests : IDisposable
+{
+    private readonly string _directory = Path.Combine(Path.GetTempPath(), $"cask-{Guid.NewGuid():N}");
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_directory))
+        {
+            Directory.Delete(_directory, recursive: true);
+        }
+    }
+
+    [Fact]
+    public void KeyMetadataStore_Put_IsFoundBeforeAndAfterFlush()
+    {
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+        CaskKeyFingerprint fingerprint = CaskKeyFingerprint.Create(key);
+        var metadata = KeyMetadata.FromKey(key, Guid.NewGuid());
+
+        using KeyMetadataStore store = KeyMetadataStore.Open(_directory);
+        store.Put(fingerprint, metadata);
+
+        Assert.True(store.TryGet(key, out KeyMetadata found));
+        Assert.Equal(metadata, found);
+
+        store.Flush();
+
+        Assert.Equal(1, store.RunCount);
+        Assert.True(store.TryGet(fingerprint, out found));
+        Assert.Equal(metadata, found);
+        Assert.Equal("TEST", found.ProviderSignature);
+        Assert.Equal('M', found.ProviderKeyKind);
+        Assert.Equal(KeyStatus.Active, found.Status);
+        Assert.False(store.TryGet(CreateFingerprints(1, seed: 1)[0], out _));
+    }
+
+    [Fact]
+    public void KeyMetadataStore_NewerWrites_HideOlderRuns()
+    {
+        CaskKeyFingerprint[] fingerprints = CreateFingerprints(3, seed: 2);
+
+        using KeyMetadataStore store = KeyMetadataStore.Open(_directory);
+        foreach (CaskKeyFingerprint fingerprint in fingerprints)
+        {
+            store.Put(fingerprint, CreateMetadata(1));
+        }
+
+        store.Flush();
+        store.Put(fingerprints[0], CreateMetadata(2));
+        store.Remove(fingerprints[1]);
+        Assert.True(store.TrySetStatus(fingerprints[2], KeyStatus.Revoked));
+        Assert.False(store.TrySetStatus(CreateFingerprints(1, seed: 3)[0], KeyStatus.Revoked));
+
+        for (int flush = 0; flush < 2; flush++)
+        {
+            Assert.True(store.TryGet(fingerprints[0], out KeyMetadata metadata));
+            Assert.Equal(CreateMetadata(2), metadata);
+            Assert.False(store.TryGet(fingerprints[1], out _));
+            Assert.True(store.TryGet(fingerprints[2], out metadata));
+            Assert.Equal(KeyStatus.Revoked, metadata.Status);
+
+            store.Flush();
+        }
+    }
+
+    [Fact]
+    public void KeyMetadataStore_Compaction_BoundsRunsAndKeepsNewestRecords()
+    {
+        var options = new KeyMetadataStoreOptions { MemtableCapacity = 16, CompactionFanIn = 2 };
+        CaskKeyFingerprint[] fingerprints = CreateFingerprints(1000, seed: 4);
+
+        using KeyMetadataStore store = KeyMetadataStore.Open(_directory, options);
+        foreach (CaskKeyFingerprint fingerprint in fingerprints)
+        {
+            store.Put(fingerprint, CreateMetadata(1));
+        }
+
+        for (int i = 0; i < fingerprints.Length; i += 10)
+        {
+            store.Put(fingerprints[i], CreateMetadata(2));
+        }
+
+        store.Remove(fingerprints[1]);
+        store.Flush();
+
+        // At most one run per size class remains with a fan-in of 2.
+        Assert.InRange(store.RunCount, 1, 7);
+        Assert.Equal(store.RunCount, Directory.GetFiles(_directory, "*.run").Length);
+
+        for (int i = 0; i < fingerprints.Length; i++)
+        {
+            bool found = store.TryGet(fingerprints[i], out KeyMetadata metadata);
+            Assert.Equal(i != 1, found);
+
+            if (found)
+            {
+                Assert.Equal(CreateMetadata(i % 10 == 0 ? 2 : 1), metadata);
+            }
+        }
+    }
+
+    [Fact]
+    public void KeyMetadataStore_Reopen_RecoversWritesFromLog()
+    {
+        CaskKeyFingerprint[] fingerprints = CreateFingerprints(20, seed: 5);
+        var options = new KeyMetadataStoreOptions { MemtableCapacity = 8 };
+
+        using (KeyMetadataStore store = KeyMetadataStore.Open(_directory, options))
+        {
+            foreach (CaskKeyFingerprint fingerprint in fingerprints)
+            {
+                store.Put(fingerprint, CreateMetadata(1));
+            }
+
+            store.Remove(fingerprints[0]);
+        }
+
+        // A crash while appending leaves a partial record, and one during a
+        // flush a temporary file.
+        string log = Directory.GetFiles(_directory, "*.log").OrderBy(path => path, StringComparer.Ordinal).Last();
+        File.AppendAllText(log, "partial");
+        string temporary = Path.Combine(_directory, "0-1.run.tmp");
+        File.WriteAllText(temporary, "partial");
+
+        using (KeyMetadataStore store = KeyMetadataStore.Open(_directory, options))
+        {
+            Assert.False(store.TryGet(fingerprints[0], out _));
+            Assert.All(fingerprints.Skip(1), fingerprint => Assert.True(store.TryGet(fingerprint, out _)));
+            Assert.False(File.Exists(temporary));
+
+            store.Put(CreateFingerprints(1, seed: 6)[0], CreateMetadata(3));
+        }
+
+        using (KeyMetadataStore store = KeyMetadataStore.Open(_directory, options))
+        {
+            Assert.True(store.TryGet(CreateFingerprints(1, seed: 6)[0], out KeyMetadata metadata));
+            Assert.Equal(CreateMetadata(3), metadata);
+        }
+    }
+
+    [Theory]
+    [InlineData(1, 1)]
+    [InlineData(10, 7)]
+    [InlineData(64, 44)]
+    public void KeyMetadataStore_FilterBitsPerKey_SetsProbesThatReadersAgreeOn(int bitsPerKey, int probes)
+    {
+        CaskKeyFingerprint[] fingerprints = CreateFingerprints(1000, seed: 8);
+
+        Assert.Equal(probes, KeyMetadataRun.GetFilterProbes(bitsPerKey));
+
+        using (KeyMetadataStore store = KeyMetadataStore.Open(_directory, new KeyMetadataStoreOptions { FilterBitsPerKey = bitsPerKey }))
+        {
+            foreach (CaskKeyFingerprint fingerprint in fingerprints)
+            {
+                store.Put(fingerprint, CreateMetadata(1));
+            }
+
+            store.Flush();
+        }
+
+        // The probes of a run come from the bits per key it was written
+        // with, not those the store is opened with.
+        using (KeyMetadataStore store = KeyMetadataStore.Open(_directory, new KeyMetadataStoreOptions { FilterBitsPerKey = 65 - bitsPerKey }))
+        {
+            Assert.Equal(1, store.RunCount);
+            Assert.All(fingerprints, fingerprint => Assert.True(store.TryGet(fingerprint, out _)));
+            Assert.All(CreateFingerprints(100, seed: 9), fingerprint => Assert.False(store.TryGet(fingerprint, out _)));
+        }
+    }
+
+    [Fact]
+    public void KeyMetadataStore_OpenTwice_Throws()
+    {
+        using KeyMetadataStore store = KeyMetadataStore.Open(_directory);
+        Assert.Throws<IOException>(() => KeyMetadataStore.Open(_directory));
+    }
+
+    [Fact]
+    public void KeyMetadataStore_ConcurrentLookups_SeeEveryKeyDuringCompaction()
+    {
+        var options = new KeyMetadataStoreOptions { MemtableCapacity = 64, CompactionFanIn = 2 };
+        CaskKeyFingerprint[] fingerprints = CreateFingerprints(5000, seed: 7);
+        int written = 0;
+        int missing = 0;
+
+        using KeyMetadataStore store = KeyMetadataStore.Open(_directory, options);
+
+        Parallel.Invoke(
+            () =>
+            {
+                foreach (CaskKeyFingerprint fingerprint in fingerprints)
+                {
+                    store.Put(fingerprint, CreateMetadata(1));
+                    Volatile.Write(ref written, written + 1);
+                }
+            },
+            () =>
+            {
+                var random = new Random(7);
+                while (Volatile.Read(ref written) < fingerprints.Length)
+                {
+                    int count = Volatile.Read(ref written);
+                    if (count > 0 && !store.TryGet(fingerprints[random.Next(count)], out _))
+                    {
+                        Interlocked.Increment(ref missing);
+                    }
+                }
+            });
+
+        Assert.Equal(0, missing);
+    }
+
+    private static KeyMetadata CreateMetadata(int version)
+    {
+        return new KeyMetadata
+        {
+            ProviderSignature = "TEST",
+            ProviderKeyKind = 'M',
+            Timestamp = new DateTimeOffset(2025, 1, 1, 0, 0, 0, TimeSpan.Zero).AddTicks(version),
+            Owner = new Guid(version, 0, 0, new byte[8]),
+            Status = KeyStatus.Active,
+        };
+    }
+
+    private static CaskKeyFingerprint[] CreateFingerprints(int count, int seed)
+    {
+        var fingerprints = new CaskKeyFingerprint[count];
+        byte[] bytes = new byte[16];
+        var random = new Random(seed);
+
+        for (int i = 0; i < count; i++)
+        {
+            random.NextBytes(bytes);
+            fingerprints[i] = CaskKeyFingerprint.Read(bytes);
+        }
+
+        return fingerprints;
+    }
+}
@@ -0,0 +1,176 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Tests;
+
+public class KeyStatusClientTests
+{
+    [Fact]
+    public void CaskKeyFingerprint_ToString_RoundTrips()
+    {
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+        var fingerprint = CaskKeyFingerprint.Create(key);
+
+        Assert.Equal(fingerprint, CaskKeyFingerprint.Create(CaskKey.Create(key.ToString())));
+        Assert.NotEqual(fingerprint, CaskKeyFingerprint.Create(Cask.GenerateKey("TEST", 'M')));
+
+        string text = fingerprint.ToString();
+        Assert.Equal(22, text.Length);
+        Assert.True(CaskKeyFingerprint.TryParse(text.AsSpan(), out CaskKeyFingerprint parsed));
+        Assert.Equal(fingerprint, parsed);
+        Assert.False(CaskKeyFingerprint.TryParse(text.AsSpan(1), out _));
+    }
+
+    [Fact]
+    public async Task KeyStatusClient_GetStatusAsync_CoalescesLookupsOfSameKey()
+    {
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+        var service = new InMemoryKeyStatusService(TimeSpan.FromMilliseconds(50));
+        service.SetStatus(key, KeyStatus.Revoked);
+
+        using var client = new KeyStatusClient(service);
+        KeyStatus[] statuses = await Task.WhenAll(Enumerable.Range(0, 100).Select(_ => client.GetStatusAsync(key)));
+
+        Assert.All(statuses, status => Assert.Equal(KeyStatus.Revoked, status));
+        Assert.Equal(1, service.Requests);
+        Assert.Equal(99, client.Statistics.Coalesced);
+    }
+
+    [Fact]
+    public async Task KeyStatusClient_GetStatusAsync_BatchesDistinctKeys()
+    {
+        CaskKey[] keys = Enumerable.Range(0, 100).Select(_ => Cask.GenerateKey("TEST", 'M')).ToArray();
+        var service = new InMemoryKeyStatusService();
+        service.SetStatus(keys[0], KeyStatus.Active);
+
+        // The batch is sent when it is full, long before the delay passes.
+        var options = new KeyStatusClientOptions { MaxBatchSize = 50, MaxBatchDelay = TimeSpan.FromMinutes(1) };
+        using var client = new KeyStatusClient(service, options);
+        KeyStatus[] statuses = await Task.WhenAll(keys.Select(key => client.GetStatusAsync(key)));
+
+        Assert.Equal(KeyStatus.Active, statuses[0]);
+        Assert.All(statuses.Skip(1), status => Assert.Equal(KeyStatus.Unknown, status));
+        Assert.Equal(2, service.Requests);
+        Assert.Equal(100, service.RequestedKeys);
+    }
+
+    [Fact]
+    public async Task KeyStatusClient_GetStatusAsync_SendsPartialBatchAfterDelay()
+    {
+        var service = new InMemoryKeyStatusService();
+        using var client = new KeyStatusClient(service, new KeyStatusClientOptions { MaxBatchDelay = TimeSpan.FromMilliseconds(10) });
+
+        Assert.Equal(KeyStatus.Unknown, await client.GetStatusAsync(Cask.GenerateKey("TEST", 'M')));
+        Assert.Equal(1, service.Requests);
+    }
+
+    [Fact]
+    public async Task KeyStatusClient_GetStatusAsync_CachesStatus()
+    {
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+        var service = new InMemoryKeyStatusService();
+        service.SetStatus(key, KeyStatus.Active);
+
+        using var client = new KeyStatusClient(service, new KeyStatusClientOptions { MaxBatchDelay = TimeSpan.Zero });
+        Assert.Equal(KeyStatus.Active, await client.GetStatusAsync(key));
+
+        service.SetStatus(key, KeyStatus.Revoked);
+        Assert.Equal(KeyStatus.Active, await client.GetStatusAsync(key));
+        Assert.Equal(1, service.Requests);
+        Assert.Equal(1, client.Statistics.CacheHits);
+    }
+
+    [Fact]
+    public async Task KeyStatusClient_GetStatusAsync_DoesNotCacheWithoutTimeToLive()
+    {
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+        var service = new InMemoryKeyStatusService();
+        service.SetStatus(key, KeyStatus.Active);
+
+        var options = new KeyStatusClientOptions { MaxBatchDelay = TimeSpan.Zero, ActiveTimeToLive = TimeSpan.Zero };
+        using var client = new KeyStatusClient(service, options);
+        Assert.Equal(KeyStatus.Active, await client.GetStatusAsync(key));
+
+        service.SetStatus(key, KeyStatus.Revoked);
+        Assert.Equal(KeyStatus.Revoked, await client.GetStatusAsync(key));
+        Assert.Equal(2, service.Requests);
+    }
+
+    [Fact]
+    public async Task KeyStatusClient_GetStatusAsync_BoundsCache()
+    {
+        var service = new InMemoryKeyStatusService();
+        var options = new KeyStatusClientOptions { MaxBatchDelay = TimeSpan.Zero, MaxCacheEntries = 100 };
+        using var client = new KeyStatusClient(service, options);
+
+        CaskKey[] keys = Enumerable.Range(0, 500).Select(_ => Cask.GenerateKey("TEST", 'M')).ToArray();
+        foreach (CaskKey key in keys)
+        {
+            await client.GetStatusAsync(key);
+        }
+
+        // The most recently cached statuses are kept.
+        foreach (CaskKey key in keys.Reverse())
+        {
+            await client.GetStatusAsync(key);
+        }
+
+        Assert.InRange(client.Statistics.CacheHits, 75, 100);
+    }
+
+    [Fact]
+    public async Task KeyStatusClient_GetStatusAsync_FailsAndRetriesFailedRequest()
+    {
+        var service = new FailingKeyStatusService();
+        using var client = new KeyStatusClient(service, new KeyStatusClientOptions { MaxBatchDelay = TimeSpan.Zero });
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+
+        await Assert.ThrowsAsync<TimeoutException>(() => client.GetStatusAsync(key));
+        await Assert.ThrowsAsync<TimeoutException>(() => client.GetStatusAsync(key));
+        Assert.Equal(2, service.Requests);
+    }
+
+    [Fact]
+    public async Task KeyStatusClient_GetStatusAsync_CancelsOnlyCanceledLookup()
+    {
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+        var service = new InMemoryKeyStatusService(TimeSpan.FromMilliseconds(100));
+        service.SetStatus(key, KeyStatus.Active);
+
+        using var client = new KeyStatusClient(service);
+        using var cancellation = new CancellationTokenSource(TimeSpan.FromMilliseconds(10));
+
+        Task<KeyStatus> canceled = client.GetStatusAsync(key, cancellation.Token);
+        Task<KeyStatus> other = client.GetStatusAsync(key);
+
+        await Assert.ThrowsAnyAsync<OperationCanceledException>(() => canceled);
+        Assert.Equal(KeyStatus.Active, await other);
+    }
+
+    [Fact]
+    public async Task KeyStatusClient_Dispose_FailsPendingLookups()
+    {
+        var service = new InMemoryKeyStatusService();
+        var client = new KeyStatusClient(service, new KeyStatusClientOptions { MaxBatchDelay = TimeSpan.FromMinutes(1) });
+
+        Task<KeyStatus> lookup = client.GetStatusAsync(Cask.GenerateKey("TEST", 'M'));
+        client.Dispose();
+
+        await Assert.ThrowsAsync<ObjectDisposedException>(() => lookup);
+        Assert.Throws<ObjectDisposedException>(() => client.GetStatusAsync(Cask.GenerateKey("TEST", 'M')));
+        Assert.Equal(0, service.Requests);
+    }
+
+    private sealed class FailingKeyStatusService : IKeyStatusService
+    {
+        public int Requests { get; private set; }
+
+        public Task<IReadOnlyList<KeyStatus>> GetStatusesAsync(IReadOnlyList<CaskKeyFingerprint> fingerprints, CancellationToken cancellationToken)
+        {
+            Requests++;
+            return Task.FromException<IReadOnlyList<KeyStatus>>(new TimeoutException());
+        }
+    }
+}
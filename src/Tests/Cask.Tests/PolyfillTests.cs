@@ -21,6 +21,8 @@
 #pragma warning disable CA1846 // Prefer AsSpan over substring: not applicable on .NET Framework
 #pragma warning disable CA1872 // Prefer ToHexString over BitConverter: not applicable on .NET Framework
 
+using System.Buffers;
+using System.Buffers.Text;
 using System.Security.Cryptography;
 using System.Text;
 
@@ -119,6 +121,81 @@ public class PolyfillTests
         Assert.Equal(basic, Encoding.UTF8.GetString(bytes));
     }
 
+    [Fact]
+    public void Random_SmallFills_NoRepeats()
+    {
+        // Many key-sized requests, which reuse one per-thread buffer on .NET
+        // Framework.
+        var seen = new HashSet<string>();
+        byte[] random = new byte[32];
+
+        for (int i = 0; i < 1024; i++)
+        {
+            RandomNumberGenerator.Fill(random);
+            Assert.True(seen.Add(Convert.ToBase64String(random)), "RandomNumberGenerator produced a repeated 32-byte sequence.");
+        }
+    }
+
+    [Fact]
+    public void Base64Url_Decode_RoundTrip()
+    {
+        // Every 4-character aligned length up to and beyond the longest key.
+        for (int length = 0; length <= 192; length += 3)
+        {
+            byte[] expected = new byte[length];
+            RandomNumberGenerator.Fill(expected);
+            string encoded = Base64Url.EncodeToString(expected);
+            byte[] encodedUtf8 = Encoding.UTF8.GetBytes(encoded);
+            byte[] decoded = new byte[length];
+
+            OperationStatus status = Base64Url.DecodeFromChars(encoded.AsSpan(), decoded, out int consumed, out int written);
+            Assert.Equal(OperationStatus.Done, status);
+            Assert.Equal(encoded.Length, consumed);
+            Assert.Equal(length, written);
+            Assert.Equal(expected, decoded);
+
+            Array.Clear(decoded, 0, decoded.Length);
+            status = Base64Url.DecodeFromUtf8(encodedUtf8, decoded, out consumed, out written);
+            Assert.Equal(OperationStatus.Done, status);
+            Assert.Equal(encodedUtf8.Length, consumed);
+            Assert.Equal(length, written);
+            Assert.Equal(expected, decoded);
+
+            Array.Clear(decoded, 0, decoded.Length);
+            written = Base64Url.DecodeFromChars(encoded.AsSpan(), decoded);
+            Assert.Equal(length, written);
+            Assert.Equal(expected, decoded);
+        }
+    }
+
+    [Fact]
+    public void Base64Url_Decode_InvalidCharacter()
+    {
+        // U+0141 would be mistaken for 'A' by an implementation that narrows
+        // UTF-16 to bytes without checking the high byte.
+        char[] invalidChars = ['*', '.', '\u0141'];
+        byte[] decoded = new byte[48];
+
+        for (int i = 0; i < 64; i++)
+        {
+            foreach (char invalid in invalidChars)
+            {
+                char[] encoded = new string('A', 64).ToCharArray();
+                encoded[i] = invalid;
+
+                OperationStatus status = Base64Url.DecodeFromChars(encoded, decoded, out _, out _);
+                Assert.Equal(OperationStatus.InvalidData, status);
+
+                if (invalid < 0x80)
+                {
+                    byte[] encodedUtf8 = Encoding.UTF8.GetBytes(encoded);
+                    status = Base64Url.DecodeFromUtf8(encodedUtf8, decoded, out _, out _);
+                    Assert.Equal(OperationStatus.InvalidData, status);
+                }
+            }
+        }
+    }
+
 #if NETFRAMEWORK // We don't need to stress test the modern BCL :)
     [Fact]
     public async Task Polyfill_ThreadingStress()
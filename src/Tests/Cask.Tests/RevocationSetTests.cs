@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Tests;
+
+public class RevocationSetTests
+{
+    [Fact]
+    public void RevocationSet_Apply_PublishesNextVersion()
+    {
+        CaskKeyFingerprint[] keys = CreateFingerprints(10);
+        var set = new RevocationSet(RevocationSnapshot.Create(1, keys.Take(5)));
+        RevocationSnapshot first = set.Current;
+
+        set.Apply(new RevocationDelta(1, 2, added: keys.Skip(5), removed: [keys[0], keys[1]]));
+
+        Assert.Equal(2, set.Current.Version);
+        Assert.Equal(8, set.Current.Count);
+        Assert.False(set.IsRevoked(keys[0]));
+        Assert.False(set.IsRevoked(keys[1]));
+        Assert.All(keys.Skip(2), key => Assert.True(set.IsRevoked(key)));
+
+        // A reader's snapshot does not change.
+        Assert.Equal(1, first.Version);
+        Assert.True(first.Contains(keys[0]));
+        Assert.False(first.Contains(keys[9]));
+    }
+
+    [Fact]
+    public void RevocationSet_Apply_RejectsDeltaForOtherVersion()
+    {
+        var set = new RevocationSet();
+        Assert.Throws<InvalidOperationException>(() => set.Apply(new RevocationDelta(1, 2, CreateFingerprints(1), [])));
+        Assert.Equal(0, set.Current.Version);
+    }
+
+    [Fact]
+    public void RevocationSet_Apply_IgnoresRedundantChanges()
+    {
+        CaskKeyFingerprint[] keys = CreateFingerprints(3);
+        var set = new RevocationSet(RevocationSnapshot.Create(1, [keys[0]]));
+
+        set.Apply(new RevocationDelta(1, 2, added: [keys[0], keys[1], keys[1]], removed: [keys[2]]));
+
+        Assert.Equal(2, set.Current.Count);
+        Assert.True(set.IsRevoked(keys[0]));
+        Assert.True(set.IsRevoked(keys[1]));
+        Assert.False(set.IsRevoked(keys[2]));
+    }
+
+    [Fact]
+    public void RevocationSnapshot_Contains_FindsAllOfManyKeys()
+    {
+        CaskKeyFingerprint[] keys = CreateFingerprints(20_000);
+        RevocationSnapshot snapshot = RevocationSnapshot.Create(1, keys.Take(10_000));
+
+        for (int i = 0; i < keys.Length; i++)
+        {
+            Assert.Equal(i < 10_000, snapshot.Contains(keys[i]));
+        }
+
+        snapshot = snapshot.Apply(new RevocationDelta(1, 2, keys.Skip(10_000), keys.Take(5_000)));
+
+        for (int i = 0; i < keys.Length; i++)
+        {
+            Assert.Equal(i >= 5_000, snapshot.Contains(keys[i]));
+        }
+    }
+
+    [Fact]
+    public void RevocationSet_IsRevoked_FindsKey()
+    {
+        CaskKey key = Cask.GenerateKey("TEST", 'M');
+        var set = new RevocationSet();
+        set.Apply(new RevocationDelta(0, 1, [CaskKeyFingerprint.Create(key)], []));
+
+        Assert.True(set.IsRevoked(key));
+        Assert.False(set.IsRevoked(Cask.GenerateKey("TEST", 'M')));
+    }
+
+    [Fact]
+    public void RevocationDelta_Read_RoundTrips()
+    {
+        CaskKeyFingerprint[] keys = CreateFingerprints(5);
+        var delta = new RevocationDelta(7, 8, keys.Take(3), keys.Skip(3));
+
+        RevocationDelta read = RevocationDelta.Read(delta.ToArray());
+
+        Assert.Equal(7, read.BaseVersion);
+        Assert.Equal(8, read.Version);
+        Assert.Equal(delta.Added.ToArray(), read.Added.ToArray());
+        Assert.Equal(delta.Removed.ToArray(), read.Removed.ToArray());
+    }
+
+    [Fact]
+    public void RevocationDelta_Read_RejectsInvalidData()
+    {
+        CaskKeyFingerprint[] keys = CreateFingerprints(2);
+        byte[] data = new RevocationDelta(1, 2, keys, []).ToArray();
+
+        Assert.Throws<InvalidDataException>(() => RevocationDelta.Read(data.AsSpan(0, data.Length - 1)));
+
+        // Swap the two fingerprints so they are out of order.
+        byte[] unsorted = (byte[])data.Clone();
+        data.AsSpan(RevocationDelta.HeaderSize, 16).CopyTo(unsorted.AsSpan(RevocationDelta.HeaderSize + 16));
+        data.AsSpan(RevocationDelta.HeaderSize + 16, 16).CopyTo(unsorted.AsSpan(RevocationDelta.HeaderSize));
+        Assert.Throws<InvalidDataException>(() => RevocationDelta.Read(unsorted));
+
+        data[0] ^= 1;
+        Assert.Throws<InvalidDataException>(() => RevocationDelta.Read(data));
+    }
+
+    [Fact]
+    public void RevocationDelta_Constructor_RejectsInvalidChanges()
+    {
+        CaskKeyFingerprint[] keys = CreateFingerprints(1);
+
+        Assert.Throws<ArgumentOutOfRangeException>(() => new RevocationDelta(2, 2, keys, []));
+        Assert.Throws<ArgumentException>(() => new RevocationDelta(1, 2, keys, keys));
+    }
+
+    private static CaskKeyFingerprint[] CreateFingerprints(int count)
+    {
+        var fingerprints = new CaskKeyFingerprint[count];
+        byte[] bytes = new byte[16];
+        var random = new Random(count);
+
+        for (int i = 0; i < count; i++)
+        {
+            random.NextBytes(bytes);
+            fingerprints[i] = CaskKeyFingerprint.Read(bytes);
+        }
+
+        return fingerprints;
+    }
+}
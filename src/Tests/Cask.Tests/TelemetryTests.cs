@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Diagnostics.Metrics;
+using System.Text;
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Tests;
+
+public sealed class TelemetryTests : IDisposable
+{
+    private readonly MeterListener _listener = new();
+    private readonly List<Measurement> _measurements = [];
+
+    public TelemetryTests()
+    {
+        _listener.InstrumentPublished = (instrument, listener) =>
+        {
+            if (instrument.Meter.Name == CaskTelemetry.Name)
+            {
+                listener.EnableMeasurementEvents(instrument);
+            }
+        };
+
+        _listener.SetMeasurementEventCallback<long>((instrument, value, tags, _) => Record(instrument, value, tags));
+        _listener.SetMeasurementEventCallback<double>((instrument, value, tags, _) => Record(instrument, value, tags));
+        _listener.Start();
+    }
+
+    public void Dispose()
+    {
+        _listener.Dispose();
+    }
+
+    [Theory, InlineData(SecretSize.Bits256, "256"), InlineData(SecretSize.Bits512, "512")]
+    public void Telemetry_GenerateKey_RecordsGeneration(SecretSize secretSize, string expectedTag)
+    {
+        Cask.GenerateKey("TEST", 'M', providerData: null, secretSize);
+
+        Measurement[] measurements = GetMeasurementsOnCurrentThread();
+
+        Measurement generated = Assert.Single(measurements.Where(m => m.Name == "cask.keys.generated"));
+        Assert.Equal(1, generated.Value);
+        Assert.Equal(expectedTag, generated.Tags["cask.secret_size"]);
+
+        Measurement duration = Assert.Single(measurements.Where(m => m.Name == "cask.generate.duration"));
+        Assert.True(duration.Value >= 0);
+
+        // Generation validates the key internally, but that must not be
+        // reported as a validation.
+        Assert.DoesNotContain(measurements, m => m.Name == "cask.keys.validated");
+    }
+
+    [Fact]
+    public void Telemetry_UnknownSecretSize_IsNotCountedAs256Bits()
+    {
+        CaskTelemetry.RecordReissue((SecretSize)3, 1);
+
+        Measurement generated = Assert.Single(GetMeasurementsOnCurrentThread().Where(m => m.Name == "cask.keys.generated"));
+        Assert.Equal("unknown", generated.Tags["cask.secret_size"]);
+    }
+
+    [Fact]
+    public void Telemetry_Validation_RecordsOneMeasurementPerCall()
+    {
+        string key = Cask.GenerateKey("TEST", 'M').ToString();
+        byte[] keyUtf8 = Encoding.UTF8.GetBytes(key);
+        _ = GetMeasurementsOnCurrentThread(clear: true);
+
+        Assert.True(Cask.IsCask(key));
+        Assert.True(Cask.IsCaskUtf8(keyUtf8));
+        Assert.True(CaskKey.TryCreate(key, out _));
+        Assert.False(Cask.IsCask("NotACaskKey"));
+        Assert.False(Cask.IsCaskUtf8("NotACaskKey"u8));
+
+        string[] expected = ["valid/none", "valid/none", "valid/none", "invalid/length", "invalid/length"];
+        string[] outcomes = GetMeasurementsOnCurrentThread()
+            .Where(m => m.Name == "cask.keys.validated")
+            .Select(m => $"{m.Tags["cask.outcome"]}/{m.Tags["cask.reason"]}")
+            .ToArray();
+
+        Assert.Equal(expected, outcomes);
+    }
+
+    [Fact]
+    public void Telemetry_Scan_RecordsBytesAndMatches()
+    {
+        string key = Cask.GenerateKey("TEST", 'M').ToString();
+        byte[] text = Encoding.UTF8.GetBytes($"key={key}\n");
+        _ = GetMeasurementsOnCurrentThread(clear: true);
+
+        var scanner = new CaskScanner();
+        scanner.ScanUtf8(text, isFinalBlock: false, []);
+        scanner.ScanUtf8(text, isFinalBlock: true, []);
+
+        Measurement[] measurements = GetMeasurementsOnCurrentThread();
+
+        Assert.Equal(2 * text.Length, measurements.Where(m => m.Name == "cask.scan.bytes").Sum(m => m.Value));
+        Assert.Equal(2, measurements.Where(m => m.Name == "cask.scan.matches").Sum(m => m.Value));
+
+        // Keys found by scanning are validated, but that must not be
+        // reported as a validation.
+        Assert.DoesNotContain(measurements, m => m.Name == "cask.keys.validated");
+    }
+
+    private void Record(Instrument instrument, double value, ReadOnlySpan<KeyValuePair<string, object?>> tags)
+    {
+        var measurement = new Measurement(instrument.Name, value, tags.ToArray().ToDictionary(t => t.Key, t => t.Value), Environment.CurrentManagedThreadId);
+
+        lock (_measurements)
+        {
+            _measurements.Add(measurement);
+        }
+    }
+
+    // Other tests running in parallel also generate and validate keys, but
+    // measurements are always reported on the thread that made them.
+    private Measurement[] GetMeasurementsOnCurrentThread(bool clear = false)
+    {
+        lock (_measurements)
+        {
+            Measurement[] result = [.. _measurements.Where(m => m.ThreadId == Environment.CurrentManagedThreadId)];
+
+            if (clear)
+            {
+                _measurements.Clear();
+            }
+
+            return result;
+        }
+    }
+
+    private sealed record Measurement(string Name, double Value, Dictionary<string, object?> Tags, int ThreadId);
+}
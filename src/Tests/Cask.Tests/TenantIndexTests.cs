@@ -0,0 +1,172 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using Xunit;
+
+namespace CommonAnnotatedSecurityKeys.Tests;
+
+public class TenantIndexTests
+{
+    private const string MicrosoftTenantId = "782ef2bb-3056-4438-946d-395022a4a19f";
+
+    [Fact]
+    public void TenantProviderData_Encode_MatchesKnownKeys()
+    {
+        Assert.Equal("ACE6ioWU3a0MAAAA", TenantProviderData.Encode("westus", MicrosoftTenantId));
+        Assert.Equal("ACAAAAAAAAAAAAAA", TenantProviderData.Encode(null, " "));
+    }
+
+    [Fact]
+    public void TenantProviderData_TryDecode_RoundTrips()
+    {
+        string providerData = TenantProviderData.Encode("eastus", "contoso");
+
+        Assert.True(TenantProviderData.TryDecode(providerData.AsSpan(), out TenantProviderData data));
+        Assert.Equal(TenantProviderData.HashIdentifier("eastus"), data.RegionHash);
+        Assert.Equal(TenantProviderData.HashIdentifier("contoso"), data.TenantHash);
+    }
+
+    [Theory]
+    [InlineData("")]
+    [InlineData("ACE6ioWU3a0MAAA")]
+    [InlineData("AXE6ioWU3a0MAAAA")]
+    [InlineData("ACE6io+U3a0MAAAA")]
+    public void TenantProviderData_TryDecode_RejectsOtherLayouts(string providerData)
+    {
+        Assert.False(TenantProviderData.TryDecode(providerData.AsSpan(), out _));
+    }
+
+    [Theory]
+    [InlineData(SecretSize.Bits256)]
+    [InlineData(SecretSize.Bits512)]
+    public void TenantIndex_TryAttribute_FindsTenant(SecretSize secretSize)
+    {
+        var builder = new TenantIndexBuilder();
+        builder.AddRegion("westus");
+        builder.AddRegion("eastus");
+        builder.AddTenant(MicrosoftTenantId);
+        builder.AddTenant("contoso");
+
+        using TenantIndex index = builder.Build();
+        CaskKey key = Cask.GenerateKey("TEST", 'A', TenantProviderData.Encode("westus", MicrosoftTenantId), secretSize);
+
+        Assert.True(index.TryAttribute(key, out IReadOnlyList<string> regions, out IReadOnlyList<string> tenants));
+        Assert.Equal(["westus"], regions.ToArray());
+        Assert.Equal([MicrosoftTenantId], tenants.ToArray());
+    }
+
+    [Fact]
+    public void TenantIndex_TryAttribute_RejectsOtherProviderData()
+    {
+        using TenantIndex index = new TenantIndexBuilder().Build();
+        CaskKey key = Cask.GenerateKey("TEST", 'A', "ABCDEFGH", SecretSize.Bits256);
+
+        Assert.False(index.TryAttribute(key, out IReadOnlyList<string> regions, out IReadOnlyList<string> tenants));
+        Assert.Empty(regions);
+        Assert.Empty(tenants);
+    }
+
+    [Fact]
+    public void TenantIndex_Find_ReturnsAllTenantsWithHash()
+    {
+        // These two IDs have the same 30-bit hash prefix.
+        var builder = new TenantIndexBuilder();
+        builder.AddTenant("tenant-39588");
+        builder.AddTenant("tenant-67738");
+        builder.AddTenant("tenant-1");
+
+        using TenantIndex index = builder.Build();
+        string hash = TenantProviderData.HashIdentifier("tenant-39588");
+
+        Assert.Equal(hash, TenantProviderData.HashIdentifier("tenant-67738"));
+        Assert.Equal(["tenant-39588", "tenant-67738"], index.FindTenants(hash).OrderBy(t => t, StringComparer.Ordinal).ToArray());
+        Assert.Empty(index.FindTenants(TenantProviderData.HashIdentifier("tenant-2")));
+        Assert.Empty(index.FindTenants("not a hash"));
+    }
+
+    [Fact]
+    public void TenantIndexBuilder_Add_RejectsDuplicates()
+    {
+        var builder = new TenantIndexBuilder();
+        Assert.True(builder.AddTenant("contoso"));
+        Assert.False(builder.AddTenant("contoso"));
+
+        using TenantIndex index = builder.Build();
+        var incremental = new TenantIndexBuilder(index);
+        Assert.False(incremental.AddTenant("contoso"));
+        Assert.True(incremental.AddTenant("fabrikam"));
+        Assert.Equal(2, incremental.TenantCount);
+
+        Assert.Throws<ArgumentException>(() => builder.AddRegion(" "));
+    }
+
+    [Fact]
+    public void TenantIndexBuilder_Incremental_KeepsExistingEntries()
+    {
+        var builder = new TenantIndexBuilder();
+        for (int i = 0; i < 1000; i++)
+        {
+            builder.AddTenant($"tenant-{i}");
+        }
+
+        builder.AddRegion("westus");
+
+        using TenantIndex first = builder.Build();
+        var incremental = new TenantIndexBuilder(first);
+        for (int i = 1000; i < 1500; i++)
+        {
+            incremental.AddTenant($"tenant-{i}");
+        }
+
+        incremental.AddRegion("eastus");
+
+        using TenantIndex second = incremental.Build();
+        Assert.Equal(1500, second.TenantCount);
+        Assert.Equal(2, second.RegionCount);
+
+        for (int i = 0; i < 1500; i++)
+        {
+            Assert.Contains($"tenant-{i}", second.FindTenants(TenantProviderData.HashIdentifier($"tenant-{i}")));
+        }
+
+        Assert.Equal(["westus"], second.FindRegions(TenantProviderData.HashIdentifier("westus")).ToArray());
+        Assert.Equal(["eastus"], second.FindRegions(TenantProviderData.HashIdentifier("eastus")).ToArray());
+    }
+
+    [Fact]
+    public void TenantIndex_Open_MapsFile()
+    {
+        var builder = new TenantIndexBuilder();
+        builder.AddRegion("westus");
+        builder.AddTenant(MicrosoftTenantId);
+
+        string path = Path.GetTempFileName();
+        try
+        {
+            using (FileStream stream = File.Create(path))
+            {
+                builder.WriteTo(stream);
+            }
+
+            using TenantIndex index = TenantIndex.Open(path);
+            Assert.Equal(1, index.TenantCount);
+            Assert.Equal([MicrosoftTenantId], index.FindTenants("U3a0M").ToArray());
+        }
+        finally
+        {
+            File.Delete(path);
+        }
+    }
+
+    [Fact]
+    public void TenantIndex_Load_RejectsInvalidData()
+    {
+        byte[] index = new TenantIndexBuilder().ToArray();
+
+        Assert.Throws<InvalidDataException>(() => TenantIndex.Load(new byte[10]));
+        Assert.Throws<InvalidDataException>(() => TenantIndex.Load(index.AsMemory(0, index.Length - 1)));
+
+        index[0] ^= 1;
+        Assert.Throws<InvalidDataException>(() => TenantIndex.Load(index));
+    }
+}